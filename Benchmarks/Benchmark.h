@@ -0,0 +1,117 @@
+//***************************************************************************************
+// Benchmark.h
+//
+// Minimal harness for the console benchmark target.  Each benchmark is a function
+// declared with BENCHMARK(Name); it times the code it cares about with Measure() and
+// prints what it finds with Report().  What it checks is right goes through Check(), and
+// any check that fails fails the run.  Run the executable with a substring of a benchmark
+// name to run only the benchmarks that match.
+//
+// Every result reported is also kept, so the run can be written out as CSV or JSON and
+// compared against a CSV from an earlier run; see BenchmarkMain.cpp for the options.
+//***************************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Benchmark
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Measure runs the body untimed for this long first, or as many times as it will time
+	// it if that is sooner, so caches, the branch predictor and the clock speed have
+	// settled before the first sample.
+	const double WarmUpMs = 20.0;
+
+	// Samples slower than the median by more than this many robust standard deviations
+	// (1.4826 median absolute deviations) are dropped as interrupted runs, though none
+	// within OutlierFloor of the median is, however tightly the rest are bunched.
+	const double OutlierDeviations = 3.0;
+	const double OutlierFloor = 0.05;
+
+	struct Result
+	{
+		std::string Name;
+
+		// Runs timed, and how many of them were dropped as outliers
+		int Iterations = 0;
+		int Outliers = 0;
+
+		// Over the runs kept
+		double MinMs = 0.0;
+		double MedianMs = 0.0;
+		double MeanMs = 0.0;
+		double MaxMs = 0.0;
+		double StdDevMs = 0.0;
+	};
+
+	///<summary>
+	/// Sums up the samples, dropping outliers.
+	///</summary>
+	Result Summarize(const std::string& name, std::vector<double> samples);
+
+	///<summary>
+	/// Runs body untimed until WarmUpMs has passed or it has run iterations times, then
+	/// times it iterations times.
+	///</summary>
+	template<typename Body>
+	Result Measure(const std::string& name, int iterations, Body&& body)
+	{
+		const auto warmUpStart = Clock::now();
+		int warmUps = 0;
+		do
+		{
+			body();
+			++warmUps;
+		} while (warmUps < iterations &&
+			std::chrono::duration<double, std::milli>(Clock::now() - warmUpStart).count() < WarmUpMs);
+
+		std::vector<double> samples(iterations);
+		for (int i = 0; i < iterations; ++i)
+		{
+			auto start = Clock::now();
+			body();
+			samples[i] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+
+		return Summarize(name, std::move(samples));
+	}
+
+	///<summary>
+	/// Prints a result and keeps it, under the benchmark running, for the CSV and JSON
+	/// output and the baseline comparison.
+	///</summary>
+	void Report(const Result& result);
+
+	///<summary>
+	/// Passes if ok.  Otherwise prints the printf style message as a failure of the
+	/// benchmark running and counts it, so the run exits with 3.  Returns ok.
+	///</summary>
+	bool Check(bool ok, const char* format, ...);
+
+	// The checks that have failed so far
+	int Failures();
+
+	using Function = void(*)();
+
+	struct Registrar
+	{
+		Registrar(const char* name, Function function);
+	};
+
+	///<summary>
+	/// Runs every registered benchmark whose name contains filter (all of them if the
+	/// filter is empty).  Returns the number run.
+	///</summary>
+	int RunAll(const std::string& filter);
+}
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static Benchmark::Registrar name##Registrar(#name, name); \
+	static void name()
@@ -0,0 +1,327 @@
+//***************************************************************************************
+// BenchmarkMain.cpp
+//
+//   Benchmarks [filter] [-csv file] [-json file] [-baseline file] [-threshold percent]
+//
+// -csv and -json write every result reported.  -baseline reads a CSV written by -csv on
+// an earlier run and compares the median of each result found in both; any that has
+// slowed by more than the threshold (10% if not given) is a regression, and the run
+// exits with 2.  A run with any failed check exits with 3, whatever the timings.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace
+{
+	struct Entry
+	{
+		const char* Name;
+		Benchmark::Function Function;
+	};
+
+	// Function-local so registrations from other translation units can run in any order.
+	std::vector<Entry>& Registry()
+	{
+		static std::vector<Entry> registry;
+		return registry;
+	}
+
+	// A result reported, with the benchmark that reported it
+	struct Reported
+	{
+		std::string Benchmark;
+		Benchmark::Result Result;
+	};
+
+	std::vector<Reported> gReported;
+	const char* gRunning = "";
+
+	// The benchmark of each check that failed
+	std::vector<std::string> gFailures;
+
+	double MedianOfSorted(const std::vector<double>& sorted)
+	{
+		size_t n = sorted.size();
+		return n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+	}
+
+	std::string Quoted(const std::string& text)
+	{
+		std::string quoted = "\"";
+		for (char c : text)
+		{
+			if (c == '"')
+				quoted += '"';
+			quoted += c;
+		}
+		return quoted + '"';
+	}
+
+	// Splits one CSV line, undoing Quoted
+	std::vector<std::string> SplitCsv(const std::string& line)
+	{
+		std::vector<std::string> fields(1);
+		bool quoted = false;
+		for (size_t i = 0; i < line.size(); ++i)
+		{
+			char c = line[i];
+			if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+				fields.back() += c, ++i;
+			else if (c == '"')
+				quoted = !quoted;
+			else if (c == ',' && !quoted)
+				fields.emplace_back();
+			else if (c != '\r')
+				fields.back() += c;
+		}
+		return fields;
+	}
+
+	std::string Key(const std::string& benchmark, const std::string& name)
+	{
+		return benchmark + '/' + name;
+	}
+
+	void WriteCsv(std::ostream& out)
+	{
+		out << "benchmark,name,runs,outliers,min_ms,median_ms,mean_ms,max_ms,stddev_ms\n";
+		out.precision(9);
+		for (const Reported& r : gReported)
+		{
+			const Benchmark::Result& result = r.Result;
+			out << r.Benchmark << ',' << Quoted(result.Name) << ',' << result.Iterations << ',' << result.Outliers << ','
+				<< result.MinMs << ',' << result.MedianMs << ',' << result.MeanMs << ',' << result.MaxMs << ','
+				<< result.StdDevMs << '\n';
+		}
+	}
+
+	void WriteJson(std::ostream& out)
+	{
+		out.precision(9);
+		out << "{\n  \"results\": [";
+		for (size_t i = 0; i < gReported.size(); ++i)
+		{
+			const Benchmark::Result& result = gReported[i].Result;
+			std::string name = result.Name;
+			for (size_t at = name.find('"'); at != std::string::npos; at = name.find('"', at + 2))
+				name.insert(at, 1, '\\');
+
+			out << (i ? ",\n" : "\n") << "    { \"benchmark\": \"" << gReported[i].Benchmark << "\", \"name\": \"" << name
+				<< "\", \"runs\": " << result.Iterations << ", \"outliers\": " << result.Outliers
+				<< ", \"minMs\": " << result.MinMs << ", \"medianMs\": " << result.MedianMs << ", \"meanMs\": " << result.MeanMs
+				<< ", \"maxMs\": " << result.MaxMs << ", \"stdDevMs\": " << result.StdDevMs << " }";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+	// The median of every result in a CSV written by WriteCsv
+	bool ReadBaseline(const std::string& fileName, std::map<std::string, double>& medians)
+	{
+		std::ifstream in(fileName);
+		if (!in)
+			return false;
+
+		std::string line;
+		std::getline(in, line);
+		while (std::getline(in, line))
+		{
+			std::vector<std::string> fields = SplitCsv(line);
+			if (fields.size() >= 6)
+				medians[Key(fields[0], fields[1])] = std::atof(fields[5].c_str());
+		}
+		return true;
+	}
+
+	///<summary>
+	/// Prints how the median of each result in the baseline has changed, and returns the
+	/// number that slowed by more than thresholdPercent.
+	///</summary>
+	int Compare(const std::map<std::string, double>& baseline, double thresholdPercent)
+	{
+		std::printf("\nAgainst the baseline (regression above %.1f%%)\n", thresholdPercent);
+
+		int regressions = 0, compared = 0;
+		for (const Reported& r : gReported)
+		{
+			auto found = baseline.find(Key(r.Benchmark, r.Result.Name));
+			if (found == baseline.end() || found->second <= 0.0)
+				continue;
+
+			double change = 100.0 * (r.Result.MedianMs - found->second) / found->second;
+			bool regressed = change > thresholdPercent;
+			std::printf("  %-56s %9.4f ms -> %9.4f ms %+7.1f%%%s\n", Key(r.Benchmark, r.Result.Name).c_str(),
+				found->second, r.Result.MedianMs, change, regressed ? "  REGRESSION" : "");
+			regressions += regressed;
+			++compared;
+		}
+
+		std::printf("  %d of %d results compared regressed\n", regressions, compared);
+		return regressions;
+	}
+}
+
+Benchmark::Registrar::Registrar(const char* name, Function function)
+{
+	Registry().push_back({ name, function });
+}
+
+Benchmark::Result Benchmark::Summarize(const std::string& name, std::vector<double> samples)
+{
+	Result result;
+	result.Name = name;
+	result.Iterations = (int)samples.size();
+	if (samples.empty())
+		return result;
+
+	std::sort(samples.begin(), samples.end());
+	const double median = MedianOfSorted(samples);
+
+	std::vector<double> deviations;
+	deviations.reserve(samples.size());
+	for (double s : samples)
+		deviations.push_back(std::fabs(s - median));
+	std::sort(deviations.begin(), deviations.end());
+
+	// Interruptions only ever make a run slower, so only the slow side is trimmed.  A
+	// median of 0 from a coarse clock leaves nothing to judge by.
+	const double allowed = std::max(OutlierDeviations * 1.4826 * MedianOfSorted(deviations), OutlierFloor * median);
+	while (allowed > 0.0 && samples.size() > 1 && samples.back() > median + allowed)
+	{
+		samples.pop_back();
+		++result.Outliers;
+	}
+
+	const double n = (double)samples.size();
+	result.MinMs = samples.front();
+	result.MedianMs = MedianOfSorted(samples);
+	result.MaxMs = samples.back();
+	for (double s : samples)
+		result.MeanMs += s;
+	result.MeanMs /= n;
+	for (double s : samples)
+		result.StdDevMs += (s - result.MeanMs) * (s - result.MeanMs);
+	result.StdDevMs = samples.size() > 1 ? std::sqrt(result.StdDevMs / (n - 1.0)) : 0.0;
+
+	return result;
+}
+
+void Benchmark::Report(const Result& result)
+{
+	std::printf("  %-40s %8.4f ms min %8.4f ms median %8.4f ms mean (%d runs",
+		result.Name.c_str(), result.MinMs, result.MedianMs, result.MeanMs, result.Iterations);
+	if (result.Outliers > 0)
+		std::printf(", %d slow dropped", result.Outliers);
+	std::printf(")\n");
+
+	gReported.push_back({ gRunning, result });
+}
+
+bool Benchmark::Check(bool ok, const char* format, ...)
+{
+	if (ok)
+		return true;
+
+	std::printf("  FAILED: ");
+	va_list args;
+	va_start(args, format);
+	std::vprintf(format, args);
+	va_end(args);
+	std::printf("\n");
+
+	gFailures.push_back(gRunning);
+	return false;
+}
+
+int Benchmark::Failures()
+{
+	return (int)gFailures.size();
+}
+
+int Benchmark::RunAll(const std::string& filter)
+{
+	int run = 0;
+	for (const Entry& entry : Registry())
+	{
+		if (std::string(entry.Name).find(filter) == std::string::npos)
+			continue;
+
+		std::printf("%s\n", entry.Name);
+		gRunning = entry.Name;
+		entry.Function();
+		++run;
+	}
+
+	return run;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string filter, csvName, jsonName, baselineName;
+	double thresholdPercent = 10.0;
+	for (int i = 1; i < argc; ++i)
+	{
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "-csv") == 0 && hasValue)
+			csvName = argv[++i];
+		else if (std::strcmp(argv[i], "-json") == 0 && hasValue)
+			jsonName = argv[++i];
+		else if (std::strcmp(argv[i], "-baseline") == 0 && hasValue)
+			baselineName = argv[++i];
+		else if (std::strcmp(argv[i], "-threshold") == 0 && hasValue)
+			thresholdPercent = std::atof(argv[++i]);
+		else if (argv[i][0] != '-')
+			filter = argv[i];
+		else
+		{
+			std::fprintf(stderr, "Usage: Benchmarks [filter] [-csv file] [-json file] [-baseline file] [-threshold percent]\n");
+			return 1;
+		}
+	}
+
+	// Read the baseline first, so a run is not wasted on a missing file
+	std::map<std::string, double> baseline;
+	if (!baselineName.empty() && !ReadBaseline(baselineName, baseline))
+	{
+		std::fprintf(stderr, "Cannot read baseline %s\n", baselineName.c_str());
+		return 1;
+	}
+
+	if (Benchmark::RunAll(filter) == 0)
+	{
+		std::printf("No benchmarks match \"%s\"\n", filter.c_str());
+		return 1;
+	}
+
+	if (!csvName.empty())
+	{
+		std::ofstream csv(csvName);
+		WriteCsv(csv);
+	}
+	if (!jsonName.empty())
+	{
+		std::ofstream json(jsonName);
+		WriteJson(json);
+	}
+
+	const bool regressed = !baselineName.empty() && Compare(baseline, thresholdPercent) > 0;
+	if (Benchmark::Failures() > 0)
+	{
+		std::printf("\n%d checks failed, in", Benchmark::Failures());
+		for (size_t i = 0; i < gFailures.size(); ++i)
+			if (i == 0 || gFailures[i] != gFailures[i - 1])
+				std::printf(" %s", gFailures[i].c_str());
+		std::printf("\n");
+		return 3;
+	}
+	if (regressed)
+		return 2;
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+//***************************************************************************************
+// BoundsBenchmark.cpp
+//
+// Times MeshBounds against a straightforward scalar loop over a mesh of several million
+// vertices laid out like the app's Vertex, so the positions are strided rather than packed.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/MeshBounds.h"
+#include "../FrameResource.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	void ScalarBounds(const std::vector<Vertex>& vertices, BoundingBox& box, BoundingSphere& sphere)
+	{
+		XMFLOAT3 vMin(FLT_MAX, FLT_MAX, FLT_MAX);
+		XMFLOAT3 vMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (const Vertex& v : vertices)
+		{
+			vMin.x = std::min(vMin.x, v.Pos.x); vMax.x = std::max(vMax.x, v.Pos.x);
+			vMin.y = std::min(vMin.y, v.Pos.y); vMax.y = std::max(vMax.y, v.Pos.y);
+			vMin.z = std::min(vMin.z, v.Pos.z); vMax.z = std::max(vMax.z, v.Pos.z);
+		}
+
+		box.Center = XMFLOAT3(0.5f*(vMin.x + vMax.x), 0.5f*(vMin.y + vMax.y), 0.5f*(vMin.z + vMax.z));
+		box.Extents = XMFLOAT3(0.5f*(vMax.x - vMin.x), 0.5f*(vMax.y - vMin.y), 0.5f*(vMax.z - vMin.z));
+
+		float radiusSq = 0.0f;
+		for (const Vertex& v : vertices)
+		{
+			float dx = v.Pos.x - box.Center.x;
+			float dy = v.Pos.y - box.Center.y;
+			float dz = v.Pos.z - box.Center.z;
+			radiusSq = std::max(radiusSq, dx*dx + dy*dy + dz*dz);
+		}
+
+		sphere.Center = box.Center;
+		sphere.Radius = std::sqrt(radiusSq);
+	}
+}
+
+BENCHMARK(MeshBoundsReduction)
+{
+	const size_t vertexCount = 4000000;
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+
+	std::vector<Vertex> vertices(vertexCount);
+	for (Vertex& v : vertices)
+		v.Pos = XMFLOAT3(position(rng), position(rng), position(rng));
+
+	BoundingBox scalarBox, simdBox;
+	BoundingSphere scalarSphere, simdSphere;
+
+	auto scalar = Benchmark::Measure("scalar bounds, 4M vertices", 20, [&]()
+	{
+		ScalarBounds(vertices, scalarBox, scalarSphere);
+	});
+
+	auto simd = Benchmark::Measure("MeshBounds, 4M vertices", 20, [&]()
+	{
+		MeshBounds::Compute(&vertices[0].Pos, vertices.size(), sizeof(Vertex), simdBox, simdSphere);
+	});
+
+	Benchmark::Report(scalar);
+	Benchmark::Report(simd);
+	std::printf("  MeshBounds is %.1fx faster (median), %.0f million vertices/s\n",
+		scalar.MedianMs / simd.MedianMs, vertexCount / 1.0e3 / simd.MedianMs);
+
+	Benchmark::Check(std::fabs(scalarSphere.Radius - simdSphere.Radius) <= 1e-3f &&
+		std::fabs(scalarBox.Extents.x - simdBox.Extents.x) <= 1e-3f, "bounds differ from the scalar reference");
+}
@@ -0,0 +1,96 @@
+//***************************************************************************************
+// BvhBenchmark.cpp
+//
+// Builds a Bvh over a million boxes, refits it after moving all of them and after moving
+// one in a hundred, and compares its frustum query with culling every box.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/Bvh.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+BENCHMARK(BoundingVolumeHierarchy)
+{
+	const std::uint32_t instanceCount = 1000000;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+	std::vector<BoundingBox> boxes(instanceCount);
+	FrustumCuller culler;
+	culler.Reserve(instanceCount);
+	for (BoundingBox& box : boxes)
+	{
+		box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+		box.Extents = XMFLOAT3(size(rng), size(rng), size(rng));
+		culler.Add(box);
+	}
+
+	Bvh bvh;
+	auto build = Benchmark::Measure("Build, 1M boxes", 5, [&]()
+	{
+		bvh.Build(boxes.data(), instanceCount);
+	});
+
+	// Nudge every hundredth box, as a turning slice moves a few of the cubies
+	std::vector<std::uint32_t> moved;
+	for (std::uint32_t i = 0; i < instanceCount; i += 100)
+		moved.push_back(i);
+
+	float offset = 0.01f;
+	auto fullRefit = Benchmark::Measure("Refit, every box", 20, [&]()
+	{
+		for (std::uint32_t i : moved)
+			boxes[i].Center.x += offset;
+		offset = -offset;
+		bvh.Refit(boxes.data());
+	});
+
+	auto partialRefit = Benchmark::Measure("Refit, 1 in 100 boxes moved", 20, [&]()
+	{
+		for (std::uint32_t i : moved)
+			boxes[i].Center.x += offset;
+		offset = -offset;
+		bvh.Refit(boxes.data(), moved.data(), (std::uint32_t)moved.size());
+	});
+
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -10.0f, 1.0f),
+		XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f*XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+	FrustumPlanes frustum = FrustumPlanes::FromMatrix(XMMatrixMultiply(view, proj));
+
+	for (std::uint32_t i = 0; i < instanceCount; ++i)
+		culler.Set(i, boxes[i]);
+
+	std::vector<std::uint32_t> linearVisible(instanceCount), bvhVisible;
+	size_t linearCount = 0;
+	bvhVisible.reserve(instanceCount);
+
+	auto linear = Benchmark::Measure("FrustumCuller, every box", 20, [&]()
+	{
+		linearCount = culler.CullBoxes(frustum, linearVisible.data());
+	});
+
+	auto query = Benchmark::Measure("Bvh frustum query", 20, [&]()
+	{
+		bvhVisible.clear();
+		bvh.QueryFrustum(frustum, bvhVisible);
+	});
+
+	Benchmark::Report(build);
+	Benchmark::Report(fullRefit);
+	Benchmark::Report(partialRefit);
+	Benchmark::Report(linear);
+	Benchmark::Report(query);
+	std::printf("  partial refit is %.1fx faster than a full one, the query %.1fx faster than culling every box (median)\n",
+		fullRefit.MedianMs / partialRefit.MedianMs, linear.MedianMs / query.MedianMs);
+
+	linearVisible.resize(linearCount);
+	std::sort(bvhVisible.begin(), bvhVisible.end());
+	Benchmark::Check(bvhVisible == linearVisible, "the Bvh found different boxes to FrustumCuller");
+}
@@ -0,0 +1,124 @@
+//***************************************************************************************
+// CommandLogBenchmark.cpp
+//
+// Records a thousand frames shaped like Rubix drawing every cubie on its own into a
+// CommandLog, against a RenderCommands that only counts, to see what logging adds to
+// each command.  The log is then read back with Analyze, and its counts checked against
+// what was recorded.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/CommandLog.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const int FrameCount = 1000;
+	const int DrawsPerFrame = 26;
+	const std::uint32_t ConstantStride = 256;
+
+	// Takes every command and does nothing but count it
+	class CountingCommands : public RenderCommands
+	{
+	public:
+		void Barrier(const void*, ResourceState, ResourceState) override { ++Count; }
+		void SetPipelineState(const void*) override { ++Count; }
+		void SetRootDescriptorTable(std::uint32_t, std::uint64_t) override { ++Count; }
+		void SetRootConstantBufferView(std::uint32_t, std::uint64_t) override { ++Count; }
+		void SetRootShaderResourceView(std::uint32_t, std::uint64_t) override { ++Count; }
+		void SetVertexBuffer(const VertexBufferView&) override { ++Count; }
+		void SetIndexBuffer(const IndexBufferView&) override { ++Count; }
+		void SetPrimitiveTopology(Topology) override { ++Count; }
+		void DrawIndexed(std::uint32_t, std::uint32_t, std::int32_t) override { ++Count; }
+
+		std::uint64_t Count = 0;
+	};
+
+	// One frame, binding everything again for every draw as CubeScene::RecordDraws does
+	void RecordFrame(RenderCommands& commands, int frame)
+	{
+		static const char backBuffer = 0;
+		static const char pipelineState = 0;
+
+		RenderCommands::VertexBufferView vertices;
+		vertices.Address = 0x10000000;
+		vertices.ByteSize = 1 << 20;
+		vertices.Stride = 32;
+		RenderCommands::IndexBufferView indices;
+		indices.Address = 0x20000000;
+		indices.ByteSize = 1 << 18;
+
+		const std::uint64_t constants = 0x100000000 + (std::uint64_t)(frame % 3) * 0x1000000;
+		commands.Barrier(&backBuffer, RenderCommands::StatePresent, RenderCommands::StateRenderTarget);
+		commands.SetRootConstantBufferView(2, constants + 0x800000);
+		commands.SetPipelineState(&pipelineState);
+		for (int i = 0; i < DrawsPerFrame; ++i)
+		{
+			commands.SetVertexBuffer(vertices);
+			commands.SetIndexBuffer(indices);
+			commands.SetPrimitiveTopology(RenderCommands::TriangleList);
+			commands.SetRootDescriptorTable(0, 0x30000000);
+			commands.SetRootConstantBufferView(1, constants + i * ConstantStride);
+			commands.SetRootConstantBufferView(3, constants + 0xC00000);
+			commands.DrawIndexed(600 + 12 * i, 1000 * i, 0);
+		}
+		commands.Barrier(&backBuffer, RenderCommands::StateRenderTarget, RenderCommands::StatePresent);
+	}
+}
+
+BENCHMARK(CommandLogging)
+{
+	const std::vector<std::uint32_t> rootBytes = { 0, 192, 512, 80, 0 };
+
+	CountingCommands counting;
+	auto direct = Benchmark::Measure("1000 frames to a counter", 20, [&]()
+	{
+		for (int f = 0; f < FrameCount; ++f)
+			RecordFrame(counting, f);
+	});
+
+	CommandLog log(rootBytes);
+	auto logged = Benchmark::Measure("1000 frames to a CommandLog", 20, [&]()
+	{
+		log.Clear();
+		for (int f = 0; f < FrameCount; ++f)
+		{
+			log.BeginFrame();
+			RecordFrame(log, f);
+		}
+	});
+
+	std::ostringstream out;
+	log.Write(out);
+	const std::string bytes = out.str();
+
+	std::vector<CommandLog::FrameSummary> frames;
+	std::string error;
+	bool read = false;
+	auto analyzing = Benchmark::Measure("Analyze 1000 frames", 20, [&]()
+	{
+		read = CommandLog::Analyze(bytes.data(), bytes.size(), frames, error);
+	});
+
+	// Every draw after the first sets the same buffers, topology, texture and material
+	bool countsMatch = read && frames.size() == FrameCount;
+	for (size_t f = 0; countsMatch && f < frames.size(); ++f)
+	{
+		const auto& frame = frames[f];
+		countsMatch = frame.Draws == DrawsPerFrame && frame.Commands == 4 + 7 * DrawsPerFrame &&
+			frame.RedundantTotal() == 5 * (DrawsPerFrame - 1) &&
+			frame.ConstantBytes == 512 + 80 + 192 * DrawsPerFrame;
+	}
+
+	const double commandCount = (double)FrameCount * (4 + 7 * DrawsPerFrame);
+	Benchmark::Report(direct);
+	Benchmark::Report(logged);
+	Benchmark::Report(analyzing);
+	std::printf("  %.1f ns a command to a counter, %.1f ns logged, %.1f ns to analyze; %.1f bytes a frame\n",
+		direct.MedianMs * 1.0e6 / commandCount, logged.MedianMs * 1.0e6 / commandCount,
+		analyzing.MedianMs * 1.0e6 / commandCount, (double)bytes.size() / FrameCount);
+	Benchmark::Check(countsMatch, "the analysis does not match what was recorded%s%s", error.empty() ? "" : ": ", error.c_str());
+}
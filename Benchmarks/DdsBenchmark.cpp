@@ -0,0 +1,270 @@
+//***************************************************************************************
+// DdsBenchmark.cpp
+//
+// Reads the headers of three DDS files built in memory the way DDSTextureLoader does
+// before it creates anything: checks the header, works out the format and sizes every
+// mip with GetSurfaceInfo.  One is a 2048x2048 BC1 texture with the DX10 extension, one
+// the same as legacy DXT1 and one a 1024x1024 A8R8G8B8 bitmask texture.  The mip sizes
+// are checked against the bytes each file holds after its headers.
+//
+// Then loads a 2048x2048 RGBA texture from disk both ways the file path has: reading the
+// whole file into memory before copying its mips into a staging buffer, as the loader
+// used to, and mapping it with DDSFile and copying the mips straight out of the mapping.
+// The file stays in the OS page cache between runs, so this is the warm load time.
+// Last, copies of the file with headers past what Direct3D 12 allows are checked to be
+// refused by DDSFile::Open.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/DDSFile.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	const int ParseCount = 10000;
+	const std::wstring TextureFile = L"benchmark_texture.dds";
+
+	struct BuiltFile
+	{
+		const char* Name;
+		std::vector<std::uint8_t> Bytes;
+	};
+
+	std::uint32_t MipCount(std::uint32_t width, std::uint32_t height)
+	{
+		std::uint32_t count = 1;
+		while (width > 1 || height > 1)
+		{
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+			++count;
+		}
+		return count;
+	}
+
+	size_t ChainBytes(std::uint32_t width, std::uint32_t height, DXGI_FORMAT format)
+	{
+		size_t total = 0;
+		for (std::uint32_t mip = 0; mip < MipCount(width, height); ++mip)
+		{
+			size_t numBytes = 0;
+			GetSurfaceInfo(width >> mip ? width >> mip : 1, height >> mip ? height >> mip : 1, format, &numBytes,
+				nullptr, nullptr);
+			total += numBytes;
+		}
+		return total;
+	}
+
+	// A file with a full mip chain, its pixels left zero
+	BuiltFile Build(const char* name, std::uint32_t width, std::uint32_t height, const DDS_PIXELFORMAT& ddpf,
+		DXGI_FORMAT format)
+	{
+		DDS_HEADER header = {};
+		header.size = sizeof(DDS_HEADER);
+		header.flags = 0x1 | DDS_HEIGHT | DDS_WIDTH | 0x1000 | 0x20000; // CAPS, PIXELFORMAT, MIPMAPCOUNT
+		header.height = height;
+		header.width = width;
+		header.mipMapCount = MipCount(width, height);
+		header.ddspf = ddpf;
+		header.caps = 0x1000 | 0x400000 | 0x8; // TEXTURE, MIPMAP, COMPLEX
+
+		const bool dx10 = (ddpf.flags & DDS_FOURCC) && ddpf.fourCC == MAKEFOURCC('D', 'X', '1', '0');
+		DDS_HEADER_DXT10 extension = {};
+		extension.dxgiFormat = format;
+		extension.resourceDimension = 3; // D3D11_RESOURCE_DIMENSION_TEXTURE2D
+		extension.arraySize = 1;
+
+		BuiltFile file;
+		file.Name = name;
+		file.Bytes.resize(sizeof(std::uint32_t) + sizeof(header) + (dx10 ? sizeof(extension) : 0) +
+			ChainBytes(width, height, format));
+		std::uint8_t* at = file.Bytes.data();
+		std::memcpy(at, &DDS_MAGIC, sizeof(std::uint32_t));
+		std::memcpy(at + sizeof(std::uint32_t), &header, sizeof(header));
+		if (dx10)
+			std::memcpy(at + sizeof(std::uint32_t) + sizeof(header), &extension, sizeof(extension));
+		return file;
+	}
+
+	DDS_PIXELFORMAT FourCC(std::uint32_t fourCC)
+	{
+		DDS_PIXELFORMAT ddpf = {};
+		ddpf.size = sizeof(DDS_PIXELFORMAT);
+		ddpf.flags = DDS_FOURCC;
+		ddpf.fourCC = fourCC;
+		return ddpf;
+	}
+
+	DDS_PIXELFORMAT A8R8G8B8()
+	{
+		DDS_PIXELFORMAT ddpf = {};
+		ddpf.size = sizeof(DDS_PIXELFORMAT);
+		ddpf.flags = DDS_RGB | 0x1; // DDPF_ALPHAPIXELS
+		ddpf.RGBBitCount = 32;
+		ddpf.RBitMask = 0x00ff0000;
+		ddpf.GBitMask = 0x0000ff00;
+		ddpf.BBitMask = 0x000000ff;
+		ddpf.ABitMask = 0xff000000;
+		return ddpf;
+	}
+
+	// Writes file with the uint32 at offset into its header, after the magic number,
+	// replaced by value, and returns whether DDSFile will open it
+	bool OpensWith(const BuiltFile& file, size_t offset, std::uint32_t value)
+	{
+		std::vector<std::uint8_t> bytes = file.Bytes;
+		std::memcpy(bytes.data() + sizeof(std::uint32_t) + offset, &value, sizeof(value));
+		{
+			std::ofstream out(NarrowPath(TextureFile), std::ios::binary);
+			out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		}
+		DDSFile dds;
+		return dds.Open(TextureFile);
+	}
+
+	// What the loaders work out from the headers before creating a texture: the format
+	// and the bytes of every mip.  Returns the bytes of the whole chain, or 0 if the file
+	// is not one they would load.
+	size_t ReadHeaders(const std::vector<std::uint8_t>& bytes)
+	{
+		const DDS_HEADER* header = nullptr;
+		const std::uint8_t* bitData = nullptr;
+		size_t bitSize = 0;
+		if (!ReadDDSHeader(bytes.data(), bytes.size(), &header, &bitData, &bitSize))
+			return 0;
+
+		const DDS_HEADER_DXT10* extension = GetDDSHeaderDXT10(header);
+		DXGI_FORMAT format = extension ? extension->dxgiFormat : GetDXGIFormat(header->ddspf);
+		if (BitsPerPixel(format) == 0)
+			return 0;
+
+		size_t total = 0;
+		size_t width = header->width, height = header->height;
+		for (std::uint32_t mip = 0; mip < header->mipMapCount; ++mip)
+		{
+			size_t numBytes = 0, rowBytes = 0, numRows = 0;
+			GetSurfaceInfo(width, height, format, &numBytes, &rowBytes, &numRows);
+			total += numBytes;
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+		return total <= bitSize ? total : 0;
+	}
+}
+
+BENCHMARK(DdsHeaders)
+{
+	BuiltFile files[] = {
+		Build("DX10 BC1 2048x2048, 12 mips", 2048, 2048, FourCC(MAKEFOURCC('D', 'X', '1', '0')), DXGI_FORMAT_BC1_UNORM),
+		Build("DXT1 2048x2048, 12 mips", 2048, 2048, FourCC(MAKEFOURCC('D', 'X', 'T', '1')), DXGI_FORMAT_BC1_UNORM),
+		Build("A8R8G8B8 1024x1024, 11 mips", 1024, 1024, A8R8G8B8(), DXGI_FORMAT_B8G8R8A8_UNORM),
+	};
+
+	for (const BuiltFile& file : files)
+	{
+		size_t total = 0;
+		auto result = Benchmark::Measure(std::string(file.Name) + ", 10k reads", 50, [&]()
+		{
+			total = 0;
+			for (int i = 0; i < ParseCount; ++i)
+				total += ReadHeaders(file.Bytes);
+		});
+		size_t chainBytes = total / ParseCount;
+
+		Benchmark::Report(result);
+		std::printf("    %.1f ns a file\n", result.MedianMs * 1.0e6 / ParseCount);
+		size_t headerBytes = file.Bytes.size() - chainBytes;
+		Benchmark::Check(chainBytes != 0 && (headerBytes == 128 || headerBytes == 148),
+			"the mip sizes do not add up to what the file holds");
+	}
+}
+
+BENCHMARK(DdsFileLoading)
+{
+	BuiltFile file = Build("", 2048, 2048, FourCC(MAKEFOURCC('D', 'X', '1', '0')), DXGI_FORMAT_R8G8B8A8_UNORM);
+	{
+		std::ofstream out(NarrowPath(TextureFile), std::ios::binary);
+		out.write(reinterpret_cast<const char*>(file.Bytes.data()), file.Bytes.size());
+		if (!out)
+		{
+			std::printf("  could not write %ls, skipping\n", TextureFile.c_str());
+			return;
+		}
+	}
+
+	// Stands in for the upload heap
+	std::vector<std::uint8_t> staging(ChainBytes(2048, 2048, DXGI_FORMAT_R8G8B8A8_UNORM));
+	size_t readCopied = 0;
+	size_t mappedCopied = 0;
+
+	auto read = Benchmark::Measure("read whole file, copy mips to staging", 20, [&]()
+	{
+		std::ifstream in(NarrowPath(TextureFile), std::ios::binary | std::ios::ate);
+		std::vector<std::uint8_t> bytes((size_t)in.tellg());
+		in.seekg(0);
+		in.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+		const DDS_HEADER* header = nullptr;
+		const std::uint8_t* bitData = nullptr;
+		size_t bitSize = 0;
+		readCopied = 0;
+		if (ReadDDSHeader(bytes.data(), bytes.size(), &header, &bitData, &bitSize) && bitSize <= staging.size())
+		{
+			std::memcpy(staging.data(), bitData, bitSize);
+			readCopied = bitSize;
+		}
+	});
+
+	std::vector<DDSFile::Surface> surfaces;
+	auto mapped = Benchmark::Measure("map with DDSFile, copy mips to staging", 20, [&]()
+	{
+		DDSFile dds;
+		mappedCopied = 0;
+		if (!dds.Open(TextureFile) || !dds.GetSurfaces(surfaces))
+			return;
+
+		for (const DDSFile::Surface& surface : surfaces)
+		{
+			const size_t bytes = (size_t)(surface.SlicePitch * surface.Depth);
+			std::memcpy(staging.data() + mappedCopied, surface.Data, bytes);
+			mappedCopied += bytes;
+		}
+	});
+
+	auto layout = Benchmark::Measure("map with DDSFile, lay out mips only", 200, [&]()
+	{
+		DDSFile dds;
+		if (dds.Open(TextureFile))
+			dds.GetSurfaces(surfaces);
+	});
+
+	Benchmark::Report(read);
+	Benchmark::Report(mapped);
+	Benchmark::Report(layout);
+	std::printf("  mapping is %.1fx faster (median), %.1f MB copied once instead of twice\n",
+		read.MedianMs / mapped.MedianMs, mappedCopied / (1024.0 * 1024.0));
+	Benchmark::Check(readCopied == staging.size() && mappedCopied == staging.size() && surfaces.size() == 12,
+		"the mips copied do not add up to the texture");
+
+	// Offsets of the DX10 header's fields are past the DDS header
+	const size_t arraySizeOffset = sizeof(DDS_HEADER) + offsetof(DDS_HEADER_DXT10, arraySize);
+	const size_t miscFlagOffset = sizeof(DDS_HEADER) + offsetof(DDS_HEADER_DXT10, miscFlag);
+	int accepted = 0;
+	accepted += OpensWith(file, offsetof(DDS_HEADER, mipMapCount), 0xFFFFFFFF);
+	accepted += OpensWith(file, offsetof(DDS_HEADER, mipMapCount), 13);
+	accepted += OpensWith(file, offsetof(DDS_HEADER, width), 0);
+	accepted += OpensWith(file, offsetof(DDS_HEADER, height), 32768);
+	accepted += OpensWith(file, arraySizeOffset, 0);
+	accepted += OpensWith(file, arraySizeOffset, 0xFFFFFFFF);
+	accepted += OpensWith(file, miscFlagOffset, 0x4) ? 0 : 1; // one cube is fine
+	Benchmark::Check(accepted == 0, "%d of 7 headers were judged wrongly against the Direct3D 12 limits", accepted);
+
+	std::remove(NarrowPath(TextureFile).c_str());
+}
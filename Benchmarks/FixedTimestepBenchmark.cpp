@@ -0,0 +1,121 @@
+//***************************************************************************************
+// FixedTimestepBenchmark.cpp
+//
+// Runs the whole-cube spin headless through FixedTimestep: a minute of frames drawn at a
+// steady 144Hz, at a jittery 20-70Hz, and with half-second stalls.  However the frames
+// fall, the spin should end up exactly where the same number of steps puts it, and the
+// stalls should drop steps rather than queue them.  Also times how many steps a second
+// the spin, with every cubie's world matrix rebuilt, can run with no window at all.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/FixedTimestep.h"
+#include "../Common/RandomEngine.h"
+#include <cstdio>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// As Rubix::Simulate and Rubix::UpdateObjects, for a cube spinning around y
+	struct Spin
+	{
+		float Angle = 0.3f;
+		float PrevAngle = 0.3f;
+
+		void Simulate(float dt)
+		{
+			PrevAngle = Angle;
+			Angle += 0.486f * dt;
+		}
+
+		void Pose(const std::vector<XMFLOAT4X4>& rest, std::vector<XMFLOAT4X4>& worlds, float alpha)const
+		{
+			float rotated = PrevAngle + (Angle - PrevAngle) * alpha;
+			for (size_t i = 0; i < rest.size(); ++i)
+			{
+				XMMATRIX world = XMMatrixMultiply(XMLoadFloat4x4(&rest[i]), XMMatrixRotationY(XMConvertToRadians(rotated)));
+				XMStoreFloat4x4(&worlds[i], world);
+				rotated += 0.0003f;
+			}
+		}
+	};
+
+	struct Run
+	{
+		const char* Name;
+		std::uint64_t Steps;
+		std::uint64_t Dropped;
+		float Angle;
+	};
+
+	template<typename FrameTime>
+	Run Play(const char* name, FrameTime&& frameTime)
+	{
+		FixedTimestep timestep(60.0, 8);
+		Spin spin;
+
+		for (double t = 0.0; t < 60.0; )
+		{
+			double dt = frameTime();
+			t += dt;
+
+			int steps = timestep.Advance(dt);
+			for (int i = 0; i < steps; ++i)
+				spin.Simulate(timestep.StepSeconds());
+		}
+
+		return { name, timestep.StepCount(), timestep.DroppedSteps(), spin.Angle };
+	}
+}
+
+BENCHMARK(SimulationSteps)
+{
+	RandomEngine engine(42);
+	int frame = 0;
+
+	Run runs[3] =
+	{
+		Play("steady 144Hz", [&]() { return 1.0 / 144.0; }),
+		Play("jittery 20-70Hz", [&]() { return (double)engine.NextFloat(1.0f / 70.0f, 1.0f / 20.0f); }),
+		Play("60Hz, stall every 5s", [&]() { return ++frame % 300 == 0 ? 0.5 : 1.0 / 60.0; }),
+	};
+
+	// 27 cubies laid out like the cube, spun for 10000 steps
+	std::vector<XMFLOAT4X4> rest(27), worlds(27);
+	for (int i = 0; i < 27; ++i)
+		XMStoreFloat4x4(&rest[i], XMMatrixTranslation((float)(i % 3) - 1.0f, (float)(i / 3 % 3) - 1.0f, (float)(i / 9) - 1.0f));
+
+	const int stepCount = 10000;
+	auto headless = Benchmark::Measure("Spin and pose 27 cubies, 10000 steps", 20, [&]()
+	{
+		FixedTimestep timestep(60.0, 8);
+		Spin spin;
+		for (int i = 0; i < 2 * stepCount; ++i)
+		{
+			// Frames at twice the step rate, so every other frame interpolates
+			int steps = timestep.Advance(1.0 / 120.0);
+			for (int s = 0; s < steps; ++s)
+				spin.Simulate(timestep.StepSeconds());
+
+			spin.Pose(rest, worlds, timestep.Alpha());
+		}
+	});
+
+	Benchmark::Report(headless);
+	std::printf("  %.0f steps per second headless, with two frames posed per step\n",
+		stepCount / (headless.MedianMs * 1.0e-3));
+
+	for (const Run& run : runs)
+	{
+		// Replaying the same number of steps directly must land on the same angle
+		Spin expected;
+		for (std::uint64_t i = 0; i < run.Steps; ++i)
+			expected.Simulate(FixedTimestep(60.0).StepSeconds());
+
+		std::printf("  %-22s %6llu steps, %4llu dropped, spin %.6f degrees\n", run.Name,
+			(unsigned long long)run.Steps, (unsigned long long)run.Dropped, run.Angle);
+		Benchmark::Check(run.Angle == expected.Angle, "%s differs from replaying the steps", run.Name);
+	}
+}
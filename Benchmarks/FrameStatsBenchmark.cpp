@@ -0,0 +1,90 @@
+//***************************************************************************************
+// FrameStatsBenchmark.cpp
+//
+// Feeds FrameStats a million frames at 60Hz with one frame in a hundred stuttering, and
+// times adding frames and summarizing the window.  The percentiles are checked against
+// sorting the window outright, and the histogram against counting it, and both exports
+// are written to memory to see what they cost.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/FrameStats.h"
+#include "../Common/RandomEngine.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	float PresentMs(RandomEngine& engine)
+	{
+		float ms = engine.NextFloat(16.0f, 17.4f);
+		if (engine.NextInt(0, 99) == 0)
+			ms += engine.NextFloat(10.0f, 40.0f);
+		return ms;
+	}
+}
+
+BENCHMARK(FrameStatistics)
+{
+	const int frameCount = 1000000;
+
+	RandomEngine engine(42);
+	std::vector<float> frames(3 * frameCount);
+	for (int i = 0; i < frameCount; ++i)
+	{
+		frames[3 * i + 0] = engine.NextFloat(0.5f, 2.0f);
+		frames[3 * i + 1] = engine.NextFloat(1.0f, 4.0f);
+		frames[3 * i + 2] = PresentMs(engine);
+	}
+
+	FrameStats stats;
+	auto adding = Benchmark::Measure("AddFrame, 1M frames", 10, [&]()
+	{
+		stats.Clear();
+		for (int i = 0; i < frameCount; ++i)
+			stats.AddFrame(frames[3 * i + 0], frames[3 * i + 1], frames[3 * i + 2]);
+	});
+
+	FrameStats::Summary present;
+	auto summarizing = Benchmark::Measure("Summarize present times, 1000 times", 10, [&]()
+	{
+		for (int i = 0; i < 1000; ++i)
+			present = stats.Summarize(FrameStats::Present);
+	});
+
+	std::ostringstream csv, json;
+	auto exporting = Benchmark::Measure("WriteCsv and WriteJson", 10, [&]()
+	{
+		csv.str("");
+		json.str("");
+		stats.WriteCsv(csv);
+		stats.WriteJson(json);
+	});
+
+	// The last WindowSize present times, sorted outright
+	std::vector<float> window(frames.end() - 3 * FrameStats::WindowSize, frames.end());
+	std::vector<float> sorted;
+	for (size_t i = 2; i < window.size(); i += 3)
+		sorted.push_back(window[i]);
+	std::sort(sorted.begin(), sorted.end());
+
+	size_t n = sorted.size();
+	bool percentilesMatch = present.P50 == sorted[n / 2] && present.P95 == sorted[n * 95 / 100] &&
+		present.P99 == sorted[n * 99 / 100] && present.Max == sorted.back();
+
+	std::vector<std::uint32_t> counted(FrameStats::BucketCount, 0);
+	for (float ms : sorted)
+		++counted[FrameStats::BucketOf(ms)];
+	bool histogramMatches = std::equal(counted.begin(), counted.end(), stats.Histogram(FrameStats::Present).begin());
+
+	Benchmark::Report(adding);
+	Benchmark::Report(summarizing);
+	Benchmark::Report(exporting);
+	std::printf("  %.1f ns per frame added, %.1f us per summary; exports are %zu and %zu bytes\n",
+		adding.MedianMs * 1.0e6 / frameCount, summarizing.MedianMs, csv.str().size(), json.str().size());
+	std::printf("  present: mean %.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+		present.Mean, present.P50, present.P95, present.P99, present.Max);
+	Benchmark::Check(percentilesMatch && histogramMatches, "the summary or histogram differs from sorting the window");
+}
@@ -0,0 +1,124 @@
+//***************************************************************************************
+// FrameUpdateBenchmark.cpp
+//
+// Times the camera's matrix rebuilds on their own, then ten seconds of CubeScene frames
+// at 60Hz with a scramble playing: the update stages Rubix::Update runs, from the camera
+// to the pass constants, staging every frame's object and pass constants into plain
+// memory standing in for the upload buffers, as the headless runner does.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../CubeScene.h"
+#include "../CubieMesh.h"
+#include "../Common/Camera.h"
+#include <cstdio>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	const int CameraUpdates = 10000;
+	const int FrameCount = 600;
+	const int FrameResourceCount = 3;
+	const float StepSeconds = 1.0f / 60.0f;
+
+	// Plain memory in place of a frame resource's upload buffers
+	struct FrameMemory
+	{
+		std::vector<std::uint8_t> Objects;
+		PassConstants Pass;
+	};
+
+	// The cubie mesh as the window draws it, as in the headless runner
+	void BuildScene(CubeScene& scene)
+	{
+		CubieMesh mesh = BuildCubieMesh(CubieMeshDesc());
+		BoundingBox box;
+		BoundingSphere sphere;
+		CubieBounds(mesh, box, sphere);
+
+		scene.SetCubieMesh(CubieLodChains(mesh), box, sphere, gCubieLodDistances);
+		scene.SetViewport(800.0f, 600.0f);
+		scene.Reset();
+	}
+}
+
+BENCHMARK(CameraMatrices)
+{
+	Camera camera;
+	camera.SetOrbit(XMFLOAT3(0.0f, 0.0f, 0.0f), 10.0f, 1.5f * XM_PI, 0.3f * XM_PI);
+	float checksum = 0.0f;
+
+	auto orbit = Benchmark::Measure("Orbit + UpdateViewMatrix, 10k", 50, [&]()
+	{
+		for (int i = 0; i < CameraUpdates; ++i)
+		{
+			camera.Orbit(0.001f, (i & 1) ? 0.0005f : -0.0005f);
+			camera.UpdateViewMatrix();
+		}
+		checksum += camera.GetView4x4f()._41;
+	});
+
+	auto lens = Benchmark::Measure("SetLens, 10k", 50, [&]()
+	{
+		for (int i = 0; i < CameraUpdates; ++i)
+			camera.SetLens(0.25f * XM_PI, 1.0f + (i & 15) * 0.01f, 1.0f, 1000.0f);
+		checksum += camera.GetProj4x4f()._11;
+	});
+
+	auto planes = Benchmark::Measure("GetFrustumPlanes, 10k", 50, [&]()
+	{
+		for (int i = 0; i < CameraUpdates; ++i)
+			checksum += camera.GetFrustumPlanes().Planes[i % 6].x;
+	});
+
+	Benchmark::Report(orbit);
+	Benchmark::Report(lens);
+	Benchmark::Report(planes);
+	std::printf("  %.1f ns an orbit, %.1f ns a lens, %.1f ns a set of planes (checksum %g)\n",
+		orbit.MedianMs * 1.0e6 / CameraUpdates, lens.MedianMs * 1.0e6 / CameraUpdates,
+		planes.MedianMs * 1.0e6 / CameraUpdates, checksum);
+}
+
+BENCHMARK(FrameUpdate)
+{
+	CubeScene scene(FrameResourceCount);
+	BuildScene(scene);
+
+	std::vector<FrameMemory> frames(FrameResourceCount);
+	const size_t objectStride = (sizeof(ObjectConstants) + 255) & ~size_t(255);
+	for (FrameMemory& frame : frames)
+		frame.Objects.resize(objectStride * CubeScene::CubieCount);
+
+	float totalTime = 0.0f;
+	auto result = Benchmark::Measure("600 frames, scrambling", 20, [&]()
+	{
+		scene.Reset();
+		scene.QueueScramble(40);
+		for (int f = 0; f < FrameCount; ++f)
+		{
+			scene.Simulate(StepSeconds);
+			totalTime += StepSeconds;
+
+			FrameMemory& memory = frames[f % FrameResourceCount];
+			FrameConstants constants;
+			constants.Objects = memory.Objects.data();
+			constants.ObjectStride = objectStride;
+			constants.Pass = &memory.Pass;
+
+			scene.UpdateCamera(StepSeconds);
+			scene.UpdateLods();
+			scene.UpdateObjects(1.0f);
+			scene.RotateThird(StepSeconds);
+			scene.StoreStagedWorlds(constants);
+			scene.UpdateObjectCBs(constants);
+			scene.UpdateVisibility();
+			scene.UpdateMainPassCB(constants, totalTime, StepSeconds);
+		}
+	});
+
+	Benchmark::Report(result);
+	std::printf("  %.2f us a frame to update and stage the constants of %d cubies\n",
+		result.MedianMs * 1.0e3 / FrameCount, CubeScene::CubieCount);
+}
@@ -0,0 +1,94 @@
+//***************************************************************************************
+// FrustumCullBenchmark.cpp
+//
+// Culls a million boxes scattered around the camera, about a tenth of which are in view,
+// with FrustumCuller and with a loop that tests one box against one plane at a time.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/FrustumCuller.h"
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	size_t ScalarCull(const std::vector<BoundingBox>& boxes, const FrustumPlanes& frustum, std::uint32_t* visible)
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < boxes.size(); ++i)
+		{
+			const BoundingBox& box = boxes[i];
+
+			bool outside = false;
+			for (const XMFLOAT4& p : frustum.Planes)
+			{
+				float dist = p.x*box.Center.x + p.y*box.Center.y + p.z*box.Center.z + p.w;
+				float reach = std::abs(p.x)*box.Extents.x + std::abs(p.y)*box.Extents.y + std::abs(p.z)*box.Extents.z;
+				if (dist + reach < 0.0f)
+				{
+					outside = true;
+					break;
+				}
+			}
+
+			if (!outside)
+				visible[count++] = (std::uint32_t)i;
+		}
+
+		return count;
+	}
+}
+
+BENCHMARK(FrustumCull)
+{
+	const size_t instanceCount = 1000000;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+	std::vector<BoundingBox> boxes(instanceCount);
+	FrustumCuller culler;
+	culler.Reserve(instanceCount);
+	for (BoundingBox& box : boxes)
+	{
+		box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+		box.Extents = XMFLOAT3(size(rng), size(rng), size(rng));
+		culler.Add(box);
+	}
+
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -10.0f, 1.0f),
+		XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f*XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+	FrustumPlanes frustum = FrustumPlanes::FromMatrix(XMMatrixMultiply(view, proj));
+
+	std::vector<std::uint32_t> scalarVisible(instanceCount), boxVisible(instanceCount), sphereVisible(instanceCount);
+	size_t scalarCount = 0, boxCount = 0, sphereCount = 0;
+
+	auto scalar = Benchmark::Measure("scalar boxes, 1M instances", 20, [&]()
+	{
+		scalarCount = ScalarCull(boxes, frustum, scalarVisible.data());
+	});
+
+	auto simdBoxes = Benchmark::Measure("FrustumCuller boxes, 1M instances", 20, [&]()
+	{
+		boxCount = culler.CullBoxes(frustum, boxVisible.data());
+	});
+
+	auto simdSpheres = Benchmark::Measure("FrustumCuller spheres, 1M instances", 20, [&]()
+	{
+		sphereCount = culler.CullSpheres(frustum, sphereVisible.data());
+	});
+
+	Benchmark::Report(scalar);
+	Benchmark::Report(simdBoxes);
+	Benchmark::Report(simdSpheres);
+	std::printf("  %zu boxes visible (%zu as spheres), boxes are %.1fx faster than scalar (median)\n",
+		boxCount, sphereCount, scalar.MedianMs / simdBoxes.MedianMs);
+
+	scalarVisible.resize(scalarCount);
+	boxVisible.resize(boxCount);
+	Benchmark::Check(scalarVisible == boxVisible, "FrustumCuller kept different boxes to the scalar reference");
+}
@@ -0,0 +1,112 @@
+//***************************************************************************************
+// GameTimerBenchmark.cpp
+//
+// Drives a GameTimer from a ManualClock through frames of known length and a pause, and
+// checks the times it reports and records.  Then times Tick() on the system clock, and
+// has one thread push frame times into a FrameTimeRing while another keeps copying out
+// the latest ones; every copy must be a run of consecutive frames.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/GameTimer.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Frame lengths in milliseconds, with a pause after the fourth
+	const double FrameMs[] = { 16.0, 17.0, 15.0, 33.0, 8.0, 16.0 };
+
+	int CheckManualClock()
+	{
+		ManualClock clock;
+		GameTimer timer(clock);
+		timer.Reset();
+
+		int errors = 0;
+		double total = 0.0;
+		for (int i = 0; i < 6; ++i)
+		{
+			if (i == 4)
+			{
+				// Time while stopped must not count
+				timer.Stop();
+				clock.Advance(2.0);
+				timer.Start();
+			}
+
+			clock.Advance(FrameMs[i] * 1.0e-3);
+			timer.Tick();
+			total += FrameMs[i] * 1.0e-3;
+
+			errors += std::fabs(timer.DeltaTime() - FrameMs[i] * 1.0e-3) > 1.0e-6 ? 1 : 0;
+			errors += std::fabs(timer.TotalTime() - total) > 1.0e-6 ? 1 : 0;
+		}
+
+		float recorded[6];
+		size_t count = timer.DeltaHistory().Latest(recorded, 6);
+		errors += count != 6 ? 1 : 0;
+		for (size_t i = 0; i < count; ++i)
+			errors += std::fabs(recorded[i] - FrameMs[i] * 1.0e-3) > 1.0e-6 ? 1 : 0;
+
+		return errors;
+	}
+}
+
+BENCHMARK(FrameTiming)
+{
+	int manualErrors = CheckManualClock();
+
+	const int tickCount = 1000000;
+	GameTimer timer;
+	timer.Reset();
+	auto ticks = Benchmark::Measure("GameTimer::Tick, 1M ticks", 10, [&]()
+	{
+		for (int i = 0; i < tickCount; ++i)
+			timer.Tick();
+	});
+
+	// Frame numbers stand in for frame times; floats hold them exactly up to 2^24
+	const int pushCount = 4000000;
+	FrameTimeRing ring;
+	std::atomic<bool> done(false);
+	long long copies = 0, torn = 0;
+
+	std::thread reader([&]()
+	{
+		std::vector<float> latest(FrameTimeRing::Capacity);
+		while (!done.load())
+		{
+			std::uint64_t first;
+			size_t count = ring.Latest(latest.data(), latest.size(), &first);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (latest[i] != (float)(first + i))
+				{
+					++torn;
+					break;
+				}
+			}
+			++copies;
+		}
+	});
+
+	auto start = Benchmark::Clock::now();
+	for (int i = 0; i < pushCount; ++i)
+		ring.Push((float)i);
+	double pushMs = std::chrono::duration<double, std::milli>(Benchmark::Clock::now() - start).count();
+
+	done.store(true);
+	reader.join();
+
+	Benchmark::Report(ticks);
+	std::printf("  %.1f ns per Tick on the system clock (%lld ticks per second)\n",
+		ticks.MedianMs * 1.0e6 / tickCount, (long long)GameTimer::SystemClock().TicksPerSecond());
+	std::printf("  %.1f ns per push with a reader copying alongside; %lld copies of the latest %zu frames\n",
+		pushMs * 1.0e6 / pushCount, copies, FrameTimeRing::Capacity);
+	Benchmark::Check(manualErrors == 0, "%d times differ from the manual clock", manualErrors);
+	Benchmark::Check(torn == 0, "%lld copies were not consecutive frames", torn);
+}
@@ -0,0 +1,86 @@
+//***************************************************************************************
+// GeometryBenchmark.cpp
+//
+// Times each GeometryGenerator::Create function at the sizes the app and the samples it
+// came from use them, and a few finer ones.  Subdivide is private, so it is timed
+// through CreateBox, which does nothing after building the 24 vertex box but subdivide
+// it: a box subdivided n times less one not subdivided at all is n Subdivide calls.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/GeometryGenerator.h"
+#include <cstdio>
+
+namespace
+{
+	// The smallest meshes are made this many times a run, to time more than the clock
+	const int SmallMeshCount = 1000;
+}
+
+BENCHMARK(GeometryGeneration)
+{
+	GeometryGenerator geoGen;
+	GeometryGenerator::MeshData mesh;
+	GeometryGenerator::FaceRange faceRanges[GeometryGenerator::CubieFaceCount];
+
+	auto box = Benchmark::Measure("CreateBox, 1000", 50, [&]()
+	{
+		for (int i = 0; i < SmallMeshCount; ++i)
+			mesh = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0);
+	});
+
+	auto subdividedBox = Benchmark::Measure("CreateBox, 5 subdivisions", 50, [&]()
+	{
+		mesh = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 5);
+	});
+	const size_t subdividedTriangles = mesh.Indices32.size() / 3;
+
+	auto cubie = Benchmark::Measure("CreateCubie, 3 bevel segments", 200, [&]()
+	{
+		mesh = geoGen.CreateCubie(1.0f, 0.08f, 3, 1, faceRanges);
+	});
+
+	auto fineCubie = Benchmark::Measure("CreateCubie, 16 bevel segments", 50, [&]()
+	{
+		mesh = geoGen.CreateCubie(1.0f, 0.08f, 16, 8, faceRanges);
+	});
+
+	auto sphere = Benchmark::Measure("CreateSphere, 64 x 64", 50, [&]()
+	{
+		mesh = geoGen.CreateSphere(1.0f, 64, 64);
+	});
+
+	auto geosphere = Benchmark::Measure("CreateGeosphere, 5 subdivisions", 50, [&]()
+	{
+		mesh = geoGen.CreateGeosphere(1.0f, 5);
+	});
+
+	auto cylinder = Benchmark::Measure("CreateCylinder, 64 x 64", 50, [&]()
+	{
+		mesh = geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 64, 64);
+	});
+
+	auto grid = Benchmark::Measure("CreateGrid, 256 x 256", 50, [&]()
+	{
+		mesh = geoGen.CreateGrid(160.0f, 160.0f, 256, 256);
+	});
+
+	auto quad = Benchmark::Measure("CreateQuad, 1000", 50, [&]()
+	{
+		for (int i = 0; i < SmallMeshCount; ++i)
+			mesh = geoGen.CreateQuad(0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+	});
+
+	Benchmark::Report(box);
+	Benchmark::Report(subdividedBox);
+	Benchmark::Report(cubie);
+	Benchmark::Report(fineCubie);
+	Benchmark::Report(sphere);
+	Benchmark::Report(geosphere);
+	Benchmark::Report(cylinder);
+	Benchmark::Report(grid);
+	Benchmark::Report(quad);
+	const double subdivideMs = subdividedBox.MedianMs - box.MedianMs / SmallMeshCount;
+	std::printf("  Subdivide: %.4f ms for 5 levels of a box, %.1f ns for each of the %zu triangles made\n",
+		subdivideMs, subdivideMs * 1.0e6 / subdividedTriangles, subdividedTriangles);
+}
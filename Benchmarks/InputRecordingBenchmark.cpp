@@ -0,0 +1,119 @@
+//***************************************************************************************
+// InputRecordingBenchmark.cpp
+//
+// Records ten minutes of made up input at 60 frames and steps a second, with the mouse
+// dragged every frame and keys pressed and released now and then, some within one frame,
+// then writes it, reads it back and plays it through frame by frame.  What is played
+// back is checked against what was recorded.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/InputRecording.h"
+#include "../Common/RandomEngine.h"
+#include "../Common/Window.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const std::uint64_t FrameCount = 60 * 60 * 10;
+	const float FrameSeconds = 1.0f / 60.0f;
+
+	void Record(InputRecording& recording)
+	{
+		RandomEngine random(7);
+		recording.Begin(7, 60.0);
+
+		int x = 400, y = 300;
+		recording.AddMouse(InputRecording::MouseDown, Window::ButtonLeft, x, y);
+		for (std::uint64_t frame = 1; frame <= FrameCount; ++frame)
+		{
+			x += random.NextInt(-4, 4);
+			y += random.NextInt(-4, 4);
+			recording.AddMouse(InputRecording::MouseMove, Window::ButtonLeft, x, y);
+
+			// A tap goes down and up within the frame
+			int key = '4' + random.NextInt(0, 5);
+			if (frame % 30 == 0)
+				recording.AddKey(key, true);
+			if (frame % 30 == 5)
+				recording.AddKey(key, false);
+			if (frame % 60 == 20)
+			{
+				recording.AddKey(key, true);
+				recording.AddKey(key, false);
+			}
+			recording.EndFrame(frame, FrameSeconds);
+		}
+		recording.AddMouse(InputRecording::MouseUp, 0, x, y);
+		recording.End(FrameCount);
+	}
+
+	bool Same(const InputRecording::Event& a, const InputRecording::Event& b)
+	{
+		return a.Step == b.Step && a.Type == b.Type && a.Key == b.Key && a.Buttons == b.Buttons &&
+			a.X == b.X && a.Y == b.Y && a.Seconds == b.Seconds;
+	}
+}
+
+BENCHMARK(InputReplay)
+{
+	InputRecording recorded;
+	auto recording = Benchmark::Measure("record 10 minutes of input", 20, [&]()
+	{
+		Record(recorded);
+	});
+
+	std::string bytes;
+	auto writing = Benchmark::Measure("write it", 20, [&]()
+	{
+		std::ostringstream out;
+		recorded.Write(out);
+		bytes = out.str();
+	});
+
+	InputRecording read;
+	std::string error;
+	bool ok = false;
+	auto reading = Benchmark::Measure("read it back", 20, [&]()
+	{
+		ok = read.Read(bytes.data(), bytes.size(), error);
+	});
+
+	// Hand out a frame's events at a time, as D3DApp does before each frame
+	size_t played = 0;
+	std::uint64_t frames = 0;
+	bool same = ok;
+	auto playing = Benchmark::Measure("play it through", 20, [&]()
+	{
+		read.Rewind();
+		played = 0;
+		frames = 0;
+		std::vector<InputRecording::Event> events;
+		InputRecording::Event frame;
+		while (read.NextFrame(events, frame))
+		{
+			++frames;
+			for (const InputRecording::Event& event : events)
+			{
+				same = same && event.Step == frames && Same(event, recorded.Events()[played]);
+				++played;
+			}
+			same = same && frame.Step == frames && Same(frame, recorded.Events()[played]);
+			++played;
+		}
+	});
+
+	const double eventCount = (double)recorded.Events().size();
+	Benchmark::Report(recording);
+	Benchmark::Report(writing);
+	Benchmark::Report(reading);
+	Benchmark::Report(playing);
+	std::printf("  %.0f events in %zu bytes, %.2f bytes an event; %.1f ns to write and %.1f ns to read each\n",
+		eventCount, bytes.size(), bytes.size() / eventCount, writing.MedianMs * 1.0e6 / eventCount,
+		reading.MedianMs * 1.0e6 / eventCount);
+	Benchmark::Check(same && read.Finished() && frames == FrameCount && played == recorded.Events().size(),
+		"what played back is not what was recorded%s%s", error.empty() ? "" : ": ", error.c_str());
+}
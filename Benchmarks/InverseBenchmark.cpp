@@ -0,0 +1,109 @@
+//***************************************************************************************
+// InverseBenchmark.cpp
+//
+// Inverts 100k random view and projection pairs, and their products, the way the main
+// pass constants used to (three XMMatrixInverse calls) and with MathHelper::InverseRigid
+// and MathHelper::InversePerspective.  Precision is how far each matrix times its
+// inverse lands from the identity.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/MathHelper.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Inverses
+	{
+		XMFLOAT4X4 InvView;
+		XMFLOAT4X4 InvProj;
+		XMFLOAT4X4 InvViewProj;
+	};
+
+	float IdentityError(CXMMATRIX M, CXMMATRIX inverse)
+	{
+		XMFLOAT4X4 product;
+		XMStoreFloat4x4(&product, XMMatrixMultiply(M, inverse));
+
+		float error = 0.0f;
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				error = std::fmax(error, std::fabs(product.m[i][j] - (i == j ? 1.0f : 0.0f)));
+
+		return error;
+	}
+
+	void WorstErrors(const std::vector<XMFLOAT4X4>& views, const std::vector<XMFLOAT4X4>& projs,
+		const std::vector<Inverses>& inverses, float errors[3])
+	{
+		errors[0] = errors[1] = errors[2] = 0.0f;
+		for (size_t i = 0; i < views.size(); ++i)
+		{
+			XMMATRIX view = XMLoadFloat4x4(&views[i]);
+			XMMATRIX proj = XMLoadFloat4x4(&projs[i]);
+			errors[0] = std::fmax(errors[0], IdentityError(view, XMLoadFloat4x4(&inverses[i].InvView)));
+			errors[1] = std::fmax(errors[1], IdentityError(proj, XMLoadFloat4x4(&inverses[i].InvProj)));
+			errors[2] = std::fmax(errors[2], IdentityError(XMMatrixMultiply(view, proj), XMLoadFloat4x4(&inverses[i].InvViewProj)));
+		}
+	}
+}
+
+BENCHMARK(PassInverses)
+{
+	const size_t count = 100000;
+
+	RandomEngine engine(42);
+	std::vector<XMFLOAT4X4> views(count), projs(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		XMVECTOR eye = XMVectorScale(engine.NextUnitVec3(), engine.NextFloat(5.0f, 50.0f));
+		XMVECTOR target = XMVectorScale(engine.NextUnitVec3(), engine.NextFloat(0.0f, 2.0f));
+		XMStoreFloat4x4(&views[i], XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+
+		float fovY = engine.NextFloat(0.2f, 0.5f)*XM_PI;
+		float aspect = engine.NextFloat(1.0f, 2.5f);
+		XMStoreFloat4x4(&projs[i], XMMatrixPerspectiveFovLH(fovY, aspect, 1.0f, 1000.0f));
+	}
+
+	std::vector<Inverses> general(count), analytic(count);
+
+	auto generalTime = Benchmark::Measure("XMMatrixInverse x3, 100k", 20, [&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMMATRIX view = XMLoadFloat4x4(&views[i]);
+			XMMATRIX proj = XMLoadFloat4x4(&projs[i]);
+			XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+			XMStoreFloat4x4(&general[i].InvView, XMMatrixInverse(nullptr, view));
+			XMStoreFloat4x4(&general[i].InvProj, XMMatrixInverse(nullptr, proj));
+			XMStoreFloat4x4(&general[i].InvViewProj, XMMatrixInverse(nullptr, viewProj));
+		}
+	});
+
+	auto analyticTime = Benchmark::Measure("Rigid and perspective inverses, 100k", 20, [&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMMATRIX invView = MathHelper::InverseRigid(XMLoadFloat4x4(&views[i]));
+			XMMATRIX invProj = MathHelper::InversePerspective(XMLoadFloat4x4(&projs[i]));
+			XMStoreFloat4x4(&analytic[i].InvView, invView);
+			XMStoreFloat4x4(&analytic[i].InvProj, invProj);
+			XMStoreFloat4x4(&analytic[i].InvViewProj, XMMatrixMultiply(invProj, invView));
+		}
+	});
+
+	float generalErrors[3], analyticErrors[3];
+	WorstErrors(views, projs, general, generalErrors);
+	WorstErrors(views, projs, analytic, analyticErrors);
+
+	Benchmark::Report(generalTime);
+	Benchmark::Report(analyticTime);
+	std::printf("  analytic inverses are %.1fx faster (median)\n", generalTime.MedianMs / analyticTime.MedianMs);
+	std::printf("  worst |M * inverse - I|    view       proj       viewProj\n");
+	std::printf("    XMMatrixInverse          %-10.3g %-10.3g %-10.3g\n", generalErrors[0], generalErrors[1], generalErrors[2]);
+	std::printf("    analytic                 %-10.3g %-10.3g %-10.3g\n", analyticErrors[0], analyticErrors[1], analyticErrors[2]);
+}
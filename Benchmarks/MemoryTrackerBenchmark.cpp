@@ -0,0 +1,75 @@
+//***************************************************************************************
+// MemoryTrackerBenchmark.cpp
+//
+// Times what counting costs: filling vectors through MemoryTracker's allocator against
+// filling plain ones, and making and dropping Allocations.  Every count made is undone
+// by the end of each run, so the tags are checked to be back where they started.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/MemoryTracker.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	const int VectorCount = 1000;
+	const int ElementCount = 256;
+	const int AllocationCount = 100000;
+
+	using TrackedVector = std::vector<std::uint32_t, MemoryTracker::Allocator<std::uint32_t, MemoryTracker::CubeState>>;
+
+	// Fills count vectors one element at a time, so each grows through every reallocation
+	template<typename Vector>
+	std::uint64_t FillVectors()
+	{
+		std::uint64_t checksum = 0;
+		for (int v = 0; v < VectorCount; ++v)
+		{
+			Vector values;
+			for (int i = 0; i < ElementCount; ++i)
+				values.push_back((std::uint32_t)(v + i));
+			checksum += values.back();
+		}
+		return checksum;
+	}
+}
+
+BENCHMARK(MemoryTags)
+{
+	const MemoryTracker::Counts before = MemoryTracker::Get(MemoryTracker::CubeState);
+	std::uint64_t checksum = 0;
+
+	auto plain = Benchmark::Measure("std::allocator, 1000 vectors of 256", 50, [&]()
+	{
+		checksum += FillVectors<std::vector<std::uint32_t>>();
+	});
+
+	auto tracked = Benchmark::Measure("MemoryTracker::Allocator, 1000 vectors of 256", 50, [&]()
+	{
+		checksum += FillVectors<TrackedVector>();
+	});
+
+	auto allocations = Benchmark::Measure("Allocation made and reset, 100k", 50, [&]()
+	{
+		MemoryTracker::Allocation allocation;
+		for (int i = 0; i < AllocationCount; ++i)
+			allocation.Reset(MemoryTracker::CubeState, (size_t)(i & 1023) + 1);
+		checksum += allocation.Bytes();
+	});
+
+	Benchmark::Report(plain);
+	Benchmark::Report(tracked);
+	Benchmark::Report(allocations);
+
+	const MemoryTracker::Counts after = MemoryTracker::Get(MemoryTracker::CubeState);
+	const int reallocations = VectorCount * 10;
+	std::printf("  %.1f ns counted on each of about %d reallocations, %.1f ns an Allocation reset (checksum %llu)\n",
+		(tracked.MedianMs - plain.MedianMs) * 1.0e6 / reallocations, reallocations,
+		allocations.MedianMs * 1.0e6 / AllocationCount, (unsigned long long)checksum);
+	Benchmark::Check(after.LiveBytes == before.LiveBytes && after.LiveAllocations == before.LiveAllocations,
+		"%llu bytes in %llu allocations still counted as cube state",
+		(unsigned long long)(after.LiveBytes - before.LiveBytes),
+		(unsigned long long)(after.LiveAllocations - before.LiveAllocations));
+}
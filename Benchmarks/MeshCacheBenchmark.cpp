@@ -0,0 +1,87 @@
+//***************************************************************************************
+// MeshCacheBenchmark.cpp
+//
+// Compares the two ways Rubix::BuildShapeGeometry can produce the cubie mesh at start up:
+// generating and simplifying it from scratch, or mapping the cache file written by an
+// earlier run.  Both paths finish by reading every byte of the vertex and index data, as
+// the upload to the GPU does, so the cached path pays for faulting its pages in.  The file
+// stays in the OS page cache between runs, so this is the warm start time.  Last, a cache
+// written under the right key with an index past the last vertex is checked to be refused.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../CubieMesh.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	// Stands in for the copy into the upload heap.
+	std::uint64_t Touch(const void* data, size_t byteSize)
+	{
+		const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+
+		std::uint64_t sum = 0;
+		for (size_t i = 0; i < byteSize; i += sizeof(std::uint64_t))
+		{
+			std::uint64_t word = 0;
+			std::memcpy(&word, bytes + i, std::min(sizeof(word), byteSize - i));
+			sum += word;
+		}
+
+		return sum;
+	}
+}
+
+BENCHMARK(MeshCacheStartup)
+{
+	const std::wstring cacheFile = L"benchmark_cubie.meshcache";
+	CubieMeshDesc desc;
+
+	volatile std::uint64_t sink = 0;
+
+	auto generate = Benchmark::Measure("generate cubie mesh", 10, [&]()
+	{
+		CubieMesh mesh = BuildCubieMesh(desc);
+
+		// The generated path also copies everything into the CPU blobs.
+		std::vector<std::uint8_t> vertexBlob(mesh.Vertices.size() * sizeof(Vertex));
+		std::vector<std::uint8_t> indexBlob(mesh.Indices.size() * sizeof(std::uint16_t));
+		std::memcpy(vertexBlob.data(), mesh.Vertices.data(), vertexBlob.size());
+		std::memcpy(indexBlob.data(), mesh.Indices.data(), indexBlob.size());
+
+		sink = sink + Touch(vertexBlob.data(), vertexBlob.size()) + Touch(indexBlob.data(), indexBlob.size());
+	});
+
+	if (!SaveCubieMesh(cacheFile, desc, BuildCubieMesh(desc)))
+	{
+		std::printf("  could not write %ls, skipping the cached path\n", cacheFile.c_str());
+		return;
+	}
+
+	auto cached = Benchmark::Measure("map cached cubie mesh", 200, [&]()
+	{
+		MeshCache cache;
+		if (!OpenCubieMesh(cacheFile, desc, cache))
+			return;
+
+		sink = sink + Touch(cache.Vertices(), cache.VertexCount() * sizeof(Vertex)) +
+			Touch(cache.Indices(), cache.IndexCount() * sizeof(std::uint16_t));
+	});
+
+	Benchmark::Report(generate);
+	Benchmark::Report(cached);
+	std::printf("  cache is %.1fx faster (median)\n", generate.MedianMs / cached.MedianMs);
+
+	MeshCache cache;
+	const bool opened = OpenCubieMesh(cacheFile, desc, cache);
+	cache.Close();
+
+	CubieMesh damaged = BuildCubieMesh(desc);
+	damaged.Indices.back() = (std::uint16_t)damaged.Vertices.size();
+	const bool damagedOpened = SaveCubieMesh(cacheFile, desc, damaged) && OpenCubieMesh(cacheFile, desc, cache);
+	Benchmark::Check(opened && !damagedOpened, "the cache %s", opened ? "opened with an index past the last vertex" :
+		"written did not open");
+
+	std::remove(NarrowPath(cacheFile).c_str());
+}
@@ -0,0 +1,103 @@
+//***************************************************************************************
+// PickBenchmark.cpp
+//
+// Picks a 64x64x64 cube, with one slice part way through a turn, through random pixels
+// of a 1280x720 view.  RayPicker with a Bvh is compared with testing every cubie.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/RayPicker.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+BENCHMARK(RayPick)
+{
+	const int n = 64;
+	const std::uint32_t cubieCount = n * n * n;
+	const int pickCount = 10000;
+
+	BoundingBox localBounds(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+
+	// The top slice is turned by a third of a right angle, like a turn in progress
+	std::vector<BoundingBox> worldBounds(cubieCount);
+	RayPicker picker;
+	picker.Resize(cubieCount);
+	for (std::uint32_t i = 0; i < cubieCount; ++i)
+	{
+		float x = (float)(i % n) - 0.5f*(n - 1);
+		float y = (float)(i / n % n) - 0.5f*(n - 1);
+		float z = (float)(i / (n * n)) - 0.5f*(n - 1);
+
+		XMMATRIX world = XMMatrixTranslation(x, y, z);
+		if (i / n % n == n - 1)
+			world = XMMatrixMultiply(world, XMMatrixRotationY(XM_PI / 6.0f));
+
+		picker.Set(i, localBounds, world);
+		localBounds.Transform(worldBounds[i], world);
+	}
+
+	Bvh bvh;
+	bvh.Build(worldBounds.data(), cubieCount);
+
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(60.0f, 80.0f, -100.0f, 1.0f),
+		XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f*XM_PI, 1280.0f / 720.0f, 1.0f, 1000.0f);
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> px(0.0f, 1280.0f), py(0.0f, 720.0f);
+	std::vector<PickRay> rays(pickCount);
+	for (PickRay& ray : rays)
+		ray = PickRay::FromScreen(px(rng), py(rng), 1280.0f, 720.0f, view, proj);
+
+	std::vector<PickHit> bvhHits(pickCount), linearHits(pickCount);
+	std::vector<char> bvhFound(pickCount), linearFound(pickCount);
+
+	auto linear = Benchmark::Measure("Every cubie, 100 picks", 3, [&]()
+	{
+		for (int r = 0; r < 100; ++r)
+		{
+			XMVECTOR origin = XMLoadFloat3(&rays[r].Origin);
+			XMVECTOR direction = XMLoadFloat3(&rays[r].Direction);
+
+			linearFound[r] = 0;
+			float closest = 1000.0f;
+			for (std::uint32_t i = 0; i < cubieCount; ++i)
+			{
+				float t;
+				int axis;
+				float sign;
+				if (picker.Intersect(i, origin, direction, t, axis, sign) && t < closest)
+				{
+					closest = t;
+					linearHits[r].Item = i;
+					linearHits[r].Distance = t;
+					linearFound[r] = 1;
+				}
+			}
+		}
+	});
+
+	auto picks = Benchmark::Measure("RayPicker, 10000 picks", 20, [&]()
+	{
+		for (int r = 0; r < pickCount; ++r)
+			bvhFound[r] = picker.Pick(bvh, rays[r], 1000.0f, bvhHits[r]);
+	});
+
+	Benchmark::Report(linear);
+	Benchmark::Report(picks);
+	std::printf("  %.0f ns per pick with the Bvh, %.0f ns testing every cubie\n",
+		picks.MedianMs * 1.0e6 / pickCount, linear.MedianMs * 1.0e6 / 100);
+
+	// The distance is what must agree; two cubies can touch where the ray enters them
+	int mismatches = 0;
+	for (int r = 0; r < 100; ++r)
+	{
+		if (bvhFound[r] != linearFound[r] ||
+			(bvhFound[r] && std::abs(bvhHits[r].Distance - linearHits[r].Distance) > 1.0e-3f))
+			++mismatches;
+	}
+	Benchmark::Check(mismatches == 0, "%d picks differ from testing every cubie", mismatches);
+}
@@ -0,0 +1,138 @@
+//***************************************************************************************
+// RandomBenchmark.cpp
+//
+// Generates 16M floats and 4M unit vectors with rand() and the old rejection loop, and
+// with RandomEngine one at a time and in batches, and through the MathHelper helpers the
+// app calls, which reach the calling thread's engine.  The batches are checked for an
+// even spread: floats should average a half and unit vectors should average to nothing.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/MathHelper.h"
+#include "../Common/RandomEngine.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Many standard errors wide for these counts, so only a skewed engine trips them: the
+	// mean of 16M floats varies by about 0.0001 and that of 4M unit vectors by about 0.0003
+	const double MeanFloatTolerance = 0.001;
+	const double MeanVectorTolerance = 0.002;
+	const double LengthTolerance = 1e-4;
+
+	float RandF(float a, float b)
+	{
+		return a + ((float)(rand()) / (float)RAND_MAX)*(b - a);
+	}
+
+	// The rand() based MathHelper::RandUnitVec3 this replaced
+	XMFLOAT3 RejectionUnitVec3()
+	{
+		while (true)
+		{
+			XMVECTOR v = XMVectorSet(RandF(-1.0f, 1.0f), RandF(-1.0f, 1.0f), RandF(-1.0f, 1.0f), 0.0f);
+			if (XMVectorGetX(XMVector3LengthSq(v)) > 1.0f)
+				continue;
+
+			XMFLOAT3 result;
+			XMStoreFloat3(&result, XMVector3Normalize(v));
+			return result;
+		}
+	}
+}
+
+BENCHMARK(RandomNumbers)
+{
+	const size_t floatCount = 16 * 1024 * 1024;
+	const size_t vectorCount = 4 * 1024 * 1024;
+
+	std::vector<float> floats(floatCount);
+	std::vector<XMFLOAT3> vectors(vectorCount);
+	RandomEngine engine(42);
+
+	auto randFloats = Benchmark::Measure("rand(), 16M floats", 5, [&]()
+	{
+		for (float& f : floats)
+			f = RandF(0.0f, 1.0f);
+	});
+
+	auto singleFloats = Benchmark::Measure("NextFloat, 16M floats", 5, [&]()
+	{
+		for (float& f : floats)
+			f = engine.NextFloat();
+	});
+
+	auto batchFloats = Benchmark::Measure("FillFloats, 16M floats", 5, [&]()
+	{
+		engine.FillFloats(floats.data(), floats.size());
+	});
+
+	double sum = 0.0;
+	for (float f : floats)
+		sum += f;
+
+	auto helperFloats = Benchmark::Measure("MathHelper::RandF, 16M floats", 5, [&]()
+	{
+		for (float& f : floats)
+			f = MathHelper::RandF(0.0f, 1.0f);
+	});
+
+	std::vector<int> ints(floatCount);
+	auto helperInts = Benchmark::Measure("MathHelper::Rand, 16M ints", 5, [&]()
+	{
+		for (int& n : ints)
+			n = MathHelper::Rand(0, 5);
+	});
+
+	auto rejectionVectors = Benchmark::Measure("rand() rejection, 4M unit vectors", 5, [&]()
+	{
+		for (XMFLOAT3& v : vectors)
+			v = RejectionUnitVec3();
+	});
+
+	auto helperVectors = Benchmark::Measure("MathHelper::RandUnitVec3, 4M vectors", 5, [&]()
+	{
+		for (XMFLOAT3& v : vectors)
+			XMStoreFloat3(&v, MathHelper::RandUnitVec3());
+	});
+
+	auto batchVectors = Benchmark::Measure("FillUnitVec3, 4M unit vectors", 5, [&]()
+	{
+		engine.FillUnitVec3(vectors.data(), vectors.size());
+	});
+
+	double meanX = 0.0, meanY = 0.0, meanZ = 0.0, worstLength = 0.0;
+	for (const XMFLOAT3& v : vectors)
+	{
+		meanX += v.x;
+		meanY += v.y;
+		meanZ += v.z;
+		worstLength = std::fmax(worstLength, std::fabs(std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z) - 1.0));
+	}
+	meanX /= vectorCount;
+	meanY /= vectorCount;
+	meanZ /= vectorCount;
+
+	Benchmark::Report(randFloats);
+	Benchmark::Report(singleFloats);
+	Benchmark::Report(batchFloats);
+	Benchmark::Report(helperFloats);
+	Benchmark::Report(helperInts);
+	Benchmark::Report(rejectionVectors);
+	Benchmark::Report(helperVectors);
+	Benchmark::Report(batchVectors);
+	std::printf("  floats %.1fx faster in batches than rand(), unit vectors %.1fx (median)\n",
+		randFloats.MedianMs / batchFloats.MedianMs, rejectionVectors.MedianMs / batchVectors.MedianMs);
+	std::printf("  mean float %.4f, mean vector (%.4f, %.4f, %.4f), worst length error %.2g\n",
+		sum / floatCount, meanX, meanY, meanZ, worstLength);
+
+	Benchmark::Check(std::fabs(sum / floatCount - 0.5) <= MeanFloatTolerance, "the floats do not average a half");
+	Benchmark::Check(std::fabs(meanX) <= MeanVectorTolerance && std::fabs(meanY) <= MeanVectorTolerance &&
+		std::fabs(meanZ) <= MeanVectorTolerance, "the unit vectors do not average to nothing");
+	Benchmark::Check(worstLength <= LengthTolerance, "the unit vectors are not unit length");
+}
@@ -0,0 +1,265 @@
+//***************************************************************************************
+// TextureStreamerBenchmark.cpp
+//
+// Streams eight 1024x1024 RGBA textures from disk into a sink that copies whatever it is
+// asked to make resident into a staging buffer, as into an upload heap, and counts it.
+// Each texture is drawn half the size of the one before, and the budget is too small for
+// all of them.  Times how long until every texture can be drawn, against loading every
+// mip of every file up front as the app used to, and how long until streaming settles.
+// The streamer is timed without workers, doing their work in Update, then once with
+// them: each worker thread keeps a profiler ring for as long as the process runs, so a
+// new set every run would time the rings more than the streaming.
+//
+// The sink checks what the streamer promises: each texture's mip tail comes first, what
+// is resident never goes over the budget, and the texture drawn largest gets every mip
+// it needs.  A sink that refuses one texture has it marked Failed while the rest stream
+// on.  The files stay in the OS page cache between runs, so these are warm loads.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/TextureStreamer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const int TextureCount = 8;
+	const std::uint32_t TextureSize = 1024;
+	const std::uint32_t MipCount = 11;
+	const std::uint64_t BudgetBytes = 7 * 1024 * 1024;
+	const unsigned WorkerCount = 4;
+	const int MaxUpdates = 1000;
+
+	std::wstring TextureFile(int i)
+	{
+		return L"benchmark_stream" + std::to_wstring(i) + L".dds";
+	}
+
+	// A DX10 R8G8B8A8 texture with a full mip chain, its pixels left zero
+	bool WriteTexture(const std::wstring& filename)
+	{
+		DDS_HEADER header = {};
+		header.size = sizeof(DDS_HEADER);
+		header.flags = 0x1 | DDS_HEIGHT | DDS_WIDTH | 0x1000 | 0x20000; // CAPS, PIXELFORMAT, MIPMAPCOUNT
+		header.height = TextureSize;
+		header.width = TextureSize;
+		header.mipMapCount = MipCount;
+		header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+		header.ddspf.flags = DDS_FOURCC;
+		header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+		header.caps = 0x1000 | 0x400000 | 0x8; // TEXTURE, MIPMAP, COMPLEX
+
+		DDS_HEADER_DXT10 extension = {};
+		extension.dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+		extension.resourceDimension = 3; // D3D11_RESOURCE_DIMENSION_TEXTURE2D
+		extension.arraySize = 1;
+
+		size_t pixelBytes = 0;
+		for (std::uint32_t mip = 0; mip < MipCount; ++mip)
+			pixelBytes += (size_t)(TextureSize >> mip) * (TextureSize >> mip) * 4;
+
+		std::ofstream out(NarrowPath(filename), std::ios::binary);
+		out.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(std::uint32_t));
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(&extension), sizeof(extension));
+		std::vector<char> pixels(pixelBytes);
+		out.write(pixels.data(), pixels.size());
+		return (bool)out;
+	}
+
+	// Copies each upload into a staging buffer, as into an upload heap, and keeps what each
+	// texture has resident and whether the streamer kept its promises
+	class CountingSink : public TextureUploadSink
+	{
+	public:
+		bool MakeResident(std::uint32_t texture, const DDSFile& file,
+			const std::vector<DDSFile::Surface>& surfaces, std::uint32_t firstMip) override
+		{
+			if ((int)texture == Refused)
+				return false;
+			if (texture >= Resident.size())
+			{
+				Resident.resize(texture + 1, 0);
+				ResidentMips.resize(texture + 1, file.MipCount());
+			}
+
+			// The first upload of every texture must be its tail, all of it small
+			if (ResidentMips[texture] == file.MipCount() && Bytes(surfaces, firstMip) > TextureStreamer::DefaultMipTailBytes &&
+				firstMip != file.MipCount() - 1)
+				TailFirst = false;
+
+			Staging.resize(std::max(Staging.size(), (size_t)Bytes(surfaces, firstMip)));
+			size_t offset = 0;
+			for (size_t mip = firstMip; mip < surfaces.size(); ++mip)
+			{
+				std::memcpy(Staging.data() + offset, surfaces[mip].Data, (size_t)surfaces[mip].SlicePitch);
+				offset += (size_t)surfaces[mip].SlicePitch;
+			}
+
+			ResidentBytes = ResidentBytes - Resident[texture] + Bytes(surfaces, firstMip);
+			Resident[texture] = Bytes(surfaces, firstMip);
+			ResidentMips[texture] = firstMip;
+			PeakBytes = std::max(PeakBytes, ResidentBytes);
+			UploadedBytes += Resident[texture];
+			++Uploads;
+			return true;
+		}
+
+		static std::uint64_t Bytes(const std::vector<DDSFile::Surface>& surfaces, std::uint32_t firstMip)
+		{
+			std::uint64_t bytes = 0;
+			for (size_t mip = firstMip; mip < surfaces.size(); ++mip)
+				bytes += surfaces[mip].SlicePitch * surfaces[mip].Depth;
+			return bytes;
+		}
+
+		std::vector<std::uint8_t> Staging;
+		std::vector<std::uint64_t> Resident;
+		std::vector<std::uint32_t> ResidentMips;
+		std::uint64_t ResidentBytes = 0;
+		std::uint64_t PeakBytes = 0;
+		std::uint64_t UploadedBytes = 0;
+		int Uploads = 0;
+		bool TailFirst = true;
+
+		// A texture to refuse every upload of, as a device refuses a file it cannot create
+		int Refused = -1;
+	};
+
+	bool AllParsed(const TextureStreamer& streamer)
+	{
+		for (int i = 0; i < TextureCount; ++i)
+			if (!streamer.GetStatus(i).Parsed)
+				return false;
+		return true;
+	}
+
+	// Requests every texture, each drawn half the size of the one before
+	void RequestAll(TextureStreamer& streamer)
+	{
+		for (int i = 0; i < TextureCount; ++i)
+		{
+			TextureStreamer::Handle texture = streamer.Request(TextureFile(i));
+			streamer.SetScreenSize(texture, (float)(TextureSize >> i));
+		}
+	}
+
+	// Updates until streaming settles: an Update after the workers finish uploads nothing.
+	// Returns the Updates it took.
+	int Settle(TextureStreamer& streamer, CountingSink& sink)
+	{
+		int updates = 0;
+		int lastUploads = -1;
+		while (updates < MaxUpdates && sink.Uploads != lastUploads)
+		{
+			lastUploads = sink.Uploads;
+			streamer.WaitForWorkers();
+			streamer.Update();
+			++updates;
+		}
+		return updates;
+	}
+}
+
+BENCHMARK(TextureStreaming)
+{
+	for (int i = 0; i < TextureCount; ++i)
+	{
+		if (!WriteTexture(TextureFile(i)))
+		{
+			std::printf("  could not write %ls, skipping\n", TextureFile(i).c_str());
+			return;
+		}
+	}
+
+	// Every mip of every file read and handed over before the first frame
+	std::uint64_t loadedBytes = 0;
+	auto upFront = Benchmark::Measure("load every mip up front", 20, [&]()
+	{
+		CountingSink sink;
+		std::vector<DDSFile::Surface> surfaces;
+		for (int i = 0; i < TextureCount; ++i)
+		{
+			DDSFile file;
+			if (!file.Open(TextureFile(i)) || !file.GetSurfaces(surfaces))
+				return;
+			sink.MakeResident(i, file, surfaces, 0);
+		}
+		loadedBytes = sink.ResidentBytes;
+	});
+
+	// Until every texture has its tail and can be drawn
+	auto tails = Benchmark::Measure("stream until every tail is resident", 20, [&]()
+	{
+		CountingSink sink;
+		TextureStreamer streamer(sink, BudgetBytes, 0);
+		RequestAll(streamer);
+		streamer.Update();
+	});
+
+	auto settle = Benchmark::Measure("stream until settled", 20, [&]()
+	{
+		CountingSink sink;
+		TextureStreamer streamer(sink, BudgetBytes, 0);
+		RequestAll(streamer);
+		Settle(streamer, sink);
+	});
+
+	// Once with workers, which is what is checked
+	CountingSink sink;
+	auto start = Benchmark::Clock::now();
+	TextureStreamer streamer(sink, BudgetBytes, WorkerCount);
+	RequestAll(streamer);
+	while (!AllParsed(streamer))
+	{
+		streamer.WaitForWorkers();
+		streamer.Update();
+	}
+	auto drawable = Benchmark::Clock::now();
+	int updates = Settle(streamer, sink);
+	auto settled = Benchmark::Clock::now();
+
+	Benchmark::Report(upFront);
+	Benchmark::Report(tails);
+	Benchmark::Report(settle);
+	Benchmark::Report(Benchmark::Summarize("stream until every tail is resident, 4 workers",
+		{ std::chrono::duration<double, std::milli>(drawable - start).count() }));
+	Benchmark::Report(Benchmark::Summarize("stream until settled, 4 workers",
+		{ std::chrono::duration<double, std::milli>(settled - start).count() }));
+
+	std::printf("  every texture drawable %.1fx sooner than loading %.1f MB up front; settled in %d more Updates\n",
+		upFront.MedianMs / tails.MedianMs, loadedBytes / (1024.0 * 1024.0), updates);
+	std::printf("  resident mips:");
+	for (int i = 0; i < TextureCount; ++i)
+		std::printf(" %u/%u", streamer.GetStatus(i).ResidentMip, streamer.GetStatus(i).WantedMip);
+	std::printf(" (resident/wanted), %.2f of %.2f MB, peak %.2f MB, %.2f MB uploaded in %d uploads\n",
+		sink.ResidentBytes / (1024.0 * 1024.0), BudgetBytes / (1024.0 * 1024.0), sink.PeakBytes / (1024.0 * 1024.0),
+		sink.UploadedBytes / (1024.0 * 1024.0), sink.Uploads);
+
+	Benchmark::Check(sink.TailFirst, "a texture's first upload was more than its mip tail");
+	Benchmark::Check(sink.PeakBytes <= BudgetBytes && sink.ResidentBytes == streamer.ResidentBytes(),
+		"the resident mips went over the budget or were miscounted");
+	Benchmark::Check(streamer.GetStatus(0).ResidentMip == streamer.GetStatus(0).WantedMip && updates < MaxUpdates,
+		"the texture drawn largest did not get every mip it needs");
+
+	// Refusing the texture drawn largest leaves the others the whole budget
+	CountingSink refusing;
+	refusing.Refused = 0;
+	TextureStreamer refused(refusing, BudgetBytes, 0);
+	RequestAll(refused);
+	Settle(refused, refusing);
+	bool othersStreamed = refusing.ResidentBytes == refused.ResidentBytes();
+	for (int i = 1; i < TextureCount; ++i)
+		othersStreamed = othersStreamed && !refused.GetStatus(i).Failed &&
+			refused.GetStatus(i).ResidentMip == refused.GetStatus(i).WantedMip;
+	Benchmark::Check(refused.GetStatus(0).Failed && othersStreamed,
+		"a texture the sink refused was not marked failed, or held the others back");
+
+	for (int i = 0; i < TextureCount; ++i)
+		std::remove(NarrowPath(TextureFile(i)).c_str());
+}
@@ -0,0 +1,129 @@
+//***************************************************************************************
+// TurnQueueBenchmark.cpp
+//
+// Plays back 10000 random turns of every layer through a TurnQueue, stepped at 60Hz the
+// way Rubix::Simulate steps it, with the rotation of every turn in progress worked out
+// each step as if for drawing.  The cube it ends with is checked against turning 27
+// matrices directly, one turn at a time with nothing merged, using only the notation:
+// a clockwise turn goes clockwise round the face's outward normal.
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include "../Common/RandomEngine.h"
+#include "../TurnQueue.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+	// Outward normal of each face, and of the face each middle layer turns like
+	XMVECTOR FaceNormal(char face, float& layer)
+	{
+		switch (face)
+		{
+		case 'L': layer = 1.0f; return XMVectorSet(-1.0f, 0.0f, 0.0f, 0.0f);
+		case 'R': layer = 1.0f; return XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+		case 'D': layer = 1.0f; return XMVectorSet(0.0f, -1.0f, 0.0f, 0.0f);
+		case 'U': layer = 1.0f; return XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+		case 'F': layer = 1.0f; return XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f);
+		case 'B': layer = 1.0f; return XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+		case 'M': layer = 0.0f; return XMVectorSet(-1.0f, 0.0f, 0.0f, 0.0f);
+		case 'E': layer = 0.0f; return XMVectorSet(0.0f, -1.0f, 0.0f, 0.0f);
+		default: layer = 0.0f; return XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f);
+		}
+	}
+
+	// Turns every cubie in the layer, then rounds away the error the rotation adds
+	void TurnDirectly(XMFLOAT4X4 (&worlds)[TurnQueue::CubieCount], char face, int quarterTurns)
+	{
+		float layer;
+		XMVECTOR normal = FaceNormal(face, layer);
+		float angle = (quarterTurns == 3 ? -1.0f : (float)quarterTurns) * XM_PIDIV2;
+		XMMATRIX rotation = XMMatrixRotationAxis(normal, angle);
+
+		for (XMFLOAT4X4& world : worlds)
+		{
+			XMVECTOR position = XMVectorSet(world._41, world._42, world._43, 0.0f);
+			if (std::fabs(XMVectorGetX(XMVector3Dot(position, normal)) - layer) > 0.5f)
+				continue;
+
+			XMStoreFloat4x4(&world, XMMatrixMultiply(XMLoadFloat4x4(&world), rotation));
+			for (int i = 0; i < 4; ++i)
+				for (int j = 0; j < 4; ++j)
+					world.m[i][j] = std::round(world.m[i][j]);
+		}
+	}
+}
+
+BENCHMARK(TurnPlayback)
+{
+	const int turnCount = 10000;
+	const char faces[] = "LRDUFBMES";
+	const char* suffixes[] = { "", "2", "'" };
+
+	RandomEngine engine(42);
+	std::string sequence;
+	XMFLOAT4X4 expected[TurnQueue::CubieCount];
+	for (int c = 0; c < TurnQueue::CubieCount; ++c)
+		XMStoreFloat4x4(&expected[c], XMMatrixTranslation((float)(c / 9 - 1), (float)(c / 3 % 3 - 1), (float)(c % 3 - 1)));
+
+	for (int i = 0; i < turnCount; ++i)
+	{
+		char face = faces[engine.NextInt(0, 8)];
+		int quarterTurns = engine.NextInt(1, 3);
+		sequence += face;
+		sequence += suffixes[quarterTurns == 3 ? 2 : quarterTurns - 1];
+		sequence += ' ';
+		TurnDirectly(expected, face, quarterTurns);
+	}
+
+	TurnQueue turns(2 * turnCount);
+	turns.SetTurnTime(0.05f);
+
+	size_t queued = 0;
+	int steps = 0;
+	float lastAngleSum = 0.0f;
+	auto playback = Benchmark::Measure("Queue and play 10000 turns at 60Hz", 10, [&]()
+	{
+		turns.Reset();
+		turns.PushSequence(sequence.c_str());
+		queued = turns.QueuedCount();
+
+		steps = 0;
+		while (turns.IsTurning() || turns.QueuedCount() > 0)
+		{
+			turns.Advance(1.0f / 60.0f);
+			for (size_t i = 0; i < turns.ActiveCount(); ++i)
+				lastAngleSum += XMVectorGetX(turns.ActiveRotation(i, 0.5f / 60.0f).r[0]);
+			++steps;
+		}
+	});
+
+	int wrong = 0;
+	for (int c = 0; c < TurnQueue::CubieCount; ++c)
+	{
+		XMFLOAT4X4 settled;
+		XMStoreFloat4x4(&settled, turns.SettledWorld(c));
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				wrong += settled.m[i][j] != expected[c].m[i][j] ? 1 : 0;
+	}
+
+	// Merging: the same face back and forth cancels, and turns round the same axis merge
+	// across each other
+	TurnQueue merging;
+	merging.PushSequence("R R'");
+	size_t cancelled = merging.QueuedCount();
+	merging.PushSequence("R L R U");
+	size_t merged = merging.QueuedCount();
+
+	Benchmark::Report(playback);
+	std::printf("  %d turns queued as %zu after merging, played in %d steps (%.1f s at 60Hz); %.0f ns per turn\n",
+		turnCount, queued, steps, steps / 60.0f, playback.MedianMs * 1.0e6 / turnCount);
+	std::printf("  R R' queues %zu turns, then R L R U queues %zu\n", cancelled, merged);
+	Benchmark::Check(wrong == 0 && cancelled == 0 && merged == 3,
+		"the played back cube differs from turning it directly (%d entries)", wrong);
+}
@@ -0,0 +1,125 @@
+//***************************************************************************************
+// CommandStatsMain.cpp
+//
+// Reads a command log written by the app (F5) or the headless runner (-log) and reports
+// what each frame submitted: draws, commands that set what was already set, bytes of
+// constants the draws read and an estimate of the bytes they fetch.
+//
+//   CommandStats log [-csv file]
+//
+// -csv writes one row per frame.
+//***************************************************************************************
+
+#include "../Common/CommandLog.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// The mean and largest of one column of the frames
+	struct Column
+	{
+		double Mean = 0.0;
+		std::uint64_t Max = 0;
+	};
+
+	template <typename Get>
+	Column Summarize(const std::vector<CommandLog::FrameSummary>& frames, Get get)
+	{
+		Column column;
+		for (const auto& frame : frames) {
+			std::uint64_t value = get(frame);
+			column.Mean += (double)value;
+			column.Max = std::max(column.Max, value);
+		}
+		column.Mean /= (double)frames.size();
+		return column;
+	}
+
+	template <typename Get>
+	void PrintRow(const char* name, const std::vector<CommandLog::FrameSummary>& frames, Get get)
+	{
+		Column column = Summarize(frames, get);
+		std::printf("  %-22s %14.1f %12llu\n", name, column.Mean, (unsigned long long)column.Max);
+	}
+
+	void WriteCsv(std::ostream& out, const std::vector<CommandLog::FrameSummary>& frames)
+	{
+		out << "Frame,Commands,Draws,Indices,Redundant";
+		for (int op = CommandLog::OpBarrier; op < CommandLog::OpDrawIndexed; ++op)
+			out << ",Redundant" << CommandLog::OpName((CommandLog::Op)op);
+		out << ",ConstantBytes,IndexBytes,VertexBytes,EstimatedBytes\n";
+
+		for (size_t i = 0; i < frames.size(); ++i) {
+			const auto& frame = frames[i];
+			out << i << ',' << frame.Commands << ',' << frame.Draws << ',' << frame.Indices << ',' << frame.RedundantTotal();
+			for (int op = CommandLog::OpBarrier; op < CommandLog::OpDrawIndexed; ++op)
+				out << ',' << frame.Redundant[op];
+			out << ',' << frame.ConstantBytes << ',' << frame.IndexBytes << ',' << frame.VertexBytes << ','
+				<< frame.EstimatedBytes() << '\n';
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string logName;
+	std::string csvName;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "-csv") == 0 && i + 1 < argc)
+			csvName = argv[++i];
+		else if (logName.empty() && argv[i][0] != '-')
+			logName = argv[i];
+		else
+			logName.clear(), i = argc;
+	}
+	if (logName.empty()) {
+		std::fprintf(stderr, "Usage: CommandStats log [-csv file]\n");
+		return 1;
+	}
+
+	std::ifstream file(logName, std::ios::binary);
+	if (!file) {
+		std::fprintf(stderr, "Cannot open %s\n", logName.c_str());
+		return 1;
+	}
+	std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	std::vector<CommandLog::FrameSummary> frames;
+	std::string error;
+	if (!CommandLog::Analyze(bytes.data(), bytes.size(), frames, error)) {
+		std::fprintf(stderr, "%s: %s\n", logName.c_str(), error.c_str());
+		return 1;
+	}
+	if (frames.empty()) {
+		std::printf("%s: no frames\n", logName.c_str());
+		return 0;
+	}
+
+	std::printf("%s: %zu frames in %zu bytes, %.1f bytes a frame\n", logName.c_str(), frames.size(),
+		bytes.size(), (double)bytes.size() / frames.size());
+	std::printf("  %-22s %14s %12s\n", "per frame", "mean", "max");
+	PrintRow("commands", frames, [](const CommandLog::FrameSummary& f) { return f.Commands; });
+	PrintRow("draws", frames, [](const CommandLog::FrameSummary& f) { return f.Draws; });
+	PrintRow("indices", frames, [](const CommandLog::FrameSummary& f) { return f.Indices; });
+	PrintRow("redundant commands", frames, [](const CommandLog::FrameSummary& f) { return f.RedundantTotal(); });
+	for (int op = CommandLog::OpBarrier; op < CommandLog::OpDrawIndexed; ++op) {
+		std::string name = std::string("  ") + CommandLog::OpName((CommandLog::Op)op);
+		PrintRow(name.c_str(), frames, [op](const CommandLog::FrameSummary& f) { return f.Redundant[op]; });
+	}
+	PrintRow("constant bytes", frames, [](const CommandLog::FrameSummary& f) { return f.ConstantBytes; });
+	PrintRow("index bytes", frames, [](const CommandLog::FrameSummary& f) { return f.IndexBytes; });
+	PrintRow("vertex bytes (at most)", frames, [](const CommandLog::FrameSummary& f) { return f.VertexBytes; });
+	PrintRow("estimated bytes", frames, [](const CommandLog::FrameSummary& f) { return f.EstimatedBytes(); });
+
+	if (!csvName.empty()) {
+		std::ofstream csv(csvName);
+		WriteCsv(csv, frames);
+	}
+	return 0;
+}
@@ -0,0 +1,423 @@
+//***************************************************************************************
+// Bvh.cpp
+//***************************************************************************************
+
+#include "Bvh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+	void Union(XMVECTOR& vMin, XMVECTOR& vMax, const BoundingBox& box)
+	{
+		XMVECTOR c = XMLoadFloat3(&box.Center);
+		XMVECTOR e = XMLoadFloat3(&box.Extents);
+		vMin = XMVectorMin(vMin, XMVectorSubtract(c, e));
+		vMax = XMVectorMax(vMax, XMVectorAdd(c, e));
+	}
+
+	// Squared distance from a point to the box [vMin, vMax], zero if it is inside.
+	float DistanceSq(FXMVECTOR point, FXMVECTOR vMin, FXMVECTOR vMax)
+	{
+		XMVECTOR closest = XMVectorClamp(point, vMin, vMax);
+		return XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(point, closest)));
+	}
+
+	float DistanceSq(FXMVECTOR point, const BoundingBox& box)
+	{
+		XMVECTOR c = XMLoadFloat3(&box.Center);
+		XMVECTOR e = XMLoadFloat3(&box.Extents);
+		return DistanceSq(point, XMVectorSubtract(c, e), XMVectorAdd(c, e));
+	}
+}
+
+void Bvh::Build(const BoundingBox* boxes, std::uint32_t count)
+{
+	mBoxes.assign(boxes, boxes + count);
+
+	mItems.resize(count);
+	for(std::uint32_t i = 0; i < count; ++i)
+		mItems[i] = i;
+
+	// A subtree over n items never needs more than 2n - 1 nodes
+	mNodes.assign(count ? 2 * count - 1 : 0, Node());
+	mParents.assign(mNodes.size(), 0);
+	mItemLeaves.assign(count, 0);
+	mNodeDirty.assign(mNodes.size(), 0);
+
+	if(count == 0)
+	{
+		mRefitOrder.clear();
+		return;
+	}
+
+	// Hand the top few levels out to other threads, roughly one subtree per core
+	int parallelDepth = 0;
+	for(unsigned threads = std::max(1u, std::thread::hardware_concurrency()); threads > 1; threads /= 2)
+		++parallelDepth;
+
+	BuildNode(0, 0, count, parallelDepth);
+
+	// Children always come after their parent in the node array, so visiting the nodes
+	// in use from the back refits every child before its parent
+	mRefitOrder.clear();
+	std::vector<std::uint32_t> stack(1, 0);
+	while(!stack.empty())
+	{
+		std::uint32_t node = stack.back();
+		stack.pop_back();
+		mRefitOrder.push_back(node);
+
+		if(!IsLeaf(mNodes[node]))
+		{
+			stack.push_back(node + 1);
+			stack.push_back(mNodes[node].Right);
+		}
+	}
+	std::sort(mRefitOrder.begin(), mRefitOrder.end(), std::greater<std::uint32_t>());
+}
+
+void Bvh::BuildNode(std::uint32_t node, std::uint32_t begin, std::uint32_t end, int parallelDepth)
+{
+	Node& n = mNodes[node];
+	n.First = begin;
+	n.Count = end - begin;
+
+	XMVECTOR vMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR vMax = XMVectorReplicate(-FLT_MAX);
+	XMVECTOR centreMin = vMin;
+	XMVECTOR centreMax = vMax;
+	for(std::uint32_t i = begin; i < end; ++i)
+	{
+		const BoundingBox& box = mBoxes[mItems[i]];
+		Union(vMin, vMax, box);
+
+		XMVECTOR centre = XMLoadFloat3(&box.Center);
+		centreMin = XMVectorMin(centreMin, centre);
+		centreMax = XMVectorMax(centreMax, centre);
+	}
+	XMStoreFloat3(&n.Min, vMin);
+	XMStoreFloat3(&n.Max, vMax);
+
+	if(end - begin <= MaxLeafSize)
+	{
+		n.Right = 0;
+		for(std::uint32_t i = begin; i < end; ++i)
+			mItemLeaves[mItems[i]] = node;
+		return;
+	}
+
+	// Split at the median centre along the axis the centres are most spread out on
+	XMFLOAT3 spread;
+	XMStoreFloat3(&spread, XMVectorSubtract(centreMax, centreMin));
+	int axis = 0;
+	if(spread.y > spread.x) axis = 1;
+	if(spread.z > (axis == 0 ? spread.x : spread.y)) axis = 2;
+
+	const std::uint32_t mid = begin + (end - begin) / 2;
+	const BoundingBox* boxes = mBoxes.data();
+	std::nth_element(mItems.begin() + begin, mItems.begin() + mid, mItems.begin() + end,
+		[boxes, axis](std::uint32_t a, std::uint32_t b)
+	{
+		return (&boxes[a].Center.x)[axis] < (&boxes[b].Center.x)[axis];
+	});
+
+	// The left subtree takes the 2(mid - begin) - 1 nodes straight after this one and the
+	// right subtree the block after that, so neither depends on how the other was split
+	const std::uint32_t left = node + 1;
+	const std::uint32_t right = node + 2 * (mid - begin);
+	n.Right = right;
+	mParents[left] = node;
+	mParents[right] = node;
+
+	if(parallelDepth > 0 && end - begin >= ParallelBuildThreshold)
+	{
+		auto leftBuild = std::async(std::launch::async, [=]() { BuildNode(left, begin, mid, parallelDepth - 1); });
+		BuildNode(right, mid, end, parallelDepth - 1);
+		leftBuild.get();
+	}
+	else
+	{
+		BuildNode(left, begin, mid, 0);
+		BuildNode(right, mid, end, 0);
+	}
+}
+
+bool Bvh::IsLeaf(const Node& node)const
+{
+	return node.Right == 0;
+}
+
+void Bvh::FitNode(std::uint32_t node)
+{
+	Node& n = mNodes[node];
+
+	XMVECTOR vMin, vMax;
+	if(IsLeaf(n))
+	{
+		vMin = XMVectorReplicate(FLT_MAX);
+		vMax = XMVectorReplicate(-FLT_MAX);
+		for(std::uint32_t i = n.First; i < n.First + n.Count; ++i)
+			Union(vMin, vMax, mBoxes[mItems[i]]);
+	}
+	else
+	{
+		const Node& left = mNodes[node + 1];
+		const Node& right = mNodes[n.Right];
+		vMin = XMVectorMin(XMLoadFloat3(&left.Min), XMLoadFloat3(&right.Min));
+		vMax = XMVectorMax(XMLoadFloat3(&left.Max), XMLoadFloat3(&right.Max));
+	}
+
+	XMStoreFloat3(&n.Min, vMin);
+	XMStoreFloat3(&n.Max, vMax);
+}
+
+void Bvh::Refit(const BoundingBox* boxes)
+{
+	std::copy(boxes, boxes + mBoxes.size(), mBoxes.begin());
+
+	for(std::uint32_t node : mRefitOrder)
+		FitNode(node);
+}
+
+void Bvh::Refit(const BoundingBox* boxes, const std::uint32_t* changed, std::uint32_t changedCount)
+{
+	// Mark the path from each moved item up to the root, stopping where it joins a path
+	// that is already marked
+	mDirtyNodes.clear();
+	for(std::uint32_t i = 0; i < changedCount; ++i)
+	{
+		std::uint32_t item = changed[i];
+		assert(item < mBoxes.size());
+		mBoxes[item] = boxes[item];
+
+		std::uint32_t node = mItemLeaves[item];
+		while(!mNodeDirty[node])
+		{
+			mNodeDirty[node] = 1;
+			mDirtyNodes.push_back(node);
+			if(node == 0)
+				break;
+			node = mParents[node];
+		}
+	}
+
+	std::sort(mDirtyNodes.begin(), mDirtyNodes.end(), std::greater<std::uint32_t>());
+	for(std::uint32_t node : mDirtyNodes)
+	{
+		FitNode(node);
+		mNodeDirty[node] = 0;
+	}
+}
+
+std::uint32_t Bvh::Size()const
+{
+	return (std::uint32_t)mBoxes.size();
+}
+
+const BoundingBox& Bvh::GetBounds(std::uint32_t item)const
+{
+	return mBoxes[item];
+}
+
+void Bvh::QueryFrustum(const FrustumPlanes& frustum, std::vector<std::uint32_t>& items)const
+{
+	if(mNodes.empty())
+		return;
+
+	XMVECTOR planes[FrustumPlanes::Count];
+	XMVECTOR absNormals[FrustumPlanes::Count];
+	for(int p = 0; p < FrustumPlanes::Count; ++p)
+	{
+		planes[p] = XMLoadFloat4(&frustum.Planes[p]);
+		absNormals[p] = XMVectorAbs(planes[p]);
+	}
+
+	const unsigned allPlanes = (1u << FrustumPlanes::Count) - 1;
+
+	// Each entry carries the planes its box still straddles.  A box completely inside a
+	// plane leaves everything below it inside that plane too.
+	struct Entry { std::uint32_t Node; unsigned Planes; };
+	Entry stack[64];
+	int top = 0;
+	stack[top++] = { 0, allPlanes };
+
+	while(top > 0)
+	{
+		Entry entry = stack[--top];
+		const Node& node = mNodes[entry.Node];
+
+		XMVECTOR vMin = XMLoadFloat3(&node.Min);
+		XMVECTOR vMax = XMLoadFloat3(&node.Max);
+		XMVECTOR centre = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+		XMVECTOR extents = XMVectorScale(XMVectorSubtract(vMax, vMin), 0.5f);
+
+		bool outside = false;
+		unsigned straddled = 0;
+		for(int p = 0; p < FrustumPlanes::Count && !outside; ++p)
+		{
+			if((entry.Planes & (1u << p)) == 0)
+				continue;
+
+			float dist = XMVectorGetX(XMPlaneDotCoord(planes[p], centre));
+			float reach = XMVectorGetX(XMVector3Dot(absNormals[p], extents));
+			if(dist + reach < 0.0f)
+				outside = true;
+			else if(dist - reach < 0.0f)
+				straddled |= 1u << p;
+		}
+
+		if(outside)
+			continue;
+
+		if(straddled == 0 || IsLeaf(node))
+		{
+			// Leaves test their items against the planes their box straddles
+			for(std::uint32_t i = node.First; i < node.First + node.Count; ++i)
+			{
+				if(straddled != 0)
+				{
+					const BoundingBox& box = mBoxes[mItems[i]];
+					XMVECTOR c = XMLoadFloat3(&box.Center);
+					XMVECTOR e = XMLoadFloat3(&box.Extents);
+
+					bool itemOutside = false;
+					for(int p = 0; p < FrustumPlanes::Count && !itemOutside; ++p)
+					{
+						if(straddled & (1u << p))
+							itemOutside = XMVectorGetX(XMPlaneDotCoord(planes[p], c)) + XMVectorGetX(XMVector3Dot(absNormals[p], e)) < 0.0f;
+					}
+					if(itemOutside)
+						continue;
+				}
+
+				items.push_back(mItems[i]);
+			}
+			continue;
+		}
+
+		stack[top++] = { node.Right, straddled };
+		stack[top++] = { entry.Node + 1, straddled };
+	}
+}
+
+void Bvh::QuerySphere(const BoundingSphere& sphere, std::vector<std::uint32_t>& items)const
+{
+	if(mNodes.empty())
+		return;
+
+	XMVECTOR centre = XMLoadFloat3(&sphere.Center);
+	float radiusSq = sphere.Radius * sphere.Radius;
+
+	std::uint32_t stack[64];
+	int top = 0;
+	stack[top++] = 0;
+
+	while(top > 0)
+	{
+		const std::uint32_t index = stack[--top];
+		const Node& node = mNodes[index];
+		if(DistanceSq(centre, XMLoadFloat3(&node.Min), XMLoadFloat3(&node.Max)) > radiusSq)
+			continue;
+
+		if(IsLeaf(node))
+		{
+			for(std::uint32_t i = node.First; i < node.First + node.Count; ++i)
+			{
+				if(DistanceSq(centre, mBoxes[mItems[i]]) <= radiusSq)
+					items.push_back(mItems[i]);
+			}
+			continue;
+		}
+
+		stack[top++] = node.Right;
+		stack[top++] = index + 1;
+	}
+}
+
+bool Bvh::Nearest(FXMVECTOR point, float maxDistance, std::uint32_t& item, float& distance)const
+{
+	if(mNodes.empty())
+		return false;
+
+	float bestSq = maxDistance * maxDistance;
+	bool found = false;
+
+	struct Entry { std::uint32_t Node; float DistanceSq; };
+	Entry stack[64];
+	int top = 0;
+	stack[top++] = { 0, DistanceSq(point, XMLoadFloat3(&mNodes[0].Min), XMLoadFloat3(&mNodes[0].Max)) };
+
+	while(top > 0)
+	{
+		Entry entry = stack[--top];
+		if(entry.DistanceSq > bestSq)
+			continue;
+
+		const Node& node = mNodes[entry.Node];
+		if(IsLeaf(node))
+		{
+			for(std::uint32_t i = node.First; i < node.First + node.Count; ++i)
+			{
+				float d = DistanceSq(point, mBoxes[mItems[i]]);
+				if(d <= bestSq)
+				{
+					bestSq = d;
+					item = mItems[i];
+					found = true;
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearer child first so the bound tightens sooner
+		const Node& left = mNodes[entry.Node + 1];
+		const Node& right = mNodes[node.Right];
+		Entry l = { entry.Node + 1, DistanceSq(point, XMLoadFloat3(&left.Min), XMLoadFloat3(&left.Max)) };
+		Entry r = { node.Right, DistanceSq(point, XMLoadFloat3(&right.Min), XMLoadFloat3(&right.Max)) };
+		if(l.DistanceSq < r.DistanceSq)
+			std::swap(l, r);
+		stack[top++] = l;
+		stack[top++] = r;
+	}
+
+	if(found)
+		distance = std::sqrt(bestSq);
+
+	return found;
+}
+
+float Bvh::IntersectRay(const Node& node, FXMVECTOR origin, FXMVECTOR invDirection, float maxDistance)
+{
+	// Slab test: the ray is inside the box between the last slab it enters and the first
+	// one it leaves
+	XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.Min), origin), invDirection);
+	XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.Max), origin), invDirection);
+	XMVECTOR tNear = XMVectorMin(t1, t2);
+	XMVECTOR tFar = XMVectorMax(t1, t2);
+
+	float enter = (std::max)((std::max)(XMVectorGetX(tNear), XMVectorGetY(tNear)), (std::max)(XMVectorGetZ(tNear), 0.0f));
+	float exit = (std::min)((std::min)(XMVectorGetX(tFar), XMVectorGetY(tFar)), (std::min)(XMVectorGetZ(tFar), maxDistance));
+
+	return enter <= exit ? enter : -1.0f;
+}
+
+bool Bvh::RayCast(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, std::uint32_t& item, float& distance)const
+{
+	const std::vector<BoundingBox>& boxes = mBoxes;
+	return RayCast(origin, direction, maxDistance,
+		[&boxes](std::uint32_t i, FXMVECTOR o, FXMVECTOR d, float& t)
+	{
+		float hit;
+		if(!boxes[i].Intersects(o, d, hit))
+			return false;
+		t = hit;
+		return true;
+	}, item, distance);
+}
@@ -0,0 +1,190 @@
+//***************************************************************************************
+// Bvh.h
+//
+// Bounding volume hierarchy over a set of axis-aligned boxes, e.g. the world bounds of
+// render items.  Items are identified by their index in the array the tree was built
+// from.
+//
+// The tree is a binary tree split at the median centroid along the longest axis, with up
+// to MaxLeafSize items per leaf.  Every subtree owns a fixed block of the node array
+// decided by its position in the item list, so large subtrees are built on separate
+// threads without any locking.  When items move but their number stays the same the tree
+// can be refit, which keeps its shape and only recomputes the bounds on the paths from
+// the moved items to the root.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+#include "FrustumCuller.h"
+
+class Bvh
+{
+public:
+	static const std::uint32_t MaxLeafSize = 4;
+
+	// Subtrees with at least this many items are built on another thread.
+	static const std::uint32_t ParallelBuildThreshold = 16384;
+
+	///<summary>
+	/// Rebuilds the tree over count boxes, which are copied.
+	///</summary>
+	void Build(const DirectX::BoundingBox* boxes, std::uint32_t count);
+
+	///<summary>
+	/// Refits the tree to new boxes for the same items.  The first overload recomputes
+	/// every node; the second only the nodes above the listed items, so its cost grows
+	/// with the number of items that moved rather than the size of the tree.
+	///</summary>
+	void Refit(const DirectX::BoundingBox* boxes);
+	void Refit(const DirectX::BoundingBox* boxes, const std::uint32_t* changed, std::uint32_t changedCount);
+
+	std::uint32_t Size()const;
+	const DirectX::BoundingBox& GetBounds(std::uint32_t item)const;
+
+	///<summary>
+	/// Appends the items whose boxes are not completely outside the frustum.  Subtrees
+	/// found to be completely inside are added without testing their items.
+	///</summary>
+	void QueryFrustum(const FrustumPlanes& frustum, std::vector<std::uint32_t>& items)const;
+
+	///<summary>
+	/// Appends the items whose boxes touch the sphere.
+	///</summary>
+	void QuerySphere(const DirectX::BoundingSphere& sphere, std::vector<std::uint32_t>& items)const;
+
+	///<summary>
+	/// Finds the item whose box is closest to point, ignoring anything further than
+	/// maxDistance.  Returns false if there is none.
+	///</summary>
+	bool Nearest(DirectX::FXMVECTOR point, float maxDistance, std::uint32_t& item, float& distance)const;
+
+	///<summary>
+	/// Finds the closest item hit by the ray origin + t*direction, 0 <= t <= maxDistance,
+	/// where direction has unit length.
+	/// test(item, origin, direction, t) decides whether an item whose box the ray enters
+	/// is really hit, and if so sets t to the hit distance and returns true.  Nodes
+	/// further away than the closest hit so far are skipped, and the nearer child of
+	/// every node is visited first.  The first overload treats the boxes as the items.
+	///</summary>
+	bool RayCast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance,
+		std::uint32_t& item, float& distance)const;
+	template<typename ItemTest>
+	bool RayCast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance,
+		ItemTest&& test, std::uint32_t& item, float& distance)const;
+
+private:
+	struct Node
+	{
+		DirectX::XMFLOAT3 Min;
+		std::uint32_t First = 0;  // Items [First, First + Count) of mItems lie below this node
+		DirectX::XMFLOAT3 Max;
+		std::uint32_t Count = 0;
+		std::uint32_t Right = 0;  // The left child always follows its parent; 0 for leaves
+	};
+
+	void BuildNode(std::uint32_t node, std::uint32_t begin, std::uint32_t end, int parallelDepth);
+	void FitNode(std::uint32_t node);
+	bool IsLeaf(const Node& node)const;
+
+	// Entry distance of the ray into the node's box, or a negative number if it misses
+	// or enters further away than maxDistance.
+	static float IntersectRay(const Node& node, DirectX::FXMVECTOR origin, DirectX::FXMVECTOR invDirection, float maxDistance);
+
+	std::vector<DirectX::BoundingBox> mBoxes;
+	std::vector<std::uint32_t> mItems;
+	std::vector<Node> mNodes;
+	std::vector<std::uint32_t> mParents;
+	std::vector<std::uint32_t> mItemLeaves;
+
+	// Every node in use, children before their parents, for refitting
+	std::vector<std::uint32_t> mRefitOrder;
+
+	// Scratch state for partial refits
+	std::vector<std::uint8_t> mNodeDirty;
+	std::vector<std::uint32_t> mDirtyNodes;
+};
+
+template<typename ItemTest>
+bool Bvh::RayCast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance,
+	ItemTest&& test, std::uint32_t& item, float& distance)const
+{
+	using namespace DirectX;
+
+	if(mNodes.empty())
+		return false;
+
+	XMVECTOR invDirection = XMVectorReciprocal(direction);
+
+	float closest = maxDistance;
+	bool hit = false;
+
+	struct Entry { std::uint32_t Node; float Distance; };
+	Entry stack[64];
+	int top = 0;
+
+	float rootDistance = IntersectRay(mNodes[0], origin, invDirection, closest);
+	if(rootDistance < 0.0f)
+		return false;
+	stack[top++] = { 0, rootDistance };
+
+	while(top > 0)
+	{
+		Entry entry = stack[--top];
+		if(entry.Distance > closest)
+			continue;
+
+		const Node& node = mNodes[entry.Node];
+		if(IsLeaf(node))
+		{
+			for(std::uint32_t i = node.First; i < node.First + node.Count; ++i)
+			{
+				float t = closest;
+				if(test(mItems[i], origin, direction, t) && t <= closest)
+				{
+					closest = t;
+					item = mItems[i];
+					hit = true;
+				}
+			}
+			continue;
+		}
+
+		std::uint32_t left = entry.Node + 1;
+		std::uint32_t right = node.Right;
+		float leftDistance = IntersectRay(mNodes[left], origin, invDirection, closest);
+		float rightDistance = IntersectRay(mNodes[right], origin, invDirection, closest);
+
+		// Push the further child first so the nearer one is visited next
+		if(leftDistance >= 0.0f && rightDistance >= 0.0f)
+		{
+			if(leftDistance < rightDistance)
+			{
+				stack[top++] = { right, rightDistance };
+				stack[top++] = { left, leftDistance };
+			}
+			else
+			{
+				stack[top++] = { left, leftDistance };
+				stack[top++] = { right, rightDistance };
+			}
+		}
+		else if(leftDistance >= 0.0f)
+		{
+			stack[top++] = { left, leftDistance };
+		}
+		else if(rightDistance >= 0.0f)
+		{
+			stack[top++] = { right, rightDistance };
+		}
+	}
+
+	if(hit)
+		distance = closest;
+
+	return hit;
+}
@@ -0,0 +1,128 @@
+//***************************************************************************************
+// ByteStream.h
+//
+// The little endian encoding the binary logs and recordings share.  ByteWriter appends
+// fixed size values and varints to a buffer, and ByteReader reads them back from memory,
+// checking every read against the end so damaged data fails instead of overrunning.
+//
+// Varints take seven bits a byte, low bits first, with the top bit set on every byte but
+// the last.  Signed values are zigzag encoded first, so small changes either way stay
+// small: 0, -1, 1, -2, 2 become 0, 1, 2, 3, 4.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ByteWriter
+{
+public:
+	void Put8(std::uint8_t value)
+	{
+		mBytes.push_back(value);
+	}
+
+	void Put32(std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+			mBytes.push_back((std::uint8_t)(value >> (8 * i)));
+	}
+
+	void Put64(std::uint64_t value)
+	{
+		for (int i = 0; i < 8; ++i)
+			mBytes.push_back((std::uint8_t)(value >> (8 * i)));
+	}
+
+	void PutVarint(std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			mBytes.push_back((std::uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		mBytes.push_back((std::uint8_t)value);
+	}
+
+	void PutSigned(std::int64_t value)
+	{
+		PutVarint(((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63));
+	}
+
+	const std::vector<std::uint8_t>& Bytes()const { return mBytes; }
+	size_t Size()const { return mBytes.size(); }
+	void Clear() { mBytes.clear(); }
+
+private:
+	std::vector<std::uint8_t> mBytes;
+};
+
+class ByteReader
+{
+public:
+	ByteReader(const std::uint8_t* data, size_t size) : mData(data), mSize(size) { }
+
+	bool AtEnd()const { return mPosition == mSize; }
+	size_t Position()const { return mPosition; }
+	size_t Remaining()const { return mSize - mPosition; }
+
+	bool Get8(std::uint8_t& value)
+	{
+		if (Remaining() < 1)
+			return false;
+		value = mData[mPosition++];
+		return true;
+	}
+
+	bool Get32(std::uint32_t& value)
+	{
+		if (Remaining() < 4)
+			return false;
+		value = 0;
+		for (int i = 0; i < 4; ++i)
+			value |= (std::uint32_t)mData[mPosition++] << (8 * i);
+		return true;
+	}
+
+	bool Get64(std::uint64_t& value)
+	{
+		if (Remaining() < 8)
+			return false;
+		value = 0;
+		for (int i = 0; i < 8; ++i)
+			value |= (std::uint64_t)mData[mPosition++] << (8 * i);
+		return true;
+	}
+
+	// Fails on a varint longer than ten bytes as well as one cut short
+	bool GetVarint(std::uint64_t& value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			std::uint8_t byte = 0;
+			if (!Get8(byte))
+				return false;
+			value |= (std::uint64_t)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool GetSigned(std::int64_t& value)
+	{
+		std::uint64_t zigzag = 0;
+		if (!GetVarint(zigzag))
+			return false;
+		value = (std::int64_t)(zigzag >> 1) ^ -(std::int64_t)(zigzag & 1);
+		return true;
+	}
+
+private:
+	const std::uint8_t* mData;
+	size_t mSize;
+	size_t mPosition = 0;
+};
@@ -3,6 +3,7 @@
 //***************************************************************************************
 
 #include "Camera.h"
+#include <cassert>
 
 using namespace DirectX;
 
@@ -126,6 +127,7 @@ void Camera::SetLens(float fovY, float aspect, float zn, float zf)
 
 	XMMATRIX P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
 	XMStoreFloat4x4(&mProj, P);
+	XMStoreFloat4x4(&mInvProj, MathHelper::InversePerspective(P));
 }
 
 void Camera::LookAt(FXMVECTOR pos, FXMVECTOR target, FXMVECTOR worldUp)
@@ -139,6 +141,8 @@ void Camera::LookAt(FXMVECTOR pos, FXMVECTOR target, FXMVECTOR worldUp)
 	XMStoreFloat3(&mRight, R);
 	XMStoreFloat3(&mUp, U);
 
+	mOrbiting = false;
+	mMoving = false;
 	mViewDirty = true;
 }
 
@@ -176,6 +180,22 @@ XMFLOAT4X4 Camera::GetProj4x4f()const
 	return mProj;
 }
 
+XMMATRIX Camera::GetInvView()const
+{
+	assert(!mViewDirty);
+	return XMLoadFloat4x4(&mInvView);
+}
+
+XMMATRIX Camera::GetInvProj()const
+{
+	return XMLoadFloat4x4(&mInvProj);
+}
+
+FrustumPlanes Camera::GetFrustumPlanes()const
+{
+	return FrustumPlanes::FromMatrix(XMMatrixMultiply(GetView(), GetProj()));
+}
+
 void Camera::Strafe(float d)
 {
 	// mPosition += d*mRight
@@ -223,7 +243,160 @@ void Camera::RotateY(float angle)
 	mViewDirty = true;
 }
 
-void Camera::UpdateViewMatrix()
+Camera::OrbitPose Camera::OrbitPose::LookAt(const XMFLOAT3& pos, const XMFLOAT3& target, const XMFLOAT3& up)
+{
+	XMVECTOR P = XMLoadFloat3(&pos);
+	XMVECTOR T = XMLoadFloat3(&target);
+	XMVECTOR toTarget = XMVectorSubtract(T, P);
+
+	XMVECTOR L = XMVector3Normalize(toTarget);
+	XMVECTOR R = XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&up), L));
+	XMVECTOR U = XMVector3Cross(L, R);
+
+	// The rows of the camera-to-world rotation are its basis vectors.
+	XMMATRIX basis(R, U, L, XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+
+	OrbitPose pose;
+	XMStoreFloat4(&pose.Orientation, XMQuaternionNormalize(XMQuaternionRotationMatrix(basis)));
+	pose.Target = target;
+	pose.Radius = XMVectorGetX(XMVector3Length(toTarget));
+	return pose;
+}
+
+void Camera::SetOrbit(const XMFLOAT3& target, float radius, float theta, float phi)
+{
+	mOrbitTarget = target;
+	mOrbitRadius = MathHelper::Clamp(radius, mMinOrbitRadius, mMaxOrbitRadius);
+	mOrbitTheta = theta;
+	mOrbitPhi = MathHelper::Clamp(phi, mMinOrbitPhi, mMaxOrbitPhi);
+
+	if(mMoving && mOrbiting)
+		mMoveTo = GetOrbitPose();
+	else if(mOrbiting)
+		SetPose(GetOrbitPose());
+}
+
+void Camera::SetOrbitLimits(float minRadius, float maxRadius, float minPhi, float maxPhi)
+{
+	mMinOrbitRadius = minRadius;
+	mMaxOrbitRadius = maxRadius;
+	mMinOrbitPhi = minPhi;
+	mMaxOrbitPhi = maxPhi;
+
+	SetOrbit(mOrbitTarget, mOrbitRadius, mOrbitTheta, mOrbitPhi);
+}
+
+void Camera::Orbit(float dTheta, float dPhi)
+{
+	SetOrbit(mOrbitTarget, mOrbitRadius, mOrbitTheta + dTheta, mOrbitPhi + dPhi);
+}
+
+void Camera::Zoom(float dRadius)
+{
+	SetOrbit(mOrbitTarget, mOrbitRadius + dRadius, mOrbitTheta, mOrbitPhi);
+}
+
+Camera::OrbitPose Camera::GetOrbitPose()const
+{
+	// Convert Spherical to Cartesian coordinates.
+	float sinPhi = sinf(mOrbitPhi);
+	XMFLOAT3 pos(
+		mOrbitTarget.x + mOrbitRadius*sinPhi*cosf(mOrbitTheta),
+		mOrbitTarget.y + mOrbitRadius*cosf(mOrbitPhi),
+		mOrbitTarget.z + mOrbitRadius*sinPhi*sinf(mOrbitTheta));
+
+	return OrbitPose::LookAt(pos, mOrbitTarget, XMFLOAT3(0.0f, 1.0f, 0.0f));
+}
+
+bool Camera::IsOrbiting()const
+{
+	return mOrbiting;
+}
+
+void Camera::MoveTo(const OrbitPose& pose, float duration)
+{
+	mOrbiting = false;
+
+	if(duration <= 0.0f)
+	{
+		mMoving = false;
+		SetPose(pose);
+		return;
+	}
+
+	// Start from where the camera is now, pivoting about the point on its line of sight
+	// as far away as the destination's target.
+	XMVECTOR P = XMLoadFloat3(&mPosition);
+	XMVECTOR L = XMLoadFloat3(&mLook);
+	float radius = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&pose.Target), P)));
+
+	XMMATRIX basis(XMLoadFloat3(&mRight), XMLoadFloat3(&mUp), L, XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+	XMStoreFloat4(&mMoveFrom.Orientation, XMQuaternionNormalize(XMQuaternionRotationMatrix(basis)));
+	XMStoreFloat3(&mMoveFrom.Target, XMVectorMultiplyAdd(XMVectorReplicate(radius), L, P));
+	mMoveFrom.Radius = radius;
+
+	mMoveTo = pose;
+	mMoveTime = 0.0f;
+	mMoveDuration = duration;
+	mMoving = true;
+}
+
+void Camera::OrbitTo(float duration)
+{
+	MoveTo(GetOrbitPose(), duration);
+	mOrbiting = true;
+}
+
+bool Camera::IsMoving()const
+{
+	return mMoving;
+}
+
+void Camera::Update(float dt)
+{
+	if(!mMoving)
+		return;
+
+	mMoveTime += dt;
+	float s = MathHelper::Clamp(mMoveTime / mMoveDuration, 0.0f, 1.0f);
+	if(s >= 1.0f)
+	{
+		mMoving = false;
+		SetPose(mMoveTo);
+		return;
+	}
+
+	// Ease in and out.
+	s = s*s*(3.0f - 2.0f*s);
+
+	OrbitPose pose;
+	XMVECTOR Q0 = XMLoadFloat4(&mMoveFrom.Orientation);
+	XMVECTOR Q1 = XMLoadFloat4(&mMoveTo.Orientation);
+	XMStoreFloat4(&pose.Orientation, XMQuaternionSlerp(Q0, Q1, s));
+	XMStoreFloat3(&pose.Target, XMVectorLerp(XMLoadFloat3(&mMoveFrom.Target), XMLoadFloat3(&mMoveTo.Target), s));
+	pose.Radius = mMoveFrom.Radius + s*(mMoveTo.Radius - mMoveFrom.Radius);
+	SetPose(pose);
+}
+
+void Camera::SetPose(const OrbitPose& pose)
+{
+	XMVECTOR Q = XMLoadFloat4(&pose.Orientation);
+	XMVECTOR R = XMVector3Rotate(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), Q);
+	XMVECTOR U = XMVector3Rotate(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), Q);
+	XMVECTOR L = XMVector3Rotate(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), Q);
+
+	// The camera sits Radius back from the target along its line of sight.
+	XMVECTOR P = XMVectorMultiplyAdd(XMVectorReplicate(-pose.Radius), L, XMLoadFloat3(&pose.Target));
+
+	XMStoreFloat3(&mPosition, P);
+	XMStoreFloat3(&mRight, R);
+	XMStoreFloat3(&mUp, U);
+	XMStoreFloat3(&mLook, L);
+
+	mViewDirty = true;
+}
+
+bool Camera::UpdateViewMatrix()
 {
 	if(mViewDirty)
 	{
@@ -268,8 +441,19 @@ void Camera::UpdateViewMatrix()
 		mView(2, 3) = 0.0f;
 		mView(3, 3) = 1.0f;
 
+		// The inverse takes view space back to the world: its rows are the camera's
+		// axes and position.
+		mInvView = XMFLOAT4X4(
+			mRight.x, mRight.y, mRight.z, 0.0f,
+			mUp.x, mUp.y, mUp.z, 0.0f,
+			mLook.x, mLook.y, mLook.z, 0.0f,
+			mPosition.x, mPosition.y, mPosition.z, 1.0f);
+
 		mViewDirty = false;
+		return true;
 	}
+
+	return false;
 }
 
 
@@ -6,17 +6,30 @@
 //    so that the view matrix can be constructed.  
 //   -It keeps track of the viewing frustum of the camera so that the projection
 //    matrix can be obtained.
+//   -It can orbit a target instead, and move smoothly from one pose to another.
 //***************************************************************************************
 
 #ifndef CAMERA_H
 #define CAMERA_H
 
-#include "d3dUtil.h"
+#include "MathHelper.h"
+#include "FrustumCuller.h"
 
 class Camera
 {
 public:
 
+	// A camera looking at Target from Radius away.  Moving between two poses turns the
+	// camera around the target rather than cutting straight through it.
+	struct OrbitPose
+	{
+		DirectX::XMFLOAT4 Orientation = { 0.0f, 0.0f, 0.0f, 1.0f };
+		DirectX::XMFLOAT3 Target = { 0.0f, 0.0f, 0.0f };
+		float Radius = 1.0f;
+
+		static OrbitPose LookAt(const DirectX::XMFLOAT3& pos, const DirectX::XMFLOAT3& target, const DirectX::XMFLOAT3& up);
+	};
+
 	Camera();
 	~Camera();
 
@@ -61,6 +74,15 @@ public:
 	DirectX::XMFLOAT4X4 GetView4x4f()const;
 	DirectX::XMFLOAT4X4 GetProj4x4f()const;
 
+	// Get the inverse View/Proj matrices, which are kept up to date with the matrices
+	// themselves without a general inversion.
+	DirectX::XMMATRIX GetInvView()const;
+	DirectX::XMMATRIX GetInvProj()const;
+
+	// Get the planes of the view frustum in world space.  Call UpdateViewMatrix first
+	// if the camera has moved.
+	FrustumPlanes GetFrustumPlanes()const;
+
 	// Strafe/Walk the camera a distance d.
 	void Strafe(float d);
 	void Walk(float d);
@@ -69,8 +91,29 @@ public:
 	void Pitch(float angle);
 	void RotateY(float angle);
 
+	// Orbit a target: theta is the angle around the world y-axis and phi the angle down
+	// from it.  The radius and phi are kept within the limits.  Changing these only moves
+	// the camera while it is orbiting.
+	void SetOrbit(const DirectX::XMFLOAT3& target, float radius, float theta, float phi);
+	void SetOrbitLimits(float minRadius, float maxRadius, float minPhi, float maxPhi);
+	void Orbit(float dTheta, float dPhi);
+	void Zoom(float dRadius);
+	OrbitPose GetOrbitPose()const;
+	bool IsOrbiting()const;
+
+	// Move smoothly to a pose, or into orbiting, over duration seconds.  The orientation
+	// is slerped, so the camera turns at an even rate.  A duration of zero jumps straight
+	// there.  LookAt cancels a move and stops orbiting.
+	void MoveTo(const OrbitPose& pose, float duration);
+	void OrbitTo(float duration);
+	bool IsMoving()const;
+
+	// Advance a move in progress by dt seconds.
+	void Update(float dt);
+
 	// After modifying camera position/orientation, call to rebuild the view matrix.
-	void UpdateViewMatrix();
+	// Returns true if the view matrix changed.
+	bool UpdateViewMatrix();
 
 private:
 
@@ -90,9 +133,31 @@ private:
 
 	bool mViewDirty = true;
 
+	// Orbit controls.
+	DirectX::XMFLOAT3 mOrbitTarget = { 0.0f, 0.0f, 0.0f };
+	float mOrbitRadius = 5.0f;
+	float mOrbitTheta = 1.5f*MathHelper::Pi;
+	float mOrbitPhi = 0.25f*MathHelper::Pi;
+	float mMinOrbitRadius = 1.0f;
+	float mMaxOrbitRadius = 1000.0f;
+	float mMinOrbitPhi = 0.1f;
+	float mMaxOrbitPhi = MathHelper::Pi - 0.1f;
+	bool mOrbiting = false;
+
+	// Move in progress.
+	OrbitPose mMoveFrom;
+	OrbitPose mMoveTo;
+	float mMoveTime = 0.0f;
+	float mMoveDuration = 0.0f;
+	bool mMoving = false;
+
 	// Cache View/Proj matrices.
 	DirectX::XMFLOAT4X4 mView = MathHelper::Identity4x4();
 	DirectX::XMFLOAT4X4 mProj = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 mInvView = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 mInvProj = MathHelper::Identity4x4();
+
+	void SetPose(const OrbitPose& pose);
 };
 
 #endif // CAMERA_H
\ No newline at end of file
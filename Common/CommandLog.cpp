@@ -0,0 +1,386 @@
+//***************************************************************************************
+// CommandLog.cpp
+//***************************************************************************************
+
+#include "CommandLog.h"
+#include <algorithm>
+#include <set>
+#include <utility>
+
+namespace
+{
+	// What is bound while a frame is read back
+	struct BoundState
+	{
+		bool HasPipelineState = false;
+		std::uint32_t PipelineState = 0;
+
+		// The op that bound each root parameter, OpCount while unbound, and its value
+		std::vector<std::pair<std::uint8_t, std::uint64_t>> Root;
+
+		bool HasVertexBuffer = false;
+		std::uint64_t VertexAddress = 0;
+		std::uint32_t VertexBytes = 0;
+		std::uint32_t VertexStride = 0;
+
+		bool HasIndexBuffer = false;
+		std::uint64_t IndexAddress = 0;
+		std::uint32_t IndexBytes = 0;
+		std::uint8_t WideIndices = 0;
+
+		bool HasTopology = false;
+		std::uint8_t Topology = 0;
+
+		// Constant buffers already read this frame, by root parameter and address
+		std::set<std::pair<std::uint32_t, std::uint64_t>> ConstantsRead;
+	};
+
+	bool Fail(std::string& error, size_t position, const std::string& what)
+	{
+		error = "at byte " + std::to_string(position) + ": " + what;
+		return false;
+	}
+}
+
+std::uint64_t CommandLog::FrameSummary::RedundantTotal()const
+{
+	std::uint64_t total = 0;
+	for (auto count : Redundant)
+		total += count;
+	return total;
+}
+
+std::uint64_t CommandLog::FrameSummary::EstimatedBytes()const
+{
+	return IndexBytes + VertexBytes + ConstantBytes;
+}
+
+CommandLog::CommandLog(const std::vector<std::uint32_t>& rootBytes, RenderCommands* next)
+	: mRootBytes(rootBytes), mNext(next)
+{
+}
+
+void CommandLog::SetRootBytes(const std::vector<std::uint32_t>& rootBytes)
+{
+	mRootBytes = rootBytes;
+}
+
+void CommandLog::SetNext(RenderCommands* next)
+{
+	mNext = next;
+}
+
+void CommandLog::BeginFrame()
+{
+	PutOp(OpFrame);
+	++mFrameCount;
+}
+
+void CommandLog::Barrier(const void* resource, ResourceState before, ResourceState after)
+{
+	PutOp(OpBarrier);
+	mBytes.Put32(Id(resource));
+	mBytes.Put8((std::uint8_t)before);
+	mBytes.Put8((std::uint8_t)after);
+
+	if (mNext != nullptr)
+		mNext->Barrier(resource, before, after);
+}
+
+void CommandLog::SetPipelineState(const void* pipelineState)
+{
+	PutOp(OpPipelineState);
+	mBytes.Put32(Id(pipelineState));
+
+	if (mNext != nullptr)
+		mNext->SetPipelineState(pipelineState);
+}
+
+void CommandLog::SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor)
+{
+	PutOp(OpRootTable);
+	mBytes.Put8((std::uint8_t)slot);
+	mBytes.Put64(descriptor);
+
+	if (mNext != nullptr)
+		mNext->SetRootDescriptorTable(slot, descriptor);
+}
+
+void CommandLog::SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address)
+{
+	PutOp(OpRootCbv);
+	mBytes.Put8((std::uint8_t)slot);
+	mBytes.Put64(address);
+
+	if (mNext != nullptr)
+		mNext->SetRootConstantBufferView(slot, address);
+}
+
+void CommandLog::SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address)
+{
+	PutOp(OpRootSrv);
+	mBytes.Put8((std::uint8_t)slot);
+	mBytes.Put64(address);
+
+	if (mNext != nullptr)
+		mNext->SetRootShaderResourceView(slot, address);
+}
+
+void CommandLog::SetVertexBuffer(const VertexBufferView& view)
+{
+	PutOp(OpVertexBuffer);
+	mBytes.Put64(view.Address);
+	mBytes.Put32(view.ByteSize);
+	mBytes.Put32(view.Stride);
+
+	if (mNext != nullptr)
+		mNext->SetVertexBuffer(view);
+}
+
+void CommandLog::SetIndexBuffer(const IndexBufferView& view)
+{
+	PutOp(OpIndexBuffer);
+	mBytes.Put64(view.Address);
+	mBytes.Put32(view.ByteSize);
+	mBytes.Put8(view.Wide ? 1 : 0);
+
+	if (mNext != nullptr)
+		mNext->SetIndexBuffer(view);
+}
+
+void CommandLog::SetPrimitiveTopology(Topology topology)
+{
+	PutOp(OpTopology);
+	mBytes.Put8((std::uint8_t)topology);
+
+	if (mNext != nullptr)
+		mNext->SetPrimitiveTopology(topology);
+}
+
+void CommandLog::DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex)
+{
+	PutOp(OpDrawIndexed);
+	mBytes.Put32(indexCount);
+	mBytes.Put32(startIndex);
+	mBytes.Put32((std::uint32_t)baseVertex);
+
+	if (mNext != nullptr)
+		mNext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+size_t CommandLog::FrameCount()const
+{
+	return mFrameCount;
+}
+
+size_t CommandLog::CommandBytes()const
+{
+	return mBytes.Size();
+}
+
+bool CommandLog::Write(std::ostream& out)const
+{
+	// The header goes through the same little endian encoding as the commands
+	ByteWriter header;
+	header.Put32(Magic);
+	header.Put32(Version);
+	header.Put32((std::uint32_t)mRootBytes.size());
+	for (auto bytes : mRootBytes)
+		header.Put32(bytes);
+
+	out.write(reinterpret_cast<const char*>(header.Bytes().data()), (std::streamsize)header.Size());
+	out.write(reinterpret_cast<const char*>(mBytes.Bytes().data()), (std::streamsize)mBytes.Size());
+	return (bool)out;
+}
+
+void CommandLog::Clear()
+{
+	mBytes.Clear();
+	mFrameCount = 0;
+	mIds.clear();
+}
+
+bool CommandLog::Analyze(const void* data, size_t size, std::vector<FrameSummary>& frames, std::string& error)
+{
+	frames.clear();
+	ByteReader in(static_cast<const std::uint8_t*>(data), size);
+
+	std::uint32_t magic = 0, version = 0, rootCount = 0;
+	if (!in.Get32(magic) || magic != Magic)
+		return Fail(error, 0, "not a command log");
+	if (!in.Get32(version) || version != Version)
+		return Fail(error, 4, "version " + std::to_string(version) + " is not " + std::to_string(Version));
+	if (!in.Get32(rootCount) || rootCount > 64)
+		return Fail(error, 8, "bad root parameter count");
+
+	std::vector<std::uint32_t> rootBytes(rootCount);
+	for (auto& bytes : rootBytes) {
+		if (!in.Get32(bytes))
+			return Fail(error, in.Position(), "header cut short");
+	}
+
+	BoundState state;
+	FrameSummary* frame = nullptr;
+	while (!in.AtEnd())
+	{
+		const size_t start = in.Position();
+		std::uint8_t op = 0;
+		in.Get8(op);
+
+		bool ok = true;
+		bool redundant = false;
+		switch (op)
+		{
+		case OpFrame:
+			// Command lists start every frame with nothing bound
+			frames.emplace_back();
+			frame = &frames.back();
+			state = BoundState();
+			state.Root.assign(rootCount, { (std::uint8_t)OpCount, 0 });
+			break;
+
+		case OpBarrier:
+		{
+			std::uint32_t resource = 0;
+			std::uint8_t before = 0, after = 0;
+			ok = in.Get32(resource) && in.Get8(before) && in.Get8(after);
+			redundant = before == after;
+			break;
+		}
+
+		case OpPipelineState:
+		{
+			std::uint32_t id = 0;
+			ok = in.Get32(id);
+			redundant = state.HasPipelineState && state.PipelineState == id;
+			state.HasPipelineState = true;
+			state.PipelineState = id;
+			break;
+		}
+
+		case OpRootTable:
+		case OpRootCbv:
+		case OpRootSrv:
+		{
+			std::uint8_t slot = 0;
+			std::uint64_t value = 0;
+			ok = in.Get8(slot) && in.Get64(value);
+			if (ok && slot >= rootCount)
+				return Fail(error, start, "root parameter " + std::to_string(slot) + " is past the root signature");
+			if (ok && frame != nullptr) {
+				redundant = state.Root[slot].first == op && state.Root[slot].second == value;
+				state.Root[slot] = { op, value };
+			}
+			break;
+		}
+
+		case OpVertexBuffer:
+		{
+			std::uint64_t address = 0;
+			std::uint32_t bytes = 0, stride = 0;
+			ok = in.Get64(address) && in.Get32(bytes) && in.Get32(stride);
+			redundant = state.HasVertexBuffer && state.VertexAddress == address &&
+				state.VertexBytes == bytes && state.VertexStride == stride;
+			state.HasVertexBuffer = true;
+			state.VertexAddress = address;
+			state.VertexBytes = bytes;
+			state.VertexStride = stride;
+			break;
+		}
+
+		case OpIndexBuffer:
+		{
+			std::uint64_t address = 0;
+			std::uint32_t bytes = 0;
+			std::uint8_t wide = 0;
+			ok = in.Get64(address) && in.Get32(bytes) && in.Get8(wide);
+			redundant = state.HasIndexBuffer && state.IndexAddress == address &&
+				state.IndexBytes == bytes && state.WideIndices == wide;
+			state.HasIndexBuffer = true;
+			state.IndexAddress = address;
+			state.IndexBytes = bytes;
+			state.WideIndices = wide;
+			break;
+		}
+
+		case OpTopology:
+		{
+			std::uint8_t topology = 0;
+			ok = in.Get8(topology);
+			redundant = state.HasTopology && state.Topology == topology;
+			state.HasTopology = true;
+			state.Topology = topology;
+			break;
+		}
+
+		case OpDrawIndexed:
+		{
+			std::uint32_t indexCount = 0, startIndex = 0, baseVertex = 0;
+			ok = in.Get32(indexCount) && in.Get32(startIndex) && in.Get32(baseVertex);
+			if (!ok || frame == nullptr)
+				break;
+
+			frame->Draws++;
+			frame->Indices += indexCount;
+			frame->IndexBytes += (std::uint64_t)indexCount * (state.WideIndices ? 4 : 2);
+			frame->VertexBytes += std::min<std::uint64_t>((std::uint64_t)indexCount * state.VertexStride, state.VertexBytes);
+
+			for (std::uint32_t slot = 0; slot < rootCount; ++slot) {
+				const auto& bound = state.Root[slot];
+				bool readsConstants = bound.first == OpRootCbv || bound.first == OpRootSrv;
+				if (readsConstants && rootBytes[slot] > 0 && state.ConstantsRead.insert({ slot, bound.second }).second)
+					frame->ConstantBytes += rootBytes[slot];
+			}
+			break;
+		}
+
+		default:
+			return Fail(error, start, "unknown command " + std::to_string(op));
+		}
+
+		if (!ok)
+			return Fail(error, start, std::string(OpName((Op)op)) + " cut short");
+
+		if (frame != nullptr && op != OpFrame) {
+			frame->Commands++;
+			if (redundant)
+				frame->Redundant[op]++;
+		}
+	}
+	return true;
+}
+
+const char* CommandLog::OpName(Op op)
+{
+	switch (op)
+	{
+	case OpFrame: return "Frame";
+	case OpBarrier: return "Barrier";
+	case OpPipelineState: return "PipelineState";
+	case OpRootTable: return "RootTable";
+	case OpRootCbv: return "RootCbv";
+	case OpRootSrv: return "RootSrv";
+	case OpVertexBuffer: return "VertexBuffer";
+	case OpIndexBuffer: return "IndexBuffer";
+	case OpTopology: return "Topology";
+	case OpDrawIndexed: return "DrawIndexed";
+	default: return "Unknown";
+	}
+}
+
+void CommandLog::PutOp(Op op)
+{
+	mBytes.Put8(op);
+}
+
+
+std::uint32_t CommandLog::Id(const void* object)
+{
+	auto it = mIds.find(object);
+	if (it != mIds.end())
+		return it->second;
+
+	std::uint32_t id = (std::uint32_t)mIds.size();
+	mIds.emplace(object, id);
+	return id;
+}
@@ -0,0 +1,148 @@
+//***************************************************************************************
+// CommandLog.h
+//
+// Records RenderCommands into a compact binary log instead of, or as well as, passing
+// them on to a device, so the commands a frame submits can be counted and compared on a
+// machine with no GPU.  Analyze reads a log back and sums up each frame: how many draws,
+// how many state changes set what was already set, how many bytes of constants the draws
+// read and an estimate of the memory traffic.
+//
+// A log is a header followed by one record per command, each an opcode byte and its
+// arguments in little endian:
+//
+//   header          "RCLG", version, root parameter count, then for each root parameter
+//                   the bytes a draw reads through it (all uint32)
+//   Frame           starts a frame
+//   Barrier         uint32 resource, uint8 before, uint8 after
+//   PipelineState   uint32 pipeline state
+//   RootTable       uint8 slot, uint64 descriptor
+//   RootCbv         uint8 slot, uint64 address
+//   RootSrv         uint8 slot, uint64 address
+//   VertexBuffer    uint64 address, uint32 bytes, uint32 stride
+//   IndexBuffer     uint64 address, uint32 bytes, uint8 32 bit indices
+//   Topology        uint8 topology
+//   DrawIndexed     uint32 index count, uint32 start index, int32 base vertex
+//
+// Resources and pipeline states are numbered in the order they are first seen, so two
+// runs that do the same thing write the same log.
+//***************************************************************************************
+
+#pragma once
+
+#include "ByteStream.h"
+#include "RenderCommands.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CommandLog : public RenderCommands
+{
+public:
+	enum Op : std::uint8_t
+	{
+		OpFrame,
+		OpBarrier,
+		OpPipelineState,
+		OpRootTable,
+		OpRootCbv,
+		OpRootSrv,
+		OpVertexBuffer,
+		OpIndexBuffer,
+		OpTopology,
+		OpDrawIndexed,
+		OpCount
+	};
+
+	static const std::uint32_t Magic = 0x474C4352; // "RCLG"
+	static const std::uint32_t Version = 1;
+
+	// What Analyze finds in one frame of a log.
+	struct FrameSummary
+	{
+		std::uint64_t Commands = 0;
+		std::uint64_t Draws = 0;
+		std::uint64_t Indices = 0;
+
+		// Commands that set what was already set, or barriers that change nothing
+		std::uint64_t Redundant[OpCount] = {};
+
+		// Bytes of constants read by the frame's draws, counting each constant buffer
+		// once however many draws read it
+		std::uint64_t ConstantBytes = 0;
+
+		// Bytes of indices and vertices the draws fetch.  A vertex is counted for every
+		// index that reads it, up to the size of the vertex buffer, so this is an upper
+		// bound on what a GPU with a vertex cache would read.
+		std::uint64_t IndexBytes = 0;
+		std::uint64_t VertexBytes = 0;
+
+		std::uint64_t RedundantTotal()const;
+
+		// Index, vertex and constant bytes together.  Texture reads and render target
+		// writes are not counted.
+		std::uint64_t EstimatedBytes()const;
+	};
+
+	///<summary>
+	/// Records commands, passing each on to next as well if it is not null.  rootBytes is
+	/// how many bytes a draw reads through each root parameter of the root signature the
+	/// commands are recorded against, 0 for descriptor tables.
+	///</summary>
+	explicit CommandLog(const std::vector<std::uint32_t>& rootBytes = {}, RenderCommands* next = nullptr);
+
+	void SetRootBytes(const std::vector<std::uint32_t>& rootBytes);
+	void SetNext(RenderCommands* next);
+
+	///<summary>
+	/// Starts a new frame.  Commands recorded before the first BeginFrame are part of no
+	/// frame and Analyze skips them.
+	///</summary>
+	void BeginFrame();
+
+	void Barrier(const void* resource, ResourceState before, ResourceState after) override;
+	void SetPipelineState(const void* pipelineState) override;
+
+	void SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor) override;
+	void SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address) override;
+	void SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address) override;
+
+	void SetVertexBuffer(const VertexBufferView& view) override;
+	void SetIndexBuffer(const IndexBufferView& view) override;
+	void SetPrimitiveTopology(Topology topology) override;
+
+	void DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex) override;
+
+	size_t FrameCount()const;
+
+	// Bytes of commands recorded, not counting the header.
+	size_t CommandBytes()const;
+
+	// Writes the header and every command recorded.
+	bool Write(std::ostream& out)const;
+
+	// Drops every command and frame recorded, keeping the root parameter sizes.
+	void Clear();
+
+	///<summary>
+	/// Sums up each frame of a log written by Write.  Returns false with what is wrong in
+	/// error if the log is damaged or from another version.
+	///</summary>
+	static bool Analyze(const void* data, size_t size, std::vector<FrameSummary>& frames, std::string& error);
+
+	static const char* OpName(Op op);
+
+private:
+	void PutOp(Op op);
+	std::uint32_t Id(const void* object);
+
+	std::vector<std::uint32_t> mRootBytes;
+	RenderCommands* mNext;
+
+	ByteWriter mBytes;
+	size_t mFrameCount = 0;
+
+	std::unordered_map<const void*, std::uint32_t> mIds;
+};
@@ -0,0 +1,100 @@
+//***************************************************************************************
+// D3D12RenderCommands.cpp
+//***************************************************************************************
+
+#include "D3D12RenderCommands.h"
+
+namespace
+{
+	D3D12_RESOURCE_STATES ToD3D12(RenderCommands::ResourceState state)
+	{
+		switch (state)
+		{
+		case RenderCommands::StateRenderTarget:
+			return D3D12_RESOURCE_STATE_RENDER_TARGET;
+		default:
+			return D3D12_RESOURCE_STATE_PRESENT;
+		}
+	}
+}
+
+D3D12RenderCommands::D3D12RenderCommands(ID3D12GraphicsCommandList* cmdList)
+	: mCmdList(cmdList)
+{
+}
+
+void D3D12RenderCommands::Barrier(const void* resource, ResourceState before, ResourceState after)
+{
+	auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+		const_cast<ID3D12Resource*>(static_cast<const ID3D12Resource*>(resource)), ToD3D12(before), ToD3D12(after));
+	mCmdList->ResourceBarrier(1, &barrier);
+}
+
+void D3D12RenderCommands::SetPipelineState(const void* pipelineState)
+{
+	mCmdList->SetPipelineState(const_cast<ID3D12PipelineState*>(static_cast<const ID3D12PipelineState*>(pipelineState)));
+}
+
+void D3D12RenderCommands::SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor)
+{
+	D3D12_GPU_DESCRIPTOR_HANDLE handle;
+	handle.ptr = descriptor;
+	mCmdList->SetGraphicsRootDescriptorTable(slot, handle);
+}
+
+void D3D12RenderCommands::SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address)
+{
+	mCmdList->SetGraphicsRootConstantBufferView(slot, address);
+}
+
+void D3D12RenderCommands::SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address)
+{
+	mCmdList->SetGraphicsRootShaderResourceView(slot, address);
+}
+
+void D3D12RenderCommands::SetVertexBuffer(const VertexBufferView& view)
+{
+	D3D12_VERTEX_BUFFER_VIEW vbv;
+	vbv.BufferLocation = view.Address;
+	vbv.SizeInBytes = view.ByteSize;
+	vbv.StrideInBytes = view.Stride;
+	mCmdList->IASetVertexBuffers(0, 1, &vbv);
+}
+
+void D3D12RenderCommands::SetIndexBuffer(const IndexBufferView& view)
+{
+	D3D12_INDEX_BUFFER_VIEW ibv;
+	ibv.BufferLocation = view.Address;
+	ibv.SizeInBytes = view.ByteSize;
+	ibv.Format = view.Wide ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+	mCmdList->IASetIndexBuffer(&ibv);
+}
+
+void D3D12RenderCommands::SetPrimitiveTopology(Topology topology)
+{
+	// Triangle lists are the only topology there is
+	mCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+void D3D12RenderCommands::DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex)
+{
+	mCmdList->DrawIndexedInstanced(indexCount, 1, startIndex, baseVertex, 0);
+}
+
+RenderCommands::VertexBufferView D3D12RenderCommands::ToView(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+	VertexBufferView result;
+	result.Address = view.BufferLocation;
+	result.ByteSize = view.SizeInBytes;
+	result.Stride = view.StrideInBytes;
+	return result;
+}
+
+RenderCommands::IndexBufferView D3D12RenderCommands::ToView(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+	IndexBufferView result;
+	result.Address = view.BufferLocation;
+	result.ByteSize = view.SizeInBytes;
+	result.Wide = view.Format == DXGI_FORMAT_R32_UINT;
+	return result;
+}
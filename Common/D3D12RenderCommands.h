@@ -0,0 +1,36 @@
+//***************************************************************************************
+// D3D12RenderCommands.h
+//
+// Records RenderCommands into a D3D12 command list.  The resources and pipeline states
+// given to it must be ID3D12Resources and ID3D12PipelineStates.
+//***************************************************************************************
+
+#pragma once
+
+#include "RenderCommands.h"
+#include "d3dUtil.h"
+
+class D3D12RenderCommands : public RenderCommands
+{
+public:
+	explicit D3D12RenderCommands(ID3D12GraphicsCommandList* cmdList);
+
+	void Barrier(const void* resource, ResourceState before, ResourceState after) override;
+	void SetPipelineState(const void* pipelineState) override;
+
+	void SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor) override;
+	void SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address) override;
+	void SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address) override;
+
+	void SetVertexBuffer(const VertexBufferView& view) override;
+	void SetIndexBuffer(const IndexBufferView& view) override;
+	void SetPrimitiveTopology(Topology topology) override;
+
+	void DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex) override;
+
+	static VertexBufferView ToView(const D3D12_VERTEX_BUFFER_VIEW& view);
+	static IndexBufferView ToView(const D3D12_INDEX_BUFFER_VIEW& view);
+
+private:
+	ID3D12GraphicsCommandList* mCmdList;
+};
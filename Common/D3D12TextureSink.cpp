@@ -0,0 +1,184 @@
+//***************************************************************************************
+// D3D12TextureSink.cpp
+//***************************************************************************************
+
+#include "D3D12TextureSink.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	bool IsBlockCompressed(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+			(format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	}
+}
+
+D3D12TextureSink::D3D12TextureSink(ID3D12Device* device)
+	: mDevice(device)
+{
+}
+
+void D3D12TextureSink::SetDescriptors(std::uint32_t texture, D3D12_CPU_DESCRIPTOR_HANDLE first, UINT descriptorSize)
+{
+	Slot& slot = GetSlot(texture);
+	slot.Descriptors[0] = first;
+	slot.Descriptors[1] = CD3DX12_CPU_DESCRIPTOR_HANDLE(first, 1, descriptorSize);
+}
+
+UINT D3D12TextureSink::DescriptorIndex(std::uint32_t texture)const
+{
+	return texture < mSlots.size() ? mSlots[texture].Current : 0;
+}
+
+void D3D12TextureSink::Begin(ID3D12GraphicsCommandList* cmdList, UINT64 completedFence, UINT64 frameFence)
+{
+	PROFILE_ZONE("D3D12TextureSink::Begin");
+	mCmdList = cmdList;
+	mFrameFence = frameFence;
+
+	mRetired.erase(std::remove_if(mRetired.begin(), mRetired.end(),
+		[completedFence](const Retired& retired) { return retired.Fence <= completedFence; }), mRetired.end());
+
+	for (Slot& slot : mSlots)
+	{
+		// Wait for the copy, and for the frames still reading the view it will go in
+		if (!slot.Pending || slot.PendingFence > completedFence || slot.OtherFreeFence > completedFence)
+			continue;
+
+		UINT other = slot.Current ^ 1;
+		if (slot.Descriptors[other].ptr != 0)
+			mDevice->CreateShaderResourceView(slot.Pending->Resource.Get(), &slot.PendingView, slot.Descriptors[other]);
+
+		slot.Pending->UploadHeap = nullptr;
+		slot.Pending->TrackMemory(mDevice);
+
+		// The frames before this one were recorded with the old view and texture
+		if (slot.Shown)
+			Retire(std::move(slot.Shown), frameFence - 1);
+		slot.Shown = std::move(slot.Pending);
+		slot.OtherFreeFence = frameFence - 1;
+		slot.Current = other;
+	}
+}
+
+bool D3D12TextureSink::MakeResident(std::uint32_t texture, const DDSFile& file,
+	const std::vector<DDSFile::Surface>& surfaces, std::uint32_t firstMip)
+{
+	PROFILE_ZONE("D3D12TextureSink::MakeResident");
+
+	// The streamer counts the mips resident once this returns true, so there must be a
+	// list to record the copy into
+	assert(mCmdList != nullptr && "Begin must be called before the streamer's Update");
+
+	// DDSFile::Open keeps the mip count, array size and depth well inside 16 bits, so the
+	// resource has just the subresources listed below
+	const DDSFile::Surface& top = surfaces[firstMip];
+	const UINT fileMips = file.MipCount();
+	const UINT16 mipCount = (UINT16)(fileMips - firstMip);
+	const UINT16 arraySize = (UINT16)file.ArraySize();
+
+	// Block compressed textures must be whole blocks across at their largest mip
+	if (IsBlockCompressed(file.Format()) && (top.Width % 4 != 0 || top.Height % 4 != 0))
+		return false;
+
+	D3D12_RESOURCE_DESC desc;
+	D3D12_SHADER_RESOURCE_VIEW_DESC view = {};
+	view.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	view.Format = file.Format();
+	if (file.Depth() > 1)
+	{
+		desc = CD3DX12_RESOURCE_DESC::Tex3D(file.Format(), top.Width, top.Height, (UINT16)top.Depth, mipCount);
+		view.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
+		view.Texture3D.MipLevels = mipCount;
+	}
+	else
+	{
+		desc = CD3DX12_RESOURCE_DESC::Tex2D(file.Format(), top.Width, top.Height, arraySize, mipCount);
+		if (file.IsCubeMap() && arraySize > 6)
+		{
+			view.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBEARRAY;
+			view.TextureCubeArray.MipLevels = mipCount;
+			view.TextureCubeArray.NumCubes = arraySize / 6;
+		}
+		else if (file.IsCubeMap())
+		{
+			view.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+			view.TextureCube.MipLevels = mipCount;
+		}
+		else if (arraySize > 1)
+		{
+			view.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+			view.Texture2DArray.MipLevels = mipCount;
+			view.Texture2DArray.ArraySize = arraySize;
+		}
+		else
+		{
+			view.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			view.Texture2D.MipLevels = mipCount;
+		}
+	}
+
+	auto resources = std::make_unique<Texture>();
+
+	// A texture the device refuses fails the texture, not the frame
+	CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
+	if (FAILED(mDevice->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &desc,
+		D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(resources->Resource.GetAddressOf()))))
+		return false;
+
+	// Subresources go mip by mip within each array item, as the surfaces do
+	std::vector<D3D12_SUBRESOURCE_DATA> data;
+	data.reserve((size_t)mipCount * arraySize);
+	for (UINT item = 0; item < arraySize; ++item)
+	{
+		for (UINT mip = firstMip; mip < fileMips; ++mip)
+		{
+			const DDSFile::Surface& surface = surfaces[(size_t)item * fileMips + mip];
+			D3D12_SUBRESOURCE_DATA subresource;
+			subresource.pData = surface.Data;
+			subresource.RowPitch = (LONG_PTR)surface.RowPitch;
+			subresource.SlicePitch = (LONG_PTR)surface.SlicePitch;
+			data.push_back(subresource);
+		}
+	}
+
+	const UINT64 uploadBytes = GetRequiredIntermediateSize(resources->Resource.Get(), 0, (UINT)data.size());
+	CD3DX12_HEAP_PROPERTIES uploadHeap(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBytes);
+	if (FAILED(mDevice->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &uploadDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(resources->UploadHeap.GetAddressOf()))))
+		return false;
+
+	UpdateSubresources(mCmdList, resources->Resource.Get(), resources->UploadHeap.Get(), 0, 0, (UINT)data.size(), data.data());
+	auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resources->Resource.Get(),
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	mCmdList->ResourceBarrier(1, &barrier);
+	resources->TrackMemory(mDevice);
+
+	// A texture not shown yet is dropped for this one, and released once its copy is done
+	Slot& slot = GetSlot(texture);
+	if (slot.Pending)
+		Retire(std::move(slot.Pending), slot.PendingFence);
+	slot.Pending = std::move(resources);
+	slot.PendingFence = mFrameFence;
+	slot.PendingView = view;
+	return true;
+}
+
+D3D12TextureSink::Slot& D3D12TextureSink::GetSlot(std::uint32_t texture)
+{
+	if (texture >= mSlots.size())
+		mSlots.resize(texture + 1);
+	return mSlots[texture];
+}
+
+void D3D12TextureSink::Retire(std::unique_ptr<Texture> resources, UINT64 fence)
+{
+	Retired retired;
+	retired.Resources = std::move(resources);
+	retired.Fence = fence;
+	mRetired.push_back(std::move(retired));
+}
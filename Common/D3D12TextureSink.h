@@ -0,0 +1,86 @@
+//***************************************************************************************
+// D3D12TextureSink.h
+//
+// Makes the mips a TextureStreamer hands it resident in D3D12 textures.  Each upload
+// creates a texture holding just the mips asked for and records copying them into it;
+// once the GPU has finished that copy, the texture's shader resource view is pointed at
+// it and the texture it replaces is released when the frames drawn with it are done.
+//
+// Each texture has two descriptors next to each other in a shader visible heap, and the
+// view is written into whichever the frames still on the GPU are not reading.
+//
+// Until a copy is shown, its texture and upload heap are held beside the texture being
+// drawn, and replaced textures are held until the frames using them are done, so the
+// memory held can be about twice the streamer's budget, which counts only the mips.
+//***************************************************************************************
+
+#pragma once
+
+#include "TextureStreamer.h"
+#include "d3dUtil.h"
+
+class D3D12TextureSink : public TextureUploadSink
+{
+public:
+	explicit D3D12TextureSink(ID3D12Device* device);
+	D3D12TextureSink(const D3D12TextureSink& rhs) = delete;
+	D3D12TextureSink& operator=(const D3D12TextureSink& rhs) = delete;
+
+	///<summary>
+	/// Where texture's two descriptors are, the second descriptorSize after the first.
+	/// Both should already hold a view to draw with until the texture has mips resident.
+	///</summary>
+	void SetDescriptors(std::uint32_t texture, D3D12_CPU_DESCRIPTOR_HANDLE first, UINT descriptorSize);
+
+	// Which of texture's two descriptors to draw with this frame, 0 or 1
+	UINT DescriptorIndex(std::uint32_t texture)const;
+
+	///<summary>
+	/// Called once a frame, before the streamer's Update, with the command list the frame
+	/// records into, the last fence value the GPU has completed and the one the frame will
+	/// signal.  Points views at the textures whose copies have finished and releases what
+	/// the GPU is done with.  MakeResident may only be called after the first Begin.
+	///</summary>
+	void Begin(ID3D12GraphicsCommandList* cmdList, UINT64 completedFence, UINT64 frameFence);
+
+	///<summary>
+	/// Records copying the mips into a new texture.  Returns false, creating nothing, if
+	/// the device will not create it: a block compressed format whose first mip is not
+	/// whole blocks, or a texture it refuses for any other reason.
+	///</summary>
+	bool MakeResident(std::uint32_t texture, const DDSFile& file,
+		const std::vector<DDSFile::Surface>& surfaces, std::uint32_t firstMip) override;
+
+private:
+	struct Slot
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE Descriptors[2] = {};
+		UINT Current = 0;
+
+		// No frame still on the GPU reads the other descriptor once this fence completes
+		UINT64 OtherFreeFence = 0;
+
+		// The texture the view shows, and the one being copied to replace it
+		std::unique_ptr<Texture> Shown;
+		std::unique_ptr<Texture> Pending;
+		UINT64 PendingFence = 0;
+		D3D12_SHADER_RESOURCE_VIEW_DESC PendingView = {};
+	};
+
+	// A texture or upload heap the GPU may still use until Fence completes
+	struct Retired
+	{
+		std::unique_ptr<Texture> Resources;
+		UINT64 Fence = 0;
+	};
+
+	Slot& GetSlot(std::uint32_t texture);
+	void Retire(std::unique_ptr<Texture> resources, UINT64 fence);
+
+	ID3D12Device* mDevice;
+	ID3D12GraphicsCommandList* mCmdList = nullptr;
+	UINT64 mFrameFence = 0;
+
+	std::vector<Slot> mSlots;
+	std::vector<Retired> mRetired;
+};
@@ -0,0 +1,189 @@
+//***************************************************************************************
+// DDSFile.cpp
+//***************************************************************************************
+
+#include "DDSFile.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace DirectX;
+
+namespace
+{
+	// From the DX10 header, as D3D11_RESOURCE_DIMENSION and D3D11_RESOURCE_MISC_FLAG have them
+	const std::uint32_t ResourceDimensionTexture3D = 4;
+	const std::uint32_t ResourceMiscTextureCube = 0x4;
+
+	// The limits Direct3D 12 puts on a texture, as the D3D12_REQ_ constants have them.
+	// The headers are not trusted past these, as CreateTextureFromDDS12 does not trust them.
+	const std::uint32_t MaxMipLevels = 15;
+	const std::uint32_t MaxArraySize = 2048;
+	const std::uint32_t MaxTexture2DSize = 16384;
+	const std::uint32_t MaxTextureCubeSize = 16384;
+	const std::uint32_t MaxTexture3DSize = 2048;
+
+	std::uint32_t NextMip(std::uint32_t size)
+	{
+		return size > 1 ? size / 2 : 1;
+	}
+
+	// The mips down to 1x1 of a texture size across at its largest
+	std::uint32_t FullMipCount(std::uint32_t size)
+	{
+		std::uint32_t mips = 1;
+		while (size > 1)
+		{
+			size /= 2;
+			++mips;
+		}
+		return mips;
+	}
+}
+
+bool DDSFile::Open(const std::wstring& filename)
+{
+	Close();
+
+	if (!mFile.Open(filename) || mFile.Size() > SIZE_MAX)
+	{
+		mFile.Close();
+		return false;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	if (!ReadDDSHeader(mFile.Data(), (size_t)mFile.Size(), &header, &mBitData, &mBitSize))
+	{
+		Close();
+		return false;
+	}
+	mHeader = header;
+
+	mWidth = header->width;
+	mHeight = header->height;
+	mDepth = (header->flags & DDS_HEADER_FLAGS_VOLUME) ? header->depth : 1;
+	mMipCount = header->mipMapCount ? header->mipMapCount : 1;
+	mArraySize = 1;
+
+	if (const DDS_HEADER_DXT10* extension = GetDDSHeaderDXT10(header))
+	{
+		// Checked before the faces are counted, so six of each cannot overflow
+		if (extension->arraySize == 0 || extension->arraySize > MaxArraySize)
+		{
+			Close();
+			return false;
+		}
+
+		mFormat = BitsPerPixel(extension->dxgiFormat) ? extension->dxgiFormat : DXGI_FORMAT_UNKNOWN;
+		mArraySize = extension->arraySize;
+		if (extension->resourceDimension != ResourceDimensionTexture3D)
+			mDepth = 1;
+		if (extension->miscFlag & ResourceMiscTextureCube)
+		{
+			mArraySize *= 6;
+			mIsCubeMap = true;
+		}
+	}
+	else
+	{
+		mFormat = GetDXGIFormat(header->ddspf);
+		if (!(header->flags & DDS_HEADER_FLAGS_VOLUME) && (header->caps2 & DDS_CUBEMAP))
+		{
+			mArraySize = 6;
+			mIsCubeMap = true;
+		}
+	}
+
+	// Palettized formats have bits per pixel but nothing to sample them with
+	switch (mFormat)
+	{
+	case DXGI_FORMAT_AI44:
+	case DXGI_FORMAT_IA44:
+	case DXGI_FORMAT_P8:
+	case DXGI_FORMAT_A8P8:
+		mFormat = DXGI_FORMAT_UNKNOWN;
+		break;
+	default:
+		break;
+	}
+
+	if (!WithinLimits())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool DDSFile::WithinLimits()const
+{
+	if (mWidth == 0 || mHeight == 0 || mDepth == 0 || mArraySize == 0 || mArraySize > MaxArraySize)
+		return false;
+
+	std::uint32_t maxSize = mIsCubeMap ? MaxTextureCubeSize : MaxTexture2DSize;
+	if (mDepth > 1)
+	{
+		if (mArraySize > 1)
+			return false;
+		maxSize = MaxTexture3DSize;
+	}
+	if (mWidth > maxSize || mHeight > maxSize || mDepth > maxSize)
+		return false;
+
+	const std::uint32_t largest = (std::max)((std::max)(mWidth, mHeight), mDepth);
+	return mMipCount <= MaxMipLevels && mMipCount <= FullMipCount(largest);
+}
+
+void DDSFile::Close()
+{
+	mFile.Close();
+	mHeader = nullptr;
+	mBitData = nullptr;
+	mBitSize = 0;
+	mFormat = DXGI_FORMAT_UNKNOWN;
+	mWidth = mHeight = mDepth = 0;
+	mMipCount = mArraySize = 0;
+	mIsCubeMap = false;
+}
+
+bool DDSFile::GetSurfaces(std::vector<Surface>& surfaces)const
+{
+	surfaces.clear();
+	if (!IsOpen() || mFormat == DXGI_FORMAT_UNKNOWN || mArraySize == 0)
+		return false;
+
+	surfaces.reserve((size_t)mMipCount * mArraySize);
+	const std::uint8_t* at = mBitData;
+	size_t remaining = mBitSize;
+	for (std::uint32_t item = 0; item < mArraySize; ++item)
+	{
+		std::uint32_t width = mWidth, height = mHeight, depth = mDepth;
+		for (std::uint32_t mip = 0; mip < mMipCount; ++mip)
+		{
+			size_t numBytes = 0, rowBytes = 0;
+			GetSurfaceInfo(width, height, mFormat, &numBytes, &rowBytes, nullptr);
+
+			// Divided rather than multiplied, so a corrupt size cannot overflow
+			if (numBytes != 0 && remaining / numBytes < depth)
+			{
+				surfaces.clear();
+				return false;
+			}
+
+			Surface surface;
+			surface.Data = at;
+			surface.RowPitch = rowBytes;
+			surface.SlicePitch = numBytes;
+			surface.Width = width;
+			surface.Height = height;
+			surface.Depth = depth;
+			surfaces.push_back(surface);
+
+			at += numBytes * depth;
+			remaining -= numBytes * depth;
+			width = NextMip(width);
+			height = NextMip(height);
+			depth = NextMip(depth);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,83 @@
+//***************************************************************************************
+// DDSFile.h
+//
+// A DDS file mapped into the address space and read in place.  Open checks the header
+// where it lies in the mapping, and GetSurfaces points at each mip of each array item
+// there too, so the pixels are never copied on their way to whoever uploads them and a
+// file is not limited to a size that fits in 32 bits.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+
+class DDSFile
+{
+public:
+	// One mip of one array item or cube face, as it lies in the file
+	struct Surface
+	{
+		const std::uint8_t* Data = nullptr;
+		std::uint64_t RowPitch = 0;
+		std::uint64_t SlicePitch = 0;
+		std::uint32_t Width = 0;
+		std::uint32_t Height = 0;
+		std::uint32_t Depth = 0;
+	};
+
+	DDSFile() = default;
+	DDSFile(const DDSFile& rhs) = delete;
+	DDSFile& operator=(const DDSFile& rhs) = delete;
+
+	///<summary>
+	/// Maps filename and checks its headers, closing any file already open.  Returns false
+	/// if the file cannot be mapped, is not a DDS file, or describes a texture Direct3D 12
+	/// cannot create: no pixels, more mips than its size has, or larger than the limits.
+	///</summary>
+	bool Open(const std::wstring& filename);
+	void Close();
+
+	bool IsOpen()const { return mHeader != nullptr; }
+
+	// The header and the bytes after it, all inside the mapping
+	const DDS_HEADER* Header()const { return mHeader; }
+	const std::uint8_t* BitData()const { return mBitData; }
+	size_t BitSize()const { return mBitSize; }
+
+	// What the headers describe.  Format is DXGI_FORMAT_UNKNOWN for a format the
+	// loaders do not read, and ArraySize counts six faces for each cube.
+	DXGI_FORMAT Format()const { return mFormat; }
+	std::uint32_t Width()const { return mWidth; }
+	std::uint32_t Height()const { return mHeight; }
+	std::uint32_t Depth()const { return mDepth; }
+	std::uint32_t MipCount()const { return mMipCount; }
+	std::uint32_t ArraySize()const { return mArraySize; }
+	bool IsCubeMap()const { return mIsCubeMap; }
+
+	///<summary>
+	/// Points a Surface at every mip of every array item, in Direct3D's subresource order:
+	/// each item's mips from the largest down, then the next item.  Returns false, leaving
+	/// surfaces empty, if the format is unknown or the file ends before the last mip.
+	///</summary>
+	bool GetSurfaces(std::vector<Surface>& surfaces)const;
+
+private:
+	bool WithinLimits()const;
+
+	MappedFile mFile;
+
+	const DDS_HEADER* mHeader = nullptr;
+	const std::uint8_t* mBitData = nullptr;
+	size_t mBitSize = 0;
+
+	DXGI_FORMAT mFormat = DXGI_FORMAT_UNKNOWN;
+	std::uint32_t mWidth = 0;
+	std::uint32_t mHeight = 0;
+	std::uint32_t mDepth = 0;
+	std::uint32_t mMipCount = 0;
+	std::uint32_t mArraySize = 0;
+	bool mIsCubeMap = false;
+};
@@ -0,0 +1,88 @@
+//***************************************************************************************
+// FixedTimestep.cpp
+//***************************************************************************************
+
+#include "FixedTimestep.h"
+#include <cassert>
+
+FixedTimestep::FixedTimestep(double stepsPerSecond, int maxSteps)
+	: mStepSeconds(1.0 / stepsPerSecond), mMaxSteps(maxSteps)
+{
+	assert(stepsPerSecond > 0.0 && maxSteps > 0);
+}
+
+void FixedTimestep::SetRate(double stepsPerSecond)
+{
+	assert(stepsPerSecond > 0.0);
+	mStepSeconds = 1.0 / stepsPerSecond;
+}
+
+void FixedTimestep::SetMaxSteps(int maxSteps)
+{
+	assert(maxSteps > 0);
+	mMaxSteps = maxSteps;
+}
+
+double FixedTimestep::Rate()const
+{
+	return 1.0 / mStepSeconds;
+}
+
+int FixedTimestep::MaxSteps()const
+{
+	return mMaxSteps;
+}
+
+float FixedTimestep::StepSeconds()const
+{
+	return (float)mStepSeconds;
+}
+
+int FixedTimestep::Advance(double frameSeconds)
+{
+	if(frameSeconds > 0.0)
+		mAccumulator += frameSeconds;
+
+	std::uint64_t steps = (std::uint64_t)(mAccumulator / mStepSeconds);
+	mAccumulator -= (double)steps * mStepSeconds;
+
+	// Rounding can leave the remainder a hair outside a step either way
+	if(mAccumulator < 0.0)
+		mAccumulator = 0.0;
+	else if(mAccumulator >= mStepSeconds)
+	{
+		mAccumulator -= mStepSeconds;
+		++steps;
+	}
+
+	if(steps > (std::uint64_t)mMaxSteps)
+	{
+		mDroppedSteps += steps - mMaxSteps;
+		steps = mMaxSteps;
+	}
+
+	mStepCount += steps;
+	return (int)steps;
+}
+
+float FixedTimestep::Alpha()const
+{
+	return (float)(mAccumulator / mStepSeconds);
+}
+
+std::uint64_t FixedTimestep::StepCount()const
+{
+	return mStepCount;
+}
+
+std::uint64_t FixedTimestep::DroppedSteps()const
+{
+	return mDroppedSteps;
+}
+
+void FixedTimestep::Reset()
+{
+	mAccumulator = 0.0;
+	mStepCount = 0;
+	mDroppedSteps = 0;
+}
@@ -0,0 +1,59 @@
+//***************************************************************************************
+// FixedTimestep.h
+//
+// Turns variable frame times into a whole number of fixed simulation steps.  Frame time
+// is banked in an accumulator and spent a step at a time, so the simulation always sees
+// the same dt and gives the same results however fast frames are drawn.  What is left
+// over is how far the frame falls between the last two steps, for interpolating what is
+// drawn.
+//
+// Each frame runs at most MaxSteps steps.  Once the simulation can no longer keep up, the
+// time it could not spend is dropped rather than carried forward, or every slow frame
+// would queue yet more steps for the next one.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+
+class FixedTimestep
+{
+public:
+	explicit FixedTimestep(double stepsPerSecond = 60.0, int maxSteps = 8);
+
+	///<summary>
+	/// Changes how many steps run per second of frame time.  Time already banked is kept.
+	///</summary>
+	void SetRate(double stepsPerSecond);
+	void SetMaxSteps(int maxSteps);
+
+	double Rate()const;
+	int MaxSteps()const;
+
+	// Seconds each step simulates.
+	float StepSeconds()const;
+
+	///<summary>
+	/// Banks frameSeconds and returns how many steps to run this frame.
+	///</summary>
+	int Advance(double frameSeconds);
+
+	// How far past the last step the banked time reaches, in [0, 1) of a step.
+	float Alpha()const;
+
+	// Steps handed out, and steps dropped because a frame would have needed more than
+	// MaxSteps, since the last Reset.
+	std::uint64_t StepCount()const;
+	std::uint64_t DroppedSteps()const;
+
+	// Empties the accumulator and clears the counts.
+	void Reset();
+
+private:
+	double mStepSeconds;
+	double mAccumulator = 0.0;
+	int mMaxSteps;
+
+	std::uint64_t mStepCount = 0;
+	std::uint64_t mDroppedSteps = 0;
+};
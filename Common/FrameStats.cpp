@@ -0,0 +1,153 @@
+//***************************************************************************************
+// FrameStats.cpp
+//***************************************************************************************
+
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+FrameStats::FrameStats()
+{
+	Clear();
+}
+
+void FrameStats::AddFrame(float updateMs, float recordMs, float presentMs)
+{
+	const float frame[TimingCount] = { updateMs, recordMs, presentMs };
+	for(int t = 0; t < TimingCount; ++t)
+	{
+		// Take the frame falling out of the window back out of the running totals
+		if(mCount == WindowSize)
+		{
+			float oldest = mFrames[t][mNext];
+			--mHistograms[t][BucketOf(oldest)];
+			mSums[t] -= oldest;
+		}
+
+		mFrames[t][mNext] = frame[t];
+		++mHistograms[t][BucketOf(frame[t])];
+		mSums[t] += frame[t];
+	}
+
+	mNext = (mNext + 1) % WindowSize;
+	if(mCount < WindowSize)
+		++mCount;
+	++mTotalFrames;
+}
+
+size_t FrameStats::Count()const
+{
+	return mCount;
+}
+
+std::uint64_t FrameStats::TotalFrames()const
+{
+	return mTotalFrames;
+}
+
+FrameStats::Summary FrameStats::Summarize(Timing timing)const
+{
+	Summary summary;
+	summary.Count = mCount;
+	if(mCount == 0)
+		return summary;
+
+	// Only the order of the window matters, so the copy can start anywhere in the ring
+	float* frames = mScratch.data();
+	std::copy(mFrames[timing].begin(), mFrames[timing].begin() + mCount, frames);
+
+	// Each selection leaves everything above it to the right, so the next only has to
+	// look past it
+	auto rank = [&](double p) { return std::min((size_t)(p * mCount), mCount - 1); };
+	size_t p50 = rank(0.50), p95 = rank(0.95), p99 = rank(0.99);
+
+	std::nth_element(frames, frames + p50, frames + mCount);
+	if(p95 > p50)
+		std::nth_element(frames + p50 + 1, frames + p95, frames + mCount);
+	if(p99 > p95)
+		std::nth_element(frames + p95 + 1, frames + p99, frames + mCount);
+
+	summary.Mean = (float)(mSums[timing] / mCount);
+	summary.P50 = frames[p50];
+	summary.P95 = frames[p95];
+	summary.P99 = frames[p99];
+	summary.Max = *std::max_element(frames + p99, frames + mCount);
+	return summary;
+}
+
+const std::array<std::uint32_t, FrameStats::BucketCount>& FrameStats::Histogram(Timing timing)const
+{
+	return mHistograms[timing];
+}
+
+float FrameStats::BucketLowerMs(int bucket)
+{
+	return bucket == 0 ? 0.0f : MinBucketMs * std::exp2((float)bucket / BucketsPerOctave);
+}
+
+int FrameStats::BucketOf(float ms)
+{
+	if(!(ms > MinBucketMs))
+		return 0;
+
+	int bucket = (int)std::floor(std::log2(ms / MinBucketMs) * BucketsPerOctave);
+	return std::min(bucket, BucketCount - 1);
+}
+
+const char* FrameStats::TimingName(Timing timing)
+{
+	switch(timing)
+	{
+	case Update: return "update";
+	case Record: return "record";
+	default: return "present";
+	}
+}
+
+void FrameStats::WriteCsv(std::ostream& out)const
+{
+	out << "frame,update_ms,record_ms,present_ms\n";
+
+	size_t oldest = mCount == WindowSize ? mNext : 0;
+	std::uint64_t firstFrame = mTotalFrames - mCount;
+	for(size_t i = 0; i < mCount; ++i)
+	{
+		size_t slot = (oldest + i) % WindowSize;
+		out << firstFrame + i << ',' << mFrames[Update][slot] << ','
+			<< mFrames[Record][slot] << ',' << mFrames[Present][slot] << '\n';
+	}
+}
+
+void FrameStats::WriteJson(std::ostream& out)const
+{
+	out << "{\n  \"frames\": " << mCount << ",\n  \"totalFrames\": " << mTotalFrames << ",\n  \"timings\": {";
+	for(int t = 0; t < TimingCount; ++t)
+	{
+		Summary s = Summarize((Timing)t);
+		out << (t ? ",\n" : "\n") << "    \"" << TimingName((Timing)t) << "\": {\n"
+			<< "      \"meanMs\": " << s.Mean << ", \"p50Ms\": " << s.P50 << ", \"p95Ms\": " << s.P95
+			<< ", \"p99Ms\": " << s.P99 << ", \"maxMs\": " << s.Max << ",\n"
+			<< "      \"histogram\": [";
+
+		bool first = true;
+		for(int b = 0; b < BucketCount; ++b)
+		{
+			if(mHistograms[t][b] == 0)
+				continue;
+			out << (first ? "" : ", ") << "{ \"fromMs\": " << BucketLowerMs(b) << ", \"count\": " << mHistograms[t][b] << " }";
+			first = false;
+		}
+		out << "]\n    }";
+	}
+	out << "\n  }\n}\n";
+}
+
+void FrameStats::Clear()
+{
+	for(auto& histogram : mHistograms)
+		histogram.fill(0);
+	mSums.fill(0.0);
+	mNext = 0;
+	mCount = 0;
+	mTotalFrames = 0;
+}
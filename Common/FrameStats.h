@@ -0,0 +1,98 @@
+//***************************************************************************************
+// FrameStats.h
+//
+// Rolling window of per-frame timings: CPU time spent updating, time spent recording and
+// submitting the frame, and the time from one present to the next.  Percentiles and the
+// worst frame show the stutter an average frame rate hides.  Each timing also keeps a
+// histogram with logarithmic buckets, a quarter of an octave wide, so short and long
+// frames are both resolved.
+//
+// Nothing allocates after construction, so stats can be taken every frame.
+//***************************************************************************************
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+class FrameStats
+{
+public:
+	enum Timing
+	{
+		Update,
+		Record,
+		Present,
+		TimingCount
+	};
+
+	// Frames in the rolling window.
+	static const size_t WindowSize = 1024;
+
+	// Histogram buckets run from MinBucketMs up, BucketsPerOctave to each doubling.  The
+	// first bucket also holds anything shorter and the last anything longer.
+	static const int BucketCount = 48;
+	static const int BucketsPerOctave = 4;
+	static constexpr float MinBucketMs = 0.125f;
+
+	struct Summary
+	{
+		size_t Count = 0;
+		float Mean = 0.0f;
+		float P50 = 0.0f;
+		float P95 = 0.0f;
+		float P99 = 0.0f;
+		float Max = 0.0f;
+	};
+
+	FrameStats();
+
+	///<summary>
+	/// Adds a frame's timings, in milliseconds, dropping the oldest frame once the window
+	/// is full.
+	///</summary>
+	void AddFrame(float updateMs, float recordMs, float presentMs);
+
+	// Frames in the window, and frames added since the last Clear.
+	size_t Count()const;
+	std::uint64_t TotalFrames()const;
+
+	///<summary>
+	/// Mean, percentiles and worst of one timing over the window.  Percentiles are taken
+	/// from the sorted frames, without interpolating between them.
+	///</summary>
+	Summary Summarize(Timing timing)const;
+
+	// Frames in the window that fall in each histogram bucket, and where a bucket starts.
+	const std::array<std::uint32_t, BucketCount>& Histogram(Timing timing)const;
+	static float BucketLowerMs(int bucket);
+	static int BucketOf(float ms);
+
+	static const char* TimingName(Timing timing);
+
+	///<summary>
+	/// One row per frame in the window, oldest first.
+	///</summary>
+	void WriteCsv(std::ostream& out)const;
+
+	///<summary>
+	/// The summary and non-empty histogram buckets of every timing.
+	///</summary>
+	void WriteJson(std::ostream& out)const;
+
+	void Clear();
+
+private:
+	// Frame timings, the oldest at mNext once the window has filled
+	std::array<std::array<float, WindowSize>, TimingCount> mFrames;
+	std::array<std::array<std::uint32_t, BucketCount>, TimingCount> mHistograms;
+	std::array<double, TimingCount> mSums;
+	size_t mNext = 0;
+	size_t mCount = 0;
+	std::uint64_t mTotalFrames = 0;
+
+	// Room to sort a copy of the window in for the percentiles
+	mutable std::array<float, WindowSize> mScratch;
+};
@@ -0,0 +1,66 @@
+//***************************************************************************************
+// FrameTimeRing.cpp
+//***************************************************************************************
+
+#include "FrameTimeRing.h"
+#include <algorithm>
+
+static_assert((FrameTimeRing::Capacity & (FrameTimeRing::Capacity - 1)) == 0, "Capacity must be a power of two");
+
+FrameTimeRing::FrameTimeRing()
+	: mCount(0), mClaimed(0)
+{
+	for(auto& sample : mSamples)
+		sample.store(0.0f, std::memory_order_relaxed);
+}
+
+void FrameTimeRing::Push(float seconds)
+{
+	// Claim the slot before overwriting it, so a reader that sees the new sample also sees
+	// that the frame it used to hold is gone.  Then publish it.
+	std::uint64_t count = mCount.load(std::memory_order_relaxed);
+	mClaimed.store(count + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	mSamples[count & (Capacity - 1)].store(seconds, std::memory_order_relaxed);
+	mCount.store(count + 1, std::memory_order_release);
+}
+
+std::uint64_t FrameTimeRing::Count()const
+{
+	return mCount.load(std::memory_order_acquire);
+}
+
+size_t FrameTimeRing::Latest(float* out, size_t maxCount, std::uint64_t* firstIndex)const
+{
+	std::uint64_t end = mCount.load(std::memory_order_acquire);
+	std::uint64_t available = std::min<std::uint64_t>(end, Capacity);
+	size_t count = (size_t)std::min<std::uint64_t>(available, maxCount);
+	std::uint64_t begin = end - count;
+
+	for(size_t i = 0; i < count; ++i)
+		out[i] = mSamples[(begin + i) & (Capacity - 1)].load(std::memory_order_relaxed);
+
+	// Any slot the writer has claimed again since we started may hold a newer frame.
+	// Those are the oldest ones copied, so drop them from the front.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	std::uint64_t claimed = mClaimed.load(std::memory_order_relaxed);
+	std::uint64_t firstValid = claimed > Capacity ? claimed - Capacity : 0;
+	if(firstValid > begin)
+	{
+		size_t overwritten = (size_t)std::min<std::uint64_t>(firstValid - begin, count);
+		std::copy(out + overwritten, out + count, out);
+		count -= overwritten;
+		begin += overwritten;
+	}
+
+	if(firstIndex != nullptr)
+		*firstIndex = begin;
+	return count;
+}
+
+void FrameTimeRing::Clear()
+{
+	mClaimed.store(0, std::memory_order_relaxed);
+	mCount.store(0, std::memory_order_release);
+}
@@ -0,0 +1,54 @@
+//***************************************************************************************
+// FrameTimeRing.h
+//
+// Keeps the most recent frame times in a fixed ring.  One thread, the one ticking the
+// timer, pushes; any number of others may copy out the latest samples at the same time
+// without locks.  A reader that is overtaken part way through a copy drops the samples
+// that were overwritten, so what it gets back is always a run of consecutive frames.
+//***************************************************************************************
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class FrameTimeRing
+{
+public:
+	// Must be a power of two.
+	static const size_t Capacity = 4096;
+
+	FrameTimeRing();
+
+	FrameTimeRing(const FrameTimeRing& rhs) = delete;
+	FrameTimeRing& operator=(const FrameTimeRing& rhs) = delete;
+
+	///<summary>
+	/// Records one frame time, overwriting the oldest once the ring is full.  Only one
+	/// thread may push.
+	///</summary>
+	void Push(float seconds);
+
+	// Frames pushed since the last Clear, including those since overwritten.
+	std::uint64_t Count()const;
+
+	///<summary>
+	/// Copies up to maxCount of the most recent frame times into out, oldest first, and
+	/// returns how many were copied.  Safe to call from any thread while frames are pushed.
+	/// If firstIndex is given it receives the Count() the first copied frame was pushed at.
+	///</summary>
+	size_t Latest(float* out, size_t maxCount, std::uint64_t* firstIndex = nullptr)const;
+
+	// Forgets every frame.  Only the pushing thread may clear.
+	void Clear();
+
+private:
+	std::array<std::atomic<float>, Capacity> mSamples;
+
+	// Frames published, and frames whose slot the writer has started on.  They only differ
+	// while a push is part way through.
+	std::atomic<std::uint64_t> mCount;
+	std::atomic<std::uint64_t> mClaimed;
+};
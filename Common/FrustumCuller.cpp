@@ -0,0 +1,194 @@
+//***************************************************************************************
+// FrustumCuller.cpp
+//***************************************************************************************
+
+#include "FrustumCuller.h"
+#include <algorithm>
+
+using namespace DirectX;
+
+FrustumPlanes FrustumPlanes::FromMatrix(FXMMATRIX viewProj)
+{
+	// With row vectors the clip coordinates are dot products with the columns of the
+	// matrix, which are the rows of its transpose.
+	XMMATRIX columns = XMMatrixTranspose(viewProj);
+
+	XMVECTOR planes[Count];
+	planes[Left] = XMVectorAdd(columns.r[3], columns.r[0]);
+	planes[Right] = XMVectorSubtract(columns.r[3], columns.r[0]);
+	planes[Bottom] = XMVectorAdd(columns.r[3], columns.r[1]);
+	planes[Top] = XMVectorSubtract(columns.r[3], columns.r[1]);
+	planes[Near] = columns.r[2];
+	planes[Far] = XMVectorSubtract(columns.r[3], columns.r[2]);
+
+	FrustumPlanes frustum;
+	for(int i = 0; i < Count; ++i)
+		XMStoreFloat4(&frustum.Planes[i], XMPlaneNormalize(planes[i]));
+
+	return frustum;
+}
+
+namespace
+{
+	struct Volumes
+	{
+		const float* CenterX;
+		const float* CenterY;
+		const float* CenterZ;
+		const float* ExtentX;
+		const float* ExtentY;
+		const float* ExtentZ;
+		const float* Radius;
+		size_t Count;
+	};
+
+	XMVECTOR LoadGroup(const float* values, size_t i)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values + i));
+	}
+
+	// Tests four volumes against each plane per iteration.  A volume is outside a plane
+	// when its centre is further behind it than the volume reaches: the radius for a
+	// sphere, or the extents projected onto the plane normal for a box.
+	template<bool Spheres>
+	size_t Cull(const Volumes& volumes, const FrustumPlanes& frustum, std::uint32_t* visible)
+	{
+		XMVECTOR nx[FrustumPlanes::Count], ny[FrustumPlanes::Count], nz[FrustumPlanes::Count], d[FrustumPlanes::Count];
+		XMVECTOR ax[FrustumPlanes::Count], ay[FrustumPlanes::Count], az[FrustumPlanes::Count];
+		for(int p = 0; p < FrustumPlanes::Count; ++p)
+		{
+			XMVECTOR plane = XMLoadFloat4(&frustum.Planes[p]);
+			nx[p] = XMVectorSplatX(plane);
+			ny[p] = XMVectorSplatY(plane);
+			nz[p] = XMVectorSplatZ(plane);
+			d[p] = XMVectorSplatW(plane);
+			ax[p] = XMVectorAbs(nx[p]);
+			ay[p] = XMVectorAbs(ny[p]);
+			az[p] = XMVectorAbs(nz[p]);
+		}
+
+		const XMVECTOR zero = XMVectorZero();
+
+		size_t count = 0;
+		for(size_t i = 0; i < volumes.Count; i += 4)
+		{
+			XMVECTOR cx = LoadGroup(volumes.CenterX, i);
+			XMVECTOR cy = LoadGroup(volumes.CenterY, i);
+			XMVECTOR cz = LoadGroup(volumes.CenterZ, i);
+
+			XMVECTOR ex = zero, ey = zero, ez = zero, r = zero;
+			if(Spheres)
+			{
+				r = LoadGroup(volumes.Radius, i);
+			}
+			else
+			{
+				ex = LoadGroup(volumes.ExtentX, i);
+				ey = LoadGroup(volumes.ExtentY, i);
+				ez = LoadGroup(volumes.ExtentZ, i);
+			}
+
+			XMVECTOR outside = XMVectorFalseInt();
+			for(int p = 0; p < FrustumPlanes::Count; ++p)
+			{
+				XMVECTOR dist = XMVectorMultiplyAdd(nx[p], cx,
+					XMVectorMultiplyAdd(ny[p], cy, XMVectorMultiplyAdd(nz[p], cz, d[p])));
+
+				XMVECTOR reach = Spheres ? r : XMVectorMultiplyAdd(ax[p], ex,
+					XMVectorMultiplyAdd(ay[p], ey, XMVectorMultiply(az[p], ez)));
+
+				outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(dist, reach), zero));
+			}
+
+			std::uint32_t mask[4];
+			XMStoreInt4(mask, outside);
+
+			// Always write the index, but only move past it if it is visible, so the
+			// compaction does not branch on the result.
+			const size_t lanes = (std::min)(volumes.Count - i, size_t(4));
+			for(size_t k = 0; k < lanes; ++k)
+			{
+				visible[count] = static_cast<std::uint32_t>(i + k);
+				count += (mask[k] == 0);
+			}
+		}
+
+		return count;
+	}
+}
+
+void FrustumCuller::Clear()
+{
+	Resize(0);
+}
+
+void FrustumCuller::Reserve(size_t count)
+{
+	const size_t padded = (count + 3) & ~size_t(3);
+	for(auto* values : { &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ, &mRadius })
+		values->reserve(padded);
+}
+
+size_t FrustumCuller::Size()const
+{
+	return mCount;
+}
+
+void FrustumCuller::Resize(size_t count)
+{
+	const size_t padded = (count + 3) & ~size_t(3);
+	for(auto* values : { &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ, &mRadius })
+		values->resize(padded, 0.0f);
+
+	mCount = count;
+}
+
+void FrustumCuller::Add(const BoundingBox& box)
+{
+	Resize(mCount + 1);
+	Set(mCount - 1, box);
+}
+
+void FrustumCuller::Add(const BoundingSphere& sphere)
+{
+	Resize(mCount + 1);
+	Set(mCount - 1, sphere);
+}
+
+void FrustumCuller::Set(size_t i, const BoundingBox& box)
+{
+	mCenterX[i] = box.Center.x;
+	mCenterY[i] = box.Center.y;
+	mCenterZ[i] = box.Center.z;
+	mExtentX[i] = box.Extents.x;
+	mExtentY[i] = box.Extents.y;
+	mExtentZ[i] = box.Extents.z;
+	mRadius[i] = XMVectorGetX(XMVector3Length(XMLoadFloat3(&box.Extents)));
+}
+
+void FrustumCuller::Set(size_t i, const BoundingSphere& sphere)
+{
+	mCenterX[i] = sphere.Center.x;
+	mCenterY[i] = sphere.Center.y;
+	mCenterZ[i] = sphere.Center.z;
+	mExtentX[i] = sphere.Radius;
+	mExtentY[i] = sphere.Radius;
+	mExtentZ[i] = sphere.Radius;
+	mRadius[i] = sphere.Radius;
+}
+
+size_t FrustumCuller::CullBoxes(const FrustumPlanes& frustum, std::uint32_t* visible)const
+{
+	Volumes volumes = { mCenterX.data(), mCenterY.data(), mCenterZ.data(),
+		mExtentX.data(), mExtentY.data(), mExtentZ.data(), mRadius.data(), mCount };
+
+	return Cull<false>(volumes, frustum, visible);
+}
+
+size_t FrustumCuller::CullSpheres(const FrustumPlanes& frustum, std::uint32_t* visible)const
+{
+	Volumes volumes = { mCenterX.data(), mCenterY.data(), mCenterZ.data(),
+		mExtentX.data(), mExtentY.data(), mExtentZ.data(), mRadius.data(), mCount };
+
+	return Cull<true>(volumes, frustum, visible);
+}
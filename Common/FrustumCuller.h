@@ -0,0 +1,74 @@
+//***************************************************************************************
+// FrustumCuller.h
+//
+// Frustum planes pulled out of a view-projection matrix, and a culler that keeps the
+// bounds of many objects in structure-of-arrays form so each SIMD iteration tests four
+// objects against a plane at once.  Culling writes the indices of the objects that may
+// be visible into a packed list, in the order the objects were added.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FrustumPlanes
+{
+	enum { Left, Right, Bottom, Top, Near, Far, Count };
+
+	// (a, b, c, d) with unit length normals pointing into the frustum, so a point p is
+	// inside every plane when a*p.x + b*p.y + c*p.z + d >= 0.
+	DirectX::XMFLOAT4 Planes[Count];
+
+	///<summary>
+	/// Extracts the planes a matrix maps onto the D3D clip volume (-w <= x,y <= w,
+	/// 0 <= z <= w).  The planes are in whatever space the matrix transforms from, so a
+	/// view-projection matrix gives world space planes.
+	///</summary>
+	static FrustumPlanes FromMatrix(DirectX::FXMMATRIX viewProj);
+};
+
+class FrustumCuller
+{
+public:
+	void Clear();
+	void Reserve(size_t count);
+	size_t Size()const;
+
+	// Sets the number of objects.  Objects added this way have empty bounds at the origin
+	// until they are Set.
+	void Resize(size_t count);
+
+	///<summary>
+	/// Adds an object, or replaces the bounds of object i.  Either kind of volume can be
+	/// culled as a box or as a sphere; the other volume is taken to be the smallest box or
+	/// sphere that holds the one given.
+	///</summary>
+	void Add(const DirectX::BoundingBox& box);
+	void Add(const DirectX::BoundingSphere& sphere);
+	void Set(size_t i, const DirectX::BoundingBox& box);
+	void Set(size_t i, const DirectX::BoundingSphere& sphere);
+
+	///<summary>
+	/// Writes the index of every object whose box (or sphere) is not completely outside
+	/// one of the planes to visible, which must have room for Size() entries.  Returns
+	/// the number written.  Objects near a corner of the frustum can be kept even though
+	/// they are outside it, but nothing that is inside is ever dropped.
+	///</summary>
+	size_t CullBoxes(const FrustumPlanes& frustum, std::uint32_t* visible)const;
+	size_t CullSpheres(const FrustumPlanes& frustum, std::uint32_t* visible)const;
+
+private:
+	// Each array is padded to a multiple of four so the last group loads whole vectors.
+	std::vector<float> mCenterX;
+	std::vector<float> mCenterY;
+	std::vector<float> mCenterZ;
+	std::vector<float> mExtentX;
+	std::vector<float> mExtentY;
+	std::vector<float> mExtentZ;
+	std::vector<float> mRadius;
+	size_t mCount = 0;
+};
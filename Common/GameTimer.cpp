@@ -2,16 +2,45 @@
 // GameTimer.cpp by Frank Luna (C) 2011 All Rights Reserved.
 //***************************************************************************************
 
-#include <windows.h>
 #include "GameTimer.h"
+#include <chrono>
+
+namespace
+{
+	// steady_clock never goes backwards.  It reads QueryPerformanceCounter on Windows and
+	// clock_gettime(CLOCK_MONOTONIC) on Linux.
+	class SteadyClock : public GameTimer::Clock
+	{
+	public:
+		std::int64_t Now()const override
+		{
+			return std::chrono::steady_clock::now().time_since_epoch().count();
+		}
+
+		std::int64_t TicksPerSecond()const override
+		{
+			using Period = std::chrono::steady_clock::period;
+			return Period::den / Period::num;
+		}
+	};
+}
+
+const GameTimer::Clock& GameTimer::SystemClock()
+{
+	static SteadyClock clock;
+	return clock;
+}
 
 GameTimer::GameTimer()
-: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
-  mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+: GameTimer(SystemClock())
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+}
+
+GameTimer::GameTimer(const Clock& clock)
+: mClock(&clock), mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
+  mPausedTime(0), mStopTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+{
+	mSecondsPerCount = 1.0 / (double)mClock->TicksPerSecond();
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -55,19 +84,20 @@ float GameTimer::DeltaTime()const
 
 void GameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = mClock->Now();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
+	mPausedTime = 0;
 	mStopTime = 0;
 	mStopped  = false;
+
+	mDeltaHistory.Clear();
 }
 
 void GameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	std::int64_t startTime = mClock->Now();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -90,8 +120,7 @@ void GameTimer::Stop()
 {
 	if( !mStopped )
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+		std::int64_t currTime = mClock->Now();
 
 		mStopTime = currTime;
 		mStopped  = true;
@@ -106,8 +135,7 @@ void GameTimer::Tick()
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = mClock->Now();
 	mCurrTime = currTime;
 
 	// Time difference between this frame and the previous.
@@ -123,5 +151,37 @@ void GameTimer::Tick()
 	{
 		mDeltaTime = 0.0;
 	}
+
+	mDeltaHistory.Push((float)mDeltaTime);
+}
+
+const FrameTimeRing& GameTimer::DeltaHistory()const
+{
+	return mDeltaHistory;
+}
+
+ManualClock::ManualClock(std::int64_t ticksPerSecond)
+: mTicksPerSecond(ticksPerSecond)
+{
+}
+
+std::int64_t ManualClock::Now()const
+{
+	return mNow;
+}
+
+std::int64_t ManualClock::TicksPerSecond()const
+{
+	return mTicksPerSecond;
+}
+
+void ManualClock::Advance(double seconds)
+{
+	mNow += (std::int64_t)(seconds * (double)mTicksPerSecond + 0.5);
+}
+
+void ManualClock::AdvanceTicks(std::int64_t ticks)
+{
+	mNow += ticks;
 }
 
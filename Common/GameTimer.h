@@ -5,11 +5,29 @@
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <cstdint>
+#include "FrameTimeRing.h"
+
 class GameTimer
 {
 public:
+	// Where a timer reads the time from.  Ticks only have to increase monotonically.
+	class Clock
+	{
+	public:
+		virtual ~Clock() = default;
+		virtual std::int64_t Now()const = 0;
+		virtual std::int64_t TicksPerSecond()const = 0;
+	};
+
+	// The system's monotonic clock, which every timer uses unless given another.
+	static const Clock& SystemClock();
+
 	GameTimer();
 
+	// Uses clock, which must outlive the timer, in place of the system clock.
+	explicit GameTimer(const Clock& clock);
+
 	float TotalTime()const; // in seconds
 	float DeltaTime()const; // in seconds
 
@@ -18,17 +36,42 @@ public:
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	// Every DeltaTime since Reset, newest last.  Other threads may read it while the
+	// timer ticks.
+	const FrameTimeRing& DeltaHistory()const;
+
 private:
+	const Clock* mClock;
 	double mSecondsPerCount;
 	double mDeltaTime;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	std::int64_t mBaseTime;
+	std::int64_t mPausedTime;
+	std::int64_t mStopTime;
+	std::int64_t mPrevTime;
+	std::int64_t mCurrTime;
 
 	bool mStopped;
+
+	FrameTimeRing mDeltaHistory;
+};
+
+// A clock that only moves when told to, for driving a GameTimer through exactly the
+// frame times a test wants.
+class ManualClock : public GameTimer::Clock
+{
+public:
+	explicit ManualClock(std::int64_t ticksPerSecond = 1000000000);
+
+	std::int64_t Now()const override;
+	std::int64_t TicksPerSecond()const override;
+
+	void Advance(double seconds);
+	void AdvanceTicks(std::int64_t ticks);
+
+private:
+	std::int64_t mNow = 0;
+	std::int64_t mTicksPerSecond;
 };
 
-#endif // GAMETIMER_H
\ No newline at end of file
+#endif // GAMETIMER_H
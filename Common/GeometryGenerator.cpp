@@ -100,6 +100,159 @@ GeometryGenerator::MeshData GeometryGenerator::CreateBox(float width, float heig
     return meshData;
 }
 
+GeometryGenerator::MeshData GeometryGenerator::CreateCubie(float size, float bevelRadius, uint32 bevelSegments,
+	uint32 numSubdivisions, FaceRange faceRanges[CubieFaceCount])
+{
+	MeshData meshData;
+
+	float h = 0.5f*size;
+
+	// Keep some flat area on every face so the grid never folds over itself.
+	float r = std::max(0.0f, std::min(bevelRadius, 0.9f*h));
+	if(bevelSegments == 0)
+		r = 0.0f;
+	if(r == 0.0f)
+		bevelSegments = 0;
+
+	numSubdivisions = std::max(numSubdivisions, 1u);
+
+	// Half extent of the box the rounded surface is offset from.
+	float inner = h - r;
+
+	//
+	// Grid coordinates along either axis of a face.  Each face covers its own half of
+	// every bevel, up to the 45 degree line where it meets the next face.  The bevel rows
+	// are spaced so that, once pushed out onto the rounded surface, they sweep out equal
+	// angles.
+	//
+
+	std::vector<float> coords;
+	for(uint32 i = 0; i < bevelSegments; ++i)
+	{
+		float theta = 0.25f*XM_PI*(1.0f - (float)i/bevelSegments);
+		coords.push_back(-inner - r*tanf(theta));
+	}
+	for(uint32 i = 0; i <= numSubdivisions; ++i)
+	{
+		coords.push_back(-inner + 2.0f*inner*i/numSubdivisions);
+	}
+	for(uint32 i = bevelSegments; i-- > 0; )
+	{
+		float theta = 0.25f*XM_PI*(1.0f - (float)i/bevelSegments);
+		coords.push_back(inner + r*tanf(theta));
+	}
+
+	//
+	// Face frames.  U and V run along the face in the directions its atlas tile's u and v
+	// increase, matching CreateBox(), and uv0 is the top left corner of the tile.
+	//
+
+	struct FaceFrame
+	{
+		XMFLOAT3 N;
+		XMFLOAT3 U;
+		XMFLOAT3 V;
+		XMFLOAT2 uv0;
+	};
+
+	const FaceFrame frames[CubieFaceCount] =
+	{
+		{ XMFLOAT3(0.0f, 0.0f, -1.0f), XMFLOAT3(1.0f, 0.0f, 0.0f),  XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT2(0.5f, 0.0f) },   // front, green
+		{ XMFLOAT3(0.0f, 0.0f, 1.0f),  XMFLOAT3(0.0f, 1.0f, 0.0f),  XMFLOAT3(-1.0f, 0.0f, 0.0f), XMFLOAT2(0.25f, 0.25f) }, // back, yellow
+		{ XMFLOAT3(0.0f, 1.0f, 0.0f),  XMFLOAT3(1.0f, 0.0f, 0.0f),  XMFLOAT3(0.0f, 0.0f, -1.0f), XMFLOAT2(0.0f, 0.25f) },  // top, white
+		{ XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f),  XMFLOAT3(-1.0f, 0.0f, 0.0f), XMFLOAT2(0.25f, 0.0f) },  // bottom, blue
+		{ XMFLOAT3(-1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, -1.0f), XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT2(0.75f, 0.0f) },  // left, orange
+		{ XMFLOAT3(1.0f, 0.0f, 0.0f),  XMFLOAT3(0.0f, 0.0f, 1.0f),  XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) }    // right, red
+	};
+
+	XMVECTOR innerMin = XMVectorReplicate(-inner);
+	XMVECTOR innerMax = XMVectorReplicate(inner);
+
+	uint32 n = (uint32)coords.size();
+	for(uint32 f = 0; f < CubieFaceCount; ++f)
+	{
+		const FaceFrame& frame = frames[f];
+		XMVECTOR N = XMLoadFloat3(&frame.N);
+		XMVECTOR U = XMLoadFloat3(&frame.U);
+		XMVECTOR V = XMLoadFloat3(&frame.V);
+
+		uint32 baseIndex = (uint32)meshData.Vertices.size();
+		faceRanges[f].BaseVertex = baseIndex;
+		faceRanges[f].VertexCount = n*n;
+		faceRanges[f].StartIndex = (uint32)meshData.Indices32.size();
+		faceRanges[f].IndexCount = (n-1)*(n-1)*6;
+
+		for(uint32 j = 0; j < n; ++j)
+		{
+			for(uint32 i = 0; i < n; ++i)
+			{
+				XMVECTOR p = h*N + coords[i]*U + coords[j]*V;
+
+				// Push the point out to distance r from the nearest point on the inner box.
+				// On the flat part of the face that nearest point is straight below it, so
+				// only the bevel rows actually move.
+				XMVECTOR q = XMVectorClamp(p, innerMin, innerMax);
+				XMVECTOR d = p - q;
+				XMVECTOR normal = N;
+				if(XMVectorGetX(XMVector3LengthSq(d)) > 0.0f)
+				{
+					normal = XMVector3Normalize(d);
+					p = q + r*normal;
+				}
+
+				// Keep the tangent running along U, bent to stay perpendicular to the normal.
+				XMVECTOR tangent = XMVector3Normalize(U - XMVector3Dot(U, normal)*normal);
+
+				Vertex v;
+				XMStoreFloat3(&v.Position, p);
+				XMStoreFloat3(&v.Normal, normal);
+				XMStoreFloat3(&v.TangentU, tangent);
+				v.TexC.x = frame.uv0.x + 0.25f*(coords[i] + h)/size;
+				v.TexC.y = frame.uv0.y + 0.25f*(coords[j] + h)/size;
+
+				meshData.Vertices.push_back(v);
+			}
+		}
+
+		// Wind the triangles so they face along N.
+		bool uvFacesOut = XMVectorGetX(XMVector3Dot(XMVector3Cross(U, V), N)) > 0.0f;
+
+		for(uint32 j = 0; j < n-1; ++j)
+		{
+			for(uint32 i = 0; i < n-1; ++i)
+			{
+				uint32 a = baseIndex + j*n + i;
+				uint32 b = a + 1;
+				uint32 c = a + n + 1;
+				uint32 d = a + n;
+
+				if(uvFacesOut)
+				{
+					meshData.Indices32.push_back(a);
+					meshData.Indices32.push_back(b);
+					meshData.Indices32.push_back(c);
+
+					meshData.Indices32.push_back(a);
+					meshData.Indices32.push_back(c);
+					meshData.Indices32.push_back(d);
+				}
+				else
+				{
+					meshData.Indices32.push_back(a);
+					meshData.Indices32.push_back(c);
+					meshData.Indices32.push_back(b);
+
+					meshData.Indices32.push_back(a);
+					meshData.Indices32.push_back(d);
+					meshData.Indices32.push_back(c);
+				}
+			}
+		}
+	}
+
+	return meshData;
+}
+
 GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount)
 {
     MeshData meshData;
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "MemoryTracker.h"
 #include <cstdint>
 #include <DirectXMath.h>
 #include <vector>
@@ -53,12 +54,15 @@ public:
         DirectX::XMFLOAT2 TexC;
 	};
 
+	// The 16 bit copy MeshData makes of its indices, counted as a copy of geometry
+	using Indices16 = std::vector<uint16, MemoryTracker::Allocator<uint16, MemoryTracker::GeometryCopies>>;
+
 	struct MeshData
 	{
 		std::vector<Vertex> Vertices;
         std::vector<uint32> Indices32;
 
-        std::vector<uint16>& GetIndices16()
+        Indices16& GetIndices16()
         {
 			if(mIndices16.empty())
 			{
@@ -71,7 +75,30 @@ public:
         }
 
 	private:
-		std::vector<uint16> mIndices16;
+		Indices16 mIndices16;
+	};
+
+	// Faces of a cubie, in the same order and with the same texture atlas tiles as
+	// the faces CreateBox() emits.
+	enum CubieFace
+	{
+		CubieFront = 0, // -z
+		CubieBack,      // +z
+		CubieTop,       // +y
+		CubieBottom,    // -y
+		CubieLeft,      // -x
+		CubieRight,     // +x
+		CubieFaceCount
+	};
+
+	// The vertices and indices one face of a cubie occupies in its MeshData.  Indices are
+	// stored relative to the whole mesh, not to BaseVertex.
+	struct FaceRange
+	{
+		uint32 BaseVertex = 0;
+		uint32 VertexCount = 0;
+		uint32 StartIndex = 0;
+		uint32 IndexCount = 0;
 	};
 
 	///<summary>
@@ -80,6 +107,17 @@ public:
 	///</summary>
     MeshData CreateBox(float width, float height, float depth, uint32 numSubdivisions);
 
+	///<summary>
+	/// Creates a cube centered at the origin whose edges and corners are rounded off with
+	/// the given radius.  bevelSegments controls the tessellation of each rounded edge and
+	/// numSubdivisions that of the flat part of each face.  Each face, together with its
+	/// half of the neighbouring bevels, is emitted as its own block of vertices and indices
+	/// in CubieFace order, and faceRanges receives where each block lives, so a renderer
+	/// can leave out the faces hidden inside a puzzle.
+	///</summary>
+	MeshData CreateCubie(float size, float bevelRadius, uint32 bevelSegments, uint32 numSubdivisions,
+		FaceRange faceRanges[CubieFaceCount]);
+
 	///<summary>
 	/// Creates a sphere centered at the origin with the given radius.  The
 	/// slices and stacks parameters control the degree of tessellation.
@@ -0,0 +1,256 @@
+//***************************************************************************************
+// InputRecording.cpp
+//***************************************************************************************
+
+#include "InputRecording.h"
+#include "ByteStream.h"
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	bool Fail(std::string& error, size_t position, const std::string& what)
+	{
+		error = "at byte " + std::to_string(position) + ": " + what;
+		return false;
+	}
+
+	bool IsKeyEvent(InputRecording::EventType type)
+	{
+		return type == InputRecording::KeyDown || type == InputRecording::KeyUp;
+	}
+}
+
+void InputRecording::Begin(std::uint64_t seed, double stepsPerSecond)
+{
+	mSeed = seed;
+	mStepsPerSecond = stepsPerSecond;
+	mEndStep = 0;
+	mEvents.clear();
+	mFrameStart = 0;
+	mNext = 0;
+}
+
+void InputRecording::AddKey(int key, bool down)
+{
+	Event event;
+	event.Type = down ? KeyDown : KeyUp;
+	event.Key = (std::uint8_t)key;
+	mEvents.push_back(event);
+}
+
+void InputRecording::AddMouse(EventType type, int buttons, int x, int y)
+{
+	Event event;
+	event.Type = type;
+	event.Buttons = (std::uint8_t)buttons;
+	event.X = x;
+	event.Y = y;
+	mEvents.push_back(event);
+}
+
+void InputRecording::EndFrame(std::uint64_t step, float seconds)
+{
+	for (size_t i = mFrameStart; i < mEvents.size(); ++i)
+		mEvents[i].Step = step;
+
+	Event frame;
+	frame.Step = step;
+	frame.Type = Frame;
+	frame.Seconds = seconds;
+	mEvents.push_back(frame);
+	mFrameStart = mEvents.size();
+}
+
+void InputRecording::End(std::uint64_t step)
+{
+	mEvents.resize(mFrameStart);
+	mEndStep = step;
+}
+
+std::uint64_t InputRecording::Seed()const
+{
+	return mSeed;
+}
+
+double InputRecording::StepsPerSecond()const
+{
+	return mStepsPerSecond;
+}
+
+std::uint64_t InputRecording::EndStep()const
+{
+	return mEndStep;
+}
+
+const std::vector<InputRecording::Event>& InputRecording::Events()const
+{
+	return mEvents;
+}
+
+bool InputRecording::Write(std::ostream& out)const
+{
+	std::uint64_t rateBits = 0;
+	std::memcpy(&rateBits, &mStepsPerSecond, sizeof(rateBits));
+
+	ByteWriter writer;
+	writer.Put32(Magic);
+	writer.Put32(Version);
+	writer.Put64(mSeed);
+	writer.Put64(rateBits);
+	writer.Put64(mEndStep);
+	writer.Put32((std::uint32_t)mEvents.size());
+
+	std::uint64_t lastStep = 0;
+	std::int32_t lastX = 0, lastY = 0;
+	for (const Event& event : mEvents)
+	{
+		writer.Put8(event.Type);
+		writer.PutVarint(event.Step - lastStep);
+		lastStep = event.Step;
+
+		if (IsKeyEvent(event.Type)) {
+			writer.Put8(event.Key);
+		}
+		else if (event.Type == Frame) {
+			std::uint32_t secondsBits = 0;
+			std::memcpy(&secondsBits, &event.Seconds, sizeof(secondsBits));
+			writer.Put32(secondsBits);
+		}
+		else {
+			writer.Put8(event.Buttons);
+			writer.PutSigned((std::int64_t)event.X - lastX);
+			writer.PutSigned((std::int64_t)event.Y - lastY);
+			lastX = event.X;
+			lastY = event.Y;
+		}
+	}
+
+	const auto& bytes = writer.Bytes();
+	out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+	return (bool)out;
+}
+
+bool InputRecording::Read(const void* data, size_t size, std::string& error)
+{
+	ByteReader in(static_cast<const std::uint8_t*>(data), size);
+
+	std::uint32_t magic = 0, version = 0, count = 0;
+	std::uint64_t seed = 0, rateBits = 0, endStep = 0;
+	if (!in.Get32(magic) || magic != Magic)
+		return Fail(error, 0, "not an input recording");
+	if (!in.Get32(version) || version != Version)
+		return Fail(error, 4, "version " + std::to_string(version) + " is not " + std::to_string(Version));
+	if (!in.Get64(seed) || !in.Get64(rateBits) || !in.Get64(endStep) || !in.Get32(count))
+		return Fail(error, in.Position(), "header cut short");
+
+	double stepsPerSecond = 0.0;
+	std::memcpy(&stepsPerSecond, &rateBits, sizeof(stepsPerSecond));
+	if (!(stepsPerSecond > 0.0))
+		return Fail(error, 16, "bad simulation rate");
+
+	// Every event takes at least three bytes, which bounds a damaged count
+	if (count > (size - in.Position()) / 3)
+		return Fail(error, in.Position() - 4, "more events than the recording has room for");
+
+	std::vector<Event> events(count);
+	std::uint64_t step = 0;
+	std::int64_t x = 0, y = 0;
+	size_t frameStart = 0;
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		Event& event = events[i];
+		const size_t start = in.Position();
+		std::uint8_t type = 0;
+		std::uint64_t steps = 0;
+		if (!in.Get8(type) || !in.GetVarint(steps))
+			return Fail(error, start, "event cut short");
+		if (type >= EventTypeCount)
+			return Fail(error, start, "unknown event " + std::to_string(type));
+
+		step += steps;
+		event.Step = step;
+		event.Type = (EventType)type;
+
+		bool ok = true;
+		if (IsKeyEvent(event.Type)) {
+			ok = in.Get8(event.Key);
+		}
+		else if (event.Type == Frame) {
+			std::uint32_t secondsBits = 0;
+			ok = in.Get32(secondsBits);
+			std::memcpy(&event.Seconds, &secondsBits, sizeof(event.Seconds));
+		}
+		else {
+			std::int64_t dx = 0, dy = 0;
+			ok = in.Get8(event.Buttons) && in.GetSigned(dx) && in.GetSigned(dy);
+			x += dx;
+			y += dy;
+			event.X = (std::int32_t)x;
+			event.Y = (std::int32_t)y;
+		}
+		if (!ok)
+			return Fail(error, start, std::string(EventName(event.Type)) + " cut short");
+
+		// A frame's events were all read by the Update it ran
+		if (event.Type == Frame) {
+			if (events[frameStart].Step != step)
+				return Fail(error, start, "frame at another step to its events");
+			frameStart = i + 1;
+		}
+	}
+	if (frameStart != events.size())
+		return Fail(error, in.Position(), "events after the last frame");
+
+	if (in.Position() != size)
+		return Fail(error, in.Position(), "unexpected bytes after the last event");
+	if (!events.empty() && events.back().Step > endStep)
+		return Fail(error, 24, "events after the step the recording ends at");
+
+	mSeed = seed;
+	mStepsPerSecond = stepsPerSecond;
+	mEndStep = endStep;
+	mEvents = std::move(events);
+	mFrameStart = mEvents.size();
+	mNext = 0;
+	return true;
+}
+
+void InputRecording::Rewind()
+{
+	mNext = 0;
+}
+
+bool InputRecording::NextFrame(std::vector<Event>& events, Event& frame)
+{
+	events.clear();
+	while (mNext < mEvents.size())
+	{
+		const Event& event = mEvents[mNext++];
+		if (event.Type == Frame) {
+			frame = event;
+			return true;
+		}
+		events.push_back(event);
+	}
+	return false;
+}
+
+bool InputRecording::Finished()const
+{
+	return mNext == mEvents.size();
+}
+
+const char* InputRecording::EventName(EventType type)
+{
+	switch (type)
+	{
+	case KeyDown: return "KeyDown";
+	case KeyUp: return "KeyUp";
+	case MouseDown: return "MouseDown";
+	case MouseUp: return "MouseUp";
+	case MouseMove: return "MouseMove";
+	case Frame: return "Frame";
+	default: return "Unknown";
+	}
+}
@@ -0,0 +1,129 @@
+//***************************************************************************************
+// InputRecording.h
+//
+// Key and mouse events grouped by the frame they arrived in, so a run can be played back
+// exactly.  Recording stores every key going down or up and every mouse button and move,
+// then closes each frame with a Frame record of how long the frame took.  Every event is
+// stamped with the simulation step its frame's Update ran at, the step count once the
+// frame's time has been spent.  Playing back hands out one frame's events at a time and
+// its frame time, so each replayed frame runs the same steps and its Update sees the
+// same input as the frame recorded, and a key pressed in one frame and released in the
+// next is never merged into one.  With the random engine seeded from the recording, a
+// replay does the same thing every time.
+//
+// A recording is a header followed by one record per event, little endian:
+//
+//   header      "RINP", version, random seed (uint64), steps per second (float64 bits),
+//               the step recording stopped at (uint64), event count (uint32)
+//   event       uint8 type, then the steps since the last event as a varint, then
+//     KeyDown, KeyUp                    uint8 key
+//     MouseDown, MouseUp, MouseMove     uint8 buttons, x and y as zigzag varints of the
+//                                       change since the last mouse event
+//     Frame                             the frame's seconds (float32 bits)
+//
+// Every event is followed, sooner or later, by the Frame it arrived in, with the same
+// step.  Frames mostly come a step or none apart and events a few pixels from the last,
+// so a frame takes six bytes, a key event three and a mouse move usually five.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class InputRecording
+{
+public:
+	enum EventType : std::uint8_t
+	{
+		KeyDown,
+		KeyUp,
+		MouseDown,
+		MouseUp,
+		MouseMove,
+		Frame,
+		EventTypeCount
+	};
+
+	struct Event
+	{
+		// The step count once the frame the event arrived in had run its steps
+		std::uint64_t Step = 0;
+		EventType Type = KeyDown;
+
+		// The key pressed or released, for KeyDown and KeyUp
+		std::uint8_t Key = 0;
+
+		// The Window::Button flags held, and where the cursor was, for mouse events
+		std::uint8_t Buttons = 0;
+		std::int32_t X = 0;
+		std::int32_t Y = 0;
+
+		// The frame time, for Frame
+		float Seconds = 0.0f;
+	};
+
+	static const std::uint32_t Magic = 0x504E4952; // "RINP"
+	static const std::uint32_t Version = 2;
+
+	///<summary>
+	/// Forgets every event and starts a recording made with the random engine seeded with
+	/// seed and the simulation running stepsPerSecond steps a second.
+	///</summary>
+	void Begin(std::uint64_t seed, double stepsPerSecond);
+
+	///<summary>
+	/// Adds an event to the frame in progress, in the order they arrived.  Its step is
+	/// filled in when the frame ends.
+	///</summary>
+	void AddKey(int key, bool down);
+	void AddMouse(EventType type, int buttons, int x, int y);
+
+	///<summary>
+	/// Ends the frame in progress: stamps its events with step, the step count once the
+	/// frame's seconds have been spent on simulation steps, and adds a Frame after them.
+	///</summary>
+	void EndFrame(std::uint64_t step, float seconds);
+
+	// Marks the step recording stopped at.  Events added since the last frame are dropped.
+	void End(std::uint64_t step);
+
+	std::uint64_t Seed()const;
+	double StepsPerSecond()const;
+	std::uint64_t EndStep()const;
+	const std::vector<Event>& Events()const;
+
+	bool Write(std::ostream& out)const;
+
+	///<summary>
+	/// Replaces the recording with one written by Write.  Returns false with what is wrong
+	/// in error if the data is damaged or from another version.
+	///</summary>
+	bool Read(const void* data, size_t size, std::string& error);
+
+	// Starts playing back from the first frame.
+	void Rewind();
+
+	///<summary>
+	/// Hands out the events of the next frame, in the order they arrived, and the Frame
+	/// that ends them.  Returns false once every frame has been handed out.
+	///</summary>
+	bool NextFrame(std::vector<Event>& events, Event& frame);
+
+	// True once every frame has been handed out.
+	bool Finished()const;
+
+	static const char* EventName(EventType type);
+
+private:
+	std::uint64_t mSeed = 0;
+	double mStepsPerSecond = 60.0;
+	std::uint64_t mEndStep = 0;
+
+	std::vector<Event> mEvents;
+	size_t mFrameStart = 0;
+	size_t mNext = 0;
+};
@@ -0,0 +1,22 @@
+//***************************************************************************************
+// Light.h
+//
+// Light as the shaders read it, moved out of Frank Luna's d3dUtil.h so constants that
+// hold lights can be filled in without D3D12.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+
+struct Light
+{
+    DirectX::XMFLOAT3 Strength = { 0.5f, 0.5f, 0.5f };
+    float FalloffStart = 1.0f;                          // point/spot light only
+    DirectX::XMFLOAT3 Direction = { 0.0f, -1.0f, 0.0f };// directional/spot light only
+    float FalloffEnd = 10.0f;                           // point/spot light only
+    DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };  // point/spot light only
+    float SpotPower = 64.0f;                            // spot light only
+};
+
+#define MaxLights 16
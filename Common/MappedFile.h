@@ -0,0 +1,50 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// Read-only view of a whole file mapped into the address space.  The operating system
+// pages the contents in on first touch, so opening a file costs the same however large it
+// is, and the bytes can be handed straight to whoever consumes them without a copy.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+	~MappedFile();
+
+	///<summary>
+	/// Maps filename for reading, closing any file already mapped.  Returns false if the
+	/// file does not exist, is empty or cannot be mapped.
+	///</summary>
+	bool Open(const std::wstring& filename);
+	void Close();
+
+	bool IsOpen()const { return mData != nullptr; }
+	const std::uint8_t* Data()const { return mData; }
+	std::uint64_t Size()const { return mSize; }
+
+private:
+	const std::uint8_t* mData = nullptr;
+	std::uint64_t mSize = 0;
+
+#if defined(_WIN32)
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#else
+	int mFile = -1;
+#endif
+};
+
+///<summary>
+/// Converts a wide path to the multibyte encoding of the current locale, for APIs that
+/// only take narrow paths.  Returns an empty string if the path cannot be represented.
+///</summary>
+std::string NarrowPath(const std::wstring& path);
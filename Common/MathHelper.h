@@ -6,28 +6,37 @@
 
 #pragma once
 
-#include <Windows.h>
 #include <DirectXMath.h>
+#include <cstddef>
 #include <cstdint>
+#include "RandomEngine.h"
 
 class MathHelper
 {
 public:
+	// The random functions draw from the calling thread's RandomEngine.
+
 	// Returns random float in [0, 1).
 	static float RandF()
 	{
-		return (float)(rand()) / (float)RAND_MAX;
+		return RandomEngine::ThreadLocal().NextFloat();
 	}
 
 	// Returns random float in [a, b).
 	static float RandF(float a, float b)
 	{
-		return a + RandF()*(b-a);
+		return RandomEngine::ThreadLocal().NextFloat(a, b);
+	}
+
+	// Fills out with count random floats in [a, b).
+	static void RandF(float* out, size_t count, float a, float b)
+	{
+		RandomEngine::ThreadLocal().FillFloats(out, count, a, b);
 	}
 
     static int Rand(int a, int b)
     {
-        return a + rand() % ((b - a) + 1);
+        return RandomEngine::ThreadLocal().NextInt(a, b);
     }
 
 	template<typename T>
@@ -78,6 +87,36 @@ public:
         return DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(&det, A));
 	}
 
+	// Inverse of a matrix made only of a rotation and a translation, such as a view
+	// matrix.  The rotation part is just transposed.
+	static DirectX::XMMATRIX InverseRigid(DirectX::CXMMATRIX M)
+	{
+		DirectX::XMMATRIX A = M;
+		A.r[3] = DirectX::XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+		A = DirectX::XMMatrixTranspose(A);
+
+		// The translation moves back along the transposed rotation.
+		DirectX::XMVECTOR t = DirectX::XMVectorMultiply(DirectX::XMVectorSplatX(M.r[3]), A.r[0]);
+		t = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSplatY(M.r[3]), A.r[1], t);
+		t = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSplatZ(M.r[3]), A.r[2], t);
+		A.r[3] = DirectX::XMVectorSetW(DirectX::XMVectorNegate(t), 1.0f);
+		return A;
+	}
+
+	// Inverse of a projection built by XMMatrixPerspectiveFovLH, worked out from the four
+	// entries that are not 0 or 1.
+	static DirectX::XMMATRIX InversePerspective(DirectX::CXMMATRIX P)
+	{
+		DirectX::XMFLOAT4X4 p;
+		DirectX::XMStoreFloat4x4(&p, P);
+
+		return DirectX::XMMATRIX(
+			1.0f / p._11, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f / p._22, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f / p._43,
+			0.0f, 0.0f, 1.0f, -p._33 / p._43);
+	}
+
     static DirectX::XMFLOAT4X4 Identity4x4()
     {
         static DirectX::XMFLOAT4X4 I(
@@ -90,6 +129,7 @@ public:
     }
 
     static DirectX::XMVECTOR RandUnitVec3();
+    static void RandUnitVec3(DirectX::XMFLOAT3* out, size_t count);
     static DirectX::XMVECTOR RandHemisphereUnitVec3(DirectX::XMVECTOR n);
 
 	static const float Infinity;
@@ -0,0 +1,85 @@
+//***************************************************************************************
+// MatrixStore.cpp
+//***************************************************************************************
+
+#include "MatrixStore.h"
+
+using namespace DirectX;
+
+namespace
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	// Transposes src in registers and writes the four rows of the result with streaming
+	// stores.  Sixty four bytes at an aligned address fill a whole write-combining buffer,
+	// so the line goes out to memory in one burst without ever being read.
+	inline void StreamTransposed(std::uint8_t* dest, const XMFLOAT4X4& src)
+	{
+		__m128 r0 = _mm_loadu_ps(&src._11);
+		__m128 r1 = _mm_loadu_ps(&src._21);
+		__m128 r2 = _mm_loadu_ps(&src._31);
+		__m128 r3 = _mm_loadu_ps(&src._41);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		float* out = reinterpret_cast<float*>(dest);
+		_mm_stream_ps(out + 0, r0);
+		_mm_stream_ps(out + 4, r1);
+		_mm_stream_ps(out + 8, r2);
+		_mm_stream_ps(out + 12, r3);
+	}
+#endif
+
+	inline void WriteTransposed(std::uint8_t* dest, const XMFLOAT4X4& src)
+	{
+		XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(dest), XMMatrixTranspose(XMLoadFloat4x4(&src)));
+	}
+}
+
+bool MatrixStore::CanStream(const void* dest, size_t destStride)
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	return ((reinterpret_cast<std::uintptr_t>(dest) | destStride) & 15) == 0;
+#else
+	return false;
+#endif
+}
+
+void MatrixStore::StoreTransposed(void* dest, size_t destStride, const XMFLOAT4X4* src, size_t count)
+{
+	std::uint8_t* out = static_cast<std::uint8_t*>(dest);
+
+#if defined(_XM_SSE_INTRINSICS_)
+	if(CanStream(dest, destStride))
+	{
+		for(size_t i = 0; i < count; ++i)
+			StreamTransposed(out + i*destStride, src[i]);
+
+		// Streaming stores are weakly ordered; make sure they are all out before anything
+		// else writes these elements or the buffer is handed to the GPU
+		_mm_sfence();
+		return;
+	}
+#endif
+
+	for(size_t i = 0; i < count; ++i)
+		WriteTransposed(out + i*destStride, src[i]);
+}
+
+void MatrixStore::StoreTransposed(void* dest, size_t destStride,
+	const XMFLOAT4X4* src, const std::uint32_t* destIndices, size_t count)
+{
+	std::uint8_t* out = static_cast<std::uint8_t*>(dest);
+
+#if defined(_XM_SSE_INTRINSICS_)
+	if(CanStream(dest, destStride))
+	{
+		for(size_t i = 0; i < count; ++i)
+			StreamTransposed(out + destIndices[i]*destStride, src[i]);
+
+		_mm_sfence();
+		return;
+	}
+#endif
+
+	for(size_t i = 0; i < count; ++i)
+		WriteTransposed(out + destIndices[i]*destStride, src[i]);
+}
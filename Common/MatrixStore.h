@@ -0,0 +1,37 @@
+//***************************************************************************************
+// MatrixStore.h
+//
+// Writes matrices transposed for HLSL straight into mapped upload buffers.  Upload heaps
+// are write-combined: reading them back is very slow, and writes are only fast when whole
+// lines are written in order.  The kernel here transposes in registers and writes each
+// matrix with streaming stores, so nothing passes through a staging struct or the cache
+// on its way to the GPU.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+
+class MatrixStore
+{
+public:
+	///<summary>
+	/// Writes the transpose of each of the count matrices in src, the i-th to
+	/// dest + i*destStride bytes.
+	///</summary>
+	static void StoreTransposed(void* dest, size_t destStride,
+		const DirectX::XMFLOAT4X4* src, size_t count);
+
+	///<summary>
+	/// As above, but the i-th matrix goes to dest + destIndices[i]*destStride bytes, for
+	/// writing a scattered set of constant buffer elements in one pass.
+	///</summary>
+	static void StoreTransposed(void* dest, size_t destStride,
+		const DirectX::XMFLOAT4X4* src, const std::uint32_t* destIndices, size_t count);
+
+	// True when dest and destStride allow streaming stores, which need 16 byte alignment.
+	// Unaligned destinations are written with ordinary stores instead.
+	static bool CanStream(const void* dest, size_t destStride);
+};
@@ -0,0 +1,156 @@
+//***************************************************************************************
+// MemoryTracker.cpp
+//***************************************************************************************
+
+#include "MemoryTracker.h"
+#include <atomic>
+#include <utility>
+
+namespace
+{
+	struct TagCounts
+	{
+		std::atomic<std::uint64_t> LiveBytes{ 0 };
+		std::atomic<std::uint64_t> PeakBytes{ 0 };
+		std::atomic<std::uint64_t> LiveAllocations{ 0 };
+		std::atomic<std::uint64_t> TotalAllocations{ 0 };
+	};
+
+	// Constant initialized, so allocations made by other files' static objects are
+	// counted whatever order they start in
+	TagCounts gTags[MemoryTracker::TagCount];
+	TagCounts gTotal;
+
+	void RaisePeak(std::atomic<std::uint64_t>& peak, std::uint64_t live)
+	{
+		std::uint64_t seen = peak.load(std::memory_order_relaxed);
+		while (live > seen && !peak.compare_exchange_weak(seen, live, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void Add(TagCounts& counts, size_t bytes)
+	{
+		std::uint64_t live = counts.LiveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		RaisePeak(counts.PeakBytes, live);
+		counts.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		counts.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Remove(TagCounts& counts, size_t bytes)
+	{
+		counts.LiveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		counts.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	MemoryTracker::Counts Read(const TagCounts& counts)
+	{
+		MemoryTracker::Counts result;
+		result.LiveBytes = counts.LiveBytes.load(std::memory_order_relaxed);
+		result.PeakBytes = counts.PeakBytes.load(std::memory_order_relaxed);
+		result.LiveAllocations = counts.LiveAllocations.load(std::memory_order_relaxed);
+		result.TotalAllocations = counts.TotalAllocations.load(std::memory_order_relaxed);
+		return result;
+	}
+
+	void WriteCounts(std::ostream& out, const MemoryTracker::Counts& counts)
+	{
+		out << "{ \"liveBytes\": " << counts.LiveBytes << ", \"peakBytes\": " << counts.PeakBytes
+			<< ", \"liveAllocations\": " << counts.LiveAllocations << ", \"totalAllocations\": "
+			<< counts.TotalAllocations << " }";
+	}
+}
+
+void MemoryTracker::Allocate(Tag tag, size_t bytes)
+{
+	Add(gTags[tag], bytes);
+	Add(gTotal, bytes);
+}
+
+void MemoryTracker::Free(Tag tag, size_t bytes)
+{
+	Remove(gTags[tag], bytes);
+	Remove(gTotal, bytes);
+}
+
+MemoryTracker::Counts MemoryTracker::Get(Tag tag)
+{
+	return Read(gTags[tag]);
+}
+
+MemoryTracker::Counts MemoryTracker::Total()
+{
+	return Read(gTotal);
+}
+
+const char* MemoryTracker::TagName(Tag tag)
+{
+	switch (tag)
+	{
+	case Geometry: return "geometry";
+	case GeometryCopies: return "geometryCopies";
+	case Textures: return "textures";
+	case UploadBuffers: return "uploadBuffers";
+	case UploadPadding: return "uploadPadding";
+	case RenderItems: return "renderItems";
+	case CubeState: return "cubeState";
+	default: return "unknown";
+	}
+}
+
+void MemoryTracker::WriteJson(std::ostream& out)
+{
+	out << "{\n  \"tags\": {";
+	for (int t = 0; t < TagCount; ++t)
+	{
+		out << (t ? ",\n" : "\n") << "    \"" << TagName((Tag)t) << "\": ";
+		WriteCounts(out, Get((Tag)t));
+	}
+	out << "\n  },\n  \"total\": ";
+	WriteCounts(out, Total());
+	out << "\n}\n";
+}
+
+MemoryTracker::Allocation::Allocation(Tag tag, size_t bytes)
+{
+	Reset(tag, bytes);
+}
+
+MemoryTracker::Allocation::~Allocation()
+{
+	Reset();
+}
+
+MemoryTracker::Allocation::Allocation(Allocation&& rhs) noexcept
+	: mTag(rhs.mTag), mBytes(rhs.mBytes)
+{
+	rhs.mTag = TagCount;
+	rhs.mBytes = 0;
+}
+
+MemoryTracker::Allocation& MemoryTracker::Allocation::operator=(Allocation&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		Reset();
+		std::swap(mTag, rhs.mTag);
+		std::swap(mBytes, rhs.mBytes);
+	}
+	return *this;
+}
+
+void MemoryTracker::Allocation::Reset(Tag tag, size_t bytes)
+{
+	Reset();
+	MemoryTracker::Allocate(tag, bytes);
+	mTag = tag;
+	mBytes = bytes;
+}
+
+void MemoryTracker::Allocation::Reset()
+{
+	if (mTag != TagCount)
+		MemoryTracker::Free(mTag, mBytes);
+	mTag = TagCount;
+	mBytes = 0;
+}
@@ -0,0 +1,123 @@
+//***************************************************************************************
+// MemoryTracker.h
+//
+// Counts the memory each part of the app holds, under a tag per part: live and peak
+// bytes, and live and total allocations.  Nothing is allocated through the tracker; the
+// code that owns some memory reports it, in one of three ways:
+//
+//   Allocator<T, tag>   an allocator for standard containers that counts what they hold
+//   Allocation          a movable object that counts a size for as long as it lives, for
+//                       memory allocated elsewhere, such as D3D12 resources and blobs
+//   Allocate / Free     the counts themselves, for anything else
+//
+// The counts are atomic, so any thread may report and read them at any time.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+class MemoryTracker
+{
+public:
+	enum Tag
+	{
+		Geometry,       // vertex and index buffers in GPU memory
+		GeometryCopies, // system memory copies of geometry: MeshGeometry blobs, MeshData's 16 bit indices
+		Textures,       // texture resources
+		UploadBuffers,  // upload heaps: the frame resources' buffers and one-off uploaders
+		UploadPadding,  // bytes of constant buffers lost to rounding elements up to 256 bytes
+		RenderItems,    // RenderItems
+		CubeState,      // CubeScene and its turns, bounds and staged matrices
+		TagCount
+	};
+
+	struct Counts
+	{
+		std::uint64_t LiveBytes = 0;
+		std::uint64_t PeakBytes = 0;
+		std::uint64_t LiveAllocations = 0;
+		std::uint64_t TotalAllocations = 0;
+	};
+
+	static void Allocate(Tag tag, size_t bytes);
+	static void Free(Tag tag, size_t bytes);
+
+	static Counts Get(Tag tag);
+
+	// Every tag together.  PeakBytes is the most ever live at once, not a sum of peaks.
+	static Counts Total();
+
+	static const char* TagName(Tag tag);
+
+	// Writes every tag's counts and the total as JSON, in bytes.
+	static void WriteJson(std::ostream& out);
+
+	///<summary>
+	/// Counts bytes under tag from when it is made until it is destroyed, reset or moved
+	/// from.  An Allocation made with the default constructor counts nothing.
+	///</summary>
+	class Allocation
+	{
+	public:
+		Allocation() = default;
+		Allocation(Tag tag, size_t bytes);
+		~Allocation();
+
+		Allocation(Allocation&& rhs) noexcept;
+		Allocation& operator=(Allocation&& rhs) noexcept;
+
+		Allocation(const Allocation& rhs) = delete;
+		Allocation& operator=(const Allocation& rhs) = delete;
+
+		// Stops counting, then counts bytes under tag instead.
+		void Reset(Tag tag, size_t bytes);
+		void Reset();
+
+		size_t Bytes()const { return mBytes; }
+
+	private:
+		Tag mTag = TagCount;
+		size_t mBytes = 0;
+	};
+
+	template<typename T, Tag tag>
+	class Allocator
+	{
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind
+		{
+			using other = Allocator<U, tag>;
+		};
+
+		Allocator() = default;
+
+		template<typename U>
+		Allocator(const Allocator<U, tag>&) { }
+
+		T* allocate(size_t count)
+		{
+			T* memory = std::allocator<T>().allocate(count);
+			MemoryTracker::Allocate(tag, count * sizeof(T));
+			return memory;
+		}
+
+		void deallocate(T* memory, size_t count)
+		{
+			MemoryTracker::Free(tag, count * sizeof(T));
+			std::allocator<T>().deallocate(memory, count);
+		}
+
+		template<typename U>
+		bool operator==(const Allocator<U, tag>&)const { return true; }
+
+		template<typename U>
+		bool operator!=(const Allocator<U, tag>&)const { return false; }
+	};
+};
@@ -0,0 +1,127 @@
+//***************************************************************************************
+// MeshBounds.cpp
+//***************************************************************************************
+
+#include "MeshBounds.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace
+{
+	// Hands out the position of the i'th point, either directly or through an index buffer.
+	struct DirectPoints
+	{
+		const std::uint8_t* Base;
+		size_t Stride;
+
+		XMVECTOR operator()(size_t i)const
+		{
+			return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(Base + i*Stride));
+		}
+	};
+
+	template<typename Index>
+	struct IndexedPoints
+	{
+		const std::uint8_t* Base;
+		size_t Stride;
+		const Index* Indices;
+
+		XMVECTOR operator()(size_t i)const
+		{
+			return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(Base + Indices[i]*Stride));
+		}
+	};
+
+	// Four independent accumulators per reduction, so consecutive points do not wait on
+	// each other's min/max.
+	template<typename Points>
+	void Reduce(const Points& points, size_t count, BoundingBox& box, BoundingSphere& sphere)
+	{
+		if (count == 0)
+		{
+			box = BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+			sphere = BoundingSphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f);
+			return;
+		}
+
+		XMVECTOR min0 = XMVectorReplicate(FLT_MAX);
+		XMVECTOR min1 = min0, min2 = min0, min3 = min0;
+		XMVECTOR max0 = XMVectorReplicate(-FLT_MAX);
+		XMVECTOR max1 = max0, max2 = max0, max3 = max0;
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			XMVECTOR p0 = points(i);
+			XMVECTOR p1 = points(i + 1);
+			XMVECTOR p2 = points(i + 2);
+			XMVECTOR p3 = points(i + 3);
+
+			min0 = XMVectorMin(min0, p0); max0 = XMVectorMax(max0, p0);
+			min1 = XMVectorMin(min1, p1); max1 = XMVectorMax(max1, p1);
+			min2 = XMVectorMin(min2, p2); max2 = XMVectorMax(max2, p2);
+			min3 = XMVectorMin(min3, p3); max3 = XMVectorMax(max3, p3);
+		}
+		for (; i < count; ++i)
+		{
+			XMVECTOR p = points(i);
+			min0 = XMVectorMin(min0, p);
+			max0 = XMVectorMax(max0, p);
+		}
+
+		XMVECTOR vMin = XMVectorMin(XMVectorMin(min0, min1), XMVectorMin(min2, min3));
+		XMVECTOR vMax = XMVectorMax(XMVectorMax(max0, max1), XMVectorMax(max2, max3));
+
+		XMVECTOR centre = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+		XMStoreFloat3(&box.Center, centre);
+		XMStoreFloat3(&box.Extents, XMVectorScale(XMVectorSubtract(vMax, vMin), 0.5f));
+
+		// Second pass for the largest squared distance from the centre.  This is usually
+		// well inside the sphere through the corners of the box.
+		XMVECTOR d0 = XMVectorZero();
+		XMVECTOR d1 = d0, d2 = d0, d3 = d0;
+
+		i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			d0 = XMVectorMax(d0, XMVector3LengthSq(XMVectorSubtract(points(i), centre)));
+			d1 = XMVectorMax(d1, XMVector3LengthSq(XMVectorSubtract(points(i + 1), centre)));
+			d2 = XMVectorMax(d2, XMVector3LengthSq(XMVectorSubtract(points(i + 2), centre)));
+			d3 = XMVectorMax(d3, XMVector3LengthSq(XMVectorSubtract(points(i + 3), centre)));
+		}
+		for (; i < count; ++i)
+			d0 = XMVectorMax(d0, XMVector3LengthSq(XMVectorSubtract(points(i), centre)));
+
+		XMVECTOR radiusSq = XMVectorMax(XMVectorMax(d0, d1), XMVectorMax(d2, d3));
+
+		sphere.Center = box.Center;
+		sphere.Radius = XMVectorGetX(XMVectorSqrt(radiusSq));
+	}
+}
+
+void MeshBounds::Compute(const void* positions, size_t count, size_t stride,
+	BoundingBox& box, BoundingSphere& sphere)
+{
+	DirectPoints points = { static_cast<const std::uint8_t*>(positions), stride };
+	Reduce(points, count, box, sphere);
+}
+
+void MeshBounds::Compute(const void* positions, size_t stride,
+	const std::uint16_t* indices, size_t indexCount, std::int32_t baseVertex,
+	BoundingBox& box, BoundingSphere& sphere)
+{
+	IndexedPoints<std::uint16_t> points = {
+		static_cast<const std::uint8_t*>(positions) + (std::ptrdiff_t)baseVertex*(std::ptrdiff_t)stride, stride, indices };
+	Reduce(points, indexCount, box, sphere);
+}
+
+void MeshBounds::Compute(const void* positions, size_t stride,
+	const std::uint32_t* indices, size_t indexCount, std::int32_t baseVertex,
+	BoundingBox& box, BoundingSphere& sphere)
+{
+	IndexedPoints<std::uint32_t> points = {
+		static_cast<const std::uint8_t*>(positions) + (std::ptrdiff_t)baseVertex*(std::ptrdiff_t)stride, stride, indices };
+	Reduce(points, indexCount, box, sphere);
+}
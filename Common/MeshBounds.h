@@ -0,0 +1,38 @@
+//***************************************************************************************
+// MeshBounds.h
+//
+// Axis-aligned boxes and spheres around vertex positions.  The positions are read straight
+// out of interleaved vertex data, and the min/max reductions run several independent SIMD
+// accumulators at once so large meshes are limited by memory bandwidth rather than by the
+// latency of each min/max.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstddef>
+#include <cstdint>
+
+class MeshBounds
+{
+public:
+	///<summary>
+	/// Bounds of count positions, each an XMFLOAT3 found stride bytes after the previous
+	/// one.  The sphere is centred on the box and just large enough to hold every point.
+	/// Empty input gives a box and sphere of size zero at the origin.
+	///</summary>
+	static void Compute(const void* positions, size_t count, size_t stride,
+		DirectX::BoundingBox& box, DirectX::BoundingSphere& sphere);
+
+	///<summary>
+	/// Bounds of the positions referenced by an index range, as drawn with
+	/// DrawIndexedInstanced(indexCount, 1, 0, baseVertex, 0) from the given indices.
+	///</summary>
+	static void Compute(const void* positions, size_t stride,
+		const std::uint16_t* indices, size_t indexCount, std::int32_t baseVertex,
+		DirectX::BoundingBox& box, DirectX::BoundingSphere& sphere);
+	static void Compute(const void* positions, size_t stride,
+		const std::uint32_t* indices, size_t indexCount, std::int32_t baseVertex,
+		DirectX::BoundingBox& box, DirectX::BoundingSphere& sphere);
+};
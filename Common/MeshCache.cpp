@@ -0,0 +1,257 @@
+//***************************************************************************************
+// MeshCache.cpp
+//***************************************************************************************
+
+#include "MeshCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+static_assert(sizeof(MeshCache::Header) == 72, "MeshCache::Header layout is part of the file format");
+static_assert(sizeof(MeshCache::Submesh) == 16, "MeshCache::Submesh layout is part of the file format");
+
+namespace
+{
+	// Whether bytes starting at offset lie inside a file of fileSize bytes.  Subtracted
+	// rather than added, so an offset near the top of the range cannot wrap round.
+	bool InsideFile(std::uint64_t offset, std::uint64_t bytes, std::uint64_t fileSize)
+	{
+		return offset <= fileSize && bytes <= fileSize - offset;
+	}
+
+	// Whether every index of a submesh, offset by its base vertex, names a vertex in the
+	// file.  The content key only says what the geometry was generated from, so a damaged
+	// payload under the right key is caught here rather than read past the mapping later.
+	bool IndicesInRange(const std::uint8_t* indices, std::uint32_t indexStride, const MeshCache::Submesh& submesh,
+		std::uint32_t vertexCount)
+	{
+		const std::uint64_t limit = vertexCount - (std::uint64_t)submesh.BaseVertexLocation;
+		const std::uint8_t* at = indices + (std::uint64_t)submesh.StartIndexLocation * indexStride;
+		for (std::uint32_t i = 0; i < submesh.IndexCount; ++i, at += indexStride)
+		{
+			std::uint32_t index = 0;
+			if (indexStride == sizeof(std::uint16_t))
+			{
+				std::uint16_t index16 = 0;
+				std::memcpy(&index16, at, sizeof(index16));
+				index = index16;
+			}
+			else
+				std::memcpy(&index, at, sizeof(index));
+
+			if (index >= limit)
+				return false;
+		}
+		return true;
+	}
+
+	std::uint64_t AlignUp(std::uint64_t offset)
+	{
+		return (offset + MeshCache::PayloadAlignment - 1) & ~std::uint64_t(MeshCache::PayloadAlignment - 1);
+	}
+
+	FILE* OpenForWriting(const std::wstring& filename)
+	{
+#if defined(_WIN32)
+		return _wfopen(filename.c_str(), L"wb");
+#else
+		std::string path = NarrowPath(filename);
+		return path.empty() ? nullptr : std::fopen(path.c_str(), "wb");
+#endif
+	}
+
+	bool MoveIntoPlace(const std::wstring& from, const std::wstring& to)
+	{
+#if defined(_WIN32)
+		return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return std::rename(NarrowPath(from).c_str(), NarrowPath(to).c_str()) == 0;
+#endif
+	}
+
+	void DeleteTemporary(const std::wstring& filename)
+	{
+#if defined(_WIN32)
+		DeleteFileW(filename.c_str());
+#else
+		std::remove(NarrowPath(filename).c_str());
+#endif
+	}
+
+	bool WriteAt(FILE* file, std::uint64_t& position, std::uint64_t offset, const void* data, size_t byteSize)
+	{
+		static const std::uint8_t zeros[MeshCache::PayloadAlignment] = {};
+
+		// Pad up to the requested offset.
+		while (position < offset)
+		{
+			size_t padding = (size_t)std::min<std::uint64_t>(offset - position, sizeof(zeros));
+			if (std::fwrite(zeros, 1, padding, file) != padding)
+				return false;
+			position += padding;
+		}
+
+		if (byteSize != 0 && std::fwrite(data, 1, byteSize, file) != byteSize)
+			return false;
+
+		position += byteSize;
+		return true;
+	}
+}
+
+bool MeshCache::Write(const std::wstring& filename, const Contents& contents)
+{
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	header.Magic = Magic;
+	header.Version = FormatVersion;
+	header.ContentKey = contents.ContentKey;
+	header.VertexStride = contents.VertexStride;
+	header.VertexCount = contents.VertexCount;
+	header.IndexStride = contents.IndexStride;
+	header.IndexCount = contents.IndexCount;
+	header.SubmeshCount = contents.SubmeshCount;
+
+	const std::uint64_t vertexBytes = (std::uint64_t)contents.VertexStride * contents.VertexCount;
+	const std::uint64_t indexBytes = (std::uint64_t)contents.IndexStride * contents.IndexCount;
+	const std::uint64_t submeshBytes = (std::uint64_t)sizeof(Submesh) * contents.SubmeshCount;
+
+	header.SubmeshOffset = sizeof(Header);
+	header.VertexOffset = AlignUp(header.SubmeshOffset + submeshBytes);
+	header.IndexOffset = AlignUp(header.VertexOffset + vertexBytes);
+	header.FileSize = header.IndexOffset + indexBytes;
+
+	const std::wstring temporary = filename + L".tmp";
+	FILE* file = OpenForWriting(temporary);
+	if (file == nullptr)
+		return false;
+
+	std::uint64_t position = 0;
+	bool written =
+		WriteAt(file, position, 0, &header, sizeof(header)) &&
+		WriteAt(file, position, header.SubmeshOffset, contents.Submeshes, (size_t)submeshBytes) &&
+		WriteAt(file, position, header.VertexOffset, contents.Vertices, (size_t)vertexBytes) &&
+		WriteAt(file, position, header.IndexOffset, contents.Indices, (size_t)indexBytes);
+
+	written = (std::fclose(file) == 0) && written;
+
+	if (!written || !MoveIntoPlace(temporary, filename))
+	{
+		DeleteTemporary(temporary);
+		return false;
+	}
+
+	return true;
+}
+
+bool MeshCache::Open(const std::wstring& filename, std::uint64_t contentKey,
+	std::uint32_t vertexStride, std::uint32_t indexStride)
+{
+	Close();
+
+	if (!mFile.Open(filename) || mFile.Size() < sizeof(Header))
+	{
+		mFile.Close();
+		return false;
+	}
+
+	const Header* header = reinterpret_cast<const Header*>(mFile.Data());
+
+	const std::uint64_t vertexBytes = (std::uint64_t)header->VertexStride * header->VertexCount;
+	const std::uint64_t indexBytes = (std::uint64_t)header->IndexStride * header->IndexCount;
+	const std::uint64_t submeshBytes = (std::uint64_t)sizeof(Submesh) * header->SubmeshCount;
+
+	// The offsets are checked against the sizes rather than recomputed so that a future
+	// writer is free to lay the file out differently without bumping the version.
+	bool valid =
+		header->Magic == Magic &&
+		header->Version == FormatVersion &&
+		header->ContentKey == contentKey &&
+		header->VertexStride == vertexStride &&
+		header->IndexStride == indexStride &&
+		(indexStride == sizeof(std::uint16_t) || indexStride == sizeof(std::uint32_t)) &&
+		header->FileSize == mFile.Size() &&
+		header->SubmeshOffset % alignof(Submesh) == 0 &&
+		header->VertexOffset % PayloadAlignment == 0 &&
+		header->IndexOffset % PayloadAlignment == 0 &&
+		header->SubmeshOffset >= sizeof(Header) &&
+		InsideFile(header->SubmeshOffset, submeshBytes, header->FileSize) &&
+		InsideFile(header->VertexOffset, vertexBytes, header->FileSize) &&
+		InsideFile(header->IndexOffset, indexBytes, header->FileSize);
+
+	if (valid)
+	{
+		const Submesh* submeshes = reinterpret_cast<const Submesh*>(mFile.Data() + header->SubmeshOffset);
+		const std::uint8_t* indices = mFile.Data() + header->IndexOffset;
+		for (std::uint32_t i = 0; i < header->SubmeshCount && valid; ++i)
+		{
+			const Submesh& s = submeshes[i];
+			valid = (std::uint64_t)s.StartIndexLocation + s.IndexCount <= header->IndexCount &&
+				s.BaseVertexLocation >= 0 && (std::uint32_t)s.BaseVertexLocation < header->VertexCount &&
+				IndicesInRange(indices, indexStride, s, header->VertexCount);
+		}
+	}
+
+	if (!valid)
+	{
+		mFile.Close();
+		return false;
+	}
+
+	mHeader = header;
+	return true;
+}
+
+void MeshCache::Close()
+{
+	mHeader = nullptr;
+	mFile.Close();
+}
+
+const void* MeshCache::Vertices()const
+{
+	return mHeader ? mFile.Data() + mHeader->VertexOffset : nullptr;
+}
+
+const void* MeshCache::Indices()const
+{
+	return mHeader ? mFile.Data() + mHeader->IndexOffset : nullptr;
+}
+
+const MeshCache::Submesh* MeshCache::Submeshes()const
+{
+	return mHeader ? reinterpret_cast<const Submesh*>(mFile.Data() + mHeader->SubmeshOffset) : nullptr;
+}
+
+std::uint32_t MeshCache::VertexCount()const
+{
+	return mHeader ? mHeader->VertexCount : 0;
+}
+
+std::uint32_t MeshCache::IndexCount()const
+{
+	return mHeader ? mHeader->IndexCount : 0;
+}
+
+std::uint32_t MeshCache::SubmeshCount()const
+{
+	return mHeader ? mHeader->SubmeshCount : 0;
+}
+
+std::uint64_t MeshCache::Hash(const void* data, size_t byteSize, std::uint64_t seed)
+{
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+
+	std::uint64_t hash = seed;
+	for (size_t i = 0; i < byteSize; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
@@ -0,0 +1,104 @@
+//***************************************************************************************
+// MeshCache.h
+//
+// Binary file format for storing generated geometry so it only has to be built once.
+// A file holds a header, a table of submeshes and the raw vertex and index buffers:
+//
+//   MeshCache::Header
+//   MeshCache::Submesh[SubmeshCount]     at SubmeshOffset
+//   vertex bytes (VertexStride each)     at VertexOffset, PayloadAlignment aligned
+//   index bytes  (IndexStride each)      at IndexOffset,  PayloadAlignment aligned
+//
+// Files are read through a MappedFile, so the buffers can be used in place.  Every file
+// carries a ContentKey the writer derives from whatever the geometry was generated from;
+// a file whose key, format version or strides do not match what the reader expects is
+// treated as missing, which is how stale caches get rebuilt.
+//***************************************************************************************
+
+#pragma once
+
+#include "MappedFile.h"
+
+class MeshCache
+{
+public:
+	static const std::uint32_t Magic = 0x4D584252; // "RBXM"
+	static const std::uint32_t FormatVersion = 1;
+	static const std::uint32_t PayloadAlignment = 64;
+
+	struct Header
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint64_t ContentKey;
+		std::uint32_t VertexStride;
+		std::uint32_t VertexCount;
+		std::uint32_t IndexStride;
+		std::uint32_t IndexCount;
+		std::uint32_t SubmeshCount;
+		std::uint32_t Reserved;
+		std::uint64_t SubmeshOffset;
+		std::uint64_t VertexOffset;
+		std::uint64_t IndexOffset;
+		std::uint64_t FileSize;
+	};
+
+	// Same meaning as the fields of SubmeshGeometry in d3dUtil.h.
+	struct Submesh
+	{
+		std::uint32_t IndexCount;
+		std::uint32_t StartIndexLocation;
+		std::int32_t BaseVertexLocation;
+		std::uint32_t Reserved;
+	};
+
+	// Everything that goes into a file.  The pointers only need to stay valid for the
+	// duration of Write().
+	struct Contents
+	{
+		std::uint64_t ContentKey = 0;
+		const void* Vertices = nullptr;
+		std::uint32_t VertexStride = 0;
+		std::uint32_t VertexCount = 0;
+		const void* Indices = nullptr;
+		std::uint32_t IndexStride = 0;
+		std::uint32_t IndexCount = 0;
+		const Submesh* Submeshes = nullptr;
+		std::uint32_t SubmeshCount = 0;
+	};
+
+	///<summary>
+	/// Writes contents to filename.  The file is written under a temporary name and then
+	/// renamed, so a reader never sees it half written.  Returns false on any I/O error.
+	///</summary>
+	static bool Write(const std::wstring& filename, const Contents& contents);
+
+	///<summary>
+	/// Maps filename and checks it is a complete, well formed cache for contentKey with the
+	/// given vertex and index strides, down to every index naming a vertex in the file.
+	/// indexStride must be 2 or 4.  Returns false (leaving nothing open) otherwise.
+	///</summary>
+	bool Open(const std::wstring& filename, std::uint64_t contentKey,
+		std::uint32_t vertexStride, std::uint32_t indexStride);
+	void Close();
+
+	// Pointers into the mapped file, valid until Close() or destruction.
+	const void* Vertices()const;
+	const void* Indices()const;
+	const Submesh* Submeshes()const;
+
+	std::uint32_t VertexCount()const;
+	std::uint32_t IndexCount()const;
+	std::uint32_t SubmeshCount()const;
+
+	///<summary>
+	/// 64-bit FNV-1a.  Chain calls through seed to hash several blocks of memory into
+	/// one content key.
+	///</summary>
+	static std::uint64_t Hash(const void* data, size_t byteSize,
+		std::uint64_t seed = 0xcbf29ce484222325ull);
+
+private:
+	MappedFile mFile;
+	const Header* mHeader = nullptr;
+};
@@ -0,0 +1,487 @@
+//***************************************************************************************
+// MeshSimplifier.cpp
+//***************************************************************************************
+
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = GeometryGenerator::uint32;
+	using Vertex = GeometryGenerator::Vertex;
+
+	// Weight of the planes that pin boundary and seam edges in place.  Large enough that
+	// sliding a boundary vertex off its edge is always more expensive than any interior
+	// collapse on a reasonably tessellated mesh.
+	const double BoundaryWeight = 1000.0;
+
+	// Symmetric 4x4 error quadric, stored as its upper triangle:
+	//
+	//  | a0 a1 a2 a3 |
+	//  |    a4 a5 a6 |
+	//  |       a7 a8 |
+	//  |          a9 |
+	struct Quadric
+	{
+		double a[10] = {};
+
+		static Quadric FromPlane(double nx, double ny, double nz, double d, double weight)
+		{
+			Quadric q;
+			q.a[0] = weight*nx*nx; q.a[1] = weight*nx*ny; q.a[2] = weight*nx*nz; q.a[3] = weight*nx*d;
+			q.a[4] = weight*ny*ny; q.a[5] = weight*ny*nz; q.a[6] = weight*ny*d;
+			q.a[7] = weight*nz*nz; q.a[8] = weight*nz*d;
+			q.a[9] = weight*d*d;
+			return q;
+		}
+
+		Quadric& operator+=(const Quadric& rhs)
+		{
+			for(int i = 0; i < 10; ++i)
+				a[i] += rhs.a[i];
+			return *this;
+		}
+
+		// Sum of the squared distances from p to every plane folded into this quadric.
+		double Evaluate(const XMFLOAT3& p)const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			return a[0]*x*x + 2.0*a[1]*x*y + 2.0*a[2]*x*z + 2.0*a[3]*x
+			     + a[4]*y*y + 2.0*a[5]*y*z + 2.0*a[6]*y
+			     + a[7]*z*z + 2.0*a[8]*z
+			     + a[9];
+		}
+	};
+
+	// A candidate half-edge collapse.  The stamps record the version of each endpoint
+	// when the cost was computed, so entries made stale by later collapses can be
+	// discarded lazily when they reach the top of the queue.
+	struct Collapse
+	{
+		double Cost;
+		uint32 From;
+		uint32 To;
+		uint32 FromStamp;
+		uint32 ToStamp;
+
+		bool operator>(const Collapse& rhs)const
+		{
+			return Cost > rhs.Cost;
+		}
+	};
+
+	std::uint64_t EdgeKey(uint32 a, uint32 b)
+	{
+		return a < b ? ((std::uint64_t)a << 32) | b : ((std::uint64_t)b << 32) | a;
+	}
+
+	// Bitwise key over every attribute of a vertex, used when welding.
+	struct VertexKey
+	{
+		static_assert(sizeof(Vertex) == 11*sizeof(float), "Vertex is expected to be tightly packed floats.");
+
+		float f[11];
+
+		explicit VertexKey(const Vertex& v)
+		{
+			std::memcpy(f, &v, sizeof(f));
+		}
+
+		bool operator==(const VertexKey& rhs)const
+		{
+			return std::memcmp(f, rhs.f, sizeof(f)) == 0;
+		}
+	};
+
+	struct VertexKeyHash
+	{
+		size_t operator()(const VertexKey& key)const
+		{
+			// FNV-1a over the raw bytes.
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.f);
+			std::uint64_t h = 14695981039346656037ull;
+			for(size_t i = 0; i < sizeof(key.f); ++i)
+			{
+				h ^= bytes[i];
+				h *= 1099511628211ull;
+			}
+			return (size_t)h;
+		}
+	};
+
+	XMVECTOR TriangleNormal(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2)
+	{
+		XMVECTOR v0 = XMLoadFloat3(&p0);
+		XMVECTOR e0 = XMVectorSubtract(XMLoadFloat3(&p1), v0);
+		XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(&p2), v0);
+		return XMVector3Cross(e0, e1);
+	}
+}
+
+GeometryGenerator::MeshData MeshSimplifier::Weld(const MeshData& meshData)
+{
+	MeshData welded;
+
+	std::unordered_map<VertexKey, uint32, VertexKeyHash> lookup;
+	lookup.reserve(meshData.Vertices.size());
+
+	std::vector<uint32> remap(meshData.Vertices.size());
+	for(size_t i = 0; i < meshData.Vertices.size(); ++i)
+	{
+		auto inserted = lookup.emplace(VertexKey(meshData.Vertices[i]), (uint32)welded.Vertices.size());
+		if(inserted.second)
+			welded.Vertices.push_back(meshData.Vertices[i]);
+
+		remap[i] = inserted.first->second;
+	}
+
+	welded.Indices32.resize(meshData.Indices32.size());
+	for(size_t i = 0; i < meshData.Indices32.size(); ++i)
+		welded.Indices32[i] = remap[meshData.Indices32[i]];
+
+	return welded;
+}
+
+MeshSimplifier::LodLevel MeshSimplifier::Simplify(const MeshData& meshData, const LodDesc& desc)
+{
+	MeshData mesh = Weld(meshData);
+
+	const uint32 vertexCount = (uint32)mesh.Vertices.size();
+	const uint32 triCount = (uint32)mesh.Indices32.size() / 3;
+
+	std::vector<uint32>& tris = mesh.Indices32;
+	std::vector<char> triRemoved(triCount, 0);
+	std::vector<char> vertRemoved(vertexCount, 0);
+	std::vector<uint32> stamps(vertexCount, 0);
+	std::vector<Quadric> quadrics(vertexCount);
+	std::vector<std::vector<uint32>> vertTris(vertexCount);
+	std::unordered_map<std::uint64_t, uint32> edgeUse;
+
+	auto position = [&](uint32 v) -> const XMFLOAT3&
+	{
+		return mesh.Vertices[v].Position;
+	};
+
+	//
+	// Fold the plane of every triangle into the quadrics of its three corners.
+	//
+
+	for(uint32 t = 0; t < triCount; ++t)
+	{
+		const uint32* tri = &tris[t*3];
+		for(int k = 0; k < 3; ++k)
+		{
+			vertTris[tri[k]].push_back(t);
+			edgeUse[EdgeKey(tri[k], tri[(k+1)%3])]++;
+		}
+
+		XMVECTOR n = TriangleNormal(position(tri[0]), position(tri[1]), position(tri[2]));
+		if(XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f)
+			continue;
+
+		XMFLOAT3 unit;
+		XMStoreFloat3(&unit, XMVector3Normalize(n));
+		const XMFLOAT3& p0 = position(tri[0]);
+		double d = -((double)unit.x*p0.x + (double)unit.y*p0.y + (double)unit.z*p0.z);
+
+		Quadric q = Quadric::FromPlane(unit.x, unit.y, unit.z, d, 1.0);
+		for(int k = 0; k < 3; ++k)
+			quadrics[tri[k]] += q;
+	}
+
+	//
+	// Edges used by a single triangle lie on a boundary or seam.  Add a plane through
+	// each such edge, perpendicular to its triangle, so collapses keep the outline.
+	//
+
+	for(uint32 t = 0; t < triCount; ++t)
+	{
+		const uint32* tri = &tris[t*3];
+		XMVECTOR faceNormal = TriangleNormal(position(tri[0]), position(tri[1]), position(tri[2]));
+		if(XMVectorGetX(XMVector3LengthSq(faceNormal)) <= 0.0f)
+			continue;
+
+		for(int k = 0; k < 3; ++k)
+		{
+			uint32 a = tri[k];
+			uint32 b = tri[(k+1)%3];
+			if(edgeUse[EdgeKey(a, b)] != 1)
+				continue;
+
+			XMVECTOR pa = XMLoadFloat3(&position(a));
+			XMVECTOR edge = XMVectorSubtract(XMLoadFloat3(&position(b)), pa);
+			XMVECTOR n = XMVector3Cross(edge, faceNormal);
+			if(XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f)
+				continue;
+
+			XMFLOAT3 unit;
+			XMStoreFloat3(&unit, XMVector3Normalize(n));
+			const XMFLOAT3& p = position(a);
+			double d = -((double)unit.x*p.x + (double)unit.y*p.y + (double)unit.z*p.z);
+
+			Quadric q = Quadric::FromPlane(unit.x, unit.y, unit.z, d, BoundaryWeight);
+			quadrics[a] += q;
+			quadrics[b] += q;
+		}
+	}
+
+	//
+	// Queue the cheapest direction of every edge.
+	//
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+	auto pushCandidate = [&](uint32 a, uint32 b)
+	{
+		Quadric q = quadrics[a];
+		q += quadrics[b];
+
+		double costOntoA = q.Evaluate(position(a));
+		double costOntoB = q.Evaluate(position(b));
+
+		Collapse c;
+		if(costOntoA <= costOntoB)
+		{
+			c.Cost = costOntoA;
+			c.From = b;
+			c.To = a;
+		}
+		else
+		{
+			c.Cost = costOntoB;
+			c.From = a;
+			c.To = b;
+		}
+
+		// Rounding can leave tiny negative errors on flat regions.
+		c.Cost = std::max(c.Cost, 0.0);
+		c.FromStamp = stamps[c.From];
+		c.ToStamp = stamps[c.To];
+		heap.push(c);
+	};
+
+	for(auto& e : edgeUse)
+		pushCandidate((uint32)(e.first >> 32), (uint32)(e.first & 0xffffffff));
+
+	// Gathers the live vertices sharing a triangle with v, dropping dead triangles from
+	// v's adjacency list on the way.
+	std::vector<uint32> neighboursFrom;
+	std::vector<uint32> neighboursTo;
+	auto collectNeighbours = [&](uint32 v, std::vector<uint32>& out)
+	{
+		out.clear();
+		auto& adj = vertTris[v];
+		adj.erase(std::remove_if(adj.begin(), adj.end(),
+			[&](uint32 t) { return triRemoved[t] != 0; }), adj.end());
+
+		for(uint32 t : adj)
+		{
+			for(int k = 0; k < 3; ++k)
+			{
+				uint32 w = tris[t*3+k];
+				if(w != v)
+					out.push_back(w);
+			}
+		}
+
+		std::sort(out.begin(), out.end());
+		out.erase(std::unique(out.begin(), out.end()), out.end());
+	};
+
+	auto canCollapse = [&](uint32 from, uint32 to) -> bool
+	{
+		// Link condition: the only vertices adjacent to both endpoints may be the opposite
+		// corners of the triangles that share the edge.  Anything more and the collapse
+		// would pinch the surface into a non-manifold fan.
+		collectNeighbours(from, neighboursFrom);
+		collectNeighbours(to, neighboursTo);
+
+		size_t common = 0;
+		auto i = neighboursFrom.begin();
+		auto j = neighboursTo.begin();
+		while(i != neighboursFrom.end() && j != neighboursTo.end())
+		{
+			if(*i < *j) ++i;
+			else if(*j < *i) ++j;
+			else { ++common; ++i; ++j; }
+		}
+
+		size_t shared = 0;
+		for(uint32 t : vertTris[from])
+		{
+			const uint32* tri = &tris[t*3];
+			if(tri[0] == to || tri[1] == to || tri[2] == to)
+				++shared;
+		}
+
+		if(common != shared)
+			return false;
+
+		// Reject collapses that would fold any surviving triangle over onto itself.
+		for(uint32 t : vertTris[from])
+		{
+			const uint32* tri = &tris[t*3];
+			if(tri[0] == to || tri[1] == to || tri[2] == to)
+				continue;
+
+			XMFLOAT3 p[3];
+			for(int k = 0; k < 3; ++k)
+				p[k] = position(tri[k]);
+
+			XMVECTOR before = TriangleNormal(p[0], p[1], p[2]);
+			if(XMVectorGetX(XMVector3LengthSq(before)) <= 0.0f)
+				continue;
+
+			for(int k = 0; k < 3; ++k)
+			{
+				if(tri[k] == from)
+					p[k] = position(to);
+			}
+
+			XMVECTOR after = TriangleNormal(p[0], p[1], p[2]);
+			if(XMVectorGetX(XMVector3Dot(before, after)) <= 0.0f)
+				return false;
+		}
+
+		return true;
+	};
+
+	//
+	// Collapse edges, cheapest first, until a stopping criterion is met.
+	//
+
+	uint32 liveTris = triCount;
+	double maxCost = (double)desc.MaxError*(double)desc.MaxError;
+	double worstCost = 0.0;
+
+	while(liveTris > desc.TargetTriangleCount && !heap.empty())
+	{
+		Collapse c = heap.top();
+		heap.pop();
+
+		if(vertRemoved[c.From] || vertRemoved[c.To] ||
+			stamps[c.From] != c.FromStamp || stamps[c.To] != c.ToStamp)
+			continue;
+
+		if(c.Cost > maxCost)
+			break;
+
+		if(!canCollapse(c.From, c.To))
+			continue;
+
+		for(uint32 t : vertTris[c.From])
+		{
+			uint32* tri = &tris[t*3];
+			if(tri[0] == c.To || tri[1] == c.To || tri[2] == c.To)
+			{
+				triRemoved[t] = 1;
+				--liveTris;
+				continue;
+			}
+
+			for(int k = 0; k < 3; ++k)
+			{
+				if(tri[k] == c.From)
+					tri[k] = c.To;
+			}
+			vertTris[c.To].push_back(t);
+		}
+
+		vertTris[c.From].clear();
+		vertRemoved[c.From] = 1;
+		quadrics[c.To] += quadrics[c.From];
+		++stamps[c.To];
+		worstCost = std::max(worstCost, c.Cost);
+
+		// Every edge touching the surviving vertex now has a different cost.
+		collectNeighbours(c.To, neighboursTo);
+		for(uint32 n : neighboursTo)
+			pushCandidate(c.To, n);
+	}
+
+	//
+	// Compact the surviving geometry.  Vertices are renumbered in order of first use so
+	// the output stays friendly to the post-transform vertex cache.
+	//
+
+	LodLevel level;
+	level.Error = (float)std::sqrt(worstCost);
+
+	std::vector<uint32> remap(vertexCount, UINT32_MAX);
+	level.Mesh.Indices32.reserve(liveTris*3);
+	for(uint32 t = 0; t < triCount; ++t)
+	{
+		if(triRemoved[t])
+			continue;
+
+		for(int k = 0; k < 3; ++k)
+		{
+			uint32 v = tris[t*3+k];
+			if(remap[v] == UINT32_MAX)
+			{
+				remap[v] = (uint32)level.Mesh.Vertices.size();
+				level.Mesh.Vertices.push_back(mesh.Vertices[v]);
+			}
+			level.Mesh.Indices32.push_back(remap[v]);
+		}
+	}
+
+	return level;
+}
+
+std::vector<MeshSimplifier::LodLevel> MeshSimplifier::BuildLodChain(const MeshData& meshData, const std::vector<LodDesc>& levels)
+{
+	std::vector<LodLevel> chain;
+	chain.reserve(levels.size() + 1);
+
+	LodLevel source;
+	source.Mesh = Weld(meshData);
+	chain.push_back(std::move(source));
+
+	// Simplifying from the previous level rather than the source keeps each step cheap.
+	// The errors add, so each level reports an upper bound against the source.
+	for(const LodDesc& desc : levels)
+	{
+		LodLevel next = Simplify(chain.back().Mesh, desc);
+		next.Error += chain.back().Error;
+		chain.push_back(std::move(next));
+	}
+
+	return chain;
+}
+
+LodSelector::LodSelector(const std::vector<float>& switchDistances, float hysteresis)
+{
+	for(float distance : switchDistances)
+	{
+		float coarser = distance*(1.0f + hysteresis);
+		float finer = distance*(1.0f - hysteresis);
+		mCoarserSq.push_back(coarser*coarser);
+		mFinerSq.push_back(finer*finer);
+	}
+}
+
+GeometryGenerator::uint32 LodSelector::Select(float distanceSq, GeometryGenerator::uint32 currentLod)const
+{
+	GeometryGenerator::uint32 lod = std::min(currentLod, LevelCount() - 1);
+
+	while(lod < mCoarserSq.size() && distanceSq > mCoarserSq[lod])
+		++lod;
+
+	while(lod > 0 && distanceSq < mFinerSq[lod-1])
+		--lod;
+
+	return lod;
+}
+
+GeometryGenerator::uint32 LodSelector::LevelCount()const
+{
+	return (GeometryGenerator::uint32)mCoarserSq.size() + 1;
+}
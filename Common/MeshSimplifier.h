@@ -0,0 +1,79 @@
+//***************************************************************************************
+// MeshSimplifier.h
+//
+// Builds chains of progressively coarser meshes from GeometryGenerator::MeshData by
+// collapsing edges in order of their quadric error (Garland & Heckbert, 1997), and picks
+// between the levels of such a chain based on viewing distance.
+//
+// Collapses are restricted to moving one endpoint of an edge onto the other, so every
+// surviving vertex keeps its original normal, tangent and texture coordinates.  Edges on
+// an open boundary or an attribute seam (e.g. where two faces of a box meet with
+// different texture coordinates) are held in place by penalty planes.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <cfloat>
+
+class MeshSimplifier
+{
+public:
+
+	using uint32 = GeometryGenerator::uint32;
+	using MeshData = GeometryGenerator::MeshData;
+
+	// Stopping criteria for one level of detail.  Edges are collapsed until the triangle
+	// count drops to TargetTriangleCount or the cheapest remaining collapse would move
+	// the surface further than MaxError, whichever happens first.
+	struct LodDesc
+	{
+		uint32 TargetTriangleCount = 0;
+		float MaxError = FLT_MAX;
+	};
+
+	struct LodLevel
+	{
+		MeshData Mesh;
+
+		// Approximate distance (in mesh units) this level deviates from the source.
+		float Error = 0.0f;
+	};
+
+	///<summary>
+	/// Merges vertices whose position, normal, tangent and texture coordinates are all
+	/// identical.  Generators such as CreateBox() and Subdivide() emit unshared vertices,
+	/// which would otherwise leave no edges to collapse.
+	///</summary>
+	static MeshData Weld(const MeshData& meshData);
+
+	///<summary>
+	/// Produces a single simplified copy of meshData.
+	///</summary>
+	static LodLevel Simplify(const MeshData& meshData, const LodDesc& desc);
+
+	///<summary>
+	/// Builds a chain of levels where level 0 is the welded source mesh and every level
+	/// after it is simplified from the one before, according to levels[i-1].
+	///</summary>
+	static std::vector<LodLevel> BuildLodChain(const MeshData& meshData, const std::vector<LodDesc>& levels);
+};
+
+// Chooses a level of detail from the squared distance between the eye and an object.
+// Level i is used while the distance is below switchDistances[i]; the last level is used
+// beyond the final switch distance.  A hysteresis band around each switch distance stops
+// objects resting on a boundary from flickering between two levels every frame.
+class LodSelector
+{
+public:
+	LodSelector() = default;
+	LodSelector(const std::vector<float>& switchDistances, float hysteresis = 0.1f);
+
+	GeometryGenerator::uint32 Select(float distanceSq, GeometryGenerator::uint32 currentLod)const;
+	GeometryGenerator::uint32 LevelCount()const;
+
+private:
+	// Squared distances at which to step to the next coarser / finer level.
+	std::vector<float> mCoarserSq;
+	std::vector<float> mFinerSq;
+};
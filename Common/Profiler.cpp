@@ -0,0 +1,222 @@
+//***************************************************************************************
+// Profiler.cpp
+//***************************************************************************************
+
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROFILER_USE_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+static_assert((Profiler::RingCapacity & (Profiler::RingCapacity - 1)) == 0, "RingCapacity must be a power of two");
+
+std::atomic<bool> Profiler::sEnabled(true);
+
+namespace
+{
+	// A zone's fields are atomic only so the thread writing a trace can read them while
+	// their owner overwrites them; relaxed stores of them are plain stores.
+	struct Slot
+	{
+		std::atomic<const char*> Name;
+		std::atomic<std::int64_t> Start;
+		std::atomic<std::int64_t> End;
+	};
+
+	// One thread's zones.  Written like FrameTimeRing: the owner claims a slot before it
+	// overwrites it and publishes it after, so a reader can tell which of the slots it
+	// copied were overwritten under it.
+	struct ThreadRing
+	{
+		std::array<Slot, Profiler::RingCapacity> Slots;
+		std::atomic<std::uint64_t> Count{ 0 };
+		std::atomic<std::uint64_t> Claimed{ 0 };
+		std::atomic<const char*> Name{ nullptr };
+		int Id = 0;
+	};
+
+	// Every thread's ring, kept after the thread exits so its zones can still be written
+	// out, and the times the profiler started at on both its clock and steady_clock.
+	struct Registry
+	{
+		std::mutex Lock;
+		std::vector<std::unique_ptr<ThreadRing>> Rings;
+		std::int64_t StartTicks = Profiler::Now();
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	};
+
+	Registry& Rings()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	// Start the clocks with the program rather than with the first zone, so no zone starts
+	// before them
+	const Registry& gStartup = Rings();
+
+	thread_local ThreadRing* tRing = nullptr;
+
+	ThreadRing& ThisThreadRing()
+	{
+		if(tRing == nullptr)
+		{
+			Registry& registry = Rings();
+			std::lock_guard<std::mutex> lock(registry.Lock);
+			registry.Rings.push_back(std::make_unique<ThreadRing>());
+			tRing = registry.Rings.back().get();
+			tRing->Id = (int)registry.Rings.size();
+		}
+		return *tRing;
+	}
+
+	void WriteName(std::ostream& out, const char* name)
+	{
+		for(const char* c = name; *c != '\0'; ++c)
+		{
+			if(*c == '"' || *c == '\\')
+				out << '\\';
+			out << *c;
+		}
+	}
+}
+
+std::int64_t Profiler::Now()
+{
+#if defined(PROFILER_USE_TSC)
+	return (std::int64_t)__rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+double Profiler::NanosecondsPerTick()
+{
+#if defined(PROFILER_USE_TSC)
+	// The timestamp counter runs at a fixed rate on any processor new enough to run D3D12,
+	// but the rate has to be measured.  Give it at least 10ms to settle.
+	Registry& registry = Rings();
+	std::chrono::steady_clock::time_point now;
+	std::int64_t ticks;
+	do
+	{
+		now = std::chrono::steady_clock::now();
+		ticks = Now();
+	} while(now - registry.StartTime < std::chrono::milliseconds(10));
+
+	double ns = std::chrono::duration<double, std::nano>(now - registry.StartTime).count();
+	return ns / (double)(ticks - registry.StartTicks);
+#else
+	return 1.0;
+#endif
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::Record(const char* name, std::int64_t start, std::int64_t end)
+{
+	ThreadRing& ring = ThisThreadRing();
+
+	std::uint64_t count = ring.Count.load(std::memory_order_relaxed);
+	ring.Claimed.store(count + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Slot& slot = ring.Slots[count & (RingCapacity - 1)];
+	slot.Name.store(name, std::memory_order_relaxed);
+	slot.Start.store(start, std::memory_order_relaxed);
+	slot.End.store(end, std::memory_order_relaxed);
+	ring.Count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThisThreadRing().Name.store(name, std::memory_order_relaxed);
+}
+
+size_t Profiler::WriteChromeTrace(std::ostream& out)
+{
+	// Rings are never removed, so once copied out from under the lock the pointers stay
+	// good while threads carry on registering
+	std::vector<ThreadRing*> rings;
+	Registry& registry = Rings();
+	{
+		std::lock_guard<std::mutex> lock(registry.Lock);
+		for(auto& ring : registry.Rings)
+			rings.push_back(ring.get());
+	}
+
+	double nsPerTick = NanosecondsPerTick();
+	std::vector<std::array<std::int64_t, 2>> times(RingCapacity);
+	std::vector<const char*> names(RingCapacity);
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	out.setf(std::ios::fixed);
+	out.precision(3);
+
+	size_t written = 0;
+	for(ThreadRing* ring : rings)
+	{
+		const char* threadName = ring->Name.load(std::memory_order_relaxed);
+		out << (ring != rings.front() ? ",\n" : "")
+			<< "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << ring->Id << ",\"args\":{\"name\":\"";
+		if(threadName != nullptr)
+			WriteName(out, threadName);
+		else
+			out << "Thread " << ring->Id;
+		out << "\"}}";
+
+		std::uint64_t end = ring->Count.load(std::memory_order_acquire);
+		std::uint64_t begin = end > RingCapacity ? end - RingCapacity : 0;
+		for(std::uint64_t i = begin; i < end; ++i)
+		{
+			const Slot& slot = ring->Slots[i & (RingCapacity - 1)];
+			names[i - begin] = slot.Name.load(std::memory_order_relaxed);
+			times[i - begin] = { slot.Start.load(std::memory_order_relaxed), slot.End.load(std::memory_order_relaxed) };
+		}
+
+		// Skip any slot the owner has claimed again since the copy started
+		std::atomic_thread_fence(std::memory_order_acquire);
+		std::uint64_t claimed = ring->Claimed.load(std::memory_order_relaxed);
+		std::uint64_t firstValid = std::max(begin, claimed > RingCapacity ? claimed - RingCapacity : 0);
+
+		for(std::uint64_t i = firstValid; i < end; ++i)
+		{
+			const auto& t = times[i - begin];
+			double startUs = (double)(t[0] - registry.StartTicks) * nsPerTick * 1.0e-3;
+			double durationUs = (double)(t[1] - t[0]) * nsPerTick * 1.0e-3;
+
+			out << ",\n{\"ph\":\"X\",\"name\":\"";
+			WriteName(out, names[i - begin]);
+			out << "\",\"pid\":1,\"tid\":" << ring->Id << ",\"ts\":" << startUs << ",\"dur\":" << durationUs << "}";
+			++written;
+		}
+	}
+
+	out << "\n]}\n";
+	return written;
+}
+
+std::uint64_t Profiler::RecordedCount()
+{
+	Registry& registry = Rings();
+	std::lock_guard<std::mutex> lock(registry.Lock);
+
+	std::uint64_t count = 0;
+	for(auto& ring : registry.Rings)
+		count += ring->Count.load(std::memory_order_acquire);
+	return count;
+}
@@ -0,0 +1,92 @@
+//***************************************************************************************
+// Profiler.h
+//
+// Scoped profiling zones for the hot path.  A zone is a local object made with
+// PROFILE_ZONE("Name"): it reads the time when it is made and again when it goes out of
+// scope, and records the pair into a ring that belongs to the calling thread, so threads
+// never contend and nothing is locked or allocated per zone.  The newest zones of every
+// thread can be written out at any time as a Chrome trace, to open in chrome://tracing or
+// Perfetto.
+//
+// Times are read from the CPU's timestamp counter on x86 and x64, and converted to
+// nanoseconds when written out; elsewhere they come from std::chrono::steady_clock.
+//***************************************************************************************
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+class Profiler
+{
+public:
+	// Zones each thread keeps before overwriting its oldest.  Must be a power of two.
+	static const size_t RingCapacity = 65536;
+
+	class Zone
+	{
+	public:
+		// name must outlive the profiler; a string literal is the usual choice.
+		explicit Zone(const char* name)
+			: mName(name), mStart(Profiler::Enabled() ? Profiler::Now() : -1)
+		{
+		}
+
+		~Zone()
+		{
+			if(mStart >= 0)
+				Profiler::Record(mName, mStart, Profiler::Now());
+		}
+
+		Zone(const Zone& rhs) = delete;
+		Zone& operator=(const Zone& rhs) = delete;
+
+	private:
+		const char* mName;
+		std::int64_t mStart;
+	};
+
+	// Raw timestamp, in ticks of the profiler's clock.
+	static std::int64_t Now();
+
+	// Nanoseconds per tick, measured against steady_clock since the profiler first ran.
+	static double NanosecondsPerTick();
+
+	// Zones made while the profiler is disabled record nothing.  It starts enabled.
+	static void SetEnabled(bool enabled);
+	static bool Enabled()
+	{
+		return sEnabled.load(std::memory_order_relaxed);
+	}
+
+	///<summary>
+	/// Records a zone on the calling thread's ring.  Zone calls this; call it directly to
+	/// record a span timed some other way.
+	///</summary>
+	static void Record(const char* name, std::int64_t start, std::int64_t end);
+
+	// Names the calling thread in the trace.  name must outlive the profiler.
+	static void SetThreadName(const char* name);
+
+	///<summary>
+	/// Writes the zones every thread still holds as Chrome trace JSON, in microseconds
+	/// since the profiler first ran.  Safe to call while other threads record; a zone
+	/// overwritten part way through the copy is left out.  Returns the number written.
+	///</summary>
+	static size_t WriteChromeTrace(std::ostream& out);
+
+	// Zones recorded by every thread since they started, including those overwritten.
+	static std::uint64_t RecordedCount();
+
+private:
+	static std::atomic<bool> sEnabled;
+};
+
+#define PROFILE_ZONE_CONCAT_(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_(a, b)
+
+// Times the rest of the enclosing scope as a zone called name.
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
@@ -0,0 +1,220 @@
+//***************************************************************************************
+// RandomEngine.cpp
+//***************************************************************************************
+
+#include "RandomEngine.h"
+#include <atomic>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// Spreads a 64 bit seed over the generator state; see Vigna's splitmix64.
+	std::uint64_t SplitMix64(std::uint64_t& x)
+	{
+		std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	// Floats in [0, 1) use the top 24 bits, which are the best ones xoshiro128+ makes
+	const float UnitFloatScale = 1.0f / 16777216.0f;
+
+#if defined(_XM_SSE_INTRINSICS_)
+	// Advances all four streams one xoshiro128+ step and returns their outputs.
+	__m128i Step(std::uint32_t (&state)[4][4])
+	{
+		__m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[0]));
+		__m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[1]));
+		__m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[2]));
+		__m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[3]));
+
+		__m128i result = _mm_add_epi32(s0, s3);
+		__m128i t = _mm_slli_epi32(s1, 9);
+
+		s2 = _mm_xor_si128(s2, s0);
+		s3 = _mm_xor_si128(s3, s1);
+		s1 = _mm_xor_si128(s1, s2);
+		s0 = _mm_xor_si128(s0, s3);
+		s2 = _mm_xor_si128(s2, t);
+		s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+		_mm_store_si128(reinterpret_cast<__m128i*>(state[0]), s0);
+		_mm_store_si128(reinterpret_cast<__m128i*>(state[1]), s1);
+		_mm_store_si128(reinterpret_cast<__m128i*>(state[2]), s2);
+		_mm_store_si128(reinterpret_cast<__m128i*>(state[3]), s3);
+		return result;
+	}
+#else
+	void Step(std::uint32_t (&state)[4][4], std::uint32_t* out)
+	{
+		for(int lane = 0; lane < 4; ++lane)
+		{
+			std::uint32_t s0 = state[0][lane], s1 = state[1][lane], s2 = state[2][lane], s3 = state[3][lane];
+
+			out[lane] = s0 + s3;
+			std::uint32_t t = s1 << 9;
+
+			s2 ^= s0;
+			s3 ^= s1;
+			s1 ^= s2;
+			s0 ^= s3;
+			s2 ^= t;
+			s3 = (s3 << 11) | (s3 >> 21);
+
+			state[0][lane] = s0;
+			state[1][lane] = s1;
+			state[2][lane] = s2;
+			state[3][lane] = s3;
+		}
+	}
+#endif
+}
+
+RandomEngine::RandomEngine(std::uint64_t seed)
+{
+	Seed(seed);
+}
+
+void RandomEngine::Seed(std::uint64_t seed)
+{
+	for(int lane = 0; lane < 4; ++lane)
+	{
+		std::uint64_t a = SplitMix64(seed);
+		std::uint64_t b = SplitMix64(seed);
+		mState[0][lane] = (std::uint32_t)a;
+		mState[1][lane] = (std::uint32_t)(a >> 32);
+		mState[2][lane] = (std::uint32_t)b;
+		mState[3][lane] = (std::uint32_t)(b >> 32);
+	}
+
+	mBuffered = 0;
+}
+
+void RandomEngine::Refill()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	_mm_store_si128(reinterpret_cast<__m128i*>(mBuffer), Step(mState));
+#else
+	Step(mState, mBuffer);
+#endif
+	mBuffered = 4;
+}
+
+std::uint32_t RandomEngine::NextUInt()
+{
+	if(mBuffered == 0)
+		Refill();
+
+	return mBuffer[--mBuffered];
+}
+
+float RandomEngine::NextFloat()
+{
+	return (float)(NextUInt() >> 8) * UnitFloatScale;
+}
+
+float RandomEngine::NextFloat(float a, float b)
+{
+	return a + NextFloat()*(b - a);
+}
+
+int RandomEngine::NextInt(int a, int b)
+{
+	// Scale into the range with a multiply rather than %, which favours small numbers
+	// and is slow
+	std::uint32_t range = (std::uint32_t)b - (std::uint32_t)a + 1;
+	if(range == 0)
+		return (int)NextUInt();
+
+	return (int)((std::uint32_t)a + (std::uint32_t)(((std::uint64_t)NextUInt() * range) >> 32));
+}
+
+XMVECTOR RandomEngine::NextFloat4()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	__m128i bits = _mm_srli_epi32(Step(mState), 8);
+	return _mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set_ps1(UnitFloatScale));
+#else
+	std::uint32_t bits[4];
+	Step(mState, bits);
+	return XMVectorSet(
+		(float)(bits[0] >> 8) * UnitFloatScale,
+		(float)(bits[1] >> 8) * UnitFloatScale,
+		(float)(bits[2] >> 8) * UnitFloatScale,
+		(float)(bits[3] >> 8) * UnitFloatScale);
+#endif
+}
+
+XMVECTOR RandomEngine::NextUnitVec3()
+{
+	// A height evenly spread over [-1, 1] and an angle evenly spread around it cover the
+	// sphere evenly, since every band of the same height has the same area
+	float z = 2.0f*NextFloat() - 1.0f;
+	float angle = XM_2PI*NextFloat();
+	float r = sqrtf(fmaxf(0.0f, 1.0f - z*z));
+
+	return XMVectorSet(r*cosf(angle), r*sinf(angle), z, 0.0f);
+}
+
+void RandomEngine::UnitVec3x4(XMVECTOR& x, XMVECTOR& y, XMVECTOR& z)
+{
+	XMVECTOR u = NextFloat4();
+	XMVECTOR v = NextFloat4();
+
+	// As NextUnitVec3, with the angle in [-pi, pi) where XMVectorSinCos is most accurate
+	z = XMVectorMultiplyAdd(u, XMVectorReplicate(2.0f), XMVectorReplicate(-1.0f));
+	XMVECTOR angle = XMVectorMultiplyAdd(v, XMVectorReplicate(XM_2PI), XMVectorReplicate(-XM_PI));
+	XMVECTOR r = XMVectorSqrt(XMVectorMax(XMVectorZero(), XMVectorNegativeMultiplySubtract(z, z, XMVectorSplatOne())));
+
+	XMVECTOR sinAngle, cosAngle;
+	XMVectorSinCos(&sinAngle, &cosAngle, angle);
+	x = XMVectorMultiply(r, cosAngle);
+	y = XMVectorMultiply(r, sinAngle);
+}
+
+void RandomEngine::FillFloats(float* out, size_t count, float a, float b)
+{
+	XMVECTOR scale = XMVectorReplicate(b - a);
+	XMVECTOR offset = XMVectorReplicate(a);
+
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(out + i), XMVectorMultiplyAdd(NextFloat4(), scale, offset));
+
+	for(; i < count; ++i)
+		out[i] = NextFloat(a, b);
+}
+
+void RandomEngine::FillUnitVec3(XMFLOAT3* out, size_t count)
+{
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		XMVECTOR x, y, z;
+		UnitVec3x4(x, y, z);
+
+		XMFLOAT4 xs, ys, zs;
+		XMStoreFloat4(&xs, x);
+		XMStoreFloat4(&ys, y);
+		XMStoreFloat4(&zs, z);
+
+		out[i + 0] = XMFLOAT3(xs.x, ys.x, zs.x);
+		out[i + 1] = XMFLOAT3(xs.y, ys.y, zs.y);
+		out[i + 2] = XMFLOAT3(xs.z, ys.z, zs.z);
+		out[i + 3] = XMFLOAT3(xs.w, ys.w, zs.w);
+	}
+
+	for(; i < count; ++i)
+		XMStoreFloat3(&out[i], NextUnitVec3());
+}
+
+RandomEngine& RandomEngine::ThreadLocal()
+{
+	// Threads take seeds in the order they first ask, so each gets its own sequence
+	static std::atomic<std::uint64_t> nextSeed(DefaultSeed);
+	thread_local RandomEngine engine(nextSeed.fetch_add(0x9e3779b97f4a7c15ull));
+	return engine;
+}
@@ -0,0 +1,75 @@
+//***************************************************************************************
+// RandomEngine.h
+//
+// Seedable xoshiro128+ generator, run as four independent streams side by side so one
+// step gives four numbers from a single SSE register.  Batches of floats and unit vectors
+// are generated four at a time; single numbers are handed out from the last batch.
+//
+// An engine must only be used from one thread at a time.  ThreadLocal() gives every
+// thread its own, so the MathHelper random functions are safe to call from anywhere.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+
+class RandomEngine
+{
+public:
+	static const std::uint64_t DefaultSeed = 0x853c49e6748fea9bull;
+
+	explicit RandomEngine(std::uint64_t seed = DefaultSeed);
+
+	///<summary>
+	/// Restarts the engine.  The same seed always gives the same sequence.
+	///</summary>
+	void Seed(std::uint64_t seed);
+
+	std::uint32_t NextUInt();
+
+	// Returns random float in [0, 1).
+	float NextFloat();
+
+	// Returns random float in [a, b).
+	float NextFloat(float a, float b);
+
+	// Returns random int in [a, b].
+	int NextInt(int a, int b);
+
+	// Returns four random floats in [0, 1).
+	DirectX::XMVECTOR NextFloat4();
+
+	// Returns a random unit vector, evenly spread over the sphere, with w = 0.
+	DirectX::XMVECTOR NextUnitVec3();
+
+	///<summary>
+	/// Fills out with count random floats in [a, b).
+	///</summary>
+	void FillFloats(float* out, size_t count, float a = 0.0f, float b = 1.0f);
+
+	///<summary>
+	/// Fills out with count random unit vectors, evenly spread over the sphere.  Each is
+	/// made from two uniform numbers directly, so unlike picking points in a cube and
+	/// throwing away those outside the sphere every batch takes the same time.
+	///</summary>
+	void FillUnitVec3(DirectX::XMFLOAT3* out, size_t count);
+
+	///<summary>
+	/// The calling thread's engine.  Each thread's is seeded differently the first time
+	/// it asks.
+	///</summary>
+	static RandomEngine& ThreadLocal();
+
+private:
+	void Refill();
+	void UnitVec3x4(DirectX::XMVECTOR& x, DirectX::XMVECTOR& y, DirectX::XMVECTOR& z);
+
+	// mState[word][stream]: the four words of each stream's state, one stream per lane
+	alignas(16) std::uint32_t mState[4][4];
+
+	// The outputs of the last step, handed out one at a time
+	alignas(16) std::uint32_t mBuffer[4];
+	int mBuffered = 0;
+};
@@ -0,0 +1,131 @@
+//***************************************************************************************
+// RayPicker.cpp
+//***************************************************************************************
+
+#include "RayPicker.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace DirectX;
+
+PickRay PickRay::FromScreen(float x, float y, float width, float height, FXMMATRIX view, CXMMATRIX proj)
+{
+	// Take the pixel to normalized device coordinates, then back through the projection
+	// and view to the points it covers on the near and far planes
+	float ndcX = 2.0f*x / width - 1.0f;
+	float ndcY = 1.0f - 2.0f*y / height;
+
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+	XMMATRIX invViewProj = XMMatrixInverse(nullptr, viewProj);
+
+	XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), invViewProj);
+	XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), invViewProj);
+
+	PickRay ray;
+	XMStoreFloat3(&ray.Origin, nearPoint);
+	XMStoreFloat3(&ray.Direction, XMVector3Normalize(XMVectorSubtract(farPoint, nearPoint)));
+	return ray;
+}
+
+void RayPicker::Resize(std::uint32_t count)
+{
+	mBoxes.resize(count);
+}
+
+std::uint32_t RayPicker::Size()const
+{
+	return (std::uint32_t)mBoxes.size();
+}
+
+void RayPicker::Set(std::uint32_t item, const BoundingBox& localBounds, FXMMATRIX world)
+{
+	assert(item < mBoxes.size());
+	Box& box = mBoxes[item];
+
+	XMMATRIX invWorld = XMMatrixInverse(nullptr, world);
+	XMStoreFloat4x4(&box.InvWorld, invWorld);
+	XMStoreFloat4x4(&box.NormalToWorld, XMMatrixTranspose(invWorld));
+
+	XMVECTOR c = XMLoadFloat3(&localBounds.Center);
+	XMVECTOR e = XMLoadFloat3(&localBounds.Extents);
+	XMStoreFloat3(&box.Min, XMVectorSubtract(c, e));
+	XMStoreFloat3(&box.Max, XMVectorAdd(c, e));
+}
+
+bool RayPicker::Intersect(std::uint32_t item, FXMVECTOR origin, FXMVECTOR direction,
+	float& distance, int& axis, float& sign)const
+{
+	const Box& box = mBoxes[item];
+
+	// Move the ray into the box's space rather than the box into the world.  The direction
+	// is not renormalized, so distances along it are still world distances.
+	XMMATRIX invWorld = XMLoadFloat4x4(&box.InvWorld);
+	XMVECTOR o = XMVector3TransformCoord(origin, invWorld);
+	XMVECTOR d = XMVector3TransformNormal(direction, invWorld);
+
+	// Test all three slabs at once
+	XMVECTOR invD = XMVectorReciprocal(d);
+	XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&box.Min), o), invD);
+	XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&box.Max), o), invD);
+
+	XMFLOAT3 tNear, tFar, dir;
+	XMStoreFloat3(&tNear, XMVectorMin(t1, t2));
+	XMStoreFloat3(&tFar, XMVectorMax(t1, t2));
+	XMStoreFloat3(&dir, d);
+
+	// The ray is inside the box between entering the last slab and leaving the first
+	int enterAxis = 0;
+	float enter = tNear.x;
+	if(tNear.y > enter) { enterAxis = 1; enter = tNear.y; }
+	if(tNear.z > enter) { enterAxis = 2; enter = tNear.z; }
+
+	float exit = std::min(tFar.x, std::min(tFar.y, tFar.z));
+	if(enter > exit || exit < 0.0f)
+		return false;
+
+	distance = std::max(enter, 0.0f);
+	axis = enterAxis;
+	sign = (&dir.x)[enterAxis] > 0.0f ? -1.0f : 1.0f;
+	return true;
+}
+
+bool RayPicker::Pick(const Bvh& bvh, const PickRay& ray, float maxDistance, PickHit& hit)const
+{
+	assert(bvh.Size() == Size());
+
+	XMVECTOR origin = XMLoadFloat3(&ray.Origin);
+	XMVECTOR direction = XMLoadFloat3(&ray.Direction);
+
+	// The tree only offers boxes whose world bounds the ray enters before the closest hit
+	// so far, so most boxes are never tested
+	int hitAxis = 0;
+	float hitSign = 1.0f;
+	auto test = [&](std::uint32_t item, FXMVECTOR o, FXMVECTOR d, float& t)
+	{
+		float closest = t;
+		int axis;
+		float sign;
+		if(!Intersect(item, o, d, t, axis, sign) || t > closest)
+			return false;
+
+		hitAxis = axis;
+		hitSign = sign;
+		return true;
+	};
+
+	std::uint32_t item;
+	float distance;
+	if(!bvh.RayCast(origin, direction, maxDistance, test, item, distance))
+		return false;
+
+	XMFLOAT3 localNormal(0.0f, 0.0f, 0.0f);
+	(&localNormal.x)[hitAxis] = hitSign;
+	XMMATRIX normalToWorld = XMLoadFloat4x4(&mBoxes[item].NormalToWorld);
+	XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&localNormal), normalToWorld));
+
+	hit.Item = item;
+	hit.Distance = distance;
+	XMStoreFloat3(&hit.Point, XMVectorMultiplyAdd(direction, XMVectorReplicate(distance), origin));
+	XMStoreFloat3(&hit.Normal, normal);
+	return true;
+}
@@ -0,0 +1,81 @@
+//***************************************************************************************
+// RayPicker.h
+//
+// Picks boxes that have been moved into the world by arbitrary affine matrices, such as
+// cubies part way through a turn, with a ray cast from the screen.  The boxes are indexed
+// like the items of a Bvh built over their world bounds; the tree finds the boxes the ray
+// could hit, nearest first, and each is then tested exactly in its own local space.
+//
+// Nothing here touches the window or the GPU, so picks can be checked from a console.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+#include "Bvh.h"
+
+struct PickRay
+{
+	DirectX::XMFLOAT3 Origin;
+	DirectX::XMFLOAT3 Direction;  // Unit length
+
+	///<summary>
+	/// The ray through pixel (x, y) of a width by height viewport, starting on the near
+	/// plane and in world space.
+	///</summary>
+	static PickRay FromScreen(float x, float y, float width, float height,
+		DirectX::FXMMATRIX view, DirectX::CXMMATRIX proj);
+};
+
+struct PickHit
+{
+	std::uint32_t Item = 0;
+	float Distance = 0.0f;
+	DirectX::XMFLOAT3 Point = { 0.0f, 0.0f, 0.0f };
+
+	// Outward normal of the face the ray entered through, in world space
+	DirectX::XMFLOAT3 Normal = { 0.0f, 0.0f, 0.0f };
+};
+
+class RayPicker
+{
+public:
+	void Resize(std::uint32_t count);
+	std::uint32_t Size()const;
+
+	///<summary>
+	/// Places item's box, given in local space, in the world with the world matrix.  The
+	/// inverse is worked out here so picking never has to.
+	///</summary>
+	void Set(std::uint32_t item, const DirectX::BoundingBox& localBounds, DirectX::FXMMATRIX world);
+
+	///<summary>
+	/// Finds the nearest box the ray hits within maxDistance, using bvh, which must be
+	/// built over the world bounds of the same items, to skip the rest.
+	///</summary>
+	bool Pick(const Bvh& bvh, const PickRay& ray, float maxDistance, PickHit& hit)const;
+
+	///<summary>
+	/// Tests the ray against one box.  On a hit sets distance, and the local axis
+	/// (0 = x, 1 = y, 2 = z) and sign of the face it entered through.
+	///</summary>
+	bool Intersect(std::uint32_t item, DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction,
+		float& distance, int& axis, float& sign)const;
+
+private:
+	struct Box
+	{
+		DirectX::XMFLOAT4X4 InvWorld;
+
+		// Turns local normals into world normals: the transpose of InvWorld
+		DirectX::XMFLOAT4X4 NormalToWorld;
+
+		DirectX::XMFLOAT3 Min;
+		DirectX::XMFLOAT3 Max;
+	};
+
+	std::vector<Box> mBoxes;
+};
@@ -0,0 +1,65 @@
+//***************************************************************************************
+// RenderCommands.h
+//
+// The commands the app records to draw a frame, without saying what records them.
+// D3D12RenderCommands passes them on to a D3D12 command list; the headless runner keeps
+// them instead.  Resources and pipeline states are only ever passed back to whatever
+// made them, so they are opaque pointers here, and GPU addresses and descriptors are
+// plain numbers.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+
+class RenderCommands
+{
+public:
+	// The states a back buffer moves between over a frame.
+	enum ResourceState
+	{
+		StatePresent,
+		StateRenderTarget
+	};
+
+	enum Topology
+	{
+		TriangleList
+	};
+
+	struct VertexBufferView
+	{
+		std::uint64_t Address = 0;
+		std::uint32_t ByteSize = 0;
+		std::uint32_t Stride = 0;
+	};
+
+	struct IndexBufferView
+	{
+		std::uint64_t Address = 0;
+		std::uint32_t ByteSize = 0;
+
+		// 32 bit indices rather than 16
+		bool Wide = false;
+	};
+
+	virtual ~RenderCommands() = default;
+
+	virtual void Barrier(const void* resource, ResourceState before, ResourceState after) = 0;
+	virtual void SetPipelineState(const void* pipelineState) = 0;
+
+	///<summary>
+	/// Binds a root parameter of the current root signature: a table of descriptors
+	/// starting at a GPU descriptor handle, or a constant or shader resource view at a GPU
+	/// virtual address.
+	///</summary>
+	virtual void SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor) = 0;
+	virtual void SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address) = 0;
+	virtual void SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address) = 0;
+
+	virtual void SetVertexBuffer(const VertexBufferView& view) = 0;
+	virtual void SetIndexBuffer(const IndexBufferView& view) = 0;
+	virtual void SetPrimitiveTopology(Topology topology) = 0;
+
+	virtual void DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex) = 0;
+};
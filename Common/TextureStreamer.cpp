@@ -0,0 +1,380 @@
+//***************************************************************************************
+// TextureStreamer.cpp
+//***************************************************************************************
+
+#include "TextureStreamer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+	const std::uint64_t PageBytes = 4096;
+
+	// Mips are only dropped from textures needed less than half as much as the one they
+	// make room for.  Dropping a mip doubles how much a texture is needed and adding one
+	// halves it, so two textures can never take the same room back and forth.
+	const float EvictionRatio = 0.5f;
+
+	// What the page reads summed to, kept so they are not optimised away
+	std::atomic<std::uint64_t> gPageSum{ 0 };
+
+	// Reads a byte of every page, so the OS faults them in from disk here rather than on
+	// the thread that copies them out
+	std::uint64_t ReadPages(const std::uint8_t* data, std::uint64_t bytes)
+	{
+		std::uint64_t sum = 0;
+		for (std::uint64_t offset = 0; offset < bytes; offset += PageBytes)
+			sum += data[offset];
+		return bytes > 0 ? sum + data[bytes - 1] : sum;
+	}
+
+	std::uint64_t SurfaceBytes(const DDSFile::Surface& surface)
+	{
+		return surface.SlicePitch * surface.Depth;
+	}
+}
+
+TextureStreamer::TextureStreamer(TextureUploadSink& sink, std::uint64_t budgetBytes, unsigned workerCount,
+	std::uint64_t mipTailBytes, std::uint64_t uploadBytesPerUpdate)
+	: mSink(sink), mBudgetBytes(budgetBytes), mMipTailBytes(mipTailBytes), mUploadBytesPerUpdate(uploadBytesPerUpdate)
+{
+	for (unsigned i = 0; i < workerCount; ++i)
+		mWorkers.emplace_back(&TextureStreamer::WorkerMain, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWorkReady.notify_all();
+	for (std::thread& worker : mWorkers)
+		worker.join();
+}
+
+TextureStreamer::Handle TextureStreamer::Request(const std::wstring& filename)
+{
+	Handle handle = (Handle)mTextures.size();
+	auto texture = std::make_unique<TextureState>();
+	texture->Filename = filename;
+	mTextures.push_back(std::move(texture));
+
+	Job job;
+	job.Type = Job::Parse;
+	job.Texture = handle;
+	job.Filename = filename;
+	Queue(std::move(job));
+	return handle;
+}
+
+void TextureStreamer::SetScreenSize(Handle texture, float texels)
+{
+	if (texture < mTextures.size())
+		mTextures[texture]->ScreenTexels = texels;
+}
+
+void TextureStreamer::Update()
+{
+	PROFILE_ZONE("TextureStreamer::Update");
+
+	// Without workers, the work queued so far is done here
+	if (mWorkers.empty())
+	{
+		while (!mJobs.empty())
+		{
+			mResults.push_back(Run(mJobs.front()));
+			mJobs.pop_front();
+		}
+	}
+
+	std::vector<Result> results;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		results.swap(mResults);
+	}
+
+	mUploadedBytes = 0;
+	for (Result& result : results)
+		Finish(result);
+
+	// Finer mips for the textures that need them, the most needed first
+	std::vector<Handle> order;
+	for (Handle h = 0; h < mTextures.size(); ++h)
+	{
+		const TextureState& texture = *mTextures[h];
+		if (texture.Parsed && !texture.Failed && texture.ResidentMip > WantedMip(texture))
+			order.push_back(h);
+	}
+	std::stable_sort(order.begin(), order.end(), [this](Handle a, Handle b)
+	{
+		return Priority(*mTextures[a], mTextures[a]->ResidentMip) > Priority(*mTextures[b], mTextures[b]->ResidentMip);
+	});
+
+	for (Handle h : order)
+	{
+		TextureState& texture = *mTextures[h];
+		const std::uint32_t next = texture.ResidentMip - 1;
+
+		// The next mip is only made resident once its pages are in, within this
+		// Update's share of uploads and the budget
+		if (texture.LoadedMip <= next)
+		{
+			const std::uint64_t extra = texture.ChainBytes[next] - texture.ChainBytes[texture.ResidentMip];
+			const bool withinUploads = mUploadedBytes == 0 ||
+				mUploadedBytes + texture.ChainBytes[next] <= mUploadBytesPerUpdate;
+			if (withinUploads && (mResidentBytes + extra <= mBudgetBytes || MakeRoom(h, extra)))
+				Resident(h, next);
+		}
+
+		// A texture the sink could not take, here or making room, is streamed no further
+		if (texture.Failed)
+			continue;
+
+		// Reads the pages of the mip after the next one in while this one is uploaded
+		if (!texture.Loading && texture.LoadedMip >= texture.ResidentMip && texture.LoadedMip > WantedMip(texture))
+		{
+			Job job;
+			job.Type = Job::Load;
+			job.Texture = h;
+			job.Surfaces = &texture.Surfaces;
+			job.MipCount = texture.MipCount;
+			job.Mip = texture.LoadedMip - 1;
+			texture.Loading = true;
+			Queue(std::move(job));
+		}
+	}
+}
+
+void TextureStreamer::WaitForWorkers()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mWorkers.empty())
+		return;
+	mWorkDone.wait(lock, [this]() { return mJobs.empty() && mBusyWorkers == 0; });
+}
+
+TextureStreamer::Status TextureStreamer::GetStatus(Handle texture)const
+{
+	Status status;
+	if (texture >= mTextures.size())
+		return status;
+
+	const TextureState& state = *mTextures[texture];
+	status.Parsed = state.Parsed;
+	status.Failed = state.Failed;
+	status.MipCount = state.MipCount;
+	status.TailMip = state.TailMip;
+	status.ResidentMip = state.ResidentMip;
+	status.WantedMip = state.Parsed ? WantedMip(state) : 0;
+	status.ResidentBytes = state.Parsed ? state.ChainBytes[state.ResidentMip] : 0;
+	return status;
+}
+
+void TextureStreamer::WorkerMain()
+{
+	Profiler::SetThreadName("TextureStreamer");
+	for (;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkReady.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+			if (mStopping)
+				return;
+
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+			++mBusyWorkers;
+		}
+
+		Result result = Run(job);
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mResults.push_back(std::move(result));
+			--mBusyWorkers;
+			if (mJobs.empty() && mBusyWorkers == 0)
+				mWorkDone.notify_all();
+		}
+	}
+}
+
+TextureStreamer::Result TextureStreamer::Run(const Job& job)const
+{
+	PROFILE_ZONE(job.Type == Job::Parse ? "TextureStreamer::Parse" : "TextureStreamer::Load");
+	Result result;
+	result.Type = job.Type;
+	result.Texture = job.Texture;
+	result.Mip = job.Mip;
+
+	const std::vector<DDSFile::Surface>* surfaces = job.Surfaces;
+	std::uint32_t mipCount = job.MipCount;
+	std::uint32_t firstMip = job.Mip;
+	std::uint32_t lastMip = job.Mip;
+
+	if (job.Type == Job::Parse)
+	{
+		result.File = std::make_unique<DDSFile>();
+		if (!result.File->Open(job.Filename) || !result.File->GetSurfaces(result.Surfaces) ||
+			result.File->MipCount() == 0)
+		{
+			result.File.reset();
+			return result;
+		}
+
+		// The tail is every mip from the last back to the first that does not fit in it
+		surfaces = &result.Surfaces;
+		mipCount = result.File->MipCount();
+		const std::uint32_t items = result.File->ArraySize();
+		std::uint64_t tailBytes = 0;
+		firstMip = lastMip = mipCount - 1;
+		for (std::uint32_t mip = mipCount; mip-- > 0;)
+		{
+			for (std::uint32_t item = 0; item < items; ++item)
+				tailBytes += SurfaceBytes(result.Surfaces[item * mipCount + mip]);
+			if (tailBytes > mMipTailBytes && mip < mipCount - 1)
+				break;
+			firstMip = mip;
+		}
+		result.Mip = firstMip;
+	}
+
+	std::uint64_t sum = 0;
+	for (size_t item = 0; item < surfaces->size() / mipCount; ++item)
+		for (std::uint32_t mip = firstMip; mip <= lastMip; ++mip)
+		{
+			const DDSFile::Surface& surface = (*surfaces)[item * mipCount + mip];
+			sum += ReadPages(surface.Data, SurfaceBytes(surface));
+		}
+	gPageSum.fetch_add(sum, std::memory_order_relaxed);
+	return result;
+}
+
+void TextureStreamer::Queue(Job job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back(std::move(job));
+	}
+	mWorkReady.notify_one();
+}
+
+void TextureStreamer::Finish(Result& result)
+{
+	TextureState& texture = *mTextures[result.Texture];
+	if (result.Type == Job::Load)
+	{
+		texture.Loading = false;
+		texture.LoadedMip = std::min(texture.LoadedMip, result.Mip);
+		return;
+	}
+
+	if (!result.File)
+	{
+		texture.Failed = true;
+		return;
+	}
+
+	texture.File = std::move(result.File);
+	texture.Surfaces = std::move(result.Surfaces);
+	texture.MipCount = texture.File->MipCount();
+	texture.TailMip = result.Mip;
+	texture.LoadedMip = result.Mip;
+	texture.ResidentMip = texture.MipCount;
+
+	const std::uint32_t items = texture.File->ArraySize();
+	texture.ChainBytes.assign(texture.MipCount + 1, 0);
+	for (std::uint32_t mip = texture.MipCount; mip-- > 0;)
+	{
+		texture.ChainBytes[mip] = texture.ChainBytes[mip + 1];
+		for (std::uint32_t item = 0; item < items; ++item)
+			texture.ChainBytes[mip] += SurfaceBytes(texture.Surfaces[item * texture.MipCount + mip]);
+	}
+	texture.Parsed = true;
+
+	// The tail goes in straight away, whatever the budget, so the texture can be drawn
+	Resident(result.Texture, texture.TailMip);
+}
+
+std::uint32_t TextureStreamer::WantedMip(const TextureState& texture)const
+{
+	if (texture.ScreenTexels <= 0.0f)
+		return texture.TailMip;
+
+	// The coarsest mip at least as wide as the texture is on screen
+	const std::uint32_t size = std::max(texture.File->Width(), texture.File->Height());
+	std::uint32_t mip = 0;
+	while (mip < texture.TailMip && std::max(size >> (mip + 1), 1u) >= texture.ScreenTexels)
+		++mip;
+	return mip;
+}
+
+float TextureStreamer::Priority(const TextureState& texture, std::uint32_t mip)const
+{
+	// How large the texture is on screen, times how many texels there each texel of the
+	// mip is stretched across, so a blurred texture covering more of the screen comes first
+	const std::uint32_t size = std::max(texture.File->Width(), texture.File->Height());
+	return texture.ScreenTexels * texture.ScreenTexels / (float)std::max(size >> mip, 1u);
+}
+
+bool TextureStreamer::Resident(Handle texture, std::uint32_t mip)
+{
+	TextureState& state = *mTextures[texture];
+	if (!mSink.MakeResident(texture, *state.File, state.Surfaces, mip))
+	{
+		state.Failed = true;
+		return false;
+	}
+
+	mResidentBytes = mResidentBytes - state.ChainBytes[state.ResidentMip] + state.ChainBytes[mip];
+	mUploadedBytes += state.ChainBytes[mip];
+	state.ResidentMip = mip;
+	return true;
+}
+
+bool TextureStreamer::MakeRoom(Handle texture, std::uint64_t bytes)
+{
+	const float limit = Priority(*mTextures[texture], mTextures[texture]->ResidentMip) * EvictionRatio;
+
+	// The textures least needed give up their finest mips first
+	std::vector<Handle> victims;
+	for (Handle h = 0; h < mTextures.size(); ++h)
+	{
+		const TextureState& victim = *mTextures[h];
+		if (h != texture && victim.Parsed && !victim.Failed && victim.ResidentMip < victim.TailMip && Priority(victim, victim.ResidentMip) < limit)
+			victims.push_back(h);
+	}
+	std::sort(victims.begin(), victims.end(), [this](Handle a, Handle b)
+	{
+		return Priority(*mTextures[a], mTextures[a]->ResidentMip) < Priority(*mTextures[b], mTextures[b]->ResidentMip);
+	});
+
+	// Works out what to drop before dropping any, so nothing is dropped for no gain
+	const std::uint64_t shortfall = mResidentBytes + bytes - mBudgetBytes;
+	std::vector<std::uint32_t> keep;
+	for (Handle h : victims)
+		keep.push_back(mTextures[h]->ResidentMip);
+	std::uint64_t freed = 0;
+	for (size_t i = 0; i < victims.size() && freed < shortfall; ++i)
+	{
+		TextureState& victim = *mTextures[victims[i]];
+		std::uint32_t mip = keep[i];
+		while (mip < victim.TailMip && freed < shortfall && Priority(victim, mip) < limit)
+		{
+			freed += victim.ChainBytes[mip] - victim.ChainBytes[mip + 1];
+			++mip;
+		}
+		keep[i] = mip;
+	}
+	if (freed < shortfall)
+		return false;
+
+	for (size_t i = 0; i < victims.size(); ++i)
+		if (keep[i] != mTextures[victims[i]]->ResidentMip)
+			Resident(victims[i], keep[i]);
+
+	// A victim the sink could not shrink keeps what it had
+	return mResidentBytes + bytes <= mBudgetBytes;
+}
@@ -0,0 +1,193 @@
+//***************************************************************************************
+// TextureStreamer.h
+//
+// Streams DDS textures in the background, a mip at a time.  Worker threads map and parse
+// each file, and the smallest mips, the mip tail, are made resident as soon as it is
+// parsed, so a texture can be drawn a frame or two after it is asked for.  Finer mips
+// follow as the texture is drawn large enough on screen to need them, for as long as they
+// fit in a budget.  The textures largest on screen and most blurred go first, and when
+// the budget is full the mips least needed elsewhere are dropped to make room.
+//
+// The budget counts the bytes of the mips resident, tails included, not the memory a sink
+// holds to get them there.  A sink that copies through upload memory, or keeps the mips
+// it replaces until the GPU is done with them, can briefly hold about twice the budget.
+//
+// Nothing here touches a GPU.  Making mips resident is left to a TextureUploadSink, which
+// D3D12TextureSink does for the app, so the queueing, budget and priorities run just the
+// same against a sink that only records what it is asked for.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TextureUploadSink
+{
+public:
+	virtual ~TextureUploadSink() = default;
+
+	///<summary>
+	/// Makes mips firstMip to the last of every array item resident for texture, in place
+	/// of any it had.  surfaces holds every mip of the file, as DDSFile::GetSurfaces gives
+	/// them; they point into file's mapping, which stays open for as long as the streamer.
+	/// Returns false, keeping whatever the texture had resident, if the mips cannot be made
+	/// resident; the streamer then marks the texture Failed and streams it no further.
+	///</summary>
+	virtual bool MakeResident(std::uint32_t texture, const DDSFile& file,
+		const std::vector<DDSFile::Surface>& surfaces, std::uint32_t firstMip) = 0;
+};
+
+class TextureStreamer
+{
+public:
+	using Handle = std::uint32_t;
+
+	// The mips of a texture that fit in a 64KB resource page together are its mip tail
+	static const std::uint64_t DefaultMipTailBytes = 64 * 1024;
+
+	// An Update uploads no more than this, beyond its first upload, so streaming in a
+	// large texture is spread over several frames
+	static const std::uint64_t DefaultUploadBytesPerUpdate = 8 * 1024 * 1024;
+
+	struct Status
+	{
+		bool Parsed = false;
+		bool Failed = false;
+		std::uint32_t MipCount = 0;
+
+		// The first mip of the tail, the finest resident, and the finest its size on
+		// screen needs.  ResidentMip is MipCount while nothing is resident.
+		std::uint32_t TailMip = 0;
+		std::uint32_t ResidentMip = 0;
+		std::uint32_t WantedMip = 0;
+
+		std::uint64_t ResidentBytes = 0;
+	};
+
+	///<summary>
+	/// Streams into sink with workerCount threads.  With no workers, each Update does the
+	/// work queued before it itself, which makes a run repeatable.  Mip tails count
+	/// against the budget but are always resident, even past it.
+	///</summary>
+	TextureStreamer(TextureUploadSink& sink, std::uint64_t budgetBytes, unsigned workerCount,
+		std::uint64_t mipTailBytes = DefaultMipTailBytes,
+		std::uint64_t uploadBytesPerUpdate = DefaultUploadBytesPerUpdate);
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer& rhs) = delete;
+	TextureStreamer& operator=(const TextureStreamer& rhs) = delete;
+
+	///<summary>
+	/// Queues filename to be parsed and its mip tail made resident.  The handle is the
+	/// texture the sink is given, numbered from 0 in the order they are asked for.
+	///</summary>
+	Handle Request(const std::wstring& filename);
+
+	///<summary>
+	/// How many texels across the texture would need to show every pixel it covers on
+	/// screen.  Finer mips are streamed in until one is at least that wide; 0, as every
+	/// texture starts, needs no more than the tail.
+	///</summary>
+	void SetScreenSize(Handle texture, float texels);
+
+	///<summary>
+	/// Called once a frame on the thread that owns the sink.  Hands the sink every tail
+	/// and mip the workers have readied since the last call, then decides what to load
+	/// next.
+	///</summary>
+	void Update();
+
+	// Blocks until the workers have nothing left to do.  What they did is handed on by
+	// the next Update.
+	void WaitForWorkers();
+
+	Status GetStatus(Handle texture)const;
+	std::uint64_t ResidentBytes()const { return mResidentBytes; }
+	std::uint64_t BudgetBytes()const { return mBudgetBytes; }
+
+private:
+	struct TextureState
+	{
+		std::wstring Filename;
+		std::unique_ptr<DDSFile> File;
+		std::vector<DDSFile::Surface> Surfaces;
+
+		// Bytes of every mip from each level to the last, of every array item, so
+		// ChainBytes[m] is what is resident with m as the finest mip
+		std::vector<std::uint64_t> ChainBytes;
+
+		bool Parsed = false;
+		bool Failed = false;
+		bool Loading = false;
+		std::uint32_t MipCount = 0;
+		std::uint32_t TailMip = 0;
+		std::uint32_t ResidentMip = 0;
+
+		// The finest mip whose pages the workers have read in
+		std::uint32_t LoadedMip = 0;
+
+		float ScreenTexels = 0.0f;
+	};
+
+	struct Job
+	{
+		enum Kind { Parse, Load };
+
+		Kind Type = Parse;
+		Handle Texture = 0;
+		std::wstring Filename;
+
+		// For Load, the mip whose pages to read in, and the file it is in
+		const std::vector<DDSFile::Surface>* Surfaces = nullptr;
+		std::uint32_t MipCount = 0;
+		std::uint32_t Mip = 0;
+	};
+
+	struct Result
+	{
+		Job::Kind Type = Job::Parse;
+		Handle Texture = 0;
+		std::unique_ptr<DDSFile> File;
+		std::vector<DDSFile::Surface> Surfaces;
+		std::uint32_t Mip = 0;
+	};
+
+	void WorkerMain();
+	Result Run(const Job& job)const;
+	void Queue(Job job);
+	void Finish(Result& result);
+
+	std::uint32_t WantedMip(const TextureState& texture)const;
+	float Priority(const TextureState& texture, std::uint32_t mip)const;
+	bool Resident(Handle texture, std::uint32_t mip);
+	bool MakeRoom(Handle texture, std::uint64_t bytes);
+
+	TextureUploadSink& mSink;
+	const std::uint64_t mBudgetBytes;
+	const std::uint64_t mMipTailBytes;
+	const std::uint64_t mUploadBytesPerUpdate;
+
+	// Only Update and the calls beside it use these, on the sink's thread
+	std::vector<std::unique_ptr<TextureState>> mTextures;
+	std::uint64_t mResidentBytes = 0;
+	std::uint64_t mUploadedBytes = 0;
+
+	// Shared with the workers
+	mutable std::mutex mMutex;
+	std::condition_variable mWorkReady;
+	std::condition_variable mWorkDone;
+	std::deque<Job> mJobs;
+	std::vector<Result> mResults;
+	unsigned mBusyWorkers = 0;
+	bool mStopping = false;
+
+	std::vector<std::thread> mWorkers;
+};
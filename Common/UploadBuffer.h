@@ -31,6 +31,13 @@ public:
 
         ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
 
+        // The bytes lost to rounding elements up are counted apart from the rest, to show
+        // what the rounding costs.
+        const UINT64 paddingBytes = UINT64(mElementByteSize - sizeof(T)) * elementCount;
+        mMemory.Reset(MemoryTracker::UploadBuffers, (size_t)(d3dUtil::ResourceBytes(device, mUploadBuffer.Get()) - paddingBytes));
+        if(paddingBytes > 0)
+            mPadding.Reset(MemoryTracker::UploadPadding, (size_t)paddingBytes);
+
         // We do not need to unmap until we are done with the resource.  However, we must not write to
         // the resource while it is in use by the GPU (so we must use synchronization techniques).
     }
@@ -55,10 +62,33 @@ public:
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
     }
 
+    // Copies count consecutive elements starting at firstElement.  Constant buffer
+    // elements are padded, so this is only for buffers created with isConstantBuffer false.
+    void CopyData(int firstElement, const T* data, UINT count)
+    {
+        assert(!mIsConstantBuffer);
+        memcpy(&mMappedData[firstElement*mElementByteSize], data, sizeof(T)*count);
+    }
+
+    // The mapped element itself, for writing parts of it in place rather than copying a
+    // whole T.  The memory is write-combined, so it must never be read back.
+    BYTE* MappedData(int elementIndex = 0)
+    {
+        return &mMappedData[elementIndex*mElementByteSize];
+    }
+
+    UINT ElementByteSize()const
+    {
+        return mElementByteSize;
+    }
+
 private:
     Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
     BYTE* mMappedData = nullptr;
 
     UINT mElementByteSize = 0;
     bool mIsConstantBuffer = false;
+
+    MemoryTracker::Allocation mMemory;
+    MemoryTracker::Allocation mPadding;
 };
\ No newline at end of file
@@ -0,0 +1,36 @@
+//***************************************************************************************
+// Win32Window.cpp
+//***************************************************************************************
+
+#include "Win32Window.h"
+
+Win32Window::Win32Window(HWND hwnd)
+	: mhWnd(hwnd)
+{
+}
+
+bool Win32Window::IsKeyDown(int key)const
+{
+	return key >= 0 && key < KeyCount && mKeysDown[key];
+}
+
+void Win32Window::SetKeyDown(int key, bool down)
+{
+	if (key >= 0 && key < KeyCount)
+		mKeysDown[key] = down;
+}
+
+void Win32Window::CaptureMouse()
+{
+	SetCapture(mhWnd);
+}
+
+void Win32Window::ReleaseMouse()
+{
+	ReleaseCapture();
+}
+
+HWND Win32Window::Handle()const
+{
+	return mhWnd;
+}
@@ -0,0 +1,31 @@
+//***************************************************************************************
+// Win32Window.h
+//
+// Window input read from Win32: the keys the window's key messages have said are down,
+// and the mouse captured with SetCapture.  Keys follow the messages rather than the
+// keyboard itself, so they change only as the messages are handled.
+//***************************************************************************************
+
+#pragma once
+
+#include "Window.h"
+#include <Windows.h>
+
+class Win32Window : public Window
+{
+public:
+	explicit Win32Window(HWND hwnd);
+
+	bool IsKeyDown(int key)const override;
+	void CaptureMouse() override;
+	void ReleaseMouse() override;
+
+	// Called from the window procedure as each key message is handled
+	void SetKeyDown(int key, bool down);
+
+	HWND Handle()const;
+
+private:
+	HWND mhWnd;
+	std::array<bool, KeyCount> mKeysDown = {};
+};
@@ -0,0 +1,36 @@
+//***************************************************************************************
+// Window.cpp
+//***************************************************************************************
+
+#include "Window.h"
+
+bool ManualWindow::IsKeyDown(int key)const
+{
+	return key >= 0 && key < KeyCount && mKeysDown[key];
+}
+
+void ManualWindow::CaptureMouse()
+{
+	mMouseCaptured = true;
+}
+
+void ManualWindow::ReleaseMouse()
+{
+	mMouseCaptured = false;
+}
+
+void ManualWindow::SetKeyDown(int key, bool down)
+{
+	if (key >= 0 && key < KeyCount)
+		mKeysDown[key] = down;
+}
+
+void ManualWindow::ReleaseKeys()
+{
+	mKeysDown.fill(false);
+}
+
+bool ManualWindow::MouseCaptured()const
+{
+	return mMouseCaptured;
+}
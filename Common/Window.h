@@ -0,0 +1,69 @@
+//***************************************************************************************
+// Window.h
+//
+// What the app asks of the window it runs in: whether a key is held down, and keeping
+// hold of the mouse while a button is down.  D3DApp gives its window a Win32Window; a
+// ManualWindow has no window behind it and reports whatever keys it is told are down,
+// for running without one.
+//***************************************************************************************
+
+#pragma once
+
+#include <array>
+
+class Window
+{
+public:
+	// Keys that are not characters, by their Win32 virtual-key codes.  Letter and digit
+	// keys are their upper case character, as they are in Win32.
+	enum Key
+	{
+		KeyShift = 0x10,
+		KeyLeft = 0x25,
+		KeyUp = 0x26,
+		KeyRight = 0x27,
+		KeyDown = 0x28
+	};
+
+	static const int KeyCount = 256;
+
+	// Mouse buttons held during a mouse event, by their Win32 MK_ flags
+	enum Button
+	{
+		ButtonLeft = 0x01,
+		ButtonRight = 0x02,
+		ButtonMiddle = 0x10,
+		ButtonMask = ButtonLeft | ButtonRight | ButtonMiddle
+	};
+
+	virtual ~Window() = default;
+
+	// True while key is held down.  Keys outside [0, KeyCount) are never down.
+	virtual bool IsKeyDown(int key)const = 0;
+
+	///<summary>
+	/// Keeps sending mouse moves to this window while a button is held, even once the
+	/// cursor leaves it, until ReleaseMouse.
+	///</summary>
+	virtual void CaptureMouse() = 0;
+	virtual void ReleaseMouse() = 0;
+};
+
+// A window that only has the keys it is told are down, for driving the app's input
+// without a real window or keyboard.
+class ManualWindow : public Window
+{
+public:
+	bool IsKeyDown(int key)const override;
+	void CaptureMouse() override;
+	void ReleaseMouse() override;
+
+	void SetKeyDown(int key, bool down);
+	void ReleaseKeys();
+
+	bool MouseCaptured()const;
+
+private:
+	std::array<bool, KeyCount> mKeysDown = {};
+	bool mMouseCaptured = false;
+};
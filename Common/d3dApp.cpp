@@ -3,7 +3,13 @@
 //***************************************************************************************
 
 #include "d3dApp.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "RandomEngine.h"
+#include "Win32Window.h"
 #include <WindowsX.h>
+#include <fstream>
+#include <iterator>
 
 using Microsoft::WRL::ComPtr;
 using namespace std;
@@ -11,6 +17,12 @@ using namespace DirectX;
 
 bool rPressed{ false };
 
+// Frames logged each time F5 is pressed
+const int CommandLogFrameCount = 60;
+
+// Where F6 records input and F7 plays it back from
+const char* const InputRecordingFile = "InputRecording.bin";
+
 LRESULT CALLBACK
 MainWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
@@ -76,6 +88,8 @@ int D3DApp::Run()
     MSG msg = { 0 };
 
     mTimer.Reset();
+    mSimStep.Reset();
+    Profiler::SetThreadName("Main");
 
     while (msg.message != WM_QUIT)
     {
@@ -92,9 +106,45 @@ int D3DApp::Run()
 
             if (!mAppPaused)
             {
+                PROFILE_ZONE("D3DApp::Frame");
+                const GameTimer::Clock& clock = GameTimer::SystemClock();
+                std::int64_t frameStart = clock.Now();
+
+                // A replay runs each frame for as long as the frame it plays back took,
+                // however long it really takes
+                GameTimer& timer = mReplayingInput ? mReplayTimer : mTimer;
+                double frameSeconds = mTimer.DeltaTime();
+                std::uint64_t replayStep = 0;
+                if (mReplayingInput)
+                    PlayInput(frameSeconds, replayStep);
+                else if (mRecordingInput)
+                    frameSeconds = (float)frameSeconds; // as the recording stores it
+
+                // The input that arrived since the last frame is read by this frame's
+                // Update, once the steps are run
+                int steps = mSimStep.Advance(frameSeconds);
+                if (mRecordingInput)
+                    mInputRecording.EndFrame(mSimStep.StepCount(), (float)frameSeconds);
+                for (int i = 0; i < steps; ++i)
+                    Simulate(mSimStep.StepSeconds());
+
+                Update(timer);
+                std::int64_t updateEnd = clock.Now();
+                Draw(timer);
+                std::int64_t drawEnd = clock.Now();
+
+                double msPerTick = 1000.0 / (double)clock.TicksPerSecond();
+                mFrameStats.AddFrame((float)((updateEnd - frameStart)*msPerTick),
+                    (float)((drawEnd - updateEnd)*msPerTick), 1000.0f*mTimer.DeltaTime());
                 CalculateFrameStats();
-                Update(mTimer);
-                Draw(mTimer);
+
+                if (mReplayingInput && mSimStep.StepCount() != replayStep)
+                {
+                    ::OutputDebugStringA("Replay stopped: a frame ran other steps than it was recorded with\n");
+                    StopInputReplay();
+                }
+                else if (mReplayingInput && mInputRecording.Finished())
+                    StopInputReplay();
             }
             else
             {
@@ -103,6 +153,7 @@ int D3DApp::Run()
         }
     }
 
+    WriteFrameStats();
     return (int)msg.wParam;
 }
 
@@ -249,6 +300,10 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         {
             mAppPaused = true;
             mTimer.Stop();
+
+            // Keys released elsewhere never send this window their key up
+            for (int key = 0; key < Window::KeyCount; ++key)
+                KeyEvent(key, false);
         }
         else
         {
@@ -350,23 +405,41 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_LBUTTONDOWN:
     case WM_MBUTTONDOWN:
     case WM_RBUTTONDOWN:
-        OnMouseDown(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        MouseEvent(InputRecording::MouseDown, (int)wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
         return 0;
     case WM_LBUTTONUP:
     case WM_MBUTTONUP:
     case WM_RBUTTONUP:
-        OnMouseUp(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        MouseEvent(InputRecording::MouseUp, (int)wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
         return 0;
     case WM_MOUSEMOVE:
-        OnMouseMove(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        MouseEvent(InputRecording::MouseMove, (int)wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        return 0;
+    case WM_KEYDOWN:
+        KeyEvent((int)wParam, true);
         return 0;
+    case WM_SYSKEYDOWN:
+    case WM_SYSKEYUP:
+        KeyEvent((int)wParam, msg == WM_SYSKEYDOWN);
+        break;
     case WM_KEYUP:
+        KeyEvent((int)wParam, false);
         if (wParam == VK_ESCAPE)
         {
             PostQuitMessage(0);
         }
         else if ((int)wParam == VK_F2)
             Set4xMsaaState(!m4xMsaaState);
+        else if ((int)wParam == VK_F3)
+            WriteFrameStats();
+        else if ((int)wParam == VK_F4)
+            WriteProfileTrace();
+        else if ((int)wParam == VK_F5 && mCommandLogFrames == 0)
+            mCommandLogFrames = CommandLogFrameCount;
+        else if ((int)wParam == VK_F6 && !mReplayingInput)
+            mRecordingInput ? StopInputRecording() : StartInputRecording();
+        else if ((int)wParam == VK_F7 && !mRecordingInput && !mReplayingInput)
+            ReplayInput(InputRecordingFile, false);
 
         return 0;
     }
@@ -407,6 +480,9 @@ bool D3DApp::InitMainWindow()
         MessageBox(0, L"CreateWindow Failed.", 0, 0);
         return false;
     }
+    auto window = std::make_unique<Win32Window>(mhMainWnd);
+    mWin32Window = window.get();
+    mWindow = std::move(window);
 
     ShowWindow(mhMainWnd, SW_SHOW);
     UpdateWindow(mhMainWnd);
@@ -579,32 +655,216 @@ void D3DApp::CalculateFrameStats()
 {
     // Code computes the average frames per second, and also the 
     // average time it takes to render one frame.  These stats 
-    // are appended to the window caption bar.
-
-    static int frameCnt = 0;
-    static float timeElapsed = 0.0f;
+    // are appended to the window caption bar, along with the
+    // slowest frames of the last FrameStats::WindowSize.
 
-    frameCnt++;
+    mCaptionFrameCount++;
 
     // Compute averages over one second period.
-    if ((mTimer.TotalTime() - timeElapsed) >= 1.0f)
+    if ((mTimer.TotalTime() - mCaptionTime) >= 1.0f)
     {
-        float fps = (float)frameCnt; // fps = frameCnt / 1
+        float fps = (float)mCaptionFrameCount; // fps = frames / 1
         float mspf = 1000.0f / fps;
 
-        wstring fpsStr = to_wstring(fps);
-        wstring mspfStr = to_wstring(mspf);
+        FrameStats::Summary present = mFrameStats.Summarize(FrameStats::Present);
 
         wstring windowText = mMainWndCaption +
-            L"    fps: " + fpsStr +
-            L"   mspf: " + mspfStr;
+            L"    fps: " + to_wstring(fps) +
+            L"   mspf: " + to_wstring(mspf) +
+            L"   p99: " + to_wstring(present.P99) +
+            L"   max: " + to_wstring(present.Max);
 
         SetWindowText(mhMainWnd, windowText.c_str());
 
         // Reset for next average.
-        frameCnt = 0;
-        timeElapsed += 1.0f;
+        mCaptionFrameCount = 0;
+        mCaptionTime += 1.0f;
+    }
+}
+
+void D3DApp::WriteFrameStats()
+{
+    std::ofstream memory("MemoryStats.json");
+    MemoryTracker::WriteJson(memory);
+
+    if (mFrameStats.Count() == 0)
+        return;
+
+    std::ofstream csv("FrameStats.csv");
+    mFrameStats.WriteCsv(csv);
+
+    std::ofstream json("FrameStats.json");
+    mFrameStats.WriteJson(json);
+}
+
+void D3DApp::WriteProfileTrace()
+{
+    std::ofstream trace("ProfileTrace.json");
+    Profiler::WriteChromeTrace(trace);
+}
+
+void D3DApp::WriteCommandLog()
+{
+    std::ofstream log("CommandLog.bin", std::ios::binary);
+    mCommandLog.Write(log);
+    mCommandLog.Clear();
+    mCommandLogFrames = 0;
+}
+
+RenderCommands& D3DApp::CommandsFor(RenderCommands& device)
+{
+    if (mCommandLogFrames == 0)
+        return device;
+
+    // The frame after the last one logged writes the log out
+    if ((int)mCommandLog.FrameCount() == mCommandLogFrames)
+    {
+        WriteCommandLog();
+        return device;
+    }
+
+    mCommandLog.SetNext(&device);
+    mCommandLog.BeginFrame();
+    return mCommandLog;
+}
+
+void D3DApp::Restart(std::uint64_t seed)
+{
+    RandomEngine::ThreadLocal().Seed(seed);
+    mSimStep.Reset();
+    OnRestart();
+}
+
+void D3DApp::StartInputRecording()
+{
+    // Any seed will do, so long as the recording keeps it
+    std::uint64_t seed = (std::uint64_t)GameTimer::SystemClock().Now();
+    Restart(seed);
+
+    // Keys already held go down in the first frame, as a replay starts with none held
+    mInputRecording.Begin(seed, mSimStep.Rate());
+    for (int key = 0; key < Window::KeyCount; ++key)
+        if (mWin32Window->IsKeyDown(key))
+            mInputRecording.AddKey(key, true);
+    mRecordingInput = true;
+}
+
+void D3DApp::StopInputRecording()
+{
+    mInputRecording.End(mSimStep.StepCount());
+    mRecordingInput = false;
+
+    std::ofstream file(InputRecordingFile, std::ios::binary);
+    mInputRecording.Write(file);
+}
+
+bool D3DApp::ReplayInput(const std::string& path, bool quitWhenDone)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::string error;
+    if (!file.is_open())
+        error = "cannot open it";
+    else if (mInputRecording.Read(bytes.data(), bytes.size(), error))
+    {
+        // Read fails on events after the last frame, so any events end in a frame
+        if (mInputRecording.Events().empty())
+            error = "it holds no frames";
+        else if (mInputRecording.StepsPerSecond() != mSimStep.Rate())
+            error = "it was recorded at another simulation rate";
     }
+    if (!error.empty())
+    {
+        ::OutputDebugStringA(("Cannot replay " + path + ": " + error + "\n").c_str());
+        return false;
+    }
+
+    Restart(mInputRecording.Seed());
+    mInputRecording.Rewind();
+
+    // Keys come from the recording until it ends
+    mWindow->ReleaseMouse();
+    auto replayWindow = std::make_unique<ManualWindow>();
+    mReplayWindow = replayWindow.get();
+    mLiveWindow = std::move(mWindow);
+    mWindow = std::move(replayWindow);
+
+    mReplayClock = ManualClock();
+    mReplayTimer.Reset();
+    mFrameStats.Clear();
+    mReplayingInput = true;
+    mQuitAfterReplay = quitWhenDone;
+    return true;
+}
+
+void D3DApp::StopInputReplay()
+{
+    mWindow = std::move(mLiveWindow);
+    mReplayWindow = nullptr;
+    mReplayingInput = false;
+
+    if (mQuitAfterReplay)
+        PostQuitMessage(0);
+}
+
+void D3DApp::MouseEvent(InputRecording::EventType type, int buttons, int x, int y)
+{
+    if (mReplayingInput)
+        return;
+
+    buttons &= Window::ButtonMask;
+    if (mRecordingInput)
+        mInputRecording.AddMouse(type, buttons, x, y);
+    DispatchMouse(type, buttons, x, y);
+}
+
+void D3DApp::DispatchMouse(InputRecording::EventType type, int buttons, int x, int y)
+{
+    switch (type)
+    {
+    case InputRecording::MouseDown:
+        OnMouseDown(buttons, x, y);
+        break;
+    case InputRecording::MouseUp:
+        OnMouseUp(buttons, x, y);
+        break;
+    case InputRecording::MouseMove:
+        OnMouseMove(buttons, x, y);
+        break;
+    default:
+        break;
+    }
+}
+
+void D3DApp::KeyEvent(int key, bool down)
+{
+    if (mWin32Window == nullptr || mWin32Window->IsKeyDown(key) == down)
+        return;
+
+    mWin32Window->SetKeyDown(key, down);
+    if (mRecordingInput)
+        mInputRecording.AddKey(key, down);
+}
+
+void D3DApp::PlayInput(double& frameSeconds, std::uint64_t& step)
+{
+    InputRecording::Event frame;
+    if (!mInputRecording.NextFrame(mReplayEvents, frame))
+        return;
+
+    for (const InputRecording::Event& event : mReplayEvents)
+    {
+        if (event.Type == InputRecording::KeyDown || event.Type == InputRecording::KeyUp)
+            mReplayWindow->SetKeyDown(event.Key, event.Type == InputRecording::KeyDown);
+        else
+            DispatchMouse(event.Type, event.Buttons, event.X, event.Y);
+    }
+
+    frameSeconds = frame.Seconds;
+    step = frame.Step;
+    mReplayClock.Advance(frameSeconds);
+    mReplayTimer.Tick();
 }
 
 void D3DApp::LogAdapters()
@@ -11,6 +11,11 @@
 
 #include "d3dUtil.h"
 #include "GameTimer.h"
+#include "FixedTimestep.h"
+#include "FrameStats.h"
+#include "CommandLog.h"
+#include "InputRecording.h"
+#include "Window.h"
 #include"../RubixCubeAppInfo.h"
 
 
@@ -19,6 +24,8 @@
 #pragma comment(lib, "D3D12.lib")
 #pragma comment(lib, "dxgi.lib")
 
+class Win32Window;
+
 class D3DApp
 {
 protected:
@@ -45,16 +52,31 @@ public:
     virtual bool Initialize();
     virtual LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+	// Plays back an input recording from the start, quitting once it ends if quitWhenDone
+	// is set.  Returns false if the file cannot be read, holds no frames or was recorded
+	// at another simulation rate.
+	bool ReplayInput(const std::string& path, bool quitWhenDone);
+
 protected:
     virtual void CreateRtvAndDsvDescriptorHeaps();
 	virtual void OnResize(); 
 	virtual void Update(const GameTimer& gt)=0;
     virtual void Draw(const GameTimer& gt)=0;
 
-	// Convenience overrides for handling mouse input.
-	virtual void OnMouseDown(WPARAM btnState, int x, int y){ }
-	virtual void OnMouseUp(WPARAM btnState, int x, int y)  { }
-	virtual void OnMouseMove(WPARAM btnState, int x, int y){ }
+	// Advances the simulation by one fixed step of dt seconds.  Run calls it as many times
+	// as the frame time allows before each Update, so anything animated here moves at the
+	// same rate however fast frames are drawn.  Update can interpolate between the last two
+	// steps with mSimStep.Alpha().
+	virtual void Simulate(float dt) { }
+
+	// Puts the app back as it first starts, before input is recorded or played back.
+	virtual void OnRestart() { }
+
+	// Convenience overrides for handling mouse input.  buttons holds the Window::Button
+	// flags of the buttons held down.
+	virtual void OnMouseDown(int buttons, int x, int y){ }
+	virtual void OnMouseUp(int buttons, int x, int y)  { }
+	virtual void OnMouseMove(int buttons, int x, int y){ }
 
 protected:
 
@@ -70,6 +92,33 @@ protected:
 	D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()const;
 
 	void CalculateFrameStats();
+	void WriteFrameStats();
+	void WriteProfileTrace();
+	void WriteCommandLog();
+
+	// What Draw should record its commands into: device itself, or while F5's capture
+	// is running, the command log passing them on to device.
+	RenderCommands& CommandsFor(RenderCommands& device);
+
+	// Reseeds the random engine, resets the simulation steps and calls OnRestart.
+	void Restart(std::uint64_t seed);
+	void StartInputRecording();
+	void StopInputRecording();
+	void StopInputReplay();
+
+	// Passes a mouse event from the window on to the handlers, recording it if input is
+	// being recorded and dropping it if a recording is playing back.
+	void MouseEvent(InputRecording::EventType type, int buttons, int x, int y);
+	void DispatchMouse(InputRecording::EventType type, int buttons, int x, int y);
+
+	// Keeps the real window's keys as its key messages say, recording each key that goes
+	// down or up if input is being recorded.  Repeats of a key held down are ignored.
+	void KeyEvent(int key, bool down);
+
+	// Called at the start of each frame while a recording plays back: hands the next
+	// recorded frame's events to the app, and gives the time the frame took and the step
+	// count its Update ran at.
+	void PlayInput(double& frameSeconds, std::uint64_t& step);
 
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
@@ -93,6 +142,42 @@ protected:
 
 	// Used to keep track of the delta-time and game time (4.4).
 	GameTimer mTimer;
+
+	// Splits frame time into fixed simulation steps.  Derived classes can change the rate
+	// and the most steps run in one frame in their constructor.
+	FixedTimestep mSimStep;
+
+	// Update, record and present-to-present times of recent frames.  They are written to
+	// FrameStats.csv and FrameStats.json on exit, or when F3 is pressed, along with what
+	// MemoryTracker counts in MemoryStats.json.
+	FrameStats mFrameStats;
+	int mCaptionFrameCount = 0;
+	float mCaptionTime = 0.0f;
+
+	// Pressing F5 logs the commands of the next mCommandLogFrames frames and writes them
+	// to CommandLog.bin.  Derived classes give the log the sizes of their root parameters.
+	CommandLog mCommandLog;
+	int mCommandLogFrames = 0;
+
+	// Keyboard state and mouse capture for the main window, made with it in InitMainWindow.
+	// Input is read through this rather than from Win32, so it can come from elsewhere.
+	std::unique_ptr<Window> mWindow;
+
+	// F6 starts and stops recording input to InputRecording.bin and F7 plays it back.
+	// While it plays, keys come from mReplayWindow in place of the real window, which
+	// waits in mLiveWindow, and each frame runs for the time the frame it plays back took,
+	// timed by mReplayTimer, so every replay runs the same steps.  mTimer still times the
+	// real frames.  mWin32Window is the real window wherever it is.
+	InputRecording mInputRecording;
+	bool mRecordingInput = false;
+	bool mReplayingInput = false;
+	bool mQuitAfterReplay = false;
+	Win32Window* mWin32Window = nullptr;
+	std::vector<InputRecording::Event> mReplayEvents;
+	std::unique_ptr<Window> mLiveWindow;
+	ManualWindow* mReplayWindow = nullptr;
+	ManualClock mReplayClock;
+	GameTimer mReplayTimer{ mReplayClock };
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
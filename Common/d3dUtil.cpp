@@ -1,5 +1,6 @@
 
 #include "d3dUtil.h"
+#include "MeshBounds.h"
 #include <comdef.h>
 #include <fstream>
 
@@ -35,6 +36,79 @@ ComPtr<ID3DBlob> d3dUtil::LoadBinary(const std::wstring& filename)
     return blob;
 }
 
+namespace
+{
+    class BlobView : public ID3DBlob
+    {
+    public:
+        BlobView(const void* data, SIZE_T byteSize, std::shared_ptr<const void> owner) :
+            mData(data),
+            mByteSize(byteSize),
+            mOwner(std::move(owner))
+        {
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+        {
+            if(object == nullptr)
+                return E_POINTER;
+
+            if(riid == __uuidof(IUnknown) || riid == __uuidof(ID3D10Blob))
+            {
+                *object = static_cast<ID3DBlob*>(this);
+                AddRef();
+                return S_OK;
+            }
+
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return InterlockedIncrement(&mRefCount);
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            ULONG refCount = InterlockedDecrement(&mRefCount);
+            if(refCount == 0)
+                delete this;
+
+            return refCount;
+        }
+
+        LPVOID STDMETHODCALLTYPE GetBufferPointer() override
+        {
+            return const_cast<void*>(mData);
+        }
+
+        SIZE_T STDMETHODCALLTYPE GetBufferSize() override
+        {
+            return mByteSize;
+        }
+
+    private:
+        ~BlobView() = default;
+
+        LONG mRefCount = 1;
+        const void* mData;
+        SIZE_T mByteSize;
+        std::shared_ptr<const void> mOwner;
+    };
+}
+
+ComPtr<ID3DBlob> d3dUtil::CreateBlobView(
+    const void* data,
+    SIZE_T byteSize,
+    std::shared_ptr<const void> owner)
+{
+    ComPtr<ID3DBlob> blob;
+    blob.Attach(new BlobView(data, byteSize, std::move(owner)));
+
+    return blob;
+}
+
 Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     ID3D12Device* device,
     ID3D12GraphicsCommandList* cmdList,
@@ -87,6 +161,15 @@ Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     return defaultBuffer;
 }
 
+UINT64 d3dUtil::ResourceBytes(ID3D12Device* device, ID3D12Resource* resource)
+{
+    if(resource == nullptr)
+        return 0;
+
+    D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    return device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+}
+
 ComPtr<ID3DBlob> d3dUtil::CompileShader(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
@@ -122,4 +205,62 @@ std::wstring DxException::ToString()const
     return FunctionName + L" failed in " + Filename + L"; line " + std::to_wstring(LineNumber) + L"; error: " + msg;
 }
 
+void MeshGeometry::ComputeBounds()
+{
+    assert(VertexBufferCPU != nullptr && VertexByteStride >= sizeof(DirectX::XMFLOAT3));
+
+    MeshBounds::Compute(VertexBufferCPU->GetBufferPointer(), VertexBufferByteSize / VertexByteStride,
+        VertexByteStride, Bounds, SphereBounds);
+
+    for(auto& arg : DrawArgs)
+        ComputeBounds(arg.second);
+}
+
+void MeshGeometry::ComputeBounds(SubmeshGeometry& submesh)const
+{
+    assert(VertexBufferCPU != nullptr && IndexBufferCPU != nullptr);
+
+    const void* vertices = VertexBufferCPU->GetBufferPointer();
+    const void* indices = IndexBufferCPU->GetBufferPointer();
+
+    if(IndexFormat == DXGI_FORMAT_R16_UINT)
+    {
+        MeshBounds::Compute(vertices, VertexByteStride,
+            static_cast<const std::uint16_t*>(indices) + submesh.StartIndexLocation,
+            submesh.IndexCount, submesh.BaseVertexLocation, submesh.Bounds, submesh.SphereBounds);
+    }
+    else
+    {
+        MeshBounds::Compute(vertices, VertexByteStride,
+            static_cast<const std::uint32_t*>(indices) + submesh.StartIndexLocation,
+            submesh.IndexCount, submesh.BaseVertexLocation, submesh.Bounds, submesh.SphereBounds);
+    }
+}
+
+namespace
+{
+    // Counts bytes under tag, or nothing when there are none
+    void Track(MemoryTracker::Allocation& allocation, MemoryTracker::Tag tag, UINT64 bytes)
+    {
+        if(bytes > 0)
+            allocation.Reset(tag, (size_t)bytes);
+        else
+            allocation.Reset();
+    }
+}
+
+void MeshGeometry::TrackMemory(ID3D12Device* device)
+{
+    Track(CpuMemory, MemoryTracker::GeometryCopies,
+        (VertexBufferCPU ? VertexBufferCPU->GetBufferSize() : 0) + (IndexBufferCPU ? IndexBufferCPU->GetBufferSize() : 0));
+    Track(GpuMemory, MemoryTracker::Geometry,
+        d3dUtil::ResourceBytes(device, VertexBufferGPU.Get()) + d3dUtil::ResourceBytes(device, IndexBufferGPU.Get()));
+    Track(UploaderMemory, MemoryTracker::UploadBuffers,
+        d3dUtil::ResourceBytes(device, VertexBufferUploader.Get()) + d3dUtil::ResourceBytes(device, IndexBufferUploader.Get()));
+}
 
+void Texture::TrackMemory(ID3D12Device* device)
+{
+    Track(ResourceMemory, MemoryTracker::Textures, d3dUtil::ResourceBytes(device, Resource.Get()));
+    Track(UploadHeapMemory, MemoryTracker::UploadBuffers, d3dUtil::ResourceBytes(device, UploadHeap.Get()));
+}
@@ -28,6 +28,8 @@
 #include "d3dx12.h"
 #include "DDSTextureLoader.h"
 #include "MathHelper.h"
+#include "MemoryTracker.h"
+#include "Light.h"
 
 extern const int gNumFrameResources;
 
@@ -114,6 +116,14 @@ public:
 
     static Microsoft::WRL::ComPtr<ID3DBlob> LoadBinary(const std::wstring& filename);
 
+    // Wraps memory owned by something else (e.g. a memory-mapped file) in a blob without
+    // copying it.  The blob keeps owner alive until it is released.  The memory may be
+    // read-only, so callers must not write through GetBufferPointer().
+    static Microsoft::WRL::ComPtr<ID3DBlob> CreateBlobView(
+        const void* data,
+        SIZE_T byteSize,
+        std::shared_ptr<const void> owner);
+
     static Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
         ID3D12Device* device,
         ID3D12GraphicsCommandList* cmdList,
@@ -121,6 +131,9 @@ public:
         UINT64 byteSize,
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
 
+    // Bytes the device sets aside for a resource, alignment included.  0 for null.
+    static UINT64 ResourceBytes(ID3D12Device* device, ID3D12Resource* resource);
+
 	static Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
 		const std::wstring& filename,
 		const D3D_SHADER_MACRO* defines,
@@ -155,6 +168,7 @@ struct SubmeshGeometry
     // Bounding box of the geometry defined by this submesh. 
     // This is used in later chapters of the book.
 	DirectX::BoundingBox Bounds;
+	DirectX::BoundingSphere SphereBounds;
 };
 
 struct MeshGeometry
@@ -184,6 +198,26 @@ struct MeshGeometry
 	// the Submeshes individually.
 	std::unordered_map<std::string, SubmeshGeometry> DrawArgs;
 
+	// Bounds of every vertex in the vertex buffer.
+	DirectX::BoundingBox Bounds;
+	DirectX::BoundingSphere SphereBounds;
+
+	// Fills in the bounds of the whole mesh and of every submesh in DrawArgs from the
+	// system memory copies.  Each vertex must start with its XMFLOAT3 position.
+	void ComputeBounds();
+
+	// Fills in the bounds of a submesh of this mesh kept outside DrawArgs.
+	void ComputeBounds(SubmeshGeometry& submesh)const;
+
+	// What the buffers above hold, as MemoryTracker counts it: the system memory copies,
+	// the GPU buffers and the uploaders.  TrackMemory counts whatever buffers are set, so
+	// call it once they all are.
+	MemoryTracker::Allocation CpuMemory;
+	MemoryTracker::Allocation GpuMemory;
+	MemoryTracker::Allocation UploaderMemory;
+
+	void TrackMemory(ID3D12Device* device);
+
 	D3D12_VERTEX_BUFFER_VIEW VertexBufferView()const
 	{
 		D3D12_VERTEX_BUFFER_VIEW vbv;
@@ -209,31 +243,10 @@ struct MeshGeometry
 	{
 		VertexBufferUploader = nullptr;
 		IndexBufferUploader = nullptr;
+		UploaderMemory.Reset();
 	}
 };
 
-struct Light
-{
-    DirectX::XMFLOAT3 Strength = { 0.5f, 0.5f, 0.5f };
-    float FalloffStart = 1.0f;                          // point/spot light only
-    DirectX::XMFLOAT3 Direction = { 0.0f, -1.0f, 0.0f };// directional/spot light only
-    float FalloffEnd = 10.0f;                           // point/spot light only
-    DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };  // point/spot light only
-    float SpotPower = 64.0f;                            // spot light only
-};
-
-#define MaxLights 16
-
-struct MaterialConstants
-{
-	DirectX::XMFLOAT4 DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 1.0f };
-	DirectX::XMFLOAT3 FresnelR0 = { 0.01f, 0.01f, 0.01f };
-	float Roughness = 0.25f;
-
-	// Used in texture mapping.
-	DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
-};
-
 // Simple struct to represent a material for our demos.  A production 3D engine
 // would likely create a class hierarchy of Materials.
 struct Material
@@ -273,6 +286,12 @@ struct Texture
 	//The texture resources & uplaod heap
 	Microsoft::WRL::ComPtr<ID3D12Resource> Resource = nullptr;
 	Microsoft::WRL::ComPtr<ID3D12Resource> UploadHeap = nullptr;
+
+	// What the resource and upload heap hold, as MemoryTracker counts it
+	MemoryTracker::Allocation ResourceMemory;
+	MemoryTracker::Allocation UploadHeapMemory;
+
+	void TrackMemory(ID3D12Device* device);
 };
 
 #ifndef ThrowIfFailed
@@ -0,0 +1,481 @@
+/*Filename: CubeScene.cpp
+ Description: Implementation file for CubeScene.h*/
+
+#include "CubeScene.h"
+#include "Common/MatrixStore.h"
+#include "Common/Profiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	//Seconds the camera takes to move to a new view
+	const float gCameraMoveTime = 0.5f;
+
+	//Degrees per second the whole cube spins, and how far each cubie lags the one before.
+	//Together they match the old spin of 0.0003 degrees per cubie per frame, on a 3x3x3 cube
+	//at 60 frames a second.
+	const float gSpinSpeed = 0.486f;
+	const float gSpinStagger = 0.0003f;
+
+	//Angle the cube is spun by before it has spun at all
+	const float gStartSpinAngle = 0.3f;
+
+	//Seconds a quarter turn of a face takes
+	const float gTurnTime = 0.25f;
+}
+
+CubeScene::CubeScene(int frameResourceCount)
+	: mFootprint(MemoryTracker::CubeState, sizeof(CubeScene)), mFrameResourceCount(frameResourceCount),
+	mPassFramesDirty(frameResourceCount)
+{
+	mTurns.SetTurnTime(gTurnTime);
+	mTurns.SetEasing(TurnEasing::SmoothStep);
+
+	//Look at the front, top and right faces from six units away
+	XMFLOAT3 centre(0.0f, 0.0f, 0.0f);
+	mCameraPresets[1] = Camera::OrbitPose::LookAt(XMFLOAT3(0.0f, 0.0f, -6.0f), centre, XMFLOAT3(0.0f, 1.0f, 0.0f));
+	mCameraPresets[2] = Camera::OrbitPose::LookAt(XMFLOAT3(0.0f, 6.0f, 0.0f), centre, XMFLOAT3(0.0f, 0.0f, 1.0f));
+	mCameraPresets[3] = Camera::OrbitPose::LookAt(XMFLOAT3(6.0f, 0.0f, 0.0f), centre, XMFLOAT3(0.0f, 1.0f, 0.0f));
+	ResetCamera();
+
+	//A whole-cube turn and a slice turn can both stage a cubie in the same frame
+	mStagedWorlds.reserve(2 * CubieCount);
+	mStagedWorldIndices.reserve(2 * CubieCount);
+	mMovedCubies.reserve(CubieCount);
+	mVisibleCubies.reserve(CubieCount);
+}
+
+void CubeScene::SetCubieMesh(const LodChains& lods, const BoundingBox& bounds,
+	const BoundingSphere& sphere, const std::vector<float>& lodDistances)
+{
+	mCubieLods = lods;
+	mCubieBounds = bounds;
+	mCubieSphere = sphere;
+	mCubieLodSelector = LodSelector(lodDistances);
+}
+
+void CubeScene::Reset()
+{
+	/*Use three nested for loops to place 3^3 individual cubes, giving each the next
+	constant buffer index*/
+	std::uint32_t object = 0;
+	for (float x = -1.0f; x <= 1.0f; x += 1.0f) {
+		for (float y = -1.0f; y <= 1.0f; y += 1.0f) {
+			for (float z = -1.0f; z <= 1.0f; z += 1.0f) {
+				Cubie& cubie = mCubies[object];
+				cubie = Cubie();
+				XMStoreFloat4x4(&cubie.World, XMMatrixTranslation(x, y, z));
+				cubie.ObjCBIndex = object;
+				cubie.NumFramesDirty = mFrameResourceCount;
+
+				//Only the faces on the outside of the cube are ever seen at rest
+				std::uint32_t exterior = 0;
+				if (z == -1.0f) exterior |= 1u << GeometryGenerator::CubieFront;
+				if (z == 1.0f) exterior |= 1u << GeometryGenerator::CubieBack;
+				if (y == 1.0f) exterior |= 1u << GeometryGenerator::CubieTop;
+				if (y == -1.0f) exterior |= 1u << GeometryGenerator::CubieBottom;
+				if (x == -1.0f) exterior |= 1u << GeometryGenerator::CubieLeft;
+				if (x == 1.0f) exterior |= 1u << GeometryGenerator::CubieRight;
+				cubie.ExteriorFaces = exterior;
+				if (!mCubieLods[AllFaces].empty())
+					cubie.Draw = mCubieLods[AllFaces][0];
+
+				//The mesh's bounds hold whichever level and faces are drawn
+				cubie.LocalBounds = mCubieBounds;
+				cubie.LocalSphere = mCubieSphere;
+				UpdateWorldBounds(cubie, XMLoadFloat4x4(&cubie.World));
+				object++;
+			}
+		}
+	}
+
+	//Build the hierarchy around where the cubies start; nothing has moved yet
+	mBounds.clear();
+	mPicker.Resize(CubieCount);
+	for (Cubie& cubie : mCubies) {
+		mBounds.push_back(cubie.WorldBounds);
+		mPicker.Set(cubie.ObjCBIndex, cubie.LocalBounds, XMLoadFloat4x4(&cubie.DrawnWorld));
+		cubie.BoundsMoved = false;
+	}
+	mMovedCubies.clear();
+	mBvh.Build(mBounds.data(), (std::uint32_t)mBounds.size());
+
+	//Every cubie starts solved and unspun with no turns waiting
+	mSpinAngle = gStartSpinAngle;
+	mPrevSpinAngle = gStartSpinAngle;
+	mTurns.Reset();
+	mTurns.TakeMovedCubies();
+	mStagedWorlds.clear();
+	mStagedWorldIndices.clear();
+
+	//Treat everything as visible until the first cull
+	mVisibleCubies.clear();
+	for (std::uint32_t i = 0; i < CubieCount; ++i)
+		mVisibleCubies.push_back(i);
+}
+
+void CubeScene::SetSpinAxis(char axis)
+{
+	mSpinAxis = axis;
+}
+
+char CubeScene::SpinAxis()const
+{
+	return mSpinAxis;
+}
+
+void CubeScene::SetCameraView(int view)
+{
+	if (view == mCameraView)
+		return;
+
+	mCameraView = view;
+	if (view == 0)
+		mCamera.OrbitTo(gCameraMoveTime);
+	else if (view >= 1 && view <= 3)
+		mCamera.MoveTo(mCameraPresets[view], gCameraMoveTime);
+}
+
+int CubeScene::CameraView()const
+{
+	return mCameraView;
+}
+
+void CubeScene::MoveEye(float dx, float dz)
+{
+	//Slide the eye across while it keeps looking at the centre of the cube
+	XMFLOAT3 eye = mCamera.GetPosition3f();
+	eye.x += dx;
+	eye.z += dz;
+	mCamera.LookAt(eye, XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+	mCameraView = 6;
+}
+
+void CubeScene::ResetCamera()
+{
+	//Orbit the centre of the cube from the same place every time
+	mCamera.SetOrbitLimits(9.0f, 1500.0f, 0.1f, MathHelper::Pi - 0.1f);
+	mCamera.SetOrbit(XMFLOAT3(0.0f, 0.0f, 0.0f), 9.0f, 1.3f*XM_PI, 0.4f*XM_PI);
+	mCamera.OrbitTo(0.0f);
+	mCameraView = 0;
+}
+
+void CubeScene::QueueScramble(int length)
+{
+	//Random turns, never two in a row about the same axis so none of them merge away
+	const char faces[] = "LRDUFB";
+	int lastAxis = -1;
+	for (int i = 0; i < length; ++i) {
+		int axis = MathHelper::Rand(0, 2);
+		if (axis == lastAxis)
+			axis = (axis + MathHelper::Rand(1, 2)) % 3;
+		lastAxis = axis;
+		mTurns.Push(faces[2 * axis + MathHelper::Rand(0, 1)], MathHelper::Rand(1, 3));
+	}
+}
+
+void CubeScene::SetViewport(float width, float height)
+{
+	mViewportWidth = width;
+	mViewportHeight = height;
+
+	//Update the aspect ratio and recompute the projection matrix
+	mCamera.SetLens(0.25f*MathHelper::Pi, width / height, 1.0f, 1000.0f);
+	mPassFramesDirty = mFrameResourceCount;
+}
+
+TurnQueue& CubeScene::Turns()
+{
+	return mTurns;
+}
+
+Camera& CubeScene::GetCamera()
+{
+	return mCamera;
+}
+
+bool CubeScene::Pick(float x, float y, PickHit& hit)
+{
+	//The camera may have been dragged since the last frame
+	if (mCamera.UpdateViewMatrix())
+		mPassFramesDirty = mFrameResourceCount;
+
+	PickRay ray = PickRay::FromScreen(x, y, mViewportWidth, mViewportHeight, mCamera.GetView(), mCamera.GetProj());
+	return mPicker.Pick(mBvh, ray, 1000.0f, hit);
+}
+
+void CubeScene::Simulate(float dt)
+{
+	PROFILE_ZONE("CubeScene::Simulate");
+	//Spin the entire cube while an axis is selected
+	mPrevSpinAngle = mSpinAngle;
+	switch (mSpinAxis) {
+	case 'x':
+	case 'y':
+	case 'z':
+		mSpinAngle += gSpinSpeed * dt;
+		break;
+	}
+
+	//Move the face turns on, and leave the cubies of any that finished where they landed
+	mTurns.Advance(dt);
+	std::uint32_t moved = mTurns.TakeMovedCubies();
+	for (int c = 0; c < CubieCount; ++c) {
+		if ((moved & (1u << c)) == 0)
+			continue;
+		XMStoreFloat4x4(&mCubies[c].World, mTurns.SettledWorld(c));
+		mCubies[c].NumFramesDirty = mFrameResourceCount;
+	}
+}
+
+void CubeScene::UpdateCamera(float dt)
+{
+	mCamera.Update(dt);
+
+	//Only rebuild the view, and the pass constants made from it, when the camera moved
+	if (mCamera.UpdateViewMatrix())
+		mPassFramesDirty = mFrameResourceCount;
+}
+
+void CubeScene::UpdateLods()
+{
+	//Faces pointing into the cube can only be seen while a slice is part way through a turn
+	bool sliceTurning = IsSliceTurning();
+
+	//Pick a level of detail for each cube based on how far it is from the eye
+	XMVECTOR eye = mCamera.GetPosition();
+	for (Cubie& cubie : mCubies) {
+		const std::vector<DrawArgs>& lods = mCubieLods[sliceTurning ? AllFaces : cubie.ExteriorFaces];
+		if (lods.empty())
+			continue;
+
+		XMVECTOR centre = XMVectorSet(cubie.World._41, cubie.World._42, cubie.World._43, 1.0f);
+		float distanceSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(centre, eye)));
+		cubie.LodIndex = mCubieLodSelector.Select(distanceSq, cubie.LodIndex);
+		cubie.Draw = lods[cubie.LodIndex];
+	}
+}
+
+void CubeScene::UpdateObjects(float alpha)
+{
+	PROFILE_ZONE("CubeScene::UpdateObjects");
+	//Draw the spin where it is between the last two simulation steps
+	float rotated = mPrevSpinAngle + (mSpinAngle - mPrevSpinAngle) * alpha;
+
+	//Rotates each cube based on the axis for the whole cube to rotate across
+	for (Cubie& cubie : mCubies) {
+		XMMATRIX rot;
+		switch (mSpinAxis) {
+		case 'x': rot = XMMatrixRotationX(XMConvertToRadians(rotated)); break;
+		case 'y': rot = XMMatrixRotationY(XMConvertToRadians(rotated)); break;
+		case 'z': rot = XMMatrixRotationZ(XMConvertToRadians(rotated)); break;
+		default: return;
+		}
+		rotated += gSpinStagger;
+		StageWorld(cubie, XMLoadFloat4x4(&cubie.World) * rot);
+	}
+}
+
+void CubeScene::RotateThird(float lookAhead)
+{
+	PROFILE_ZONE("CubeScene::RotateThird");
+	//Draw the cubies of every face turn in progress where they are between the last two
+	//simulation steps
+	for (size_t i = 0; i < mTurns.ActiveCount(); ++i) {
+		XMMATRIX rot = mTurns.ActiveRotation(i, lookAhead);
+		for (auto c : mTurns.ActiveCubies(i)) {
+			Cubie& cubie = mCubies[c];
+			StageWorld(cubie, XMLoadFloat4x4(&cubie.World) * rot);
+		}
+	}
+}
+
+void CubeScene::StoreStagedWorlds(const FrameConstants& frame)
+{
+	//Write every staged matrix straight into its object constants in one pass.  The World
+	//matrix is the first member, so each lands at the start of its element.
+	static_assert(offsetof(ObjectConstants, World) == 0, "World must start the object constants");
+	MatrixStore::StoreTransposed(frame.Objects, frame.ObjectStride,
+		mStagedWorlds.data(), mStagedWorldIndices.data(), mStagedWorlds.size());
+
+	mStagedWorlds.clear();
+	mStagedWorldIndices.clear();
+}
+
+void CubeScene::UpdateObjectCBs(const FrameConstants& frame)
+{
+	PROFILE_ZONE("CubeScene::UpdateObjectCBs");
+	std::uint8_t* objects = static_cast<std::uint8_t*>(frame.Objects);
+	for (Cubie& cubie : mCubies) {
+		//Only update the cbuffer data if the constants have changed.  This needs to be
+		//tracked per frame resource.
+		if (cubie.NumFramesDirty > 0) {
+			XMMATRIX world = XMLoadFloat4x4(&cubie.World);
+			XMMATRIX texTransform = XMLoadFloat4x4(&cubie.TexTransform);
+
+			ObjectConstants objConstants;
+			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
+			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+
+			std::memcpy(objects + cubie.ObjCBIndex * frame.ObjectStride, &objConstants, sizeof(ObjectConstants));
+			UpdateWorldBounds(cubie, world);
+
+			//Next FrameResource need to be updated too.
+			cubie.NumFramesDirty--;
+		}
+	}
+}
+
+void CubeScene::UpdateVisibility()
+{
+	//Refit the hierarchy around the cubies that moved, usually just the turning slice
+	for (auto index : mMovedCubies) {
+		Cubie& cubie = mCubies[index];
+		mBounds[index] = cubie.WorldBounds;
+		mPicker.Set(index, cubie.LocalBounds, XMLoadFloat4x4(&cubie.DrawnWorld));
+		cubie.BoundsMoved = false;
+	}
+	mBvh.Refit(mBounds.data(), mMovedCubies.data(), (std::uint32_t)mMovedCubies.size());
+	mMovedCubies.clear();
+
+	mVisibleCubies.clear();
+	mBvh.QueryFrustum(mCamera.GetFrustumPlanes(), mVisibleCubies);
+}
+
+void CubeScene::UpdateMainPassCB(const FrameConstants& frame, float totalTime, float dt)
+{
+	PROFILE_ZONE("CubeScene::UpdateMainPassCB");
+	//Nothing the shaders read changes unless the camera or viewport did, so each frame
+	//resource keeps the constants it was last given.  The times are left stale as no
+	//shader uses them.
+	if (mPassFramesDirty <= 0)
+		return;
+
+	XMMATRIX view = mCamera.GetView();
+	XMMATRIX proj = mCamera.GetProj();
+
+	//The camera keeps its inverses alongside its matrices, so none need a general inverse
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+	XMMATRIX invView = mCamera.GetInvView();
+	XMMATRIX invProj = mCamera.GetInvProj();
+	XMMATRIX invViewProj = XMMatrixMultiply(invProj, invView);
+
+	XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
+	XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
+	XMStoreFloat4x4(&mMainPassCB.Proj, XMMatrixTranspose(proj));
+	XMStoreFloat4x4(&mMainPassCB.InvProj, XMMatrixTranspose(invProj));
+	XMStoreFloat4x4(&mMainPassCB.ViewProj, XMMatrixTranspose(viewProj));
+	XMStoreFloat4x4(&mMainPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
+	mMainPassCB.EyePosW = mCamera.GetPosition3f();
+	mMainPassCB.RenderTargetSize = XMFLOAT2(mViewportWidth, mViewportHeight);
+	mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / mViewportWidth, 1.0f / mViewportHeight);
+	mMainPassCB.NearZ = mCamera.GetNearZ();
+	mMainPassCB.FarZ = mCamera.GetFarZ();
+	mMainPassCB.TotalTime = totalTime;
+	mMainPassCB.DeltaTime = dt;
+
+	//Directional Lights
+	mMainPassCB.Lights[0].Direction = { -3.0f, 0.0f, -3.0f };
+	mMainPassCB.Lights[0].Strength = { 0.3f, 0.3f, 0.3f };
+
+	mMainPassCB.Lights[1].Direction = { 3.0f, 0.0f, 3.0f };
+	mMainPassCB.Lights[1].Strength = { 0.3f, 0.3f, 0.3f };
+
+	//Point Lights
+	mMainPassCB.Lights[2].Position = { 0.0f, -6.0f, 0.0f };
+	mMainPassCB.Lights[2].Strength = { 2.0f, 2.0f, 2.0f };
+
+	//Spotlight
+	mMainPassCB.Lights[3].Position = { 0.0f, 6.0f, 0.0f };
+	mMainPassCB.Lights[3].Direction = { 0.0f, -1.0f, 0.0f };
+	mMainPassCB.Lights[3].Strength = { 1.0f, 1.0f, 1.0f };
+	mMainPassCB.Lights[3].SpotPower = 0.001f;
+
+	*frame.Pass = mMainPassCB;
+	mPassFramesDirty--;
+}
+
+void CubeScene::RecordDraws(const CubieBindings& bindings, RenderCommands& commands)const
+{
+	PROFILE_ZONE("CubeScene::RecordDraws");
+	for (auto index : mVisibleCubies) {
+		const Cubie& cubie = mCubies[index];
+
+		//The cube at the very centre has no faces on the outside to draw
+		if (cubie.Draw.IndexCount == 0)
+			continue;
+
+		commands.SetVertexBuffer(bindings.Vertices);
+		commands.SetIndexBuffer(bindings.Indices);
+		commands.SetPrimitiveTopology(RenderCommands::TriangleList);
+
+		commands.SetRootDescriptorTable(RootTexture, bindings.Texture);
+		commands.SetRootConstantBufferView(RootObject, bindings.Objects + cubie.ObjCBIndex * bindings.ObjectStride);
+		commands.SetRootConstantBufferView(RootMaterial, bindings.Material);
+
+		commands.DrawIndexed(cubie.Draw.IndexCount, cubie.Draw.StartIndexLocation, cubie.Draw.BaseVertexLocation);
+	}
+}
+
+bool CubeScene::IsSliceTurning()const
+{
+	return mTurns.IsTurning();
+}
+
+const Cubie& CubeScene::GetCubie(int i)const
+{
+	return mCubies[i];
+}
+
+const std::vector<std::uint32_t>& CubeScene::VisibleCubies()const
+{
+	return mVisibleCubies;
+}
+
+float CubeScene::LargestCubieOnScreen()const
+{
+	//A sphere of radius r, d away, covers about 2r / (2d tan(fovY/2)) of the viewport's height
+	XMVECTOR eye = mCamera.GetPosition();
+	float screenPerUnit = 1.0f / (2.0f * tanf(0.5f * mCamera.GetFovY()));
+	float largest = 0.0f;
+	for (auto index : mVisibleCubies) {
+		const BoundingSphere& sphere = mCubies[index].WorldSphere;
+		float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&sphere.Center) - eye));
+
+		//The camera is inside the cubie, which fills the screen
+		if (distance <= sphere.Radius)
+			return mViewportHeight;
+
+		largest = (std::max)(largest, 2.0f * sphere.Radius / distance * screenPerUnit * mViewportHeight);
+	}
+	return (std::min)(largest, mViewportHeight);
+}
+
+void CubeScene::UpdateWorldBounds(Cubie& cubie, FXMMATRIX world)
+{
+	//Keep the bounds following whatever the cubie is drawn with
+	cubie.LocalBounds.Transform(cubie.WorldBounds, world);
+	cubie.LocalSphere.Transform(cubie.WorldSphere, world);
+	XMStoreFloat4x4(&cubie.DrawnWorld, world);
+
+	//Only the cubies that moved need refitting into the hierarchy
+	if (!cubie.BoundsMoved) {
+		cubie.BoundsMoved = true;
+		mMovedCubies.push_back(cubie.ObjCBIndex);
+	}
+}
+
+void CubeScene::StageWorld(Cubie& cubie, FXMMATRIX world)
+{
+	//Only the world matrix changes while a cubie turns; its texture transform is already
+	//in the constants from when it was last dirty
+	mStagedWorlds.emplace_back();
+	XMStoreFloat4x4(&mStagedWorlds.back(), world);
+	mStagedWorldIndices.push_back(cubie.ObjCBIndex);
+	UpdateWorldBounds(cubie, world);
+}
@@ -0,0 +1,210 @@
+/*Filename: CubeScene.h
+ Description: The cube as the CPU sees it, with no window or device: where every cubie
+ is, the spin and face turns moving them, the camera, which level of detail each cubie
+ draws, which cubies are in view, and the constants the shaders read.  Rubix draws it
+ with D3D12; the headless runner drives the same code with no GPU at all.
+
+ A frame runs the stages in the order Rubix::Update calls them, and writes its constants
+ through a FrameConstants, which points either at a frame resource's mapped constant
+ buffers or at plain memory.*/
+
+#pragma once
+#include "Common/Bvh.h"
+#include "Common/Camera.h"
+#include "Common/GeometryGenerator.h"
+#include "Common/MemoryTracker.h"
+#include "Common/MeshSimplifier.h"
+#include "Common/RayPicker.h"
+#include "Common/RenderCommands.h"
+#include "RenderTypes.h"
+#include "TurnQueue.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//One of the 27 cubies
+struct Cubie
+{
+	//Where the cubie rests after the last turn that moved it
+	DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+
+	//Frame resources whose object constants are still waiting for World and TexTransform
+	int NumFramesDirty = 0;
+
+	//Which object constants are the cubie's
+	std::uint32_t ObjCBIndex = 0;
+
+	//Bitmask of the GeometryGenerator::CubieFace faces that point out of the puzzle, the
+	//level of detail drawn, and the draw that gives
+	std::uint32_t ExteriorFaces = 0;
+	std::uint32_t LodIndex = 0;
+	DrawArgs Draw;
+
+	//Bounds of the cubie mesh, and the same bounds moved by the world matrix most recently
+	//written to the object constants
+	DirectX::BoundingBox LocalBounds;
+	DirectX::BoundingSphere LocalSphere;
+	DirectX::BoundingBox WorldBounds;
+	DirectX::BoundingSphere WorldSphere;
+
+	//That world matrix itself, which is not World while the cubie is turning
+	DirectX::XMFLOAT4X4 DrawnWorld = MathHelper::Identity4x4();
+
+	//Set once the world bounds have moved and are waiting to be refit into the hierarchy
+	bool BoundsMoved = false;
+};
+
+//Where a frame's constants are written
+struct FrameConstants
+{
+	//The first object's constants, with each of the others ObjectStride bytes further on
+	void* Objects = nullptr;
+	size_t ObjectStride = sizeof(ObjectConstants);
+
+	PassConstants* Pass = nullptr;
+};
+
+//What every cubie is drawn from: the cubie mesh's buffers, the texture and material they
+//share, and the GPU addresses of the object constants a FrameConstants wrote to
+struct CubieBindings
+{
+	RenderCommands::VertexBufferView Vertices;
+	RenderCommands::IndexBufferView Indices;
+	std::uint64_t Texture = 0;
+	std::uint64_t Objects = 0;
+	std::uint64_t ObjectStride = 0;
+	std::uint64_t Material = 0;
+};
+
+class CubeScene
+{
+public:
+	static const int CubieCount = TurnQueue::CubieCount;
+
+	//Every combination of the cubie's faces, as a bitmask of GeometryGenerator::CubieFace
+	static const std::uint32_t AllFaces = (1u << GeometryGenerator::CubieFaceCount) - 1;
+
+	//Draws of every combination of faces, finest level first
+	using LodChains = std::array<std::vector<DrawArgs>, AllFaces + 1>;
+
+	//Each change to the constants is written frameResourceCount times, once to each copy
+	//of them that frames take turns to use.
+	explicit CubeScene(int frameResourceCount);
+
+	//The cubie mesh: the draws for each combination of faces, the bounds of the whole
+	//cubie, which hold every level, and the distances to step to coarser levels at.
+	void SetCubieMesh(const LodChains& lods, const DirectX::BoundingBox& bounds,
+		const DirectX::BoundingSphere& sphere, const std::vector<float>& lodDistances);
+
+	//Back to a solved cube with nothing turning.  Leaves the spin and camera alone.
+	void Reset();
+
+	//Spins the whole cube about 'x', 'y' or 'z', or stops it for anything else.
+	void SetSpinAxis(char axis);
+	char SpinAxis()const;
+
+	//Heads for view 0 (orbiting) or 1 to 3 (looking at a face) when the view changes.  Any
+	//other view, such as 6 after MoveEye, leaves the camera where it is.
+	void SetCameraView(int view);
+	int CameraView()const;
+
+	//Slides the eye across while it keeps looking at the centre of the cube, which
+	//switches to view 6.
+	void MoveEye(float dx, float dz);
+
+	//Orbits the centre from where the camera starts.
+	void ResetCamera();
+
+	//Queues random turns, never two in a row about the same axis.
+	void QueueScramble(int length);
+
+	//Lens for a window of the given size, and the size the pass constants are given.
+	void SetViewport(float width, float height);
+
+	TurnQueue& Turns();
+	Camera& GetCamera();
+
+	//Finds the cubie and face under a point of the viewport.
+	bool Pick(float x, float y, PickHit& hit);
+
+	//One fixed simulation step.
+	void Simulate(float dt);
+
+	//The stages of a frame, in the order they run.  alpha is how far the frame is between
+	//the last two simulation steps, and lookAhead the seconds that is past the last one.
+	void UpdateCamera(float dt);
+	void UpdateLods();
+	void UpdateObjects(float alpha);
+	void RotateThird(float lookAhead);
+	void StoreStagedWorlds(const FrameConstants& frame);
+	void UpdateObjectCBs(const FrameConstants& frame);
+	void UpdateVisibility();
+	void UpdateMainPassCB(const FrameConstants& frame, float totalTime, float dt);
+
+	//Records a draw of each visible cubie on its own, binding everything every draw needs.
+	void RecordDraws(const CubieBindings& bindings, RenderCommands& commands)const;
+
+	bool IsSliceTurning()const;
+	const Cubie& GetCubie(int i)const;
+
+	//The cubies at least partly inside the view frustum, as of the last UpdateVisibility.
+	const std::vector<std::uint32_t>& VisibleCubies()const;
+
+	//How many pixels tall the nearest visible cubie is drawn, as of the last UpdateVisibility,
+	//or 0 if none is visible.  Textures are streamed in as fine as that needs.
+	float LargestCubieOnScreen()const;
+
+private:
+	void UpdateWorldBounds(Cubie& cubie, DirectX::FXMMATRIX world);
+	void StageWorld(Cubie& cubie, DirectX::FXMMATRIX world);
+
+	//The scene itself, with its cubies, turns and camera, counted as cube state
+	MemoryTracker::Allocation mFootprint;
+
+	int mFrameResourceCount;
+
+	std::array<Cubie, CubieCount> mCubies;
+
+	//Levels of detail for the cubie mesh and the distances to switch between them
+	LodChains mCubieLods;
+	LodSelector mCubieLodSelector;
+	DirectX::BoundingBox mCubieBounds;
+	DirectX::BoundingSphere mCubieSphere;
+
+	//Hierarchy over the cubies' world bounds, and the cubies that have moved since it was
+	//last refit
+	Bvh mBvh;
+	std::vector<DirectX::BoundingBox, CubeStateAllocator<DirectX::BoundingBox>> mBounds;
+	std::vector<std::uint32_t, CubeStateAllocator<std::uint32_t>> mMovedCubies;
+
+	//Finds the cubie and face under the cursor
+	RayPicker mPicker;
+
+	//World matrices of the cubies moving this frame, and the object constants they go to
+	std::vector<DirectX::XMFLOAT4X4, CubeStateAllocator<DirectX::XMFLOAT4X4>> mStagedWorlds;
+	std::vector<std::uint32_t, CubeStateAllocator<std::uint32_t>> mStagedWorldIndices;
+
+	std::vector<std::uint32_t> mVisibleCubies;
+
+	//Face turns waiting to be made and in progress, and where every cubie has got to
+	TurnQueue mTurns;
+
+	//Axis the whole cube spins about, and the angle it is spun by at the last two steps
+	char mSpinAxis = ' ';
+	float mSpinAngle = 0.3f;
+	float mPrevSpinAngle = 0.3f;
+
+	//Orbits the cube or moves between the views of its faces, and the view it was last
+	//sent to.  The poses for views 1 to 3 never change so they are worked out up front.
+	Camera mCamera;
+	std::array<Camera::OrbitPose, 4> mCameraPresets;
+	int mCameraView = 0;
+	float mViewportWidth = 1.0f;
+	float mViewportHeight = 1.0f;
+
+	//The pass constants only change with the camera or the viewport
+	PassConstants mMainPassCB;
+	int mPassFramesDirty = 0;
+};
@@ -0,0 +1,224 @@
+/*Filename: CubieBatch.cpp
+ Description: Implementation file for CubieBatch.h*/
+
+#include "CubieBatch.h"
+#include <climits>
+#include <cstring>
+
+void CubieBatch::SetSource(const Vertex* vertices, UINT vertexCount, const std::uint16_t* indices, UINT indexCount)
+{
+	mSourceVertices = vertices;
+	mSourceVertexCount = vertexCount;
+	mSourceIndices = indices;
+	mSourceIndexCount = indexCount;
+
+	//Everything has to be rebuilt from the new source
+	for (auto& c : mCubies)
+		c.Dirty = true;
+}
+
+void CubieBatch::Resize(UINT cubieCount)
+{
+	mCubies.assign(cubieCount, Cubie());
+	mVertices.clear();
+	mIndices.clear();
+}
+
+UINT CubieBatch::CubieCount()const
+{
+	return (UINT)mCubies.size();
+}
+
+UINT CubieBatch::BatchedVertexCount(const SubmeshGeometry& submesh)const
+{
+	Cubie cubie;
+	cubie.Submesh.IndexCount = submesh.IndexCount;
+	cubie.Submesh.StartIndexLocation = submesh.StartIndexLocation;
+	cubie.Submesh.BaseVertexLocation = submesh.BaseVertexLocation;
+	MeasureSource(cubie);
+
+	return cubie.VertexCount;
+}
+
+void CubieBatch::SetCubie(UINT cubie, UINT cubieId, const SubmeshGeometry& submesh)
+{
+	Cubie& c = mCubies[cubie];
+	if (c.CubieId == cubieId &&
+		c.Submesh.IndexCount == submesh.IndexCount &&
+		c.Submesh.StartIndexLocation == submesh.StartIndexLocation &&
+		c.Submesh.BaseVertexLocation == submesh.BaseVertexLocation)
+		return;
+
+	c.CubieId = cubieId;
+	c.Submesh.IndexCount = submesh.IndexCount;
+	c.Submesh.StartIndexLocation = submesh.StartIndexLocation;
+	c.Submesh.BaseVertexLocation = submesh.BaseVertexLocation;
+	c.Dirty = true;
+}
+
+void CubieBatch::MeasureSource(Cubie& cubie)const
+{
+	//Only copy the range of vertices the submesh actually uses
+	const std::uint16_t* indices = mSourceIndices + cubie.Submesh.StartIndexLocation;
+	UINT lowest = UINT_MAX;
+	UINT highest = 0;
+	for (UINT i = 0; i < cubie.Submesh.IndexCount; ++i) {
+		lowest = (std::min)(lowest, (UINT)indices[i]);
+		highest = (std::max)(highest, (UINT)indices[i]);
+	}
+
+	cubie.FirstIndex = cubie.Submesh.IndexCount ? lowest : 0;
+	cubie.VertexCount = cubie.Submesh.IndexCount ? highest - lowest + 1 : 0;
+}
+
+void CubieBatch::Emit(const Cubie& cubie, BatchedVertex* vertices, std::uint32_t* indices)const
+{
+	const Vertex* source = mSourceVertices + cubie.Submesh.BaseVertexLocation + cubie.FirstIndex;
+	for (UINT i = 0; i < cubie.VertexCount; ++i) {
+		vertices[i].Pos = source[i].Pos;
+		vertices[i].Normal = source[i].Normal;
+		vertices[i].TexC = source[i].TexC;
+		vertices[i].CubieId = cubie.CubieId;
+	}
+
+	//Indices are absolute in the batch, as it is drawn with a base vertex of 0
+	const std::uint16_t* sourceIndices = mSourceIndices + cubie.Submesh.StartIndexLocation;
+	for (UINT i = 0; i < cubie.Submesh.IndexCount; ++i)
+		indices[i] = cubie.BatchVertexStart + (sourceIndices[i] - cubie.FirstIndex);
+}
+
+bool CubieBatch::Update()
+{
+	bool changed = false;
+
+	//Patch cubies that still fit their old space, up to the first one that does not
+	UINT firstResized = (UINT)mCubies.size();
+	for (UINT i = 0; i < mCubies.size(); ++i) {
+		Cubie& c = mCubies[i];
+		if (!c.Dirty)
+			continue;
+
+		MeasureSource(c);
+		if (i < firstResized && c.VertexCount == c.BatchVertexCount && c.Submesh.IndexCount == c.BatchIndexCount) {
+			Emit(c, mVertices.data() + c.BatchVertexStart, mIndices.data() + c.BatchIndexStart);
+			c.Dirty = false;
+			changed = true;
+		}
+		else if (firstResized == mCubies.size()) {
+			firstResized = i;
+		}
+	}
+
+	if (firstResized == mCubies.size())
+		return changed;
+
+	//Everything from the first resized cubie onwards moves, so rebuild the tail of the
+	//buffers, copying unchanged cubies across from their old position
+	const UINT vertexTail = mCubies[firstResized].BatchVertexStart;
+	const UINT indexTail = mCubies[firstResized].BatchIndexStart;
+	mVertexScratch.assign(mVertices.begin() + vertexTail, mVertices.end());
+	mIndexScratch.assign(mIndices.begin() + indexTail, mIndices.end());
+	mVertices.resize(vertexTail);
+	mIndices.resize(indexTail);
+
+	for (UINT i = firstResized; i < mCubies.size(); ++i) {
+		Cubie& c = mCubies[i];
+		const UINT oldVertexStart = c.BatchVertexStart;
+		const UINT oldIndexStart = c.BatchIndexStart;
+
+		c.BatchVertexStart = (UINT)mVertices.size();
+		c.BatchIndexStart = (UINT)mIndices.size();
+
+		if (c.Dirty) {
+			c.BatchVertexCount = c.VertexCount;
+			c.BatchIndexCount = c.Submesh.IndexCount;
+			mVertices.resize(mVertices.size() + c.BatchVertexCount);
+			mIndices.resize(mIndices.size() + c.BatchIndexCount);
+			Emit(c, mVertices.data() + c.BatchVertexStart, mIndices.data() + c.BatchIndexStart);
+			c.Dirty = false;
+		}
+		else {
+			auto vertices = mVertexScratch.begin() + (oldVertexStart - vertexTail);
+			mVertices.insert(mVertices.end(), vertices, vertices + c.BatchVertexCount);
+
+			//Shift the indices to where the cubie's vertices now start
+			auto indices = mIndexScratch.begin() + (oldIndexStart - indexTail);
+			for (UINT j = 0; j < c.BatchIndexCount; ++j)
+				mIndices.push_back(indices[j] - oldVertexStart + c.BatchVertexStart);
+		}
+	}
+
+	return true;
+}
+
+const std::vector<BatchedVertex>& CubieBatch::Vertices()const
+{
+	return mVertices;
+}
+
+const std::vector<std::uint32_t>& CubieBatch::Indices()const
+{
+	return mIndices;
+}
+
+bool CubieBatch::Validate(std::string& error)const
+{
+	UINT vertexStart = 0;
+	UINT indexStart = 0;
+	for (UINT i = 0; i < mCubies.size(); ++i) {
+		const Cubie& c = mCubies[i];
+		const std::string cubie = "cubie " + std::to_string(i) + ": ";
+
+		if (c.Dirty) {
+			error = cubie + "has changes that have not been batched";
+			return false;
+		}
+		if (c.BatchVertexStart != vertexStart || c.BatchIndexStart != indexStart) {
+			error = cubie + "is not packed directly after the cubie before it";
+			return false;
+		}
+		if (c.BatchIndexCount != c.Submesh.IndexCount) {
+			error = cubie + "has " + std::to_string(c.BatchIndexCount) + " indices but its submesh has " +
+				std::to_string(c.Submesh.IndexCount);
+			return false;
+		}
+		if ((std::uint64_t)c.Submesh.StartIndexLocation + c.Submesh.IndexCount > mSourceIndexCount) {
+			error = cubie + "submesh runs past the end of the source indices";
+			return false;
+		}
+
+		for (UINT j = 0; j < c.Submesh.IndexCount; ++j) {
+			const UINT batchIndex = mIndices[c.BatchIndexStart + j];
+			const UINT sourceIndex = c.Submesh.BaseVertexLocation + mSourceIndices[c.Submesh.StartIndexLocation + j];
+
+			if (batchIndex < c.BatchVertexStart || batchIndex >= c.BatchVertexStart + c.BatchVertexCount) {
+				error = cubie + "index " + std::to_string(j) + " points outside the cubie's vertices";
+				return false;
+			}
+			if (sourceIndex >= mSourceVertexCount) {
+				error = cubie + "index " + std::to_string(j) + " points outside the source vertices";
+				return false;
+			}
+
+			const BatchedVertex& batched = mVertices[batchIndex];
+			const Vertex& source = mSourceVertices[sourceIndex];
+			if (batched.CubieId != c.CubieId ||
+				std::memcmp(&batched.Pos, &source.Pos, sizeof(source.Pos)) != 0 ||
+				std::memcmp(&batched.Normal, &source.Normal, sizeof(source.Normal)) != 0 ||
+				std::memcmp(&batched.TexC, &source.TexC, sizeof(source.TexC)) != 0) {
+				error = cubie + "vertex for index " + std::to_string(j) + " does not match the source";
+				return false;
+			}
+		}
+
+		vertexStart += c.BatchVertexCount;
+		indexStart += c.BatchIndexCount;
+	}
+
+	if (vertexStart != mVertices.size() || indexStart != mIndices.size()) {
+		error = "the merged buffers hold data that belongs to no cubie";
+		return false;
+	}
+
+	return true;
+}
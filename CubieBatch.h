@@ -0,0 +1,74 @@
+/*Filename: CubieBatch.h
+ Description: Merges the geometry every cubie draws into one vertex and index buffer,
+ so the whole cube can be drawn with a single call.  Each merged vertex carries the id
+ of its cubie, which the batched vertex shader uses to look up that cubie's transform*/
+
+#pragma once
+#include "FrameResource.h"
+
+class CubieBatch
+{
+public:
+	//The cubie geometry that submeshes passed to SetCubie refer to.  It must stay alive
+	//for as long as the batch is used.
+	void SetSource(const Vertex* vertices, UINT vertexCount, const std::uint16_t* indices, UINT indexCount);
+
+	//Sets the number of cubies in the batch and empties it.  Cubies draw nothing until SetCubie is called.
+	void Resize(UINT cubieCount);
+	UINT CubieCount()const;
+
+	//Number of vertices a cubie drawing submesh adds to the batch
+	UINT BatchedVertexCount(const SubmeshGeometry& submesh)const;
+
+	//Sets the submesh of the source geometry cubie draws and the id written into its vertices.
+	//Cubies that change are rebuilt at the next Update.
+	void SetCubie(UINT cubie, UINT cubieId, const SubmeshGeometry& submesh);
+
+	//Brings the merged buffers up to date.  Cubies whose geometry kept the same size are
+	//patched in place; otherwise everything after the first cubie that changed size is
+	//moved along, and only the cubies that changed are rebuilt from the source.
+	//Returns true if the merged buffers changed.
+	bool Update();
+
+	const std::vector<BatchedVertex>& Vertices()const;
+	const std::vector<std::uint32_t>& Indices()const;
+
+	//Checks every cubie's part of the merged buffers against the source geometry it was
+	//built from.  Returns false and describes the first mismatch found if they differ.
+	bool Validate(std::string& error)const;
+
+private:
+	struct Cubie
+	{
+		UINT CubieId = 0;
+		SubmeshGeometry Submesh;
+
+		//The source vertices the submesh uses are [BaseVertexLocation + FirstIndex, +VertexCount)
+		UINT FirstIndex = 0;
+		UINT VertexCount = 0;
+
+		//Where this cubie lives in the merged buffers
+		UINT BatchVertexStart = 0;
+		UINT BatchIndexStart = 0;
+		UINT BatchVertexCount = 0;
+		UINT BatchIndexCount = 0;
+
+		bool Dirty = false;
+	};
+
+	void MeasureSource(Cubie& cubie)const;
+	void Emit(const Cubie& cubie, BatchedVertex* vertices, std::uint32_t* indices)const;
+
+	const Vertex* mSourceVertices = nullptr;
+	UINT mSourceVertexCount = 0;
+	const std::uint16_t* mSourceIndices = nullptr;
+	UINT mSourceIndexCount = 0;
+
+	std::vector<Cubie> mCubies;
+	std::vector<BatchedVertex> mVertices;
+	std::vector<std::uint32_t> mIndices;
+
+	//Scratch copies of the tail of the merged buffers, kept to avoid reallocating every rebatch
+	std::vector<BatchedVertex> mVertexScratch;
+	std::vector<std::uint32_t> mIndexScratch;
+};
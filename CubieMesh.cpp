@@ -0,0 +1,178 @@
+/*Filename: CubieMesh.cpp
+ Description: Implementation file for CubieMesh.h*/
+
+#include "CubieMesh.h"
+#include "Common/MeshBounds.h"
+#include <type_traits>
+
+static_assert(CubieMesh::LodCount == std::tuple_size<decltype(CubieMeshDesc::Lods)>::value + 1,
+	"CubieMesh::LodCount must match the number of simplified levels");
+static_assert(std::is_trivially_copyable<CubieMeshDesc>::value, "CubieMeshDesc is hashed as raw bytes");
+
+//Bump whenever CreateCubie, MeshSimplifier or the layout below start producing different
+//output for the same CubieMeshDesc, so caches written by older builds are thrown away.
+static const std::uint32_t gCubieGeneratorRevision = 1;
+
+CubieMesh BuildCubieMesh(const CubieMeshDesc& desc)
+{
+	GeometryGenerator geoGen;
+	GeometryGenerator::FaceRange faceRanges[GeometryGenerator::CubieFaceCount];
+	GeometryGenerator::MeshData cubie = geoGen.CreateCubie(desc.Size, desc.BevelRadius,
+		desc.BevelSegments, desc.Subdivisions, faceRanges);
+
+	//Build progressively coarser copies of each face so distant cubes cost fewer triangles.
+	//The faces are simplified separately so every level keeps its faces apart.
+	std::vector<MeshSimplifier::LodDesc> lodDescs(desc.Lods.begin(), desc.Lods.end());
+
+	std::vector<MeshSimplifier::LodLevel> faceLods[GeometryGenerator::CubieFaceCount];
+	for (std::uint32_t f = 0; f < GeometryGenerator::CubieFaceCount; ++f)
+	{
+		const GeometryGenerator::FaceRange& range = faceRanges[f];
+
+		GeometryGenerator::MeshData face;
+		face.Vertices.assign(cubie.Vertices.begin() + range.BaseVertex,
+			cubie.Vertices.begin() + range.BaseVertex + range.VertexCount);
+		for (std::uint32_t i = 0; i < range.IndexCount; ++i)
+			face.Indices32.push_back(cubie.Indices32[range.StartIndex + i] - range.BaseVertex);
+
+		faceLods[f] = MeshSimplifier::BuildLodChain(face, lodDescs);
+	}
+
+	CubieMesh mesh;
+
+	//Lay the vertices out one level at a time, with the six faces of a level side by side
+	std::array<std::uint32_t, CubieMesh::LodCount> lodBaseVertex;
+	std::array<std::array<std::uint32_t, GeometryGenerator::CubieFaceCount>, CubieMesh::LodCount> faceVertexOffset;
+	for (std::uint32_t lod = 0; lod < CubieMesh::LodCount; ++lod)
+	{
+		lodBaseVertex[lod] = (std::uint32_t)mesh.Vertices.size();
+		for (std::uint32_t f = 0; f < GeometryGenerator::CubieFaceCount; ++f)
+		{
+			faceVertexOffset[lod][f] = (std::uint32_t)mesh.Vertices.size() - lodBaseVertex[lod];
+			for (auto& v : faceLods[f][lod].Mesh.Vertices)
+			{
+				Vertex vertex;
+				vertex.Pos = v.Position;
+				vertex.Normal = v.Normal;
+				vertex.TexC = v.TexC;
+				mesh.Vertices.push_back(vertex);
+			}
+		}
+	}
+
+	//Give every combination of faces its own index range at every level, so a cube is
+	//still a single draw whichever of its faces are hidden
+	for (std::uint32_t faces = 0; faces <= gAllCubieFaces; ++faces)
+	{
+		for (std::uint32_t lod = 0; lod < CubieMesh::LodCount; ++lod)
+		{
+			DrawArgs submesh;
+			submesh.StartIndexLocation = (std::uint32_t)mesh.Indices.size();
+			submesh.BaseVertexLocation = (std::int32_t)lodBaseVertex[lod];
+
+			for (std::uint32_t f = 0; f < GeometryGenerator::CubieFaceCount; ++f)
+			{
+				if ((faces & (1u << f)) == 0)
+					continue;
+
+				for (auto i : faceLods[f][lod].Mesh.Indices32)
+					mesh.Indices.push_back((std::uint16_t)(i + faceVertexOffset[lod][f]));
+			}
+
+			submesh.IndexCount = (std::uint32_t)mesh.Indices.size() - submesh.StartIndexLocation;
+			mesh.Submeshes.push_back(submesh);
+		}
+	}
+
+	return mesh;
+}
+
+namespace
+{
+	//Slices draws stored at [faces * LodCount + lod] into a chain for each combination
+	template<typename Submesh>
+	CubeScene::LodChains SliceLodChains(const Submesh* submeshes)
+	{
+		static_assert(CubeScene::AllFaces == gAllCubieFaces, "the scene draws every combination the mesh holds");
+
+		CubeScene::LodChains lods;
+		for (std::uint32_t faces = 0; faces <= gAllCubieFaces; ++faces)
+		{
+			lods[faces].resize(CubieMesh::LodCount);
+			for (std::uint32_t lod = 0; lod < CubieMesh::LodCount; ++lod)
+			{
+				const Submesh& submesh = submeshes[faces * CubieMesh::LodCount + lod];
+				lods[faces][lod].IndexCount = submesh.IndexCount;
+				lods[faces][lod].StartIndexLocation = submesh.StartIndexLocation;
+				lods[faces][lod].BaseVertexLocation = submesh.BaseVertexLocation;
+			}
+		}
+		return lods;
+	}
+}
+
+const std::vector<float> gCubieLodDistances = { 40.0f, 80.0f, 160.0f };
+
+CubeScene::LodChains CubieLodChains(const CubieMesh& mesh)
+{
+	return SliceLodChains(mesh.Submeshes.data());
+}
+
+CubeScene::LodChains CubieLodChains(const MeshCache& cache)
+{
+	return SliceLodChains(cache.Submeshes());
+}
+
+void CubieBounds(const CubieMesh& mesh, DirectX::BoundingBox& box, DirectX::BoundingSphere& sphere)
+{
+	const DrawArgs& full = mesh.Submeshes[gAllCubieFaces * CubieMesh::LodCount];
+	MeshBounds::Compute(mesh.Vertices.data(), sizeof(Vertex), mesh.Indices.data() + full.StartIndexLocation,
+		full.IndexCount, full.BaseVertexLocation, box, sphere);
+}
+
+std::uint64_t CubieMeshKey(const CubieMeshDesc& desc)
+{
+	const std::uint32_t layout[] = { gCubieGeneratorRevision, (std::uint32_t)sizeof(Vertex), CubieMesh::LodCount };
+
+	std::uint64_t key = MeshCache::Hash(layout, sizeof(layout));
+	return MeshCache::Hash(&desc, sizeof(desc), key);
+}
+
+bool SaveCubieMesh(const std::wstring& filename, const CubieMeshDesc& desc, const CubieMesh& mesh)
+{
+	std::vector<MeshCache::Submesh> submeshes(mesh.Submeshes.size());
+	for (size_t i = 0; i < submeshes.size(); ++i)
+	{
+		submeshes[i].IndexCount = mesh.Submeshes[i].IndexCount;
+		submeshes[i].StartIndexLocation = mesh.Submeshes[i].StartIndexLocation;
+		submeshes[i].BaseVertexLocation = mesh.Submeshes[i].BaseVertexLocation;
+		submeshes[i].Reserved = 0;
+	}
+
+	MeshCache::Contents contents;
+	contents.ContentKey = CubieMeshKey(desc);
+	contents.Vertices = mesh.Vertices.data();
+	contents.VertexStride = sizeof(Vertex);
+	contents.VertexCount = (std::uint32_t)mesh.Vertices.size();
+	contents.Indices = mesh.Indices.data();
+	contents.IndexStride = sizeof(std::uint16_t);
+	contents.IndexCount = (std::uint32_t)mesh.Indices.size();
+	contents.Submeshes = submeshes.data();
+	contents.SubmeshCount = (std::uint32_t)submeshes.size();
+
+	return MeshCache::Write(filename, contents);
+}
+
+bool OpenCubieMesh(const std::wstring& filename, const CubieMeshDesc& desc, MeshCache& cache)
+{
+	if (!cache.Open(filename, CubieMeshKey(desc), sizeof(Vertex), sizeof(std::uint16_t)))
+		return false;
+
+	if (cache.SubmeshCount() != (gAllCubieFaces + 1) * CubieMesh::LodCount)
+	{
+		cache.Close();
+		return false;
+	}
+
+	return true;
+}
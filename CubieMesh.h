@@ -0,0 +1,69 @@
+/*Filename: CubieMesh.h
+ Description: Builds the vertex and index data for a single cubie, with every
+ combination of faces at every level of detail, and saves/loads it through the
+ mesh cache so it only has to be generated once*/
+
+#pragma once
+#include "CubeScene.h"
+#include "Common/GeometryGenerator.h"
+#include "Common/MeshCache.h"
+#include "Common/MeshSimplifier.h"
+#include "RenderTypes.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Bitmask with every GeometryGenerator::CubieFace set.
+const std::uint32_t gAllCubieFaces = (1u << GeometryGenerator::CubieFaceCount) - 1;
+
+//Everything the cubie mesh is generated from.  All of it feeds the cache key, so changing
+//any value here rebuilds the cache on the next start.
+struct CubieMeshDesc
+{
+	float Size = 1.0f;
+	float BevelRadius = 0.08f;
+	std::uint32_t BevelSegments = 3;
+	std::uint32_t Subdivisions = 1;
+
+	//Stopping criteria for each level after the full detail one
+	std::array<MeshSimplifier::LodDesc, 3> Lods = { {
+		{ 48, 0.004f },
+		{ 16, 0.01f },
+		{ 2, 0.03f } } };
+};
+
+struct CubieMesh
+{
+	static const std::uint32_t LodCount = 4;
+
+	std::vector<Vertex> Vertices;
+	std::vector<std::uint16_t> Indices;
+
+	//Draw arguments for every combination of faces at every level of detail,
+	//stored at [faces * LodCount + lod]
+	std::vector<DrawArgs> Submeshes;
+};
+
+//The distances to step the cubie to each coarser level at, as the window draws it
+extern const std::vector<float> gCubieLodDistances;
+
+CubieMesh BuildCubieMesh(const CubieMeshDesc& desc);
+
+//The draws of a built or cached mesh, one level of detail chain for every combination of
+//faces.  The cache must have been opened with OpenCubieMesh.
+CubeScene::LodChains CubieLodChains(const CubieMesh& mesh);
+CubeScene::LodChains CubieLodChains(const MeshCache& cache);
+
+//Bounds of the full cubie.  Every level and face combination fits inside it, so its bounds
+//hold whichever one is drawn.
+void CubieBounds(const CubieMesh& mesh, DirectX::BoundingBox& box, DirectX::BoundingSphere& sphere);
+
+//Key identifying meshes built from desc by this version of the generator
+std::uint64_t CubieMeshKey(const CubieMeshDesc& desc);
+
+bool SaveCubieMesh(const std::wstring& filename, const CubieMeshDesc& desc, const CubieMesh& mesh);
+
+//Maps a cache written by SaveCubieMesh for the same desc.  Returns false if the file is
+//missing, damaged or was built from different parameters.
+bool OpenCubieMesh(const std::wstring& filename, const CubieMeshDesc& desc, MeshCache& cache);
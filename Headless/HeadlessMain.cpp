@@ -0,0 +1,321 @@
+//***************************************************************************************
+// HeadlessMain.cpp
+//
+// Runs the cube for a fixed number of frames with no window or GPU.  Builds the cubie
+// mesh and the scene, replays a script of spins, turns and camera moves, records each
+// frame's commands into a NullBackend and prints how long the CPU took.  Frames are timed
+// by a ManualClock moved on a fixed length each frame, so two runs of the same script do
+// the same work.
+//
+//   Headless [-frames N] [-fps N] [-script file] [-stats file] [-trace file] [-log file]
+//            [-memory file]
+//
+// -stats writes the frame stats as JSON, -trace the profiler's zones as a Chrome trace,
+// -log every frame's commands as a CommandLog, which CommandStats reads, and -memory what
+// MemoryTracker counts as JSON.
+//***************************************************************************************
+
+#include "HeadlessScript.h"
+#include "NullBackend.h"
+#include "../CubeScene.h"
+#include "../CubieMesh.h"
+#include "../Common/CommandLog.h"
+#include "../Common/FixedTimestep.h"
+#include "../Common/FrameStats.h"
+#include "../Common/GameTimer.h"
+#include "../Common/MemoryTracker.h"
+#include "../Common/Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// The same as the window runs with
+	const int FrameResourceCount = 3;
+	const double SimulationRate = 60.0;
+	const int MaxSimulationSteps = 8;
+	const float ViewportWidth = 800.0f;
+	const float ViewportHeight = 600.0f;
+
+	struct Options
+	{
+		std::uint32_t Frames = 3600;
+		double Fps = 60.0;
+		std::string Script;
+		std::string Stats;
+		std::string Trace;
+		std::string Log;
+		std::string Memory;
+	};
+
+	// Plain memory in place of a frame resource's upload buffers
+	struct FrameMemory
+	{
+		std::vector<std::uint8_t> Objects;
+		PassConstants Pass;
+	};
+
+	// Made up GPU addresses for what Rubix binds, with each frame resource's constants far
+	// enough from the next that none overlap
+	const std::uint64_t CubieVertexAddress = 0x10000000;
+	const std::uint64_t CubieIndexAddress = 0x20000000;
+	const std::uint64_t TextureDescriptor = 0x30000000;
+	const std::uint64_t FrameResourceAddress = 0x100000000;
+	const std::uint64_t FrameResourceSpan = 0x1000000;
+	const std::uint64_t PassOffset = 0x800000;
+	const std::uint64_t MaterialOffset = 0xC00000;
+
+	// Stand ins for the back buffer and the pipeline state, which are only ever compared
+	const char BackBuffer = 0;
+	const char OpaquePSO = 0;
+
+	double Milliseconds(Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	bool ReadOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+			if (value == nullptr)
+				return false;
+
+			if (std::strcmp(argv[i], "-frames") == 0)
+				options.Frames = (std::uint32_t)std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(argv[i], "-fps") == 0)
+				options.Fps = std::strtod(value, nullptr);
+			else if (std::strcmp(argv[i], "-script") == 0)
+				options.Script = value;
+			else if (std::strcmp(argv[i], "-stats") == 0)
+				options.Stats = value;
+			else if (std::strcmp(argv[i], "-trace") == 0)
+				options.Trace = value;
+			else if (std::strcmp(argv[i], "-log") == 0)
+				options.Log = value;
+			else if (std::strcmp(argv[i], "-memory") == 0)
+				options.Memory = value;
+			else
+				return false;
+			++i;
+		}
+		return options.Frames > 0 && options.Fps > 0.0;
+	}
+
+	// The cubie mesh as the window draws it, without the cache or any buffers.  Fills in
+	// where the mesh's buffers would be.
+	void BuildScene(CubeScene& scene, CubieBindings& bindings)
+	{
+		CubieMesh mesh = BuildCubieMesh(CubieMeshDesc());
+		BoundingBox box;
+		BoundingSphere sphere;
+		CubieBounds(mesh, box, sphere);
+
+		bindings.Vertices.Address = CubieVertexAddress;
+		bindings.Vertices.ByteSize = (std::uint32_t)(mesh.Vertices.size() * sizeof(Vertex));
+		bindings.Vertices.Stride = sizeof(Vertex);
+		bindings.Indices.Address = CubieIndexAddress;
+		bindings.Indices.ByteSize = (std::uint32_t)(mesh.Indices.size() * sizeof(std::uint16_t));
+
+		scene.SetCubieMesh(CubieLodChains(mesh), box, sphere, gCubieLodDistances);
+		scene.SetViewport(ViewportWidth, ViewportHeight);
+		scene.Reset();
+	}
+
+	// The commands Rubix::Draw records for cubies drawn on their own
+	void RecordFrame(const CubeScene& scene, CubieBindings bindings, int frameResource, size_t objectStride,
+		RenderCommands& commands)
+	{
+		PROFILE_ZONE("Headless::RecordFrame");
+		const std::uint64_t frameAddress = FrameResourceAddress + frameResource * FrameResourceSpan;
+
+		bindings.Texture = TextureDescriptor;
+		bindings.Objects = frameAddress;
+		bindings.ObjectStride = objectStride;
+		bindings.Material = frameAddress + MaterialOffset;
+
+		commands.Barrier(&BackBuffer, RenderCommands::StatePresent, RenderCommands::StateRenderTarget);
+		commands.SetRootConstantBufferView(RootPass, frameAddress + PassOffset);
+		commands.SetPipelineState(&OpaquePSO);
+		scene.RecordDraws(bindings, commands);
+		commands.Barrier(&BackBuffer, RenderCommands::StateRenderTarget, RenderCommands::StatePresent);
+	}
+
+	void PrintSummary(const FrameStats& stats, FrameStats::Timing timing)
+	{
+		FrameStats::Summary summary = stats.Summarize(timing);
+		std::printf("  %-8s %8.4f ms mean %8.4f ms p50 %8.4f ms p95 %8.4f ms p99 %8.4f ms max\n",
+			FrameStats::TimingName(timing), summary.Mean, summary.P50, summary.P95, summary.P99, summary.Max);
+	}
+
+	void PrintMemory(const char* name, const MemoryTracker::Counts& counts)
+	{
+		std::printf("  %-15s %10.1f KB live %10.1f KB peak %6llu live %8llu total allocations\n", name,
+			counts.LiveBytes / 1024.0, counts.PeakBytes / 1024.0, (unsigned long long)counts.LiveAllocations,
+			(unsigned long long)counts.TotalAllocations);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!ReadOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "Usage: Headless [-frames N] [-fps N] [-script file] [-stats file] [-trace file] [-log file] [-memory file]\n");
+		return 1;
+	}
+	Profiler::SetThreadName("Headless");
+
+	HeadlessScript script;
+	std::string error;
+	if (options.Script.empty())
+	{
+		std::istringstream text(HeadlessScript::Default());
+		script.Parse(text, error);
+	}
+	else
+	{
+		std::ifstream file(options.Script);
+		if (!file)
+		{
+			std::fprintf(stderr, "Cannot open %s\n", options.Script.c_str());
+			return 1;
+		}
+		if (!script.Parse(file, error))
+		{
+			std::fprintf(stderr, "%s: %s\n", options.Script.c_str(), error.c_str());
+			return 1;
+		}
+	}
+
+	auto setupStart = Clock::now();
+	CubeScene scene(FrameResourceCount);
+	CubieBindings bindings;
+	BuildScene(scene, bindings);
+	double setupMs = Milliseconds(Clock::now() - setupStart);
+
+	std::vector<FrameMemory> frames(FrameResourceCount);
+	const size_t objectStride = (sizeof(ObjectConstants) + 255) & ~size_t(255);
+	for (FrameMemory& frame : frames)
+		frame.Objects.resize(objectStride * CubeScene::CubieCount);
+
+	FixedTimestep step(SimulationRate, MaxSimulationSteps);
+	NullBackend backend;
+	FrameStats stats;
+
+	// With -log, commands are logged on their way to the backend
+	CommandLog log(RootParameterBytes((std::uint32_t)objectStride, CubeScene::CubieCount), &backend);
+	RenderCommands& commands = options.Log.empty() ? static_cast<RenderCommands&>(backend) : log;
+
+	ManualClock clock;
+	GameTimer timer(clock);
+	timer.Reset();
+	double updateTotalMs = 0.0;
+	double recordTotalMs = 0.0;
+
+	auto runStart = Clock::now();
+	for (std::uint32_t f = 0; f < options.Frames; ++f)
+	{
+		PROFILE_ZONE("Headless::Frame");
+		auto frameStart = Clock::now();
+
+		clock.Advance(1.0 / options.Fps);
+		timer.Tick();
+		const float dt = timer.DeltaTime();
+
+		script.Apply(f, scene);
+
+		int steps = step.Advance(dt);
+		for (int s = 0; s < steps; ++s)
+			scene.Simulate(step.StepSeconds());
+
+		const int frameResource = (int)(f % FrameResourceCount);
+		FrameMemory& memory = frames[frameResource];
+		FrameConstants constants;
+		constants.Objects = memory.Objects.data();
+		constants.ObjectStride = objectStride;
+		constants.Pass = &memory.Pass;
+
+		// The stages in the order Rubix::Update runs them
+		scene.UpdateCamera(dt);
+		scene.UpdateLods();
+		scene.UpdateObjects(step.Alpha());
+		scene.RotateThird(step.Alpha() * step.StepSeconds());
+		scene.StoreStagedWorlds(constants);
+		scene.UpdateObjectCBs(constants);
+		scene.UpdateVisibility();
+		scene.UpdateMainPassCB(constants, timer.TotalTime(), dt);
+		auto updateEnd = Clock::now();
+
+		backend.BeginFrame();
+		if (!options.Log.empty())
+			log.BeginFrame();
+		RecordFrame(scene, bindings, frameResource, objectStride, commands);
+		auto recordEnd = Clock::now();
+
+		double updateMs = Milliseconds(updateEnd - frameStart);
+		double recordMs = Milliseconds(recordEnd - updateEnd);
+		stats.AddFrame((float)updateMs, (float)recordMs, (float)Milliseconds(recordEnd - frameStart));
+		updateTotalMs += updateMs;
+		recordTotalMs += recordMs;
+	}
+	double runMs = Milliseconds(Clock::now() - runStart);
+
+	const NullBackend::Totals& totals = backend.GetTotals();
+	std::printf("Headless: %u frames at %.0f fps, %s (%zu commands, last on frame %u)\n",
+		options.Frames, options.Fps, options.Script.empty() ? "default script" : options.Script.c_str(),
+		script.CommandCount(), script.LastFrame());
+	std::printf("  built the scene in %.1f ms, ran every frame in %.1f ms\n", setupMs, runMs);
+	std::printf("  mean over every frame: %.4f ms update, %.4f ms record\n",
+		updateTotalMs / options.Frames, recordTotalMs / options.Frames);
+	std::printf("  over the last %zu frames:\n", stats.Count());
+	PrintSummary(stats, FrameStats::Update);
+	PrintSummary(stats, FrameStats::Record);
+	PrintSummary(stats, FrameStats::Present);
+	std::printf("  %llu commands, %llu draws, %.1f a frame, %llu indices; %llu simulation steps, %llu dropped\n",
+		(unsigned long long)totals.Commands, (unsigned long long)totals.Draws,
+		(double)totals.Draws / totals.Frames, (unsigned long long)totals.Indices, (unsigned long long)step.StepCount(),
+		(unsigned long long)step.DroppedSteps());
+	std::printf("  memory, as MemoryTracker counts it:\n");
+	for (int t = 0; t < MemoryTracker::TagCount; ++t)
+		PrintMemory(MemoryTracker::TagName((MemoryTracker::Tag)t), MemoryTracker::Get((MemoryTracker::Tag)t));
+	PrintMemory("total", MemoryTracker::Total());
+
+	if (!options.Stats.empty())
+	{
+		std::ofstream json(options.Stats);
+		stats.WriteJson(json);
+	}
+	if (!options.Trace.empty())
+	{
+		std::ofstream trace(options.Trace);
+		Profiler::WriteChromeTrace(trace);
+	}
+	if (!options.Memory.empty())
+	{
+		std::ofstream json(options.Memory);
+		MemoryTracker::WriteJson(json);
+	}
+	if (!options.Log.empty())
+	{
+		std::ofstream file(options.Log, std::ios::binary);
+		if (!log.Write(file))
+		{
+			std::fprintf(stderr, "Cannot write %s\n", options.Log.c_str());
+			return 1;
+		}
+		std::printf("  logged %zu frames of commands in %zu bytes\n", log.FrameCount(), log.CommandBytes());
+	}
+	return 0;
+}
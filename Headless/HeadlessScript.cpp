@@ -0,0 +1,189 @@
+//***************************************************************************************
+// HeadlessScript.cpp
+//***************************************************************************************
+
+#include "HeadlessScript.h"
+#include "../CubeScene.h"
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+	const int DefaultScrambleLength = 25;
+
+	bool Fail(std::string& error, int line, const std::string& what)
+	{
+		error = "line " + std::to_string(line) + ": " + what;
+		return false;
+	}
+}
+
+bool HeadlessScript::Parse(std::istream& in, std::string& error)
+{
+	mCommands.clear();
+	mNext = 0;
+
+	std::string text;
+	for (int line = 1; std::getline(in, text); ++line)
+	{
+		std::istringstream words(text);
+		std::string first;
+		if (!(words >> first) || first[0] == '#')
+			continue;
+
+		Command command;
+		std::istringstream frame(first);
+		if (!(frame >> command.Frame) || !frame.eof())
+			return Fail(error, line, "expected a frame number, not \"" + first + "\"");
+
+		std::string name;
+		if (!(words >> name))
+			return Fail(error, line, "expected a command after the frame number");
+
+		if (name == "spin")
+		{
+			std::string axis;
+			words >> axis;
+			if (axis == "x" || axis == "y" || axis == "z")
+				command.Axis = axis[0];
+			else if (axis != "off")
+				return Fail(error, line, "spin needs x, y, z or off");
+			command.Type = Spin;
+		}
+		else if (name == "turn")
+		{
+			std::getline(words >> std::ws, command.Turns);
+
+			// Check the turns read without queueing them anywhere that matters
+			TurnQueue check;
+			if (check.PushSequence(command.Turns.c_str()) <= 0)
+				return Fail(error, line, "\"" + command.Turns + "\" is not a sequence of turns");
+			command.Type = Turn;
+		}
+		else if (name == "scramble")
+		{
+			command.Count = DefaultScrambleLength;
+			if (!(words >> std::ws).eof() && (!(words >> command.Count) || command.Count < 0))
+				return Fail(error, line, "scramble length must be a whole number");
+			command.Type = Scramble;
+		}
+		else if (name == "view")
+		{
+			if (!(words >> command.Count) || command.Count < 0 || command.Count > 3)
+				return Fail(error, line, "view must be 0, 1, 2 or 3");
+			command.Type = View;
+		}
+		else if (name == "orbit" || name == "eye")
+		{
+			if (!(words >> command.X >> command.Y))
+				return Fail(error, line, name + " needs two numbers");
+			command.Type = name == "orbit" ? Orbit : Eye;
+		}
+		else if (name == "zoom")
+		{
+			if (!(words >> command.X))
+				return Fail(error, line, "zoom needs a number");
+			command.Type = Zoom;
+		}
+		else if (name == "reset")
+		{
+			command.Type = Reset;
+		}
+		else
+		{
+			return Fail(error, line, "unknown command \"" + name + "\"");
+		}
+
+		// Anything left over is a mistake, unless it is a comment
+		std::string extra;
+		if (command.Type != Turn && words >> extra && extra[0] != '#')
+			return Fail(error, line, "unexpected \"" + extra + "\"");
+
+		mCommands.push_back(command);
+	}
+
+	std::stable_sort(mCommands.begin(), mCommands.end(),
+		[](const Command& a, const Command& b) { return a.Frame < b.Frame; });
+	return true;
+}
+
+const char* HeadlessScript::Default()
+{
+	return
+		"# Spin about each axis in turn while the camera visits every face\n"
+		"0 spin y\n"
+		"60 view 1\n"
+		"120 turn R U R' U'\n"
+		"240 spin x\n"
+		"240 view 2\n"
+		"300 turn F2 B2 L2 R2 U2 D2\n"
+		"480 view 3\n"
+		"480 spin z\n"
+		"540 scramble\n"
+		"# Back to orbiting, dragging the camera round and in while the scramble plays out\n"
+		"600 view 0\n"
+		"660 orbit 0.5 0.1\n"
+		"690 orbit -1.0 -0.2\n"
+		"720 zoom -3\n"
+		"780 eye 1 0\n"
+		"840 eye 0 -2\n"
+		"900 spin off\n"
+		"960 view 0\n"
+		"1020 zoom 20\n"
+		"1080 reset\n"
+		"1080 spin y\n"
+		"1140 scramble 100\n";
+}
+
+int HeadlessScript::Apply(std::uint32_t frame, CubeScene& scene)
+{
+	int run = 0;
+	for (; mNext < mCommands.size() && mCommands[mNext].Frame <= frame; ++mNext, ++run)
+	{
+		const Command& command = mCommands[mNext];
+		switch (command.Type)
+		{
+		case Spin:
+			scene.SetSpinAxis(command.Axis);
+			break;
+		case Turn:
+			scene.Turns().PushSequence(command.Turns.c_str());
+			break;
+		case Scramble:
+			scene.QueueScramble(command.Count);
+			break;
+		case View:
+			scene.SetCameraView(command.Count);
+			break;
+		case Orbit:
+			scene.GetCamera().Orbit(command.X, command.Y);
+			break;
+		case Zoom:
+			scene.GetCamera().Zoom(command.X);
+			break;
+		case Eye:
+			scene.MoveEye(command.X, command.Y);
+			break;
+		case Reset:
+			scene.Reset();
+			scene.ResetCamera();
+			break;
+		}
+	}
+	return run;
+}
+
+void HeadlessScript::Rewind()
+{
+	mNext = 0;
+}
+
+size_t HeadlessScript::CommandCount()const
+{
+	return mCommands.size();
+}
+
+std::uint32_t HeadlessScript::LastFrame()const
+{
+	return mCommands.empty() ? 0 : mCommands.back().Frame;
+}
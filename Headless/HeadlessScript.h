@@ -0,0 +1,87 @@
+//***************************************************************************************
+// HeadlessScript.h
+//
+// What the headless runner does to the cube, and on which frames.  Each line of a script
+// is a frame number followed by a command; blank lines and lines starting with # are
+// skipped.  Commands for the same frame run in the order they are written.
+//
+//   <frame> spin x|y|z|off        spin the whole cube about an axis, or stop it
+//   <frame> turn R U R' U2        queue face turns
+//   <frame> scramble [length]     queue random turns, 25 unless given
+//   <frame> view 0|1|2|3          orbit, or look at the front, top or right face
+//   <frame> orbit dTheta dPhi     orbit the camera by that many radians
+//   <frame> zoom dRadius          move the orbiting camera in or out
+//   <frame> eye dx dz             slide the eye across, as the arrow keys do
+//   <frame> reset                 back to a solved cube and the starting camera
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+class CubeScene;
+
+class HeadlessScript
+{
+public:
+	enum CommandType
+	{
+		Spin,
+		Turn,
+		Scramble,
+		View,
+		Orbit,
+		Zoom,
+		Eye,
+		Reset
+	};
+
+	struct Command
+	{
+		std::uint32_t Frame = 0;
+		CommandType Type = Reset;
+
+		// The axis to spin about, ' ' to stop
+		char Axis = ' ';
+
+		// The turns to queue, the scramble length or the view
+		std::string Turns;
+		int Count = 0;
+
+		// Orbit, zoom and eye amounts
+		float X = 0.0f;
+		float Y = 0.0f;
+	};
+
+	///<summary>
+	/// Reads a script, replacing any read before.  On the first line that cannot be read,
+	/// returns false with its number and what is wrong with it in error.
+	///</summary>
+	bool Parse(std::istream& in, std::string& error);
+
+	// The script run when none is given: spins, turns, a scramble and every camera move.
+	static const char* Default();
+
+	///<summary>
+	/// Runs the commands for every frame up to and including frame not yet run.  Returns
+	/// the number run.
+	///</summary>
+	int Apply(std::uint32_t frame, CubeScene& scene);
+
+	// Starts again from the first command.
+	void Rewind();
+
+	size_t CommandCount()const;
+
+	// The frame of the last command, or 0 if there are none.
+	std::uint32_t LastFrame()const;
+
+private:
+	// Sorted by frame, keeping the order of commands for the same frame
+	std::vector<Command> mCommands;
+	size_t mNext = 0;
+};
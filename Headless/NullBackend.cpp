@@ -0,0 +1,88 @@
+//***************************************************************************************
+// NullBackend.cpp
+//***************************************************************************************
+
+#include "NullBackend.h"
+
+void NullBackend::BeginFrame()
+{
+	mDraws.clear();
+	++mTotals.Frames;
+}
+
+void NullBackend::Barrier(const void* resource, ResourceState before, ResourceState after)
+{
+	++mTotals.Commands;
+}
+
+void NullBackend::SetPipelineState(const void* pipelineState)
+{
+	++mTotals.Commands;
+}
+
+void NullBackend::SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor)
+{
+	if (slot < mRoot.size())
+		mRoot[slot] = descriptor;
+	++mTotals.Commands;
+}
+
+void NullBackend::SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address)
+{
+	if (slot < mRoot.size())
+		mRoot[slot] = address;
+	++mTotals.Commands;
+}
+
+void NullBackend::SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address)
+{
+	if (slot < mRoot.size())
+		mRoot[slot] = address;
+	++mTotals.Commands;
+}
+
+void NullBackend::SetVertexBuffer(const VertexBufferView& view)
+{
+	++mTotals.Commands;
+}
+
+void NullBackend::SetIndexBuffer(const IndexBufferView& view)
+{
+	++mTotals.Commands;
+}
+
+void NullBackend::SetPrimitiveTopology(Topology topology)
+{
+	++mTotals.Commands;
+}
+
+void NullBackend::DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex)
+{
+	Draw draw;
+	draw.Objects = mRoot[RootObject];
+	draw.Args.IndexCount = indexCount;
+	draw.Args.StartIndexLocation = startIndex;
+	draw.Args.BaseVertexLocation = baseVertex;
+	mDraws.push_back(draw);
+
+	++mTotals.Commands;
+	++mTotals.Draws;
+	mTotals.Indices += indexCount;
+}
+
+const std::vector<NullBackend::Draw>& NullBackend::Draws()const
+{
+	return mDraws;
+}
+
+const NullBackend::Totals& NullBackend::GetTotals()const
+{
+	return mTotals;
+}
+
+void NullBackend::Reset()
+{
+	mDraws.clear();
+	mTotals = Totals();
+	mRoot.fill(0);
+}
@@ -0,0 +1,68 @@
+//***************************************************************************************
+// NullBackend.h
+//
+// Stands in for D3D12 in the headless runner.  It takes the same commands Rubix::Draw
+// records into a command list and keeps the draws in memory instead, so the CPU cost of
+// building a frame is measured without a device, and what would have been drawn can be
+// checked.
+//***************************************************************************************
+
+#pragma once
+
+#include "../Common/RenderCommands.h"
+#include "../RenderTypes.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class NullBackend : public RenderCommands
+{
+public:
+	struct Draw
+	{
+		// The object constants bound when the draw was made
+		std::uint64_t Objects = 0;
+		DrawArgs Args;
+	};
+
+	struct Totals
+	{
+		std::uint64_t Frames = 0;
+		std::uint64_t Commands = 0;
+		std::uint64_t Draws = 0;
+		std::uint64_t Indices = 0;
+	};
+
+	///<summary>
+	/// Starts a new frame, dropping the last frame's draws.
+	///</summary>
+	void BeginFrame();
+
+	void Barrier(const void* resource, ResourceState before, ResourceState after) override;
+	void SetPipelineState(const void* pipelineState) override;
+
+	void SetRootDescriptorTable(std::uint32_t slot, std::uint64_t descriptor) override;
+	void SetRootConstantBufferView(std::uint32_t slot, std::uint64_t address) override;
+	void SetRootShaderResourceView(std::uint32_t slot, std::uint64_t address) override;
+
+	void SetVertexBuffer(const VertexBufferView& view) override;
+	void SetIndexBuffer(const IndexBufferView& view) override;
+	void SetPrimitiveTopology(Topology topology) override;
+
+	void DrawIndexed(std::uint32_t indexCount, std::uint32_t startIndex, std::int32_t baseVertex) override;
+
+	// The draws of the current frame, in the order they were made.
+	const std::vector<Draw>& Draws()const;
+
+	// Everything recorded since construction or the last Reset.
+	const Totals& GetTotals()const;
+
+	void Reset();
+
+private:
+	std::vector<Draw> mDraws;
+	Totals mTotals;
+
+	// What each root parameter was last bound to
+	std::array<std::uint64_t, RootParameterCount> mRoot = {};
+};
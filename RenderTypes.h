@@ -0,0 +1,102 @@
+/*Filename: RenderTypes.h
+ Description: The vertices and constants the shaders read, and the arguments of an indexed
+ draw, with no D3D12 types, so the cube can be updated without a device*/
+
+#pragma once
+#include "Common/Light.h"
+#include "Common/MathHelper.h"
+#include <cstdint>
+#include <vector>
+
+struct ObjectConstants
+{
+    DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
+
+};
+
+struct PassConstants
+{
+    DirectX::XMFLOAT4X4 View = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 InvView = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 Proj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 InvProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 ViewProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 InvViewProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT3 EyePosW = { 0.0f, 0.0f, 0.0f };
+    float cbPerObjectPad1 = 0.0f;
+    DirectX::XMFLOAT2 RenderTargetSize = { 0.0f, 0.0f };
+    DirectX::XMFLOAT2 InvRenderTargetSize = { 0.0f, 0.0f };
+    float NearZ = 0.0f;
+    float FarZ = 0.0f;
+    float TotalTime = 0.0f;
+    float DeltaTime = 0.0f;
+
+    DirectX::XMFLOAT4 AmbientLight = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+    // Indices [0, NUM_DIR_LIGHTS) are directional lights;
+    // indices [NUM_DIR_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHTS) are point lights;
+    // indices [NUM_DIR_LIGHTS+NUM_POINT_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHT+NUM_SPOT_LIGHTS)
+    // are spot lights for a maximum of MaxLights per object.
+    Light Lights[MaxLights];
+};
+
+struct MaterialConstants
+{
+	DirectX::XMFLOAT4 DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 1.0f };
+	DirectX::XMFLOAT3 FresnelR0 = { 0.01f, 0.01f, 0.01f };
+	float Roughness = 0.25f;
+
+	// Used in texture mapping.
+	DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
+};
+
+struct Vertex
+{
+    DirectX::XMFLOAT3 Pos;
+    DirectX::XMFLOAT3 Normal;
+	DirectX::XMFLOAT2 TexC;
+};
+
+// Vertex of the merged cubie batch.  CubieId is the ObjCBIndex of the cubie the vertex
+// belongs to, which the batched vertex shader uses to fetch its world matrix.
+struct BatchedVertex
+{
+    DirectX::XMFLOAT3 Pos;
+    DirectX::XMFLOAT3 Normal;
+    DirectX::XMFLOAT2 TexC;
+    std::uint32_t CubieId;
+};
+
+// Where an indexed draw reads its indices and vertices from.  The same as a
+// SubmeshGeometry without its bounds.
+struct DrawArgs
+{
+    std::uint32_t IndexCount = 0;
+    std::uint32_t StartIndexLocation = 0;
+    std::int32_t BaseVertexLocation = 0;
+};
+
+// The parameters of the root signature everything is drawn with, in order.
+enum RootParameter : std::uint32_t
+{
+    RootTexture,        // Table holding the diffuse texture
+    RootObject,         // ObjectConstants of the item drawn
+    RootPass,           // PassConstants
+    RootMaterial,       // MaterialConstants of the item drawn
+    RootBatchObjects,   // Every cubie's ObjectConstants, read by the batched vertex shader
+    RootParameterCount
+};
+
+// Bytes a draw reads through each root parameter, as a CommandLog wants them.  The batch
+// reads objectCount object constants, objectStride bytes apart.
+inline std::vector<std::uint32_t> RootParameterBytes(std::uint32_t objectStride, std::uint32_t objectCount)
+{
+    std::vector<std::uint32_t> bytes(RootParameterCount, 0);
+    bytes[RootObject] = sizeof(ObjectConstants);
+    bytes[RootPass] = sizeof(PassConstants);
+    bytes[RootMaterial] = sizeof(MaterialConstants);
+    bytes[RootBatchObjects] = objectStride * objectCount;
+    return bytes;
+}
@@ -12,7 +12,15 @@
 #include "Common/MathHelper.h"
 #include "Common/UploadBuffer.h"
 #include "Common/GeometryGenerator.h"
+#include "Common/MeshSimplifier.h"
+#include "Common/Profiler.h"
+#include "Common/D3D12RenderCommands.h"
+#include "Common/D3D12TextureSink.h"
+#include "Common/TextureStreamer.h"
 #include "FrameResource.h"
+#include "CubieMesh.h"
+#include "CubieBatch.h"
+#include "CubeScene.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -23,8 +31,20 @@ using namespace DirectX::PackedVector;
 
 const int gNumFrameResources = 3;
 
-//Global variable for the amount to rotate the entire cube by.
-float rotated{ 0.3f };
+//Simulation steps per second, and the most run in one frame before time is dropped
+const double gSimulationRate = 60.0;
+const int gMaxSimulationSteps = 8;
+
+//How many turns a scramble makes
+const int gScrambleLength = 25;
+
+//Bytes of mips the streamer keeps resident, mip tails included, and its workers.  The
+//sink can briefly hold about twice this while it swaps textures.
+const std::uint64_t gTextureBudgetBytes = 64 * 1024 * 1024;
+const unsigned gTextureWorkers = 2;
+
+//The atlas is four faces across, so a cubie face shows a quarter of its width
+const float gAtlasTilesAcross = 4.0f;
 
 // Lightweight structure stores parameters to draw a shape.  This will
 // vary from app-to-app.
@@ -32,18 +52,8 @@ struct RenderItem
 {
 	RenderItem() = default;
 
-	// World matrix of the shape that describes the object's local space
-	// relative to the world space, which defines the position, orientation,
-	// and scale of the object in the world.
-	XMFLOAT4X4 World = MathHelper::Identity4x4();
-
-	XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-
-	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
-	// Because we have an object cbuffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify obect data we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	int NumFramesDirty = gNumFrameResources;
+	// Where the item is, and the constants that say so, belong to the cubie of the
+	// CubeScene with the same index.
 
 	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
 	UINT ObjCBIndex = -1;
@@ -58,6 +68,20 @@ struct RenderItem
 	UINT IndexCount = 0;
 	UINT StartIndexLocation = 0;
 	int BaseVertexLocation = 0;
+
+	// Counted by MemoryTracker as render items.
+	static void* operator new(size_t bytes)
+	{
+		void* item = ::operator new(bytes);
+		MemoryTracker::Allocate(MemoryTracker::RenderItems, bytes);
+		return item;
+	}
+
+	static void operator delete(void* item, size_t bytes)
+	{
+		MemoryTracker::Free(MemoryTracker::RenderItems, bytes);
+		::operator delete(item);
+	}
 };
 
 class Rubix : public D3DApp
@@ -74,19 +98,21 @@ private:
 	virtual void OnResize()override;
 	virtual void Update(const GameTimer& gt)override;
 	virtual void Draw(const GameTimer& gt)override;
+	virtual void Simulate(float dt)override;
+
+	virtual void OnRestart()override;
 
-	virtual void OnMouseDown(WPARAM btnState, int x, int y)override;
-	virtual void OnMouseUp(WPARAM btnState, int x, int y)override;
-	virtual void OnMouseMove(WPARAM btnState, int x, int y)override;
+	virtual void OnMouseDown(int buttons, int x, int y)override;
+	virtual void OnMouseUp(int buttons, int x, int y)override;
+	virtual void OnMouseMove(int buttons, int x, int y)override;
 
 	void OnKeyboardInput(const GameTimer& gt);
-	void UpdateCamera(const GameTimer& gt);
-	void UpdateObjects(const GameTimer & gt);
-	void RotateThird(const GameTimer & gt);
-	void UpdateLastFace(char face);
-	void UpdateObjectCBs(const GameTimer& gt);
+	bool KeyPressed(int key);
+	void MoveEye(float dx, float dz);
+	void UpdateLods();
+	void UpdateCubieBatch();
+	void UpdateVisibility();
 	void UpdateMaterialCBs(const GameTimer& gt);
-	void UpdateMainPassCB(const GameTimer& gt);
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -97,7 +123,8 @@ private:
 	void BuildFrameResources();
 	void BuildMaterials();
 	void BuildRenderItems();
-	void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+	void DrawRenderItems(RenderCommands& commands, const std::vector<RenderItem*>& ritems);
+	CubieBindings GetCubieBindings()const;
 
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
@@ -115,38 +142,52 @@ private:
 
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
 	std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
-	std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
 	std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
 
 	std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
+	std::vector<D3D12_INPUT_ELEMENT_DESC> mBatchedInputLayout;
 
 	ComPtr<ID3D12PipelineState> mOpaquePSO = nullptr;
 	ComPtr<ID3D12PipelineState> mwireframePSO = nullptr;
 	ComPtr<ID3D12PipelineState> mfrontFacePSO = nullptr;
 	ComPtr<ID3D12PipelineState> mbackFacePSO = nullptr;
 
+	//The same pipeline states for drawing every cubie from the batch in one go
+	ComPtr<ID3D12PipelineState> mBatchedOpaquePSO = nullptr;
+	ComPtr<ID3D12PipelineState> mBatchedWireframePSO = nullptr;
+	ComPtr<ID3D12PipelineState> mBatchedFrontFacePSO = nullptr;
+	ComPtr<ID3D12PipelineState> mBatchedBackFacePSO = nullptr;
+
 	// List of all the render items.
 	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
 
 	// Render items divided by PSO.
 	std::vector<RenderItem*> mOpaqueRitems;
 
-	PassConstants mMainPassCB;
+	//Every opaque cubie merged into one buffer, and the render item that draws it
+	CubieBatch mCubieBatch;
+	std::unique_ptr<RenderItem> mBatchRitem;
+	UINT mBatchVertexCapacity = 0;
+	UINT mBatchIndexCapacity = 0;
+	int mBatchFramesDirty = 0;
+
+	//The cubies, their turns, the camera and the constants made from them.  The scene
+	//records the draws of cubies drawn on their own; the render items share their indices
+	//and feed the batch.
+	CubeScene mScene{ gNumFrameResources };
 
-	XMFLOAT3 mEyePos = { 0.0f, 0.0f, 0.0f };
-	XMFLOAT4X4 mView = MathHelper::Identity4x4();
-	XMFLOAT4X4 mProj = MathHelper::Identity4x4();
+	//The batch item while any cubie is at least partly inside the view frustum.  Cubies
+	//drawn on their own are culled by the scene.
+	std::vector<RenderItem*> mVisibleBatchRitems;
 
-	float mTheta = 1.3f*XM_PI;
-	float mPhi = 0.4f*XM_PI;
-	float mRadius = 2.5f;
+	//Streams the atlas in a mip at a time, beginning with its mip tail, so nothing waits
+	//on it to start.  The sink must outlive the streamer, which uploads through it.
+	std::unique_ptr<D3D12TextureSink> mTextureSink;
+	std::unique_ptr<TextureStreamer> mTextureStreamer;
+	TextureStreamer::Handle mAtlas = 0;
 
-	float topRotation = 90.0f;
-	float bottomRotation = 90.0f;
-	float leftRotation = 90.0f;
-	float rightRotation = 90.0f;
-	float backRotation = 90.0f;
-	float frontRotation = 90.0f;
+	//Keys held down last frame, so turns are only queued once per press
+	std::array<bool, Window::KeyCount> mKeysDown = {};
 
 	POINT mLastMousePos;
 };
@@ -165,6 +206,13 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 		if (!theApp.Initialize())
 			return 0;
 
+		//"-replay file" plays an input recording from the start and quits once it ends
+		std::istringstream args(cmdLine);
+		std::string option, path;
+		if (args >> option && option == "-replay" && std::getline(args >> std::ws, path) &&
+			!theApp.ReplayInput(path, true))
+			return 1;
+
 		return theApp.Run();
 	}
 	catch (DxException& e)
@@ -179,6 +227,9 @@ Rubix::Rubix(HINSTANCE hInstance)
 {
 	//Set the window caption
 	mMainWndCaption = L"COM428 Assignment";
+
+	mSimStep.SetRate(gSimulationRate);
+	mSimStep.SetMaxSteps(gMaxSimulationSteps);
 }
 
 Rubix::~Rubix()
@@ -189,6 +240,7 @@ Rubix::~Rubix()
 
 bool Rubix::Initialize()
 {
+	PROFILE_ZONE("Rubix::Initialize");
 	if (!D3DApp::Initialize())
 		return false;
 
@@ -210,9 +262,6 @@ bool Rubix::Initialize()
 	BuildFrameResources();
 	BuildPSOs();
 
-	//Send a mouse click to force camera to clamp to the limit.
-	OnMouseMove(MK_RBUTTON, 0, 0);
-
 	// Execute the initialization commands.
 	ThrowIfFailed(mCommandList->Close());
 	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
@@ -229,12 +278,23 @@ void Rubix::OnResize()
 	D3DApp::OnResize();
 
 	// The window resized, so update the aspect ratio and recompute the projection matrix.
-	XMMATRIX P = XMMatrixPerspectiveFovLH(0.25f*MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-	XMStoreFloat4x4(&mProj, P);
+	mScene.SetViewport((float)mClientWidth, (float)mClientHeight);
+}
+
+void Rubix::OnRestart()
+{
+	//Back to the solved cube and the starting view, with nothing held down
+	appInfo = RubixCubeAppInfo{};
+	mOpaqueRitems.clear();
+	BuildRenderItems();
+	mScene.ResetCamera();
+	mKeysDown.fill(false);
+	mLastMousePos = { 0, 0 };
 }
 
 void Rubix::Update(const GameTimer& gt)
 {
+	PROFILE_ZONE("Rubix::Update");
 	/*Check if the cube needs reset*/
 	if (appInfo.needsReset()) {
 		//Create a new app info object and override the current one with it
@@ -246,15 +306,16 @@ void Rubix::Update(const GameTimer& gt)
 		BuildRenderItems();
 		//Draw them in their new positions
 		Draw(gt);
-		//Reset the initial values mEyePos is calculated from
-		mTheta = 1.3f*XM_PI;
-		mPhi = 0.4f*XM_PI;
-		mRadius = 2.5f;
-		//Send mouse click to force camera to clamp limit
-		OnMouseMove(MK_RBUTTON, 0, 0);
+		//Put the camera back where it started
+		mScene.ResetCamera();
 	}
 	OnKeyboardInput(gt);
-	UpdateCamera(gt);
+
+	//The scene follows whatever spin and view the keys have chosen
+	mScene.SetSpinAxis(appInfo.rotationAxis());
+	mScene.SetCameraView(appInfo.getCameraPosition());
+	mScene.UpdateCamera(gt.DeltaTime());
+	UpdateLods();
 
 	// Cycle through the circular frame resource array.
 	mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
@@ -270,15 +331,27 @@ void Rubix::Update(const GameTimer& gt)
 		CloseHandle(eventHandle);
 	}
 
-	UpdateObjects(gt);
-	RotateThird(gt);
-	UpdateObjectCBs(gt);
+	//The scene writes straight into this frame resource's constant buffers
+	FrameConstants frame;
+	frame.Objects = mCurrFrameResource->ObjectCB->MappedData();
+	frame.ObjectStride = mCurrFrameResource->ObjectCB->ElementByteSize();
+	frame.Pass = reinterpret_cast<PassConstants*>(mCurrFrameResource->PassCB->MappedData());
+
+	//Draw the spin and turns where they are between the last two simulation steps
+	mScene.UpdateObjects((float)mSimStep.Alpha());
+	mScene.RotateThird((float)(mSimStep.Alpha() * mSimStep.StepSeconds()));
+	mScene.StoreStagedWorlds(frame);
+	mScene.UpdateObjectCBs(frame);
+	UpdateCubieBatch();
+	UpdateVisibility();
 	UpdateMaterialCBs(gt);
-	UpdateMainPassCB(gt);
+	mTextureStreamer->SetScreenSize(mAtlas, mScene.LargestCubieOnScreen() * gAtlasTilesAcross);
+	mScene.UpdateMainPassCB(frame, gt.TotalTime(), gt.DeltaTime());
 }
 
 void Rubix::Draw(const GameTimer& gt)
 {
+	PROFILE_ZONE("Rubix::Draw");
 	auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
 
 	// Reuse the memory associated with command recording.
@@ -289,12 +362,19 @@ void Rubix::Draw(const GameTimer& gt)
 	// Reusing the command list reuses memory.
 	ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mOpaquePSO.Get()));
 
+	//Show whatever mips have finished copying, then record copying in any more that are ready
+	mTextureSink->Begin(mCommandList.Get(), mFence->GetCompletedValue(), mCurrentFence + 1);
+	mTextureStreamer->Update();
+	mMaterials["rubixCube"]->DiffuseSrvHeapIndex = mTextureSink->DescriptorIndex(mAtlas);
+
+	D3D12RenderCommands d3dCommands(mCommandList.Get());
+	RenderCommands& commands = CommandsFor(d3dCommands);
+
 	mCommandList->RSSetViewports(1, &mScreenViewport);
 	mCommandList->RSSetScissorRects(1, &mScissorRect);
 
 	// Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+	commands.Barrier(CurrentBackBuffer(), RenderCommands::StatePresent, RenderCommands::StateRenderTarget);
 
 	// Clear the back buffer and depth buffer.
 	mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
@@ -309,35 +389,49 @@ void Rubix::Draw(const GameTimer& gt)
 	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
 	auto passCB = mCurrFrameResource->PassCB->Resource();
-	mCommandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
+	commands.SetRootConstantBufferView(RootPass, passCB->GetGPUVirtualAddress());
+
+	//The batch has its own vertex format, so it needs the batched version of every PSO
+	bool batched = appInfo.getDrawMode() == 'b';
+	if (batched) {
+		commands.SetPipelineState(mBatchedOpaquePSO.Get());
+	}
 
 	/*Check if any of the keys predefined in the brief to change the Pipeline
 	state have been depressed and switch the Pipeline State Object to the
 	relevant one.*/
 	if (appInfo.getFill() == 'w') {
-		mCommandList->SetPipelineState(mwireframePSO.Get());
+		commands.SetPipelineState(batched ? mBatchedWireframePSO.Get() : mwireframePSO.Get());
 	}
 	if (appInfo.getFill() == 's') {
-		mCommandList->SetPipelineState(mOpaquePSO.Get());
+		commands.SetPipelineState(batched ? mBatchedOpaquePSO.Get() : mOpaquePSO.Get());
 	}
 	if (appInfo.getCull() == 'b') {
-		mCommandList->SetPipelineState(mbackFacePSO.Get());
+		commands.SetPipelineState(batched ? mBatchedBackFacePSO.Get() : mbackFacePSO.Get());
 	}
 	if (appInfo.getCull() == 'f') {
-		mCommandList->SetPipelineState(mfrontFacePSO.Get());
+		commands.SetPipelineState(batched ? mBatchedFrontFacePSO.Get() : mfrontFacePSO.Get());
 	}
 	if (appInfo.getCull() == 'n') {
-		mCommandList->SetPipelineState(mOpaquePSO.Get());
+		commands.SetPipelineState(batched ? mBatchedOpaquePSO.Get() : mOpaquePSO.Get());
 	}
 
 	/*Draw the render items in the opaque item list regardless of pipeline state
 	as even though their Fill and cull modes can be changed, the objects are still
 	opaque*/
-	DrawRenderItems(mCommandList.Get(), mOpaqueRitems);
+	if (batched) {
+		//The batched vertex shader reads each cubie's world matrix straight out of the object constants
+		auto objectCB = mCurrFrameResource->ObjectCB->Resource();
+		commands.SetRootShaderResourceView(RootBatchObjects, objectCB->GetGPUVirtualAddress());
+		DrawRenderItems(commands, mVisibleBatchRitems);
+	}
+	else {
+		//Each cubie the scene can see is drawn on its own
+		mScene.RecordDraws(GetCubieBindings(), commands);
+	}
 
 	// Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+	commands.Barrier(CurrentBackBuffer(), RenderCommands::StateRenderTarget, RenderCommands::StatePresent);
 
 	// Done recording commands.
 	ThrowIfFailed(mCommandList->Close());
@@ -359,45 +453,38 @@ void Rubix::Draw(const GameTimer& gt)
 	mCommandQueue->Signal(mFence.Get(), mCurrentFence);
 }
 
-void Rubix::OnMouseDown(WPARAM btnState, int x, int y)
+void Rubix::OnMouseDown(int buttons, int x, int y)
 {
 	mLastMousePos.x = x;
 	mLastMousePos.y = y;
 
-	SetCapture(mhMainWnd);
+	mWindow->CaptureMouse();
 }
 
-void Rubix::OnMouseUp(WPARAM btnState, int x, int y)
+void Rubix::OnMouseUp(int buttons, int x, int y)
 {
-	ReleaseCapture();
+	mWindow->ReleaseMouse();
 }
 
-void Rubix::OnMouseMove(WPARAM btnState, int x, int y)
+void Rubix::OnMouseMove(int buttons, int x, int y)
 {
-	if ((btnState & MK_LBUTTON) != 0)
+	if ((buttons & Window::ButtonLeft) != 0)
 	{
 		// Make each pixel correspond to a quarter of a degree.
 		float dx = XMConvertToRadians(0.25f*static_cast<float>(x - mLastMousePos.x));
 		float dy = XMConvertToRadians(0.25f*static_cast<float>(y - mLastMousePos.y));
 
 		// Update angles based on input to orbit camera around box.
-		mTheta += dx;
-		mPhi += dy;
-
-		// Restrict the angle mPhi.
-		mPhi = MathHelper::Clamp(mPhi, 0.1f, MathHelper::Pi - 0.1f);
+		mScene.GetCamera().Orbit(dx, dy);
 	}
-	else if ((btnState & MK_RBUTTON) != 0)
+	else if ((buttons & Window::ButtonRight) != 0)
 	{
 		// Make each pixel correspond to 0.2 unit in the scene.
 		float dx = 0.05f*static_cast<float>(x - mLastMousePos.x);
 		float dy = 0.05f*static_cast<float>(y - mLastMousePos.y);
 
 		// Update the camera radius based on input.
-		mRadius += dx - dy;
-
-		// Restrict the radius.
-		mRadius = MathHelper::Clamp(mRadius, 9.0f, 1500.0f);
+		mScene.GetCamera().Zoom(dx - dy);
 	}
 
 	mLastMousePos.x = x;
@@ -406,370 +493,185 @@ void Rubix::OnMouseMove(WPARAM btnState, int x, int y)
 
 void Rubix::OnKeyboardInput(const GameTimer& gt)
 {
-	/*Check if any relevant keys return a high bit*/
+	/*Check if any relevant keys are held down*/
 
 	//Move forward
-	if (GetAsyncKeyState(VK_UP) & 0x8000) {
-		mEyePos.z += (10.0f*gt.DeltaTime());
-		appInfo.setCameraPosition(6);
-		UpdateCamera(gt);
+	if (mWindow->IsKeyDown(Window::KeyUp)) {
+		MoveEye(0.0f, 10.0f*gt.DeltaTime());
 	}
 	//Move Back
-	if (GetAsyncKeyState(VK_DOWN) & 0x8000) {
-		mEyePos.z += (-10.0f*gt.DeltaTime());
-		appInfo.setCameraPosition(6);
-		UpdateCamera(gt);
+	if (mWindow->IsKeyDown(Window::KeyDown)) {
+		MoveEye(0.0f, -10.0f*gt.DeltaTime());
 	}
 	//Move Left
-	if (GetAsyncKeyState(VK_LEFT) & 0x8000) {
-		mEyePos.x += (-10.0f*gt.DeltaTime());
-		appInfo.setCameraPosition(6);
-		UpdateCamera(gt);
+	if (mWindow->IsKeyDown(Window::KeyLeft)) {
+		MoveEye(-10.0f*gt.DeltaTime(), 0.0f);
 	}
 	//Move Right
-	if (GetAsyncKeyState(VK_RIGHT) & 0x8000) {
-		mEyePos.x += (10.0f*gt.DeltaTime());
-		appInfo.setCameraPosition(6);
-		UpdateCamera(gt);
+	if (mWindow->IsKeyDown(Window::KeyRight)) {
+		MoveEye(10.0f*gt.DeltaTime(), 0.0f);
 	}
 
 	//Enable or disable rotation selection across an axis
-	if (GetAsyncKeyState('R') & 0x8000)
+	if (mWindow->IsKeyDown('R'))
 		(appInfo.getRotatable()) ? appInfo.setRotatable(false) : appInfo.setRotatable(true);
 
 	//Select an axis to rotate across
-	if (GetAsyncKeyState('X') & 0x8000 && appInfo.getRotatable())
+	if (mWindow->IsKeyDown('X') && appInfo.getRotatable())
 		appInfo.setRotationAxis('x');
 
-	if (GetAsyncKeyState('Y') & 0x8000 && appInfo.getRotatable())
+	if (mWindow->IsKeyDown('Y') && appInfo.getRotatable())
 		appInfo.setRotationAxis('y');
 
-	if (GetAsyncKeyState('Z') & 0x8000 && appInfo.getRotatable())
+	if (mWindow->IsKeyDown('Z') && appInfo.getRotatable())
 		appInfo.setRotationAxis('z');
 
 	//Raise the reset flag
-	if (GetAsyncKeyState('I') & 0x8000)
+	if (mWindow->IsKeyDown('I'))
 		appInfo.needsReset(true);
 	//Change the render mode to Solid
-	if (GetAsyncKeyState('S') & 0x8000)
+	if (mWindow->IsKeyDown('S'))
 		appInfo.setRenderMode('s');
 	//Change the render mode to wireframe
-	if (GetAsyncKeyState('W') & 0x8000)
+	if (mWindow->IsKeyDown('W'))
 		appInfo.setRenderMode('w');
 	//Set the cull mode to none
-	if (GetAsyncKeyState('N') & 0x8000)
+	if (mWindow->IsKeyDown('N'))
 		appInfo.setCullMode('n');
 	//Set the cull mode to front face
-	if (GetAsyncKeyState('F') & 0x8000)
+	if (mWindow->IsKeyDown('F'))
 		appInfo.setCullMode('f');
 	//Set the cull mode to back face
-	if (GetAsyncKeyState('B') & 0x8000)
+	if (mWindow->IsKeyDown('B'))
 		appInfo.setCullMode('b');
 	//View the front of the cube
-	if (GetAsyncKeyState('1') & 0x8000)
+	if (mWindow->IsKeyDown('1'))
 		appInfo.setCameraPosition(1);
 	//View the top of the cube
-	if (GetAsyncKeyState('2') & 0x8000)
+	if (mWindow->IsKeyDown('2'))
 		appInfo.setCameraPosition(2);
 	//View the right of the cube
-	if (GetAsyncKeyState('3') & 0x8000)
+	if (mWindow->IsKeyDown('3'))
 		appInfo.setCameraPosition(3);
-	//Rotate the front face 90 degrees
-	if (GetAsyncKeyState('4') & 0x8000)
-		appInfo.setSelectedThird('f');
-	//Rotate the left face 90 degrees
-	if (GetAsyncKeyState('5') & 0x8000)
-		appInfo.setSelectedThird('l');
-	//Rotate the right face 90 degrees
-	if (GetAsyncKeyState('6') & 0x8000)
-		appInfo.setSelectedThird('r');
-	//Rotate the back face 90 degrees
-	if (GetAsyncKeyState('7') & 0x8000)
-		appInfo.setSelectedThird('b');
-	//Rotate the top face 90 degrees
-	if (GetAsyncKeyState('8') & 0x8000)
-		appInfo.setSelectedThird('t');
-	//Rotate the bottom face 90 degrees
-	if (GetAsyncKeyState('9') & 0x8000)
-		appInfo.setSelectedThird('d');
+	//Turn the front, left, right, back, top or bottom face 90 degrees clockwise, or
+	//anticlockwise with shift held.  Each press queues one turn.
+	int quarterTurns = mWindow->IsKeyDown(Window::KeyShift) ? 3 : 1;
+	if (KeyPressed('4'))
+		mScene.Turns().Push('F', quarterTurns);
+	if (KeyPressed('5'))
+		mScene.Turns().Push('L', quarterTurns);
+	if (KeyPressed('6'))
+		mScene.Turns().Push('R', quarterTurns);
+	if (KeyPressed('7'))
+		mScene.Turns().Push('B', quarterTurns);
+	if (KeyPressed('8'))
+		mScene.Turns().Push('U', quarterTurns);
+	if (KeyPressed('9'))
+		mScene.Turns().Push('D', quarterTurns);
+	//Scramble the cube
+	if (KeyPressed('J'))
+		mScene.QueueScramble(gScrambleLength);
 	//Exit orthographic view
-	if (GetAsyncKeyState('0') & 0x8000)
+	if (mWindow->IsKeyDown('0'))
 		appInfo.setCameraPosition(0);
+	//Draw every cubie in one batch
+	if (mWindow->IsKeyDown('G'))
+		appInfo.setDrawMode('b');
+	//Draw each cubie on its own
+	if (mWindow->IsKeyDown('H'))
+		appInfo.setDrawMode('i');
 
 }
 
-void Rubix::UpdateCamera(const GameTimer& gt)
+bool Rubix::KeyPressed(int key)
 {
-	// Convert Spherical to Cartesian coordinates.
-	XMVECTOR up;
-	//Set the eye position based on the camera position variable
-	switch (appInfo.getCameraPosition()) {
-	case 1:
-		mEyePos.x = 0.0f;
-		mEyePos.y = 0.0f;
-		mEyePos.z = -6.0f;
-		up = XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f);
-		break;
-	case 2:
-		mEyePos.x = 0.0f;
-		mEyePos.y = 6.0f;
-		mEyePos.z = 0.0f;
-		up = XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f);
-		break;
-	case 3:
-		mEyePos.x = 6.0f;
-		mEyePos.y = 0.0f;
-		mEyePos.z = 0.0f;
-		up = XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f);
-		break;
-	case 0:
-		mEyePos.x = mRadius * sinf(mPhi)*cosf(mTheta);
-		mEyePos.z = mRadius * sinf(mPhi)*sinf(mTheta);
-		mEyePos.y = mRadius * cosf(mPhi);
-		up = XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f);
-		break;
-	default:
-		up = XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f);
-		break;
-	}
-
-	// Build the view matrix.
-
-	XMVECTOR pos = XMVectorSet(mEyePos.x, mEyePos.y, mEyePos.z, 1.0f);
-	XMVECTOR target = XMVectorZero();
-
-
-	XMMATRIX view = XMMatrixLookAtLH(pos, target, up);
-	XMStoreFloat4x4(&mView, view);
-
-
+	bool down = mWindow->IsKeyDown(key);
+	bool pressed = down && !mKeysDown[key];
+	mKeysDown[key] = down;
+	return pressed;
 }
 
-void Rubix::UpdateObjects(const GameTimer& gt) {
-	//Check the case
-	XMMATRIX world;
-	XMMATRIX rot;
-	ObjectConstants objConstants;
-	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-	//Rotates each cube based on the axis for the whole cube to rotate across
-	switch (appInfo.rotationAxis()) {
-	case 'x':
-		for (auto &e : mAllRitems) {
-			world = XMLoadFloat4x4(&e->World);
-			rot = XMMatrixRotationX(XMConvertToRadians(rotated));
-			rotated += 0.0003f;
-			world *= rot;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-		}
-		break;
-	case 'y':
-		for (auto &e : mAllRitems) {
-			world = XMLoadFloat4x4(&e->World);
-			rot = XMMatrixRotationY(XMConvertToRadians(rotated));
-			rotated += 0.0003f;
-			world *= rot;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-		}
-		break;
-	case 'z':
-		for (auto &e : mAllRitems) {
-			world = XMLoadFloat4x4(&e->World);
-			rot = XMMatrixRotationZ(XMConvertToRadians(rotated));
-			rotated += 0.0003f;
-			world *= rot;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-		}
-		break;
-	default:
-		rot = XMMatrixRotationX(0);
-	}
-
-	//Update the world matrix for the RIs
+void Rubix::MoveEye(float dx, float dz)
+{
+	mScene.MoveEye(dx, dz);
+	appInfo.setCameraPosition(6);
 }
 
-void Rubix::RotateThird(const GameTimer&gt) {
-	//Set up to manipulate the cubes
-	XMMATRIX world;
-	XMMATRIX rot;
-	ObjectConstants objConstants;
-	//Track which face last rotated
-	char lastFace = ' ';
-	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-	//Check which third has been selected
+void Rubix::UpdateLods()
+{
+	//Draw whatever level and faces the scene picked for each cubie
+	mScene.UpdateLods();
 	for (auto& e : mAllRitems) {
-		switch (appInfo.getSelectedThird()) {
-		case 'f':
-			if (e->ObjCBIndex == appInfo.frontIndicies_.at(0) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(1) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(2) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(3) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(4) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(5) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(6) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(7) ||
-				e->ObjCBIndex == appInfo.frontIndicies_.at(8)) {
-				world = XMLoadFloat4x4(&e->World);
-				rot = XMMatrixRotationZ(XMConvertToRadians(topRotation));
-				world *= rot;
-				XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-				currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-			}
-			break;
-		case 'l':
-			if (e->ObjCBIndex == appInfo.leftIndicies_.at(0) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(1) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(2) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(3) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(4) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(5) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(6) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(7) ||
-				e->ObjCBIndex == appInfo.leftIndicies_.at(8)) {
-				world = XMLoadFloat4x4(&e->World);
-				rot = XMMatrixRotationX(XMConvertToRadians(bottomRotation));
-				world *= rot;
-				XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-				currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-			}
-			break;
-		case 'r':
-			if (e->ObjCBIndex == appInfo.rightIndicies_.at(0) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(1) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(2) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(3) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(4) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(5) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(6) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(7) ||
-				e->ObjCBIndex == appInfo.rightIndicies_.at(8)) {
-				world = XMLoadFloat4x4(&e->World);
-				rot = XMMatrixRotationX(XMConvertToRadians(bottomRotation));
-				world *= rot;
-				XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-				currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-			}
-			break;
-		case 'b':
-			if (e->ObjCBIndex == appInfo.backIndicies_.at(0) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(1) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(2) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(3) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(4) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(5) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(6) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(7) ||
-				e->ObjCBIndex == appInfo.backIndicies_.at(8)) {
-				world = XMLoadFloat4x4(&e->World);
-				rot = XMMatrixRotationZ(XMConvertToRadians(bottomRotation));
-				world *= rot;
-				XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-				currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-			}
-			break;
-		case 't':
-			if (e->ObjCBIndex == appInfo.topIndicies_.at(0) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(1) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(2) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(3) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(4) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(5) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(6) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(7) ||
-				e->ObjCBIndex == appInfo.topIndicies_.at(8)) {
-				world = XMLoadFloat4x4(&e->World);
-				rot = XMMatrixRotationY(XMConvertToRadians(bottomRotation));
-				world *= rot;
-				XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-				currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-			}
-			break;
-		case 'd':
-			if (e->ObjCBIndex == appInfo.bottomIndicies_.at(0) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(1) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(2) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(3) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(4) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(5) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(6) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(7) ||
-				e->ObjCBIndex == appInfo.bottomIndicies_.at(8)) {
-				world = XMLoadFloat4x4(&e->World);
-				rot = XMMatrixRotationY(XMConvertToRadians(bottomRotation));
-				world *= rot;
-				XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-				currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-			}
-			break;
-		}
+		const DrawArgs& draw = mScene.GetCubie(e->ObjCBIndex).Draw;
+		e->IndexCount = draw.IndexCount;
+		e->StartIndexLocation = draw.StartIndexLocation;
+		e->BaseVertexLocation = draw.BaseVertexLocation;
 	}
-	appInfo.setSelectedThird(' ');
 }
-void Rubix::UpdateLastFace(char face) {
-	//Update the CB Indicies that compose each face after a rotation
-	switch (face) {
-	case 'd':
-		bottomRotation += 90.0f;
-		switch ((int)bottomRotation) {
-		case 180:
-			appInfo.bottomIndicies_.at(0) = 2;
-			appInfo.bottomIndicies_.at(1) = 1;
-			appInfo.bottomIndicies_.at(2) = 0;
-			appInfo.bottomIndicies_.at(3) = 11;
-			appInfo.bottomIndicies_.at(5) = 9;
-			appInfo.bottomIndicies_.at(6) = 20;
-			appInfo.bottomIndicies_.at(7) = 19;
-			appInfo.bottomIndicies_.at(8) = 18;
-			break;
-		case 270:
-			appInfo.bottomIndicies_.at(0);
-			appInfo.bottomIndicies_.at(1);
-			appInfo.bottomIndicies_.at(2);
-			appInfo.bottomIndicies_.at(3);
-			appInfo.bottomIndicies_.at(5);
-			appInfo.bottomIndicies_.at(6);
-			appInfo.bottomIndicies_.at(7);
-			appInfo.bottomIndicies_.at(8);
-			break;
-		default:
-			appInfo.bottomIndicies_.at(0);
-			appInfo.bottomIndicies_.at(1);
-			appInfo.bottomIndicies_.at(2);
-			appInfo.bottomIndicies_.at(3);
-			appInfo.bottomIndicies_.at(5);
-			appInfo.bottomIndicies_.at(6);
-			appInfo.bottomIndicies_.at(7);
-			appInfo.bottomIndicies_.at(8);
-			break;
-		}
 
-		break;
-	}
+void Rubix::Simulate(float dt) {
+	PROFILE_ZONE("Rubix::Simulate");
+	mScene.SetSpinAxis(appInfo.rotationAxis());
+	mScene.Simulate(dt);
 }
-void Rubix::UpdateObjectCBs(const GameTimer& gt)
+
+void Rubix::UpdateCubieBatch()
 {
-	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-	for (auto& e : mAllRitems)
-	{
-		// Only update the cbuffer data if the constants have changed.  
-		// This needs to be tracked per frame resource.
-		if (e->NumFramesDirty > 0)
-		{
-			XMMATRIX world = XMLoadFloat4x4(&e->World);
-			XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
+	if (appInfo.getDrawMode() != 'b')
+		return;
+
+	//Follow whatever each cubie would draw on its own.  Only the cubies that changed, such
+	//as those that start or stop showing their inner faces when a slice turns, get rebatched.
+	for (UINT i = 0; i < mOpaqueRitems.size(); ++i) {
+		auto ri = mOpaqueRitems[i];
+		SubmeshGeometry submesh;
+		submesh.IndexCount = ri->IndexCount;
+		submesh.StartIndexLocation = ri->StartIndexLocation;
+		submesh.BaseVertexLocation = ri->BaseVertexLocation;
+		mCubieBatch.SetCubie(i, ri->ObjCBIndex, submesh);
+	}
 
-			ObjectConstants objConstants;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+	if (mCubieBatch.Update()) {
+#if defined(DEBUG) | defined(_DEBUG)
+		std::string error;
+		if (!mCubieBatch.Validate(error)) {
+			::OutputDebugStringA(("Cubie batch does not match its source: " + error + "\n").c_str());
+			assert(false);
+		}
+#endif
+		//Each frame resource has its own copy of the batch to update
+		mBatchFramesDirty = gNumFrameResources;
+	}
 
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
+	const auto& vertices = mCubieBatch.Vertices();
+	const auto& indices = mCubieBatch.Indices();
+	assert(vertices.size() <= mBatchVertexCapacity && indices.size() <= mBatchIndexCapacity);
 
-			// Next FrameResource need to be updated too.
-			e->NumFramesDirty--;
-		}
+	auto currBatchVB = mCurrFrameResource->BatchVB.get();
+	auto currBatchIB = mCurrFrameResource->BatchIB.get();
+	if (mBatchFramesDirty > 0) {
+		currBatchVB->CopyData(0, vertices.data(), (UINT)vertices.size());
+		currBatchIB->CopyData(0, indices.data(), (UINT)indices.size());
+		mBatchFramesDirty--;
 	}
+
+	//Draw from this frame's copy of the batch
+	auto geo = mBatchRitem->Geo;
+	geo->VertexBufferGPU = currBatchVB->Resource();
+	geo->IndexBufferGPU = currBatchIB->Resource();
+	geo->VertexBufferByteSize = (UINT)vertices.size() * sizeof(BatchedVertex);
+	geo->IndexBufferByteSize = (UINT)indices.size() * sizeof(std::uint32_t);
+	mBatchRitem->IndexCount = (UINT)indices.size();
+}
+
+void Rubix::UpdateVisibility()
+{
+	mScene.UpdateVisibility();
+
+	//The batch is drawn whole, so it is needed as long as any cubie can be seen
+	mVisibleBatchRitems.clear();
+	if (!mScene.VisibleCubies().empty())
+		mVisibleBatchRitems.push_back(mBatchRitem.get());
 }
 
 void Rubix::UpdateMaterialCBs(const GameTimer& gt)
@@ -798,89 +700,37 @@ void Rubix::UpdateMaterialCBs(const GameTimer& gt)
 	}
 }
 
-void Rubix::UpdateMainPassCB(const GameTimer& gt)
-{
-	XMMATRIX view = XMLoadFloat4x4(&mView);
-	XMMATRIX proj = XMLoadFloat4x4(&mProj);
-
-	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-	XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-	XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
-
-
-	XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
-	XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
-	XMStoreFloat4x4(&mMainPassCB.Proj, XMMatrixTranspose(proj));
-	XMStoreFloat4x4(&mMainPassCB.InvProj, XMMatrixTranspose(invProj));
-	XMStoreFloat4x4(&mMainPassCB.ViewProj, XMMatrixTranspose(viewProj));
-	XMStoreFloat4x4(&mMainPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
-	mMainPassCB.EyePosW = mEyePos;
-	mMainPassCB.RenderTargetSize = XMFLOAT2((float)mClientWidth, (float)mClientHeight);
-	mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / mClientWidth, 1.0f / mClientHeight);
-	mMainPassCB.NearZ = 1.0f;
-	mMainPassCB.FarZ = 1000.0f;
-	mMainPassCB.TotalTime = gt.TotalTime();
-	mMainPassCB.DeltaTime = gt.DeltaTime();
-	//mMainPassCB.AmbientLight = { 0.25f, 0.25f, 0.35f, 1.0f };
-
-	//Directional Lights
-	mMainPassCB.Lights[0].Direction = {-3.0f, 0.0f, -3.0f };
-	mMainPassCB.Lights[0].Strength = { 0.3f, 0.3f, 0.3f };
-
-	mMainPassCB.Lights[1].Direction = { 3.0f, 0.0f, 3.0f };
-	mMainPassCB.Lights[1].Strength = { 0.3f, 0.3f, 0.3f };
-
-	//Point Lights
-	mMainPassCB.Lights[2].Position = { 0.0f, -6.0f, 0.0f };
-	mMainPassCB.Lights[2].Strength = { 2.0f,2.0f,2.0f };
-
-	//Spotlight
-	mMainPassCB.Lights[3].Position = { 0.0f,6.0f,0.0f };
-	mMainPassCB.Lights[3].Direction = { 0.0f, -1.0f, 0.0f };
-	mMainPassCB.Lights[3].Strength = { 1.0f,1.0f,1.0f };
-	mMainPassCB.Lights[3].SpotPower = 0.001f;
-
-
-	
-
-
-	auto currPassCB = mCurrFrameResource->PassCB.get();
-	currPassCB->CopyData(0, mMainPassCB);
-}
-
 void Rubix::LoadTextures()
 {
-	//Load the rubiks cube texture atlas
-	auto cubeTextureAtlas = std::make_unique<Texture>();
-	cubeTextureAtlas->Name = "cubeTextureAtlas";
-	cubeTextureAtlas->Filename = L"Textures/atlas.dds";
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-		mCommandList.Get(), cubeTextureAtlas->Filename.c_str(),
-		cubeTextureAtlas->Resource, cubeTextureAtlas->UploadHeap));
-
-	mTextures[cubeTextureAtlas->Name] = std::move(cubeTextureAtlas);
-
+	PROFILE_ZONE("Rubix::LoadTextures");
+	//Ask for the rubiks cube texture atlas.  It is read in the background and drawn black
+	//until its mip tail is resident, a frame or two after the first.
+	mTextureSink = std::make_unique<D3D12TextureSink>(md3dDevice.Get());
+	mTextureStreamer = std::make_unique<TextureStreamer>(*mTextureSink, gTextureBudgetBytes, gTextureWorkers);
+	mAtlas = mTextureStreamer->Request(L"Textures/atlas.dds");
 }
 
 void Rubix::BuildRootSignature()
 {
+	PROFILE_ZONE("Rubix::BuildRootSignature");
 	CD3DX12_DESCRIPTOR_RANGE texTable;
 	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
 	// Root parameter can be a table, root descriptor or root constants.
-	CD3DX12_ROOT_PARAMETER slotRootParameter[4];
+	CD3DX12_ROOT_PARAMETER slotRootParameter[RootParameterCount];
 
 	// Perfomance TIP: Order from most frequent to least frequent.
-	slotRootParameter[0].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
-	slotRootParameter[1].InitAsConstantBufferView(0);
-	slotRootParameter[2].InitAsConstantBufferView(1);
-	slotRootParameter[3].InitAsConstantBufferView(2);
+	slotRootParameter[RootTexture].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
+	slotRootParameter[RootObject].InitAsConstantBufferView(0);
+	slotRootParameter[RootPass].InitAsConstantBufferView(1);
+	slotRootParameter[RootMaterial].InitAsConstantBufferView(2);
+	//Every cubie's object constants, read by the batched vertex shader
+	slotRootParameter[RootBatchObjects].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
 	auto staticSamplers = GetStaticSamplers();
 
 	// A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(RootParameterCount, slotRootParameter,
 		(UINT)staticSamplers.size(), staticSamplers.data(),
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -905,11 +755,12 @@ void Rubix::BuildRootSignature()
 
 void Rubix::BuildDescriptorHeaps()
 {
+	PROFILE_ZONE("Rubix::BuildDescriptorHeaps");
 	//
 	// Create the SRV heap.
 	//
 	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-	srvHeapDesc.NumDescriptors = 1;
+	srvHeapDesc.NumDescriptors = 2;
 	srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 	srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 	ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvDescriptorHeap)));
@@ -919,23 +770,26 @@ void Rubix::BuildDescriptorHeaps()
 	//
 	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
-	auto cubeTextureAtlas = mTextures["cubeTextureAtlas"]->Resource;
-
+	//The atlas has two descriptors, so the texture sink can point one at finer mips while
+	//frames still on the GPU read the other.  Both start as null views, which sample black.
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Format = cubeTextureAtlas->GetDesc().Format;
+	srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = cubeTextureAtlas->GetDesc().MipLevels;
+	srvDesc.Texture2D.MipLevels = 1;
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-	md3dDevice->CreateShaderResourceView(cubeTextureAtlas.Get(), &srvDesc, hDescriptor);
-
+	md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, hDescriptor);
+	md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, CD3DX12_CPU_DESCRIPTOR_HANDLE(hDescriptor, 1, mCbvSrvDescriptorSize));
+	mTextureSink->SetDescriptors(mAtlas, hDescriptor, mCbvSrvDescriptorSize);
 }
 
 void Rubix::BuildShadersAndInputLayout()
 {
+	PROFILE_ZONE("Rubix::BuildShadersAndInputLayout");
 	mShaders["standardVS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "VS", "vs_5_0");
+	mShaders["batchedVS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "VSBatched", "vs_5_0");
 	mShaders["opaquePS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "PS", "ps_5_0");
 
 	mInputLayout =
@@ -944,61 +798,97 @@ void Rubix::BuildShadersAndInputLayout()
 		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 	};
+
+	mBatchedInputLayout = mInputLayout;
+	mBatchedInputLayout.push_back({ "CUBIEID", 0, DXGI_FORMAT_R32_UINT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
 }
 
 void Rubix::BuildShapeGeometry()
 {
-	GeometryGenerator geoGen;
-	GeometryGenerator::MeshData box = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3);
+	PROFILE_ZONE("Rubix::BuildShapeGeometry");
+	//Generating and simplifying the cubie is by far the slowest part of start up, so it is
+	//done once and saved.  Later starts map the saved file and use its buffers in place.
+	const std::wstring cacheFile = L"cubie.meshcache";
+	CubieMeshDesc desc;
 
-	SubmeshGeometry boxSubmesh;
-	boxSubmesh.IndexCount = (UINT)box.Indices32.size();
-	boxSubmesh.StartIndexLocation = 0;
-	boxSubmesh.BaseVertexLocation = 0;
-
-	std::vector<Vertex> vertices(box.Vertices.size());
+	auto geo = std::make_unique<MeshGeometry>();
+	geo->Name = "cubieGeo";
 
+	//Levels of detail for the cubie mesh, one chain for every combination of faces
+	//that can be drawn
+	CubeScene::LodChains cubieLods;
 
-	for (size_t i = 0; i < box.Vertices.size(); ++i)
+	auto cache = std::make_shared<MeshCache>();
+	if (OpenCubieMesh(cacheFile, desc, *cache))
 	{
-		vertices[i].Pos = box.Vertices[i].Position;
-		vertices[i].Normal = box.Vertices[i].Normal;
-		vertices[i].TexC = box.Vertices[i].TexC;
+		cubieLods = CubieLodChains(*cache);
+
+		//The blobs point straight into the mapping and keep it open for as long as they live
+		geo->VertexBufferCPU = d3dUtil::CreateBlobView(cache->Vertices(), cache->VertexCount() * sizeof(Vertex), cache);
+		geo->IndexBufferCPU = d3dUtil::CreateBlobView(cache->Indices(), cache->IndexCount() * sizeof(std::uint16_t), cache);
 	}
+	else
+	{
+		CubieMesh mesh = BuildCubieMesh(desc);
 
-	std::vector<std::uint16_t> indices = box.GetIndices16();
+		//Not being able to save the cache only costs time on the next start
+		SaveCubieMesh(cacheFile, desc, mesh);
 
+		cubieLods = CubieLodChains(mesh);
 
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
+		const UINT vbByteSize = (UINT)mesh.Vertices.size() * sizeof(Vertex);
+		const UINT ibByteSize = (UINT)mesh.Indices.size() * sizeof(std::uint16_t);
 
-	auto geo = std::make_unique<MeshGeometry>();
-	geo->Name = "boxGeo";
+		ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
+		CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), mesh.Vertices.data(), vbByteSize);
 
-	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
+		ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
+		CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), mesh.Indices.data(), ibByteSize);
+	}
 
-	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+	const UINT vbByteSize = (UINT)geo->VertexBufferCPU->GetBufferSize();
+	const UINT ibByteSize = (UINT)geo->IndexBufferCPU->GetBufferSize();
 
 	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
+		mCommandList.Get(), geo->VertexBufferCPU->GetBufferPointer(), vbByteSize, geo->VertexBufferUploader);
 
 	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+		mCommandList.Get(), geo->IndexBufferCPU->GetBufferPointer(), ibByteSize, geo->IndexBufferUploader);
 
 	geo->VertexByteStride = sizeof(Vertex);
 	geo->VertexBufferByteSize = vbByteSize;
 	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
 	geo->IndexBufferByteSize = ibByteSize;
+	geo->TrackMemory(md3dDevice.Get());
+
+	const DrawArgs& full = cubieLods[gAllCubieFaces][0];
+	SubmeshGeometry& cubie = geo->DrawArgs["cubie"];
+	cubie.IndexCount = full.IndexCount;
+	cubie.StartIndexLocation = full.StartIndexLocation;
+	cubie.BaseVertexLocation = full.BaseVertexLocation;
 
-	geo->DrawArgs["box"] = boxSubmesh;
+	//Bounds of the whole mesh, which hold every level, as CubieBounds says
+	geo->ComputeBounds();
+
+	mScene.SetCubieMesh(cubieLods, cubie.Bounds, cubie.SphereBounds, gCubieLodDistances);
+
+	//The batch merges copies of the cubie geometry, so it reads straight from the CPU copies
+	mCubieBatch.SetSource(static_cast<const Vertex*>(geo->VertexBufferCPU->GetBufferPointer()), vbByteSize / sizeof(Vertex),
+		static_cast<const std::uint16_t*>(geo->IndexBufferCPU->GetBufferPointer()), ibByteSize / sizeof(std::uint16_t));
 
 	mGeometries[geo->Name] = std::move(geo);
+
+	//Its buffers live in the frame resources and are pointed at every frame in UpdateCubieBatch
+	auto batchGeo = std::make_unique<MeshGeometry>();
+	batchGeo->Name = "cubieBatchGeo";
+	batchGeo->VertexByteStride = sizeof(BatchedVertex);
+	batchGeo->IndexFormat = DXGI_FORMAT_R32_UINT;
+	mGeometries[batchGeo->Name] = std::move(batchGeo);
 }
 
 void Rubix::BuildPSOs()
 {
+	PROFILE_ZONE("Rubix::BuildPSOs");
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC opaquePsoDesc;
 
 	//
@@ -1049,19 +939,54 @@ void Rubix::BuildPSOs()
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC backFacePsoDesc = opaquePsoDesc;
 	backFacePsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
 	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&backFacePsoDesc, IID_PPV_ARGS(&mbackFacePSO)));
+
+	//
+	// Batched versions of the PSOs above.
+	//
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC batchedPsoDesc = opaquePsoDesc;
+	batchedPsoDesc.InputLayout = { mBatchedInputLayout.data(), (UINT)mBatchedInputLayout.size() };
+	batchedPsoDesc.VS =
+	{
+		reinterpret_cast<BYTE*>(mShaders["batchedVS"]->GetBufferPointer()),
+		mShaders["batchedVS"]->GetBufferSize()
+	};
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&batchedPsoDesc, IID_PPV_ARGS(&mBatchedOpaquePSO)));
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC batchedWireframePsoDesc = batchedPsoDesc;
+	batchedWireframePsoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&batchedWireframePsoDesc, IID_PPV_ARGS(&mBatchedWireframePSO)));
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC batchedFrontFacePsoDesc = batchedPsoDesc;
+	batchedFrontFacePsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_FRONT;
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&batchedFrontFacePsoDesc, IID_PPV_ARGS(&mBatchedFrontFacePSO)));
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC batchedBackFacePsoDesc = batchedPsoDesc;
+	batchedBackFacePsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&batchedBackFacePsoDesc, IID_PPV_ARGS(&mBatchedBackFacePSO)));
 }
 
 void Rubix::BuildFrameResources()
 {
+	PROFILE_ZONE("Rubix::BuildFrameResources");
+	//Leave room in the batch for every cubie to draw all of its faces at full detail
+	const SubmeshGeometry& largest = mGeometries["cubieGeo"]->DrawArgs["cubie"];
+	mBatchVertexCapacity = (UINT)mAllRitems.size() * mCubieBatch.BatchedVertexCount(largest);
+	mBatchIndexCapacity = (UINT)mAllRitems.size() * largest.IndexCount;
+
 	for (int i = 0; i < gNumFrameResources; ++i)
 	{
 		mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
-			1, (UINT)mAllRitems.size(), (UINT)mMaterials.size()));
+			1, (UINT)mAllRitems.size(), (UINT)mMaterials.size(), mBatchVertexCapacity, mBatchIndexCapacity));
 	}
+
+	//What each draw reads through the root signature, for logging commands with F5
+	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
+	mCommandLog.SetRootBytes(RootParameterBytes(objCBByteSize, (UINT)mAllRitems.size()));
 }
 
 void Rubix::BuildMaterials()
 {
+	PROFILE_ZONE("Rubix::BuildMaterials");
 	//Create a material for the lights to interact with
 	auto rubixCube = std::make_unique<Material>();
 	rubixCube->Name = "rubixCube";
@@ -1077,34 +1002,45 @@ void Rubix::BuildMaterials()
 
 void Rubix::BuildRenderItems()
 {
-	/*Create an int to assign as the Constant Buffer index for each new object
-	and set it to 0 to allow the first object to have CB Index 0*/
-	int object{ 0 };
-	/*Use three nested for loops to create 3^3 individual cubes*/
-	for (float x = -1.0f; x <= 1.0f; x += 1.0f) {
-		for (float y = -1.0f; y <= 1.0f; y += 1.0f) {
-			for (float z = -1.0f; z <= 1.0f; z += 1.0f) {
-				auto boxRitem = std::make_unique<RenderItem>();
-				XMStoreFloat4x4(&boxRitem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f)*XMMatrixTranslation(x, y, z));
-				boxRitem->ObjCBIndex = object;
-				boxRitem->Mat = mMaterials["rubixCube"].get();
-				boxRitem->Geo = mGeometries["boxGeo"].get();
-				boxRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-				boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
-				boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
-				boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
-				mAllRitems.push_back(std::move(boxRitem));
-				object++;//Increment the object variable to assign a unique CB Index to the next cube.
-			}
-		}
+	PROFILE_ZONE("Rubix::BuildRenderItems");
+	//Start from scratch when rebuilding after a reset
+	mAllRitems.clear();
+	mScene.Reset();
+
+	//One item draws each of the scene's cubies, with the same constant buffer index
+	for (int object = 0; object < CubeScene::CubieCount; ++object) {
+		const DrawArgs& draw = mScene.GetCubie(object).Draw;
+		auto boxRitem = std::make_unique<RenderItem>();
+		boxRitem->ObjCBIndex = object;
+		boxRitem->Mat = mMaterials["rubixCube"].get();
+		boxRitem->Geo = mGeometries["cubieGeo"].get();
+		boxRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+		boxRitem->IndexCount = draw.IndexCount;
+		boxRitem->StartIndexLocation = draw.StartIndexLocation;
+		boxRitem->BaseVertexLocation = draw.BaseVertexLocation;
+		mAllRitems.push_back(std::move(boxRitem));
 	}
 
 	// All the render items are opaque.
 	for (auto& e : mAllRitems)
 		mOpaqueRitems.push_back(e.get());
+
+	//One item draws the whole batch.  Its world matrices come from the cubies' object
+	//constants, so the object constant buffer it is given is never read.
+	mCubieBatch.Resize((UINT)mOpaqueRitems.size());
+	mBatchFramesDirty = gNumFrameResources;
+
+	mBatchRitem = std::make_unique<RenderItem>();
+	mBatchRitem->ObjCBIndex = 0;
+	mBatchRitem->Mat = mMaterials["rubixCube"].get();
+	mBatchRitem->Geo = mGeometries["cubieBatchGeo"].get();
+	mBatchRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+	//Treat everything as visible until the first cull
+	mVisibleBatchRitems = { mBatchRitem.get() };
 }
 
-void Rubix::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
+void Rubix::DrawRenderItems(RenderCommands& commands, const std::vector<RenderItem*>& ritems)
 {
 	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 	UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
@@ -1117,9 +1053,13 @@ void Rubix::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vecto
 	{
 		auto ri = ritems[i];
 
-		cmdList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-		cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-		cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
+		//Nothing to draw, such as a batch of cubies with no faces showing
+		if (ri->IndexCount == 0)
+			continue;
+
+		commands.SetVertexBuffer(D3D12RenderCommands::ToView(ri->Geo->VertexBufferView()));
+		commands.SetIndexBuffer(D3D12RenderCommands::ToView(ri->Geo->IndexBufferView()));
+		commands.SetPrimitiveTopology(RenderCommands::TriangleList);
 
 		CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 		tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvDescriptorSize);
@@ -1127,14 +1067,34 @@ void Rubix::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vecto
 		D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex*objCBByteSize;
 		D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + ri->Mat->MatCBIndex*matCBByteSize;
 
-		cmdList->SetGraphicsRootDescriptorTable(0, tex);
-		cmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
-		cmdList->SetGraphicsRootConstantBufferView(3, matCBAddress);
+		commands.SetRootDescriptorTable(RootTexture, tex.ptr);
+		commands.SetRootConstantBufferView(RootObject, objCBAddress);
+		commands.SetRootConstantBufferView(RootMaterial, matCBAddress);
 
-		cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+		commands.DrawIndexed(ri->IndexCount, ri->StartIndexLocation, ri->BaseVertexLocation);
 	}
 }
 
+CubieBindings Rubix::GetCubieBindings()const
+{
+	//Every cubie shares the one mesh and material
+	const MeshGeometry* geo = mGeometries.at("cubieGeo").get();
+	const Material* mat = mMaterials.at("rubixCube").get();
+	UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+	tex.Offset(mat->DiffuseSrvHeapIndex, mCbvSrvDescriptorSize);
+
+	CubieBindings bindings;
+	bindings.Vertices = D3D12RenderCommands::ToView(geo->VertexBufferView());
+	bindings.Indices = D3D12RenderCommands::ToView(geo->IndexBufferView());
+	bindings.Texture = tex.ptr;
+	bindings.Objects = mCurrFrameResource->ObjectCB->Resource()->GetGPUVirtualAddress();
+	bindings.ObjectStride = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
+	bindings.Material = mCurrFrameResource->MaterialCB->Resource()->GetGPUVirtualAddress() + mat->MatCBIndex*matCBByteSize;
+	return bindings;
+}
+
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> Rubix::GetStaticSamplers()
 {
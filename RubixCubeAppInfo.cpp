@@ -21,6 +21,7 @@ RubixCubeAppInfo::RubixCubeAppInfo()
     selectedThird_ = ' ';
     rotatable_ = false;
     rotationAxis_ = ' ';
+    drawMode_ = ' ';
     topIndicies_ = { 6,7,8,15,16,17,24,25,26 };
     bottomIndicies_ = { 0,1,2,9,10,11,18,19,20 };
     leftIndicies_ = { 0,1,2,3,4,5,6,7,8 };
@@ -71,6 +72,11 @@ bool RubixCubeAppInfo::getRotatable() const
     return rotatable_;
 }
 
+char RubixCubeAppInfo::getDrawMode() const
+{
+    return drawMode_;
+}
+
 void RubixCubeAppInfo::needsReset(bool needsReset)
 {
     needsReset_ = needsReset;
@@ -105,3 +111,8 @@ void RubixCubeAppInfo::setRotatable(bool rotatable)
 {
     rotatable_ = rotatable;
 }
+
+void RubixCubeAppInfo::setDrawMode(char drawMode)
+{
+    drawMode_ = drawMode;
+}
@@ -21,6 +21,7 @@ public:
     int getCameraPosition()const;
     char getSelectedThird()const;
     bool getRotatable() const;
+    char getDrawMode() const;
 
 	//Setters
     void needsReset(bool needsReset);
@@ -30,6 +31,7 @@ public:
     void setCameraPosition(int cameraPosition);
     void setSelectedThird(char selectedThird);
     void setRotatable(bool rotatable);
+    void setDrawMode(char drawMode);
 
 	//Vectrors storing the constant buffers of the cubes making up each face
     std::vector<UINT> topIndicies_;
@@ -47,4 +49,5 @@ private:
     int cameraPosition_;
     char selectedThird_;
     bool rotatable_;
+    char drawMode_;
 };
\ No newline at end of file
@@ -67,6 +67,18 @@ cbuffer cbMaterial : register(b2)
     float4x4 gMatTransform;
 };
 
+// Object constants of every cubie, indexed by the cubie id of a batched vertex.  This is
+// the same upload buffer cbPerObject is bound from, so each element is padded to 256 bytes.
+struct ObjectData
+{
+    float4x4 World;
+    float4x4 TexTransform;
+    float4x4 WorldViewProj;
+    float4x4 Pad;
+};
+
+StructuredBuffer<ObjectData> gObjects : register(t1);
+
 struct VertexIn
 {
 	float3 PosL    : POSITION;
@@ -103,6 +115,39 @@ VertexOut VS(VertexIn vin)
     return vout;
 }
 
+struct BatchedVertexIn
+{
+	float3 PosL    : POSITION;
+    float3 NormalL : NORMAL;
+	float2 TexC    : TEXCOORD;
+    uint   CubieId : CUBIEID;
+};
+
+// Same as VS, but takes the world and texture transforms from the cubie the vertex
+// belongs to rather than from cbPerObject, so the whole batch can be drawn at once.
+VertexOut VSBatched(BatchedVertexIn vin)
+{
+	VertexOut vout = (VertexOut)0.0f;
+
+    ObjectData obj = gObjects[vin.CubieId];
+
+    // Transform to world space.
+    float4 posW = mul(float4(vin.PosL, 1.0f), obj.World);
+    vout.PosW = posW.xyz;
+
+    // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
+    vout.NormalW = mul(vin.NormalL, (float3x3)obj.World);
+
+    // Transform to homogeneous clip space.
+    vout.PosH = mul(posW, gViewProj);
+
+	// Output vertex attributes for interpolation across triangle.
+    float4 texC = mul(float4(vin.TexC, 0.0f, 1.0f), obj.TexTransform);
+    vout.TexC = mul(texC, gMatTransform).xy;
+
+    return vout;
+}
+
 float4 PS(VertexOut pin) : SV_Target
 {
 	//Calculate the diffuseAlbedo colour using the texture sampler
@@ -0,0 +1,337 @@
+/*Filename: TurnQueue.cpp
+ Description: Implementation file for TurnQueue.h*/
+
+#include "TurnQueue.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace DirectX;
+
+namespace
+{
+	//The axis a layer turns about (0 x, 1 y, 2 z), where it sits along that axis, and
+	//which way round the axis a clockwise turn goes.  Looking along an axis towards the
+	//origin, positive angles turn clockwise, so a face turns clockwise about its own
+	//outward normal and the middle layers follow the faces they are named after.
+	bool FaceLayer(char face, int& axis, int& layer, int& sign)
+	{
+		switch (face) {
+		case 'L': axis = 0; layer = -1; sign = -1; return true;
+		case 'M': axis = 0; layer = 0; sign = -1; return true;
+		case 'R': axis = 0; layer = 1; sign = 1; return true;
+		case 'D': axis = 1; layer = -1; sign = -1; return true;
+		case 'E': axis = 1; layer = 0; sign = -1; return true;
+		case 'U': axis = 1; layer = 1; sign = 1; return true;
+		case 'F': axis = 2; layer = -1; sign = -1; return true;
+		case 'S': axis = 2; layer = 0; sign = -1; return true;
+		case 'B': axis = 2; layer = 1; sign = 1; return true;
+		default: return false;
+		}
+	}
+
+	//Reads one turn such as R, R2 or R' and moves p past it
+	bool ReadTurn(const char*& p, Turn& turn)
+	{
+		int axis, layer, sign;
+		if (!FaceLayer(*p, axis, layer, sign))
+			return false;
+
+		turn.Face = *p++;
+		turn.QuarterTurns = 1;
+		if (*p == '2') {
+			turn.QuarterTurns = 2;
+			++p;
+		}
+		if (*p == '\'') {
+			//R2' is the same as R2
+			if (turn.QuarterTurns == 1)
+				turn.QuarterTurns = 3;
+			++p;
+		}
+		return *p == '\0' || *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r';
+	}
+
+	const char* SkipSpace(const char* p)
+	{
+		while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+			++p;
+		return p;
+	}
+
+	//Turns v a quarter turn about the axis, as XMMatrixRotationX/Y/Z(XM_PIDIV2) would
+	template<typename T>
+	void QuarterTurn(std::array<T, 3>& v, int axis)
+	{
+		int b = (axis + 1) % 3;
+		int c = (axis + 2) % 3;
+		T vb = v[b];
+		v[b] = -v[c];
+		v[c] = vb;
+	}
+}
+
+TurnQueue::TurnQueue(size_t capacity)
+	: mQueue(capacity)
+{
+	assert(capacity > 0);
+	Reset();
+}
+
+bool TurnQueue::Push(char face, int quarterTurns)
+{
+	int axis, layer, sign;
+	if (!FaceLayer(face, axis, layer, sign))
+		return false;
+
+	quarterTurns = ((quarterTurns % 4) + 4) % 4;
+	if (quarterTurns == 0)
+		return true;
+
+	//Turns about the same axis do not disturb each other, so look back through the run of
+	//them at the end of the queue for one of the same layer to merge with
+	for (size_t i = mCount; i-- > 0; ) {
+		Turn& queued = Queued(i);
+		int queuedAxis, queuedLayer, queuedSign;
+		FaceLayer(queued.Face, queuedAxis, queuedLayer, queuedSign);
+		if (queuedAxis != axis)
+			break;
+
+		if (queued.Face == face) {
+			queued.QuarterTurns = (queued.QuarterTurns + quarterTurns) % 4;
+			if (queued.QuarterTurns == 0)
+				RemoveQueued(i);
+			return true;
+		}
+	}
+
+	if (mCount == mQueue.size())
+		return false;
+
+	Turn& turn = Queued(mCount++);
+	turn.Face = face;
+	turn.QuarterTurns = quarterTurns;
+	return true;
+}
+
+int TurnQueue::PushSequence(const char* turns)
+{
+	//Read everything first, so a mistake part way through queues nothing
+	int count = 0;
+	Turn turn;
+	for (const char* p = SkipSpace(turns); *p != '\0'; p = SkipSpace(p)) {
+		if (!ReadTurn(p, turn))
+			return -1;
+		++count;
+	}
+
+	//Merging only ever shortens the queue, so this is enough room
+	if ((size_t)count > mQueue.size() - mCount)
+		return -1;
+
+	for (const char* p = SkipSpace(turns); *p != '\0'; p = SkipSpace(p)) {
+		ReadTurn(p, turn);
+		Push(turn.Face, turn.QuarterTurns);
+	}
+	return count;
+}
+
+void TurnQueue::Clear()
+{
+	mHead = 0;
+	mCount = 0;
+}
+
+void TurnQueue::Reset()
+{
+	Clear();
+	mActiveCount = 0;
+
+	for (int c = 0; c < CubieCount; ++c) {
+		mPosition[c] = { { (std::int8_t)(c / 9 - 1), (std::int8_t)(c / 3 % 3 - 1), (std::int8_t)(c % 3 - 1) } };
+		for (int row = 0; row < 3; ++row)
+			for (int column = 0; column < 3; ++column)
+				mOrientation[c][row][column] = row == column ? 1 : 0;
+	}
+	mMovedCubies = (1u << CubieCount) - 1;
+}
+
+void TurnQueue::SetTurnTime(float seconds)
+{
+	mTurnTime = (std::max)(seconds, 0.0f);
+}
+
+void TurnQueue::SetEasing(TurnEasing easing)
+{
+	mEasing = easing;
+}
+
+void TurnQueue::Advance(float dt)
+{
+	StartQueued();
+	dt = (std::max)(dt, 0.0f);
+
+	while (mActiveCount > 0) {
+		//Run everything on to the first turn that finishes, or to the end of dt
+		float step = dt;
+		for (size_t i = 0; i < mActiveCount; ++i)
+			step = (std::min)(step, mActive[i].Duration - mActive[i].Elapsed);
+
+		bool finished = false;
+		for (size_t i = 0; i < mActiveCount; ) {
+			Active& turn = mActive[i];
+			if (turn.Duration - turn.Elapsed <= step) {
+				Finish(turn);
+				turn = mActive[--mActiveCount];
+				finished = true;
+			}
+			else {
+				turn.Elapsed += step;
+				++i;
+			}
+		}
+		dt -= step;
+
+		if (!finished)
+			break;
+		StartQueued();
+	}
+}
+
+bool TurnQueue::IsTurning()const
+{
+	return mActiveCount > 0;
+}
+
+size_t TurnQueue::QueuedCount()const
+{
+	return mCount;
+}
+
+size_t TurnQueue::Capacity()const
+{
+	return mQueue.size();
+}
+
+size_t TurnQueue::ActiveCount()const
+{
+	return mActiveCount;
+}
+
+const Turn& TurnQueue::ActiveTurn(size_t i)const
+{
+	return mActive[i].Move;
+}
+
+const std::array<std::uint8_t, TurnQueue::LayerSize>& TurnQueue::ActiveCubies(size_t i)const
+{
+	return mActive[i].Cubies;
+}
+
+XMMATRIX TurnQueue::ActiveRotation(size_t i, float lookAhead)const
+{
+	const Active& turn = mActive[i];
+	float t = 1.0f;
+	if (turn.Duration > 0.0f)
+		t = (std::min)(turn.Elapsed + (std::max)(lookAhead, 0.0f), turn.Duration) / turn.Duration;
+
+	float angle = turn.Quarters * XM_PIDIV2 * Ease(t);
+	switch (turn.Axis) {
+	case 0: return XMMatrixRotationX(angle);
+	case 1: return XMMatrixRotationY(angle);
+	default: return XMMatrixRotationZ(angle);
+	}
+}
+
+XMMATRIX TurnQueue::SettledWorld(int cubie)const
+{
+	const auto& o = mOrientation[cubie];
+	const auto& p = mPosition[cubie];
+	return XMMatrixSet(
+		o[0][0], o[0][1], o[0][2], 0.0f,
+		o[1][0], o[1][1], o[1][2], 0.0f,
+		o[2][0], o[2][1], o[2][2], 0.0f,
+		p[0], p[1], p[2], 1.0f);
+}
+
+std::uint32_t TurnQueue::TakeMovedCubies()
+{
+	std::uint32_t moved = mMovedCubies;
+	mMovedCubies = 0;
+	return moved;
+}
+
+Turn& TurnQueue::Queued(size_t i)
+{
+	return mQueue[(mHead + i) % mQueue.size()];
+}
+
+void TurnQueue::RemoveQueued(size_t i)
+{
+	for (; i + 1 < mCount; ++i)
+		Queued(i) = Queued(i + 1);
+	--mCount;
+}
+
+bool TurnQueue::StartQueued()
+{
+	//Start turns from the front of the queue for as long as they are about the same axis
+	//as the turns in progress and on a layer that is free
+	bool started = false;
+	while (mCount > 0) {
+		const Turn& next = Queued(0);
+		int axis, layer, sign;
+		FaceLayer(next.Face, axis, layer, sign);
+
+		if (mActiveCount > 0 && mActive[0].Axis != axis)
+			break;
+
+		bool layerBusy = false;
+		for (size_t i = 0; i < mActiveCount; ++i)
+			layerBusy |= mActive[i].Layer == layer;
+		if (layerBusy)
+			break;
+
+		Active& turn = mActive[mActiveCount++];
+		turn.Move = next;
+		turn.Axis = axis;
+		turn.Layer = layer;
+		turn.Quarters = sign * (next.QuarterTurns == 3 ? -1 : next.QuarterTurns);
+		turn.Elapsed = 0.0f;
+		turn.Duration = mTurnTime * (next.QuarterTurns == 2 ? 2.0f : 1.0f);
+
+		int found = 0;
+		for (int c = 0; c < CubieCount; ++c) {
+			if (mPosition[c][axis] == layer)
+				turn.Cubies[found++] = (std::uint8_t)c;
+		}
+		assert(found == LayerSize);
+
+		mHead = (mHead + 1) % mQueue.size();
+		--mCount;
+		started = true;
+	}
+	return started;
+}
+
+void TurnQueue::Finish(const Active& turn)
+{
+	//Settle the cubies exactly where the turn leaves them
+	int quarters = ((turn.Quarters % 4) + 4) % 4;
+	for (std::uint8_t c : turn.Cubies) {
+		for (int q = 0; q < quarters; ++q) {
+			QuarterTurn(mPosition[c], turn.Axis);
+			for (auto& row : mOrientation[c])
+				QuarterTurn(row, turn.Axis);
+		}
+		mMovedCubies |= 1u << c;
+	}
+}
+
+float TurnQueue::Ease(float t)const
+{
+	switch (mEasing) {
+	case TurnEasing::SmoothStep: return t * t * (3.0f - 2.0f * t);
+	case TurnEasing::SmootherStep: return t * t * t * (t * (6.0f * t - 15.0f) + 10.0f);
+	default: return t;
+	}
+}
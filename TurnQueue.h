@@ -0,0 +1,128 @@
+/*Filename: TurnQueue.h
+ Description: Queues turns of the cube's layers, from the keys or whole sequences such as
+ scrambles and solutions written in the usual notation, and animates them.  It keeps
+ track of where every cubie is and which way round it sits, so each turn moves whichever
+ cubies are in its layer when it starts.
+
+ Turns queued one after another on the same face are merged (R R is R2, and R R' is
+ nothing).  Turns of parallel layers never share a cubie, so they are animated at the
+ same time.  The queue is allocated once, so even a long solution is played back
+ without allocating.*/
+
+#pragma once
+#include "Common/MemoryTracker.h"
+#include <DirectXMath.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//For the containers holding the cube's state, so MemoryTracker counts them as cube state
+template<typename T>
+using CubeStateAllocator = MemoryTracker::Allocator<T, MemoryTracker::CubeState>;
+
+enum class TurnEasing
+{
+	Linear,
+	SmoothStep,
+	SmootherStep
+};
+
+//A turn of one layer.  Face is one of the outer faces F B L R U D, or one of the middle
+//layers M (turned like L), E (like D) or S (like F).
+struct Turn
+{
+	char Face = ' ';
+
+	//Quarter turns clockwise looking at the face: 1, 2 for a half turn, or 3 for a
+	//quarter turn anticlockwise
+	int QuarterTurns = 0;
+};
+
+class TurnQueue
+{
+public:
+	static const int CubieCount = 27;
+	static const int LayerSize = 9;
+
+	//Starts solved, with every cubie where BuildRenderItems puts it: cubie
+	//9*(x+1) + 3*(y+1) + (z+1) at (x, y, z).
+	explicit TurnQueue(size_t capacity = 4096);
+
+	//Queues a turn, merging it with a queued turn of the same layer if only turns of
+	//parallel layers come between them.  Returns false if face is not a layer or the
+	//queue is full.
+	bool Push(char face, int quarterTurns = 1);
+
+	//Queues turns written like "R U R' U2", separated by spaces.  Returns the number of
+	//turns read, or -1 if the text is not a sequence of turns or they do not all fit, in
+	//which case nothing is queued.
+	int PushSequence(const char* turns);
+
+	//Drops the queued turns.  Turns already in progress carry on.
+	void Clear();
+
+	//Back to solved, with nothing queued or in progress.
+	void Reset();
+
+	//Seconds a quarter turn takes; half turns take twice as long.
+	void SetTurnTime(float seconds);
+	void SetEasing(TurnEasing easing);
+
+	//Moves the turns in progress on by dt seconds.  Time left over when a turn finishes is
+	//spent on the turns queued after it, so playback is the same however dt is split up.
+	void Advance(float dt);
+
+	bool IsTurning()const;
+	size_t QueuedCount()const;
+	size_t Capacity()const;
+
+	//The turns in progress, the cubies each is moving, and how far each has turned after
+	//lookAhead more seconds, as a rotation to apply after the cubies' settled worlds.
+	size_t ActiveCount()const;
+	const Turn& ActiveTurn(size_t i)const;
+	const std::array<std::uint8_t, LayerSize>& ActiveCubies(size_t i)const;
+	DirectX::XMMATRIX ActiveRotation(size_t i, float lookAhead = 0.0f)const;
+
+	//Where a cubie is, and which way round it is, after the last turn that finished with
+	//it.  Exact, however many turns it has been through.
+	DirectX::XMMATRIX SettledWorld(int cubie)const;
+
+	//Bit c is set for each cubie c whose settled world changed since the last call.
+	std::uint32_t TakeMovedCubies();
+
+private:
+	struct Active
+	{
+		Turn Move;
+		int Axis = 0;
+		int Layer = 0;
+		int Quarters = 0; //Signed quarter turns about the axis
+		float Elapsed = 0.0f;
+		float Duration = 0.0f;
+		std::array<std::uint8_t, LayerSize> Cubies;
+	};
+
+	Turn& Queued(size_t i);
+	void RemoveQueued(size_t i);
+	bool StartQueued();
+	void Finish(const Active& turn);
+	float Ease(float t)const;
+
+	//Ring buffer of turns waiting to start
+	std::vector<Turn, CubeStateAllocator<Turn>> mQueue;
+	size_t mHead = 0;
+	size_t mCount = 0;
+
+	//At most one turn per layer of the same axis runs at a time
+	std::array<Active, 3> mActive;
+	size_t mActiveCount = 0;
+
+	//Each cubie's position and the rows of its rotation, all whole numbers
+	std::array<std::array<std::int8_t, 3>, CubieCount> mPosition;
+	std::array<std::array<std::array<std::int8_t, 3>, 3>, CubieCount> mOrientation;
+	std::uint32_t mMovedCubies = 0;
+
+	float mTurnTime = 0.25f;
+	TurnEasing mEasing = TurnEasing::SmoothStep;
+};